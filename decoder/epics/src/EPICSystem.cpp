@@ -5,7 +5,8 @@
 #include <iomanip>
 #include <algorithm>
 #include <cassert>
-#include <sstream>
+#include <charconv>
+#include <cstring>
 
 #define EPICS_UNDEFINED_VALUE -9999.9
 
@@ -83,12 +84,26 @@ void EPICSystem::ReadMap(const std::string &path)
     }
 }
 
+// keep the sorted channel names for the lookup in the parser
+static void __insert_sorted(std::vector<std::pair<std::string, uint32_t>> &sorted,
+        const std::string &name, uint32_t id)
+{
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), name,
+            [](const std::pair<std::string, uint32_t> &a, const std::string &b) {return a.first < b;});
+
+    if(it != sorted.end() && it->first == name)
+        it->second = id;
+    else
+        sorted.emplace(it, name, id);
+}
+
 void EPICSystem::AddChannel(const std::string &name)
 {
     auto it = epics_map.find(name);
 
     if(it == epics_map.end()) {
         epics_map[name] = epics_values.size();
+        __insert_sorted(sorted_channels, name, epics_values.size());
         epics_values.push_back(EPICS_UNDEFINED_VALUE);
     } else {
         std::cout << " EPICS Warning: Failed to add duplicated channel "
@@ -105,6 +120,7 @@ void EPICSystem::AddChannel(const std::string &name, uint32_t id, float value)
     }
 
     epics_map[name] = id;
+    __insert_sorted(sorted_channels, name, id);
     epics_values.at(id) = value;
 }
 
@@ -116,67 +132,103 @@ void EPICSystem::UpdateChannel(const std::string &name, const float &value)
     }
 }
 
-void EPICSystem::FillRawData(const char *data)
+void EPICSystem::UpdateChannel(std::string_view name, const float &value)
 {
-    std::string raw_data(data);
+    int ch = FindChannel(name);
+    if(ch >= 0) {
+        epics_values[ch] = value;
+    }
+}
 
-    auto break_lines = [](const std::string &buf) -> std::vector<std::string>
-    {
-        std::vector<std::string> res;
+int EPICSystem::FindChannel(std::string_view name)
+const
+{
+    auto it = std::lower_bound(sorted_channels.begin(), sorted_channels.end(), name,
+            [](const std::pair<std::string, uint32_t> &a, std::string_view b) {return a.first < b;});
 
-        if(buf.size() <= 0)
-            return res;
+    if(it == sorted_channels.end() || it->first != name)
+        return -1;
 
-        size_t start = 0, end = 0;
-        for(; end<=buf.size(); end++) {
-            //std::cout<<"@"<<buf[end]<<"@ = @"<<(int)buf[end]<<std::endl;
-            if( (int)buf[end] != 10 && end != buf.size())
-                continue;
+    return it->second;
+}
 
-            if(end == start)
-                continue;
+// same white spaces as the stream extraction
+static inline bool __is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
 
-            std::string _tmp = buf.substr(start, end-start);
-            start = end+1;
+void EPICSystem::FillRawData(const char *data)
+{
+    // the tokens are views of the bank, no copies
+    const char *p = data;
+
+    // skip the empty lines
+    while(*p == '\n')
+        p++;
+
+    // the first line is the time stamp
+    const char *line_end = std::strchr(p, '\n');
+    if(line_end == nullptr)
+        line_end = p + std::strlen(p);
+    current_timestamp.assign(p, line_end);
+
+    // channel_name  channel_value
+    p = line_end;
+    while(*p)
+    {
+        if(*p == '\n') {
+            p++;
+            continue;
+        }
 
-            res.push_back(_tmp);
+        // split the line by white spaces, expect 2 tokens for an epics channel
+        std::string_view tokens[2];
+        int ntokens = 0;
+        while(*p && *p != '\n')
+        {
+            while(*p && *p != '\n' && __is_space(*p))
+                p++;
+            const char *beg = p;
+            while(*p && !__is_space(*p))
+                p++;
+            if(p == beg)
+                continue;
+            if(ntokens < 2)
+                tokens[ntokens] = std::string_view(beg, p - beg);
+            ntokens++;
         }
-        return res;
-    };
-    auto vec = break_lines(raw_data);
 
-    current_timestamp = vec[0];
+        if(ntokens != 2)
+            continue;
 
-    std::vector<std::pair<std::string, float>> cache;
-    for(size_t i=1; i<vec.size(); i++)
-    {
-        std::istringstream iss(vec[i]);
-        std::string tmp;
-        std::vector<std::string> v_split;
-        while(iss >> tmp) {
-            std::string _t = strip(tmp);
-            if(_t.size() > 0) v_split.push_back(strip(_t));
+        // stod accepts a leading '+' and the hex numbers (0x...), from_chars does not
+        std::string_view val_str = tokens[1];
+        bool negative = false;
+        if(val_str.size() > 1 && (val_str[0] == '+' || val_str[0] == '-')) {
+            negative = (val_str[0] == '-');
+            val_str.remove_prefix(1);
+        }
+        auto fmt = std::chars_format::general;
+        if(val_str.size() > 2 && val_str[0] == '0' && (val_str[1] == 'x' || val_str[1] == 'X')) {
+            fmt = std::chars_format::hex;
+            val_str.remove_prefix(2);
         }
 
-        // expect 2 elements for each epics channel
-        // channel_name  channel_value
-        if(v_split.size() == 2){
-            float val = 0;
-            std::string name = v_split[0];
-            try {
-                val = std::stod(v_split[1]);
-            } catch(...) {
-                std::cout<<__PRETTY_FUNCTION__<<" WARNING: failed fetching epics value for :"
-                    <<name<<std::endl;
-            }
-
-            cache.emplace_back(name, val);
+        double val = 0;
+        auto res = std::from_chars(val_str.data(), val_str.data() + val_str.size(), val, fmt);
+        // a sign is already removed
+        if(val_str[0] == '+' || val_str[0] == '-')
+            res.ec = std::errc::invalid_argument;
+        if(negative)
+            val = -val;
+        if(res.ec != std::errc()) {
+            val = 0;
+            std::cout<<__PRETTY_FUNCTION__<<" WARNING: failed fetching epics value for :"
+                <<tokens[0]<<std::endl;
         }
-    }
 
-    for(size_t i=0; i<cache.size(); i++)
-    {
-        UpdateChannel(cache[i].first, cache[i].second);
+        UpdateChannel(tokens[0], static_cast<float>(val));
     }
 }
 
@@ -2,8 +2,10 @@
 
 #include "TObject.h"
 
+// upper bounds of the decoded data per channel, the channel buffers are reserved to these sizes so the decoding
+// does not allocate memory, the pulse number is 2 bits and the window width (PTW) is at most 512 samples
 #define FADC250_MAX_NPEAKS 4
-#define FADC250_MAX_NSAMPLES 256
+#define FADC250_MAX_NSAMPLES 512
 
 // data structures
 namespace fdec
@@ -50,6 +52,7 @@ public:
         raw.reserve(FADC250_MAX_NSAMPLES);
     }
 
+    // keeps the capacities
     void Clear() { ped = Pedestal(0., 0.), peaks.clear(), raw.clear(); }
 
     ClassDef(Fadc250Data, 1);  // root io
@@ -7,6 +7,7 @@
 //
 
 #include "Fadc250Decoder.h"
+#include <algorithm>
 
 using namespace fdec;
 
@@ -23,21 +24,23 @@ inline Fadc250Data &get_channel(Fadc250Event &ev, uint32_t ch)
     return ev.channels[ch];
 }
 
+// fill the samples after the window header at buf[beg] until the next type word or the end of buffer,
+// at most max_samples are kept, returns the number of words read
 template<class Container>
-inline uint32_t fill_in_words(const uint32_t *buf, size_t beg, Container &raw_data, size_t max_words = -1)
+inline uint32_t fill_in_words(const uint32_t *buf, size_t beg, size_t buflen, Container &raw_data, size_t max_samples)
 {
     uint32_t nwords = 0;
-    for (uint32_t i = beg + 1; raw_data.size() < max_words; ++i, ++nwords) {
+    for (size_t i = beg + 1; i < buflen; ++i, ++nwords) {
         auto data = buf[i];
         // finished
-        if ((data & 0x80000000) && nwords > 0) {
+        if (data & 0x80000000) {
             return nwords;
         }
 
-        if (!(data & 0x20000000)) {
+        if (!(data & 0x20000000) && (raw_data.size() < max_samples)) {
             raw_data.push_back((data >> 16) & 0x1FFF);
         }
-        if (!(data & 0x2000)) {
+        if (!(data & 0x2000) && (raw_data.size() < max_samples)) {
             raw_data.push_back((data & 0x1FFF));
         }
     }
@@ -75,7 +78,9 @@ const
     }
 
     res.number = (header & 0x3FFFFF);
-    std::vector<std::vector<PeakBuffer>> peak_buffers(res.channels.size());
+    // channel is 4 bits and pulse number is 2 bits in the data words
+    PeakBuffer peak_buffers[FADC250_MAX_NCHANNELS][FADC250_MAX_NPEAKS];
+    size_t nchans = std::min(res.channels.size(), static_cast<size_t>(FADC250_MAX_NCHANNELS));
     uint32_t type = FillerWord;
 
     for (size_t iw = 1; iw < buflen; ++iw) {
@@ -91,17 +96,24 @@ const
         switch (type) {
         // trigger timing, might be multiple timing words
         case TriggerTime:
-            res.time.push_back(data & 0xFFFFFF);
+            if (res.time.size() < FADC250_MAX_NTIMES) {
+                res.time.push_back(data & 0xFFFFFF);
+            }
             break;
         // window raw data
         case WindowRawData:
             if (new_type) {
                 // get channel and window size
                 uint32_t ch = (data >> 23) & 0xF;
-                size_t nwords= (data & 0xFFF);
+                size_t nsamples = std::min(static_cast<size_t>(data & 0xFFF), static_cast<size_t>(FADC250_MAX_NSAMPLES));
+                if (ch >= nchans) {
+                    std::cout << "Fadc250Decoder Error: unexpected channel " << ch << " for window raw data. ";
+                    print_word(data);
+                    break;
+                }
                 auto &raw_data = get_channel(res, ch).raw;
                 raw_data.clear();
-                iw += fill_in_words(buf, iw, raw_data, nwords);
+                iw += fill_in_words(buf, iw, buflen, raw_data, nsamples);
             } else {
                 std::cout << "Fadc250Decoder Error: unexpected window raw data word. ";
                 print_word(data);
@@ -124,9 +136,6 @@ const
                 uint32_t ch = (data >> 23) & 0xF;
                 uint32_t pulse_num = (data >> 21) & 0x3;
                 // uint32_t quality = (data >> 19) & 0x3;
-                if (peak_buffers[ch].size() < pulse_num + 1) {
-                    peak_buffers[ch].resize(4);
-                }
                 peak_buffers[ch][pulse_num].integral = data & 0x7FFFF;
                 peak_buffers[ch][pulse_num].in_data = true;
             }
@@ -136,10 +145,6 @@ const
                 uint32_t ch = (data >> 23) & 0xF;
                 uint32_t pulse_num = (data >> 21) & 0x3;
                 // uint32_t quality = (data >> 19) & 0x3;
-                auto &chan = get_channel(res, ch);
-                if (peak_buffers[ch].size() < pulse_num + 1) {
-                    peak_buffers[ch].resize(4);
-                }
                 // convert to ns (1e3 / _clk (MHz) / 64)
                 peak_buffers[ch][pulse_num].time = data & 0xFFFF;
                 peak_buffers[ch][pulse_num].in_data = true;
@@ -160,7 +165,7 @@ const
     }
 
     // fill peak buffers to result
-    for (size_t i = 0; i < peak_buffers.size(); ++i) {
+    for (size_t i = 0; i < nchans; ++i) {
         for (auto &peak : peak_buffers[i]) {
             if (!peak.in_data) {
                 continue;
@@ -34,6 +34,11 @@ enum Fadc250Type {
     FillerWord = 15,
 };
 
+#define FADC250_MAX_NCHANNELS 16
+#define FADC250_MAX_NTIMES 4
+
+// decoded data of a slot, keep one for each slot and reuse it for all the events,
+// the buffers are reserved to the upper bounds so the decoding does not allocate memory
 class Fadc250Event
 {
 public:
@@ -41,12 +46,14 @@ public:
     std::vector<uint32_t> time;
     std::vector<Fadc250Data> channels;
 
-    Fadc250Event(uint32_t n = 0, uint32_t nch = 16)
+    Fadc250Event(uint32_t n = 0, uint32_t nch = FADC250_MAX_NCHANNELS)
         : number(n), mode(0)
     {
+        time.reserve(FADC250_MAX_NTIMES);
         channels.resize(nch);
     }
 
+    // keeps the capacities
     void Clear()
     {
         mode = 0;
@@ -60,9 +67,10 @@ class Fadc250Decoder
 public:
     Fadc250Decoder(double clk = 250.);
 
-    // for an event data
+    // for an event data, it decodes into the buffers of the event and does not allocate memory once they reach the
+    // upper bounds (reserved by Fadc250Event), the samples beyond FADC250_MAX_NSAMPLES of a window are discarded
     void DecodeEvent(Fadc250Event &event, const uint32_t *buf, size_t len) const;
-    inline Fadc250Event DecodeEvent(const uint32_t *buf, size_t len, size_t nchans = 16) const
+    inline Fadc250Event DecodeEvent(const uint32_t *buf, size_t len, size_t nchans = FADC250_MAX_NCHANNELS) const
     {
         Fadc250Event evt;
         evt.channels.resize(nchans);
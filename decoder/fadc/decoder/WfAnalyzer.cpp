@@ -13,6 +13,12 @@ Analyzer::Analyzer(size_t res, double thres, size_t npeds, double ped_flat, uint
 }
 
 void Analyzer::Analyze(Fadc250Data &data, double ped_ext, double err_ext) const
+{
+    thread_local AnalyzerBuffers bufs;
+    Analyze(data, bufs, ped_ext, err_ext);
+}
+
+void Analyzer::Analyze(Fadc250Data &data, AnalyzerBuffers &bufs, double ped_ext, double err_ext) const
 {
     uint32_t *samples = &data.raw[0];
     size_t nsamples = data.raw.size();
@@ -20,13 +26,16 @@ void Analyzer::Analyze(Fadc250Data &data, double ped_ext, double err_ext) const
 
     data.peaks.clear();
 
-    auto buffer = SmoothSpectrum(samples, nsamples, _res);
+    bufs.buffer.resize(nsamples);
+    double *buffer = bufs.buffer.data();
+    SmoothSpectrum(samples, nsamples, _res, buffer);
 
     // search local maxima
-    auto candidates = SearchMaxima(buffer, _thres);
+    SearchMaxima(buffer, nsamples, _thres, bufs);
+    auto &candidates = bufs.candidates;
 
     // get pedestal event by event 
-    data.ped = FindPedestal(buffer, candidates);
+    data.ped = FindPedestal(buffer, nsamples, bufs);
 
     //changed by Jixie: use fixed pedestal and its sigma value to overwrite the newly extracted mean & err
     if(ped_ext>10.0) data.ped.mean = ped_ext;
@@ -112,27 +121,62 @@ Fadc250Data Analyzer::Analyze(const uint32_t *samples, size_t nsamples) const
 
 //find pedestal, it assumes the pedestal is a constant (for simple FADC250 spectrum)
 Pedestal Analyzer::FindPedestal(const std::vector<double> &buffer, const std::vector<Peak> &/*peaks*/) const
+{
+    AnalyzerBuffers bufs;
+    return FindPedestal(buffer.data(), buffer.size(), bufs);
+}
+
+Pedestal Analyzer::FindPedestal(const double *buffer, size_t size, AnalyzerBuffers &bufs) const
 {
     Pedestal ped{0., 0.};
     // too few samples, use the minimum value as the pedestal
-    if (buffer.size() < _npeds) {
-        _calc_mean_err(ped.mean, ped.err, &buffer[0], buffer.size());
-        for (auto &val : buffer) {
-            if (val < ped.mean) { ped.mean = val; }
+    if (size < _npeds) {
+        _calc_mean_err(ped.mean, ped.err, buffer, size);
+        for (size_t i = 0; i < size; ++i) {
+            if (buffer[i] < ped.mean) { ped.mean = buffer[i]; }
         }
         return ped;
     }
 
     // number of trailing samples for pedestal
-    int ntrails = std::max(_npeds, buffer.size()/12);
+    size_t ntrails = std::max(_npeds, size/12);
     // criteria for good pedestal (some overflow events will have a few flat samples)
     double max_mean = _overflow*0.95;
     bool find_baseline = false;
 
+    // prefix sums of the samples (relative to the first one to keep the precision),
+    // so the mean and variance of every window are obtained in O(1)
+    auto &sum = bufs.sum;
+    auto &sum2 = bufs.sum2;
+    sum.resize(size + 1);
+    sum2.resize(size + 1);
+    double ref = buffer[0], max_sum = 0.;
+    sum[0] = sum2[0] = 0.;
+    for (size_t i = 0; i < size; ++i) {
+        double diff = buffer[i] - ref;
+        sum[i + 1] = sum[i] + diff;
+        sum2[i + 1] = sum2[i] + diff*diff;
+        max_sum = std::max(max_sum, std::abs(sum[i + 1]));
+    }
+
+    // the prefix sums are only used to skip the windows that cannot be selected, the windows close to the criteria
+    // are recomputed with _calc_mean_err so the results are exactly the same as computing every window from scratch
+    double nwin = static_cast<double>(ntrails), inv_nwin = 1./nwin;
+    double tol_mean = 1e-9*(1. + std::abs(ref) + max_sum/nwin);
+    double tol_var = 1e-9*(1. + sum2[size]/nwin + (max_sum/nwin)*(max_sum/nwin));
+    double max_var = _ped_flat*_ped_flat;
+
     // progressively find a good baseline
     ped.mean = max_mean;
-    for (size_t i = 0; i <= buffer.size() - ntrails; ++i) {
-        double mean = 0., err = 100.*_ped_flat;
+    for (size_t i = 0; (_ped_flat > 0.) && (i + ntrails <= size); ++i) {
+        double wsum = sum[i + ntrails] - sum[i];
+        double mean = ref + wsum*inv_nwin;
+        double var = (sum2[i + ntrails] - sum2[i] - wsum*wsum*inv_nwin)*inv_nwin;
+        // not flat, or not below the current baseline (which starts from max_mean)
+        if ((var >= max_var + tol_var) || (mean >= ped.mean + tol_mean)) {
+            continue;
+        }
+        double err;
         _calc_mean_err(mean, err, &buffer[i], ntrails);
         if(err < _ped_flat && mean < max_mean) {
             find_baseline = true;
@@ -144,7 +188,8 @@ Pedestal Analyzer::FindPedestal(const std::vector<double> &buffer, const std::ve
     }
 
     // complicated spectrum
-    auto ybuf = buffer;
+    auto &ybuf = bufs.ybuf;
+    ybuf.assign(buffer, buffer + size);
     TSpectrum s;
     s.Background(&ybuf[0], ybuf.size(), ybuf.size()/4, TSpectrum::kBackDecreasingWindow,
                     TSpectrum::kBackOrder2, false, TSpectrum::kBackSmoothing3, false);
@@ -153,27 +198,63 @@ Pedestal Analyzer::FindPedestal(const std::vector<double> &buffer, const std::ve
 
 std::vector<Peak> Analyzer::SearchMaxima(const std::vector<double> &buffer, double height_thres) const
 {
-    std::vector<Peak> candidates;
-    if (buffer.size() < 3) { return candidates; }
+    AnalyzerBuffers bufs;
+    SearchMaxima(buffer.data(), buffer.size(), height_thres, bufs);
+    return bufs.candidates;
+}
 
-    candidates.reserve(buffer.size()/3);
-    // get trend
-    auto trend = [] (double v1, double v2, double thr = 0.1) {
-        return std::abs(v1 - v2) < thr ? 0 : (v1 > v2 ? 1 : -1);
+void Analyzer::SearchMaxima(const double *buffer, size_t size, double height_thres, AnalyzerBuffers &bufs) const
+{
+    auto &candidates = bufs.candidates;
+    candidates.clear();
+    if (size < 3) { return; }
+
+    // get trend, same as (|v1 - v2| < thr ? 0 : (v1 > v2 ? 1 : -1)) but without branches
+    auto get_trend = [] (double v1, double v2, double thr = 0.1) {
+        double diff = v1 - v2;
+        return static_cast<int>(diff >= thr) - static_cast<int>(diff <= -thr);
     };
-    for (uint32_t i = 1; i < buffer.size() - 1; ++i) {
-        int tr1 = trend(buffer[i], buffer[i - 1]);
-        int tr2 = trend(buffer[i], buffer[i + 1]);
+
+    // trend[i] is the trend of sample i to sample i - 1, trend(buffer[i], buffer[i + 1]) is then -trend[i + 1]
+    // run_left[i] is the number of the same trends ending at i (down to 2), it extends the peak range to the left
+    // run_not_up[i] (run_not_down[i]) is the number of non-rising (non-declining) trends starting at i,
+    // it extends the peak range of a rising (declining) edge to the right
+    auto &trend = bufs.trend;
+    auto &run_left = bufs.run_left;
+    auto &run_not_up = bufs.run_not_up;
+    auto &run_not_down = bufs.run_not_down;
+    trend.resize(size + 1);
+    run_left.resize(size + 1);
+    run_not_up.resize(size + 1);
+    run_not_down.resize(size + 1);
+
+    trend[0] = trend[size] = 0;
+    run_left[0] = run_left[1] = 0;
+    int run = 0;
+    for (size_t i = 1; i < size; ++i) {
+        trend[i] = get_trend(buffer[i], buffer[i - 1]);
+        if (i >= 2) {
+            run = ((i > 2) && (trend[i] == trend[i - 1])) ? run + 1 : 1;
+            run_left[i] = run;
+        }
+    }
+    int not_up = 0, not_down = 0;
+    run_not_up[size] = run_not_down[size] = 0;
+    for (size_t i = size - 1; i >= 1; --i) {
+        not_up = (trend[i] <= 0) ? not_up + 1 : 0;
+        not_down = (trend[i] >= 0) ? not_down + 1 : 0;
+        run_not_up[i] = not_up;
+        run_not_down[i] = not_down;
+    }
+
+    for (uint32_t i = 1; i < size - 1; ++i) {
+        int tr1 = trend[i];
+        int tr2 = -trend[i + 1];
         // peak at the rising (declining) edge
         if ((tr1 * tr2 >= 0) && (std::abs(tr1) > 0)) {
-            uint32_t left = 1, right = 1;
             // search the peak range
-            while ((i > left + 1) && (trend(buffer[i - left], buffer[i - left - 1]) == tr1)) {
-                left ++;
-            }
-            while ((i + right < buffer.size() - 1) && (trend(buffer[i + right], buffer[i + right + 1])*tr1 >= 0)) {
-                right ++;
-            }
+            uint32_t left = 1 + (((i > 2) && (trend[i - 1] == tr1)) ? run_left[i - 1] : 0);
+            uint32_t right = 1 + ((tr1 > 0) ? run_not_up[i + 2] : run_not_down[i + 2]);
 
             double base = (buffer[i - left] * right + buffer[i + right] * left) / static_cast<double>(left + right);
             double height = std::abs(buffer[i] - base);
@@ -182,6 +263,4 @@ std::vector<Peak> Analyzer::SearchMaxima(const std::vector<double> &buffer, doub
             }
         }
     }
-    return candidates;
 }
-
@@ -72,6 +72,20 @@ inline void _linear_regr(double &p0, double &p1, double &err, const T *x, const
     err = std::sqrt(err/static_cast<double>(npts));
 }
 
+// scratch buffers for the analyzer, keep one for each thread and reuse it for all the waveforms,
+// the analysis does not allocate memory once the buffers have grown to the waveform size
+struct AnalyzerBuffers
+{
+    // smoothed spectrum and its copy for the background estimation
+    std::vector<double> buffer, ybuf;
+    // prefix sums of the samples and their squares for the pedestal windows
+    std::vector<double> sum, sum2;
+    // trends between the neighbor samples and the lengths of the trend runs for the peak ranges
+    std::vector<int> trend, run_left, run_not_up, run_not_down;
+    // peak candidates
+    std::vector<Peak> candidates;
+};
+
 // analyzer class
 class Analyzer
 {
@@ -83,13 +97,17 @@ public:
     virtual ~Analyzer() {}
 
     // analyze waveform samples
+    void Analyze(Fadc250Data &data, AnalyzerBuffers &bufs, double ped_ext=0, double err_ext=0) const;
+    // use the scratch buffers of the calling thread
     void Analyze(Fadc250Data &data, double ped_ext=0, double err_ext=0) const;
     Fadc250Data Analyze(const uint32_t *samples, size_t nsamples) const;
 
     // find pedestal, it assumes the pedestal is a constant (for simple FADC250 spectrum)
+    Pedestal FindPedestal(const double *buffer, size_t size, AnalyzerBuffers &bufs) const;
     Pedestal FindPedestal(const std::vector<double> &buffer, const std::vector<Peak> &/*peaks*/) const;
 
-    // search local maxima as peak candidates
+    // search local maxima as peak candidates, the results are in bufs.candidates
+    void SearchMaxima(const double *buffer, size_t size, double height_thres, AnalyzerBuffers &bufs) const;
     std::vector<Peak> SearchMaxima(const std::vector<double> &buffer, double height_thres) const;
 
     // get
@@ -116,11 +134,20 @@ public:
     // static methods
     template<typename T>
     static std::vector<double> SmoothSpectrum(const T *samples, size_t nsamples, size_t res)
+    {
+        std::vector<double> buffer(nsamples);
+        SmoothSpectrum(samples, nsamples, res, buffer.data());
+        return buffer;
+    }
+
+    // smooth the spectrum into a buffer of nsamples
+    template<typename T>
+    static void SmoothSpectrum(const T *samples, size_t nsamples, size_t res, double *buffer)
     {
         if (res <= 1) {
-            return std::vector<double>(samples, samples + nsamples);
+            std::copy(samples, samples + nsamples, buffer);
+            return;
         }
-        std::vector<double> buffer(nsamples);
         for (size_t i = 0; i < nsamples; ++i) {
             double val = samples[i];
             double weights = 1.0;
@@ -132,7 +159,6 @@ public:
             }
             buffer[i] = val/weights;
         }
-        return buffer;
     }
 
     template<typename T>
@@ -0,0 +1,149 @@
+#ifndef MPD_SSP_RAW_EVENT_DECODER_H
+#define MPD_SSP_RAW_EVENT_DECODER_H
+
+#include <vector>
+
+#include "AbstractRawDecoder.h"
+#include "MPDDataStruct.h"
+#include "RolStruct.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// define macros
+
+#define SSP_TIME_SAMPLE 6 // number of time sample is fixed to 6 in ssp firmware
+#define TS_PERIOD_LEN 129 // word length of each time sample
+
+////////////////////////////////////////////////////////////////////////////////
+// SSP apv data flag
+
+struct APVDataType
+{
+    uint32_t data_flag;
+    uint32_t crate_id;
+    uint32_t mpd_id;
+    uint32_t adc_ch;
+    uint32_t slot_id;
+
+    APVDataType():
+        data_flag(0), crate_id(-1), mpd_id(-1), adc_ch(-1), slot_id(11)
+    {}
+
+    // copy ctor
+    APVDataType(const APVDataType &r):
+        data_flag(r.data_flag), crate_id(r.crate_id), mpd_id(r.mpd_id),
+        adc_ch(r.adc_ch), slot_id(r.slot_id)
+    {}
+
+    // copy assignment
+    APVDataType & operator = (const APVDataType &r) {
+        data_flag = r.data_flag;
+        crate_id = r.crate_id;
+        mpd_id = r.mpd_id;
+        adc_ch = r.adc_ch;
+        slot_id = r.slot_id;
+        return *this;
+    }
+
+    void SetAPVAddress(const APVAddress &a) {
+        crate_id = a.crate_id;
+        mpd_id = a.mpd_id;
+        adc_ch = a.adc_ch;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// SSP raw data decoder
+
+class MPDSSPRawEventDecoder : public AbstractRawDecoder
+{
+public:
+    // word length of the decoded data of one APV
+    static constexpr uint32_t APV_DATA_SIZE = SSP_TIME_SAMPLE * TS_PERIOD_LEN;
+
+    MPDSSPRawEventDecoder();
+    ~MPDSSPRawEventDecoder();
+
+    void Decode(const uint32_t *pBuf, uint32_t fBufLen, std::vector<int> &vTagTrack);
+    void DecodeAPV(const uint32_t *pBuf, uint32_t fBufLen,
+            std::vector<int> &vTagTrack);
+
+    // the decoded APVs are stored in a flat buffer (APV_DATA_SIZE words per APV),
+    // indexed by a dense APV id, the ids of the APVs from the GEM map can be
+    // assigned in advance, APVs not in the list get new ids when they first appear
+    void SetAPVList(const std::vector<APVAddress> &apvs);
+    int GetAPVIndex(const APVAddress &addr) const;
+    uint32_t GetNumberOfAPVs() const {return apv_address.size();}
+    // dense ids of the APVs decoded since the last Clear, in decoding order
+    const std::vector<int> &GetDecodedAPVs() const {return decoded_apvs;}
+    const APVAddress &GetAPVAddress(int id) const {return apv_address[id];}
+    const int *GetAPVData(int id) const {return &apv_data[id * APV_DATA_SIZE];}
+    const APVDataType &GetAPVDataFlags(int id) const {return apv_flags[id];}
+    // nullptr if there is no online common mode for this APV
+    const int *GetAPVOnlineCommonMode(int id) const
+    {
+        return apv_has_cm[id] ? &apv_online_cm[id * SSP_TIME_SAMPLE] : nullptr;
+    }
+
+    // maps of the decoded data, they are built from the flat buffer on request
+    const std::unordered_map<APVAddress, std::vector<int>> &
+        GetAPV() const;
+    const std::unordered_map<APVAddress, APVDataType> &
+        GetAPVDataFlags() const;
+    const std::unordered_map<APVAddress, std::vector<int>> &
+        GetAPVOnlineCommonMode() const;
+
+    void sspApvDataDecode(const uint32_t & data);
+
+    void Clear();
+
+    // debug helper
+    void print();
+
+private:
+    int addAPV(const APVAddress &addr);
+    int findOrAddAPV(const APVAddress &addr);
+    int *onlineCommonMode(const APVAddress &addr);
+    void buildMaps() const;
+
+private:
+    // dense APV ids
+    std::unordered_map<APVAddress, int> apv_index;
+    std::vector<APVAddress> apv_address;
+    APVAddress last_address;
+    int last_index = -1;
+
+    // decoded data, reused for all events, only the decoded parts are reset by Clear
+    std::vector<int> apv_data;
+    // flags: lower 6-bit in effect. bit(6)=1: common mode subtracted
+    //                               bit(5)=1: build all strips (zero suppression is disabled)
+    std::vector<APVDataType> apv_flags;
+    // common mode calculated online (6 time samples per APV)
+    std::vector<int> apv_online_cm;
+    std::vector<char> apv_decoded, apv_has_cm;
+    std::vector<int> decoded_apvs, cm_apvs;
+    APVAddress apvAddress;
+
+    // maps for GetAPV, GetAPVDataFlags and GetAPVOnlineCommonMode
+    mutable bool maps_valid = false;
+    mutable std::unordered_map<APVAddress, std::vector<int>> mAPVData;
+    mutable std::unordered_map<APVAddress, APVDataType> mAPVDataFlags;
+    mutable std::unordered_map<APVAddress, std::vector<int>> mAPVOnlineCommonMode;
+
+    // the 6 time samples in one strip <channel_no, 6 ADCs>
+    uint32_t current_strip_number = -1;
+    int vStripADC[SSP_TIME_SAMPLE];
+    APVDataType flags;
+
+    // words for getting information during ssp decoding, they carry over
+    // from one data word to the next, so every decoder instance keeps its own
+    // (each replay thread can then run its own decoder)
+    uint32_t type_last = 15; // initialize to type FILLER WORD
+    uint32_t time_last = 0;
+    int new_type = 0;
+    int apv_data_word = 0;
+    bool current_strip_finished = false;
+    int mpd_debug_header_word = 0;
+    int mpd_timestamp_data_word = 0;
+};
+
+#endif
@@ -1,4 +1,6 @@
 #include "EvioFileReader.h"
+#include "EvIndex.h"
+#include "EvMappedChannel.h"
 
 #include <iostream>
 
@@ -33,7 +35,8 @@ EvioFileReader::EvioFileReader(std::string file_name)
 
 EvioFileReader::~EvioFileReader()
 {
-    // place holder
+    delete pMappedFile;
+    delete pIndex;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -41,7 +44,7 @@ EvioFileReader::~EvioFileReader()
 
 void EvioFileReader::SetFile(const char* path)
 {
-    fFileName = path;
+    SetFile(std::string(path));
 }
 
 ////////////////////////////////////////////////////////////////
@@ -50,6 +53,13 @@ void EvioFileReader::SetFile(const char* path)
 void EvioFileReader::SetFile(std::string path)
 {
     fFileName = path;
+
+    // the index belongs to the previous file
+    delete pMappedFile;
+    delete pIndex;
+    pMappedFile = nullptr;
+    pIndex = nullptr;
+    bIndexTried = false;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -124,7 +134,51 @@ int EvioFileReader::Read(uint32_t *buf, uint32_t size)
 int EvioFileReader::ReadEventNum(const uint32_t **pEvent, uint32_t *buflen,
         uint32_t eventNumber)
 {
-    return evReadRandom(fFileHandle, pEvent, buflen, eventNumber);
+    // without the index, it needs the random access mode "ra", which
+    // scans the whole file when it is opened
+    if(!LoadIndex())
+        return evReadRandom(fFileHandle, pEvent, buflen, eventNumber);
+
+    // event number starts from 1, same as evReadRandom
+    if(pEvent == nullptr || eventNumber < 1 || eventNumber > pIndex->Size())
+        return S_EVFILE_BADARG;
+
+    const evc::EvIndexEntry &entry = (*pIndex)[eventNumber - 1];
+    if(pMappedFile->Seek(entry) != evc::status::success
+            || pMappedFile->Read() != evc::status::success)
+        return S_EVFILE_BADFILE;
+
+    // the event parsers expect a fully swapped event
+    pMappedFile->SwapEvent();
+    *pEvent = pMappedFile->GetRawBuffer();
+    *buflen = entry.length;
+
+    return S_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////
+// load the event index (<file>.idx), build it if it does not exist
+
+bool EvioFileReader::LoadIndex()
+{
+    if(bIndexTried)
+        return pIndex != nullptr;
+    bIndexTried = true;
+
+    pIndex = new evc::EvIndex();
+    pMappedFile = new evc::EvMappedChannel();
+    if(pIndex->LoadOrBuild(fFileName) != evc::status::success
+            || pMappedFile->Open(fFileName) != evc::status::success) {
+        std::cout<<"Warning: EvioFileReader cannot use the event index for: "
+                 <<fFileName<<", fall back to evReadRandom."<<std::endl;
+        delete pMappedFile;
+        delete pIndex;
+        pMappedFile = nullptr;
+        pIndex = nullptr;
+        return false;
+    }
+
+    return true;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -1,21 +1,10 @@
 #include "MPDSSPRawEventDecoder.h"
 #include "sspApvdec.h"
 #include <iostream>
+#include <algorithm>
 #include <cassert>
 
 
-////////////////////////////////////////////////////////////////
-// static words for getting information during ssp decoding, 
-// a temporary solution, needs to be removed
-
-static uint32_t type_last = 15;	/* initialize to type FILLER WORD */
-static uint32_t time_last = 0;
-static int new_type = 0;
-static int apv_data_word = 0;
-static bool current_strip_finished = false;
-static int mpd_debug_header_word = 0;
-static int mpd_timestamp_data_word = 0;
-
 ////////////////////////////////////////////////////////////////
 // a helper for printing word in binary format (13 digits a group)
 
@@ -61,7 +50,8 @@ MPDSSPRawEventDecoder::MPDSSPRawEventDecoder()
                             -1, // mpd id   = fiber id
                             -1);// adc ch   = apv id
 
-    vStripADC.clear();
+    for(auto &adc: vStripADC)
+        adc = 0;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -102,6 +92,8 @@ void MPDSSPRawEventDecoder::Decode([[maybe_unused]] const uint32_t *pBuf,
 void MPDSSPRawEventDecoder::DecodeAPV(const uint32_t *pBuf, uint32_t fBufLen,
         [[maybe_unused]]std::vector<int> &vTagTrack)
 {
+    maps_valid = false;
+
     for(uint32_t i = 0; i<fBufLen; i++)
     {
         sspApvDataDecode(pBuf[i]);
@@ -115,40 +107,113 @@ void MPDSSPRawEventDecoder::DecodeAPV(const uint32_t *pBuf, uint32_t fBufLen,
         apvAddress.crate_id = vTagTrack[1];
 
         // reorganize data into time sample format
-        if(mAPVData.find(apvAddress) == mAPVData.end()) {
-            mAPVData[apvAddress].resize(SSP_TIME_SAMPLE * TS_PERIOD_LEN, 0);
+        int id = findOrAddAPV(apvAddress);
+        if(!apv_decoded[id]) {
+            apv_decoded[id] = 1;
+            decoded_apvs.push_back(id);
             flags.SetAPVAddress(apvAddress);
-            mAPVDataFlags[apvAddress] = flags;
+            apv_flags[id] = flags;
         }
 
+        int *data = &apv_data[id * APV_DATA_SIZE];
         for(int ts = 0; ts < SSP_TIME_SAMPLE; ts++)
         {
 #ifdef DEBUG
             // duplicate APV ID detected
-            if(mAPVData[apvAddress][ts*TS_PERIOD_LEN + current_strip_number] != 0) 
-            {
+            if(data[ts*TS_PERIOD_LEN + current_strip_number] != 0)
                 std::cout<<__func__<<" Warning: duplicated APV detected: "<<apvAddress<<std::endl;
-                while( mAPVData.find(apvAddress) != mAPVData.end() &&
-                        mAPVData[apvAddress][ts*TS_PERIOD_LEN + current_strip_number] != 0)
-                {
-                    apvAddress.adc_ch += 16;
-                }
-                if(mAPVData.find(apvAddress) == mAPVData.end() )
-                    mAPVData[apvAddress].resize(SSP_TIME_SAMPLE * TS_PERIOD_LEN, 0);
-            }
 #endif
-            mAPVData[apvAddress][ts*TS_PERIOD_LEN + current_strip_number] = 
-                vStripADC[ts];
+            data[ts*TS_PERIOD_LEN + current_strip_number] = vStripADC[ts];
         }
     }
 }
 
+////////////////////////////////////////////////////////////////
+// assign the dense ids to the APVs in the GEM map, the buffers
+// for all of them are allocated here
+
+void MPDSSPRawEventDecoder::SetAPVList(const std::vector<APVAddress> &apvs)
+{
+    Clear();
+
+    apv_index.clear();
+    apv_address.clear();
+    apv_data.clear();
+    apv_flags.clear();
+    apv_online_cm.clear();
+    apv_decoded.clear();
+    apv_has_cm.clear();
+    last_index = -1;
+
+    apv_address.reserve(apvs.size());
+    apv_data.reserve(apvs.size() * APV_DATA_SIZE);
+    for(auto &a: apvs)
+    {
+        if(apv_index.find(a) == apv_index.end())
+            addAPV(a);
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// get the dense id of an APV, -1 if it is unknown
+
+int MPDSSPRawEventDecoder::GetAPVIndex(const APVAddress &addr) const
+{
+    auto it = apv_index.find(addr);
+    return (it == apv_index.end()) ? -1 : it->second;
+}
+
+////////////////////////////////////////////////////////////////
+// add an APV to the flat buffers
+
+int MPDSSPRawEventDecoder::addAPV(const APVAddress &addr)
+{
+    int id = apv_address.size();
+    apv_index[addr] = id;
+    apv_address.push_back(addr);
+    apv_data.resize(apv_data.size() + APV_DATA_SIZE, 0);
+    apv_flags.emplace_back();
+    apv_online_cm.resize(apv_online_cm.size() + SSP_TIME_SAMPLE, 0);
+    apv_decoded.push_back(0);
+    apv_has_cm.push_back(0);
+    return id;
+}
+
+////////////////////////////////////////////////////////////////
+// the strips of one APV come together, so the last APV is checked first
+
+int MPDSSPRawEventDecoder::findOrAddAPV(const APVAddress &addr)
+{
+    if(last_index >= 0 && addr == last_address)
+        return last_index;
+
+    auto it = apv_index.find(addr);
+    last_index = (it == apv_index.end()) ? addAPV(addr) : it->second;
+    last_address = addr;
+    return last_index;
+}
+
+////////////////////////////////////////////////////////////////
+// online common mode buffer of an APV
+
+int *MPDSSPRawEventDecoder::onlineCommonMode(const APVAddress &addr)
+{
+    int id = findOrAddAPV(addr);
+    if(!apv_has_cm[id]) {
+        apv_has_cm[id] = 1;
+        cm_apvs.push_back(id);
+        maps_valid = false;
+    }
+    return &apv_online_cm[id * SSP_TIME_SAMPLE];
+}
+
 ////////////////////////////////////////////////////////////////
 // get decoded apv data
 
 const std::unordered_map<APVAddress, std::vector<int>> &
 MPDSSPRawEventDecoder::GetAPV() const
 {
+    buildMaps();
     return mAPVData;
 }
 
@@ -158,6 +223,7 @@ MPDSSPRawEventDecoder::GetAPV() const
 const std::unordered_map<APVAddress, APVDataType> &
 MPDSSPRawEventDecoder::GetAPVDataFlags() const
 {
+    buildMaps();
     return mAPVDataFlags;
 }
 
@@ -167,17 +233,53 @@ MPDSSPRawEventDecoder::GetAPVDataFlags() const
 const std::unordered_map<APVAddress, std::vector<int>> &
 MPDSSPRawEventDecoder::GetAPVOnlineCommonMode() const
 {
+    buildMaps();
     return mAPVOnlineCommonMode;
 }
 
 ////////////////////////////////////////////////////////////////
-// clear for next event
+// copy the decoded data to the maps
 
-void MPDSSPRawEventDecoder::Clear()
+void MPDSSPRawEventDecoder::buildMaps() const
 {
+    if(maps_valid)
+        return;
+
     mAPVData.clear();
     mAPVDataFlags.clear();
     mAPVOnlineCommonMode.clear();
+    for(auto &id: decoded_apvs)
+    {
+        const int *data = GetAPVData(id);
+        mAPVData[apv_address[id]].assign(data, data + APV_DATA_SIZE);
+        mAPVDataFlags[apv_address[id]] = apv_flags[id];
+    }
+    for(auto &id: cm_apvs)
+    {
+        const int *cm = GetAPVOnlineCommonMode(id);
+        mAPVOnlineCommonMode[apv_address[id]].assign(cm, cm + SSP_TIME_SAMPLE);
+    }
+    maps_valid = true;
+}
+
+////////////////////////////////////////////////////////////////
+// clear for next event, only the buffers of decoded APVs are reset
+
+void MPDSSPRawEventDecoder::Clear()
+{
+    for(auto &id: decoded_apvs)
+    {
+        std::fill_n(&apv_data[id * APV_DATA_SIZE], APV_DATA_SIZE, 0);
+        apv_decoded[id] = 0;
+    }
+    for(auto &id: cm_apvs)
+    {
+        std::fill_n(&apv_online_cm[id * SSP_TIME_SAMPLE], SSP_TIME_SAMPLE, 0);
+        apv_has_cm[id] = 0;
+    }
+    decoded_apvs.clear();
+    cm_apvs.clear();
+    maps_valid = false;
 }
 
 // a helper to get negative values
@@ -196,11 +298,7 @@ static int convert(const uint32_t & word)
 void MPDSSPRawEventDecoder::sspApvDataDecode(const uint32_t &data)
 {
     current_strip_finished = false;
-    //static uint32_t type_last = 15;	/* initialize to type FILLER WORD */
-    //static uint32_t time_last = 0;
-    //static int new_type = 0;
     int type_current = 0;
-    //static int apv_data_word = 0;
     generic_data_word_t gword;
 
     gword.raw = data;
@@ -315,9 +413,8 @@ void MPDSSPRawEventDecoder::sspApvDataDecode(const uint32_t &data)
                                 //        d.bf.apv_sample1,
                                 //        d.bf.apv_sample0);
                                 current_strip_number = d.bf.apv_channel_num_40;
-                                vStripADC.clear();
-                                vStripADC.push_back(static_cast<int>(convert(d.bf.apv_sample0)));
-                                vStripADC.push_back(static_cast<int>(convert(d.bf.apv_sample1)));
+                                vStripADC[0] = static_cast<int>(convert(d.bf.apv_sample0));
+                                vStripADC[1] = static_cast<int>(convert(d.bf.apv_sample1));
                                 //print();
                                 //if(static_cast<int>(convert(d.bf.apv_sample0)) < 0 || 
                                 //        static_cast<int>(convert(d.bf.apv_sample1)) < 0 )
@@ -338,8 +435,8 @@ void MPDSSPRawEventDecoder::sspApvDataDecode(const uint32_t &data)
                                 //        d.bf.apv_sample3,
                                 //        d.bf.apv_sample2);
                                 current_strip_number |= (d.bf.apv_channel_num_65 << 5);
-                                vStripADC.push_back(static_cast<int>(convert(d.bf.apv_sample2)));
-                                vStripADC.push_back(static_cast<int>(convert(d.bf.apv_sample3)));
+                                vStripADC[2] = static_cast<int>(convert(d.bf.apv_sample2));
+                                vStripADC[3] = static_cast<int>(convert(d.bf.apv_sample3));
                                 //print();
 
                                 apv_data_word++;
@@ -354,8 +451,8 @@ void MPDSSPRawEventDecoder::sspApvDataDecode(const uint32_t &data)
                                 //        d.bf.apv_sample5,
                                 //        d.bf.apv_sample4);
                                 apvAddress.adc_ch = d.bf.apv_id;
-                                vStripADC.push_back(static_cast<int>(convert(d.bf.apv_sample4)));
-                                vStripADC.push_back(static_cast<int>(convert(d.bf.apv_sample5)));
+                                vStripADC[4] = static_cast<int>(convert(d.bf.apv_sample4));
+                                vStripADC[5] = static_cast<int>(convert(d.bf.apv_sample5));
  
                                 apv_data_word=1;
                                 current_strip_finished = true;
@@ -439,9 +536,9 @@ void MPDSSPRawEventDecoder::sspApvDataDecode(const uint32_t &data)
                     //        d.bf.CM_T0,
                     //        d.bf.CM_T1);
 
-                    mAPVOnlineCommonMode[apvAddress].resize(6); // debug
-                    mAPVOnlineCommonMode[apvAddress][0] = d.bf.CM_T0;
-                    mAPVOnlineCommonMode[apvAddress][1] = d.bf.CM_T1;
+                    int *cm = onlineCommonMode(apvAddress); // debug
+                    cm[0] = d.bf.CM_T0;
+                    cm[1] = d.bf.CM_T1;
                 }
                 else {
                     switch (mpd_debug_header_word)
@@ -455,8 +552,9 @@ void MPDSSPRawEventDecoder::sspApvDataDecode(const uint32_t &data)
                                 //        d.bf.CM_T2,
                                 //        d.bf.CM_T3);
 
-                                mAPVOnlineCommonMode[apvAddress][2] = d.bf.CM_T2;
-                                mAPVOnlineCommonMode[apvAddress][3] = d.bf.CM_T3;
+                                int *cm = onlineCommonMode(apvAddress);
+                                cm[2] = d.bf.CM_T2;
+                                cm[3] = d.bf.CM_T3;
 
                                 break;
                             }
@@ -470,8 +568,9 @@ void MPDSSPRawEventDecoder::sspApvDataDecode(const uint32_t &data)
                                 //        d.bf.CM_T4,
                                 //        d.bf.CM_T5);
 
-                                mAPVOnlineCommonMode[apvAddress][4] = d.bf.CM_T4;
-                                mAPVOnlineCommonMode[apvAddress][5] = d.bf.CM_T5;
+                                int *cm = onlineCommonMode(apvAddress);
+                                cm[4] = d.bf.CM_T4;
+                                cm[5] = d.bf.CM_T5;
 
                                 break;
                             }
@@ -0,0 +1,58 @@
+#ifndef GEM_APV_KERNELS_H
+#define GEM_APV_KERNELS_H
+
+////////////////////////////////////////////////////////////////////////////////
+// vectorized kernels for the APV zero suppression
+//
+// the kernels work on the structure-of-arrays layout of GEMAPV: each time
+// sample is a contiguous row of strips, and the pedestal offsets and noises
+// are kept in separate arrays
+//
+// the kernel set is chosen at runtime by the CPU features (AVX2, SSE4.1, or
+// the scalar fallback), all sets give identical results: the element-wise
+// operations are the same IEEE operations in any width, and the sums keep
+// the original summation order, only the comparisons and the selections
+// around them are vectorized
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace apv_kernels {
+
+// number of the highest strips excluded from the sorting common mode
+#define NUM_HIGH_STRIPS 20
+
+struct KernelSet
+{
+    const char *name;
+
+    // buf[i] -= offset[i]
+    void (*subtract_pedestal)(float *buf, const float *offset, uint32_t size);
+    // buf[i] -= val
+    void (*subtract_value)(float *buf, float val, uint32_t size);
+    // buf[i] *= val
+    void (*scale)(float *buf, float val, uint32_t size);
+    // average of the strips without the highest NUM_HIGH_STRIPS strips
+    float (*common_mode_sorting)(const float *buf, uint32_t size);
+    // average of the strips below average A + rms_thres*noise, average A is from the strips in [range_min, range_max]
+    float (*common_mode_danning)(const float *buf, const float *noise, uint32_t size,
+            float range_min, float range_max, double rms_thres);
+    // hits[i] = (time sample average of strip i) > noise[i]*thres,
+    // the time samples are nts rows of the buffer separated by stride
+    void (*zero_sup_mask)(const float *buf, uint32_t stride, uint32_t nts,
+            const float *noise, float thres, bool *hits, uint32_t size);
+};
+
+// the kernel set in use, the best one supported by this CPU unless changed by Select
+const KernelSet &Get();
+// the scalar reference kernels
+const KernelSet &Scalar();
+// all the kernel sets supported by this CPU, the scalar set is the first one
+std::vector<const KernelSet*> Available();
+// use a kernel set by its name ("scalar", "sse4.1", "avx2"), returns false if it is not supported
+bool Select(const std::string &name);
+
+};
+
+#endif
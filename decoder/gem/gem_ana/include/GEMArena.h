@@ -0,0 +1,88 @@
+#ifndef GEM_ARENA_H
+#define GEM_ARENA_H
+
+////////////////////////////////////////////////////////////////////////////////
+// a bump allocator for the per-event data of a plane (the time samples of the
+// strip hits)
+//
+// the memory is allocated in blocks, an allocation only moves the offset in the
+// current block, Reset() rewinds to the first block and keeps all the blocks,
+// so it stops allocating once it has grown to the largest event
+// the returned memory is valid until the next Reset(), only trivially
+// destructible types can be allocated since nothing is destroyed
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+class GEMArena
+{
+public:
+    GEMArena(size_t block_bytes = 64*1024)
+        : block_size(block_bytes), current(0), offset(0)
+    {}
+
+    // the blocks are owned, moving keeps the allocated memory valid
+    GEMArena(const GEMArena &) = delete;
+    GEMArena(GEMArena &&) = default;
+    GEMArena &operator =(const GEMArena &) = delete;
+    GEMArena &operator =(GEMArena &&) = default;
+
+    template<typename T>
+    T *Allocate(size_t n)
+    {
+        static_assert(std::is_trivially_destructible<T>::value,
+                "GEMArena does not destroy the allocated objects");
+        if(n == 0)
+            return nullptr;
+        return static_cast<T*>(allocate(n*sizeof(T), alignof(T)));
+    }
+
+    void Reset()
+    {
+        current = 0;
+        offset = 0;
+    }
+
+    size_t GetNBlocks() const {return blocks.size();}
+    size_t GetCapacity() const
+    {
+        size_t res = 0;
+        for(auto &b: blocks)
+            res += b.size;
+        return res;
+    }
+
+private:
+    void *allocate(size_t bytes, size_t align)
+    {
+        for(; current < blocks.size(); ++current, offset = 0)
+        {
+            size_t beg = (offset + align - 1) / align * align;
+            if(beg + bytes <= blocks[current].size) {
+                offset = beg + bytes;
+                return blocks[current].data.get() + beg;
+            }
+        }
+
+        // need a new block, the memory from new[] is aligned for any fundamental type
+        size_t size = (bytes > block_size) ? bytes : block_size;
+        blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+        current = blocks.size() - 1;
+        offset = bytes;
+        return blocks[current].data.get();
+    }
+
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    size_t block_size;
+    std::vector<Block> blocks;
+    size_t current, offset;
+};
+
+#endif
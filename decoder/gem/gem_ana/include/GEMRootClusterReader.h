@@ -0,0 +1,60 @@
+#ifndef GEM_ROOT_CLUSTER_READER_H
+#define GEM_ROOT_CLUSTER_READER_H
+
+#include <TTree.h>
+#include <TFile.h>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// read the cluster tree saved by GEMRootClusterTree
+//
+// both layouts are supported, the flat one (stripNo[nStrip] with stripOffset)
+// and the old one (stripNo[nCluster][100]), the strips of a cluster are
+// accessed the same way for both, the arrays are sized by the largest event
+// in the tree
+
+class GEMRootClusterReader
+{
+public:
+    GEMRootClusterReader(const char *path, const char *tree_name = "GEMCluster");
+    ~GEMRootClusterReader();
+
+    bool IsOpen() const {return pTree != nullptr;}
+    bool IsFlatLayout() const {return flat_layout;}
+    Long64_t GetEntries() const;
+    bool GetEntry(Long64_t i);
+
+    // strips of a cluster
+    int GetStripNo(int icluster, int istrip) const;
+    float GetStripAdc(int icluster, int istrip) const;
+    const int *GetStripNoArray(int icluster) const;
+    const float *GetStripAdcArray(int icluster) const;
+
+private:
+    template<typename T>
+    void setBranch(const char *name, std::vector<T> &buf, size_t size);
+
+private:
+    TFile *pFile = nullptr;
+    TTree *pTree = nullptr;
+    bool flat_layout = false;
+    int old_cluster_size = 100;         // strips per cluster of the old layout
+
+public:
+    // information saved, same names as in the writer
+    int evtID = 0;
+    int nCluster = 0;
+    std::vector<int> Plane, Prod, Module, Axis, Size;
+    std::vector<float> Adc, Pos;
+    std::vector<int> StripOffset;       // computed from the sizes for the old layout
+    int nStrip = 0;
+    std::vector<int> StripNo;
+    std::vector<float> StripADC;
+
+    int nAPV = 0;
+    std::vector<int> apv_crate_id, apv_mpd_id, apv_adc_ch;
+    std::vector<int> CM_offline[6], CM_online[6];
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef GEM_ROOT_CLUSTER_TREE_H
+#define GEM_ROOT_CLUSTER_TREE_H
+
+#include <TTree.h>
+#include <TFile.h>
+#include <string>
+#include <vector>
+
+class GEMSystem;
+class GEMCluster;
+
+////////////////////////////////////////////////////////////////////////////////
+// replay evio files, and cluster all hits, save clusters to root tree
+//
+// the per-cluster and per-apv arrays are saved as variable-length leaf lists
+// (same branches as before), the strips of all clusters are flattened into
+// stripNo[nStrip]/stripAdc[nStrip], the strips of cluster i start from
+// stripOffset[i] and there are size[i] of them
+//
+// the arrays are growable buffers reused for all events, so the memory
+// follows the largest event instead of the old static arrays
+// (200000 clusters x 100 strips, about 166 MB of address space per tree, only
+// the pages written by the events were resident, so it was mostly virtual)
+// use GEMRootClusterReader to read both the old and the flat layout
+
+class GEMRootClusterTree
+{
+public:
+    GEMRootClusterTree(const char *path);
+    ~GEMRootClusterTree();
+
+    void Write();
+    void Fill(GEMSystem* gem_sys, const uint32_t &evt_num);
+
+private:
+    // a growable array saved with a leaf list, the branch address follows the buffer
+    template<typename T>
+    struct BranchBuffer
+    {
+        TBranch *branch = nullptr;
+        std::vector<T> data;
+
+        BranchBuffer() {data.reserve(64);}
+        void UpdateAddress()
+        {
+            if(branch && branch->GetAddress() != reinterpret_cast<char*>(data.data()))
+                branch->SetAddress(data.data());
+        }
+    };
+
+    template<typename T>
+    void addBranch(BranchBuffer<T> &buf, const char *name, const char *leaflist);
+    void updateAddresses();
+
+private:
+    TTree *pTree = nullptr;
+    TFile *pFile = nullptr;
+
+    std::string fPath;
+
+    // information to save
+    int evtID;
+    int nCluster;                        // number of clusters in current event
+    BranchBuffer<int> Plane;             // layer id
+    BranchBuffer<int> Prod;              // detector i
+    BranchBuffer<int> Module;            // detector position index in layer
+    BranchBuffer<int> Axis;              // plane x/y
+    BranchBuffer<int> Size;              // cluster size
+    BranchBuffer<float> Adc;             // cluster adc
+    BranchBuffer<float> Pos;             // cluster pos
+    BranchBuffer<int> StripOffset;       // index of the first strip in the flat strip arrays
+
+    int nStrip;                          // number of strips of all clusters
+    BranchBuffer<int> StripNo;
+    BranchBuffer<float> StripADC;
+
+    // for common mode study only
+    int nAPV;
+    BranchBuffer<int> apv_crate_id;
+    BranchBuffer<int> apv_mpd_id;
+    BranchBuffer<int> apv_adc_ch;
+    BranchBuffer<int> CM_offline[6];
+    BranchBuffer<int> CM_online[6];
+
+    // clustering method
+    GEMCluster *cluster_method = nullptr;
+};
+
+#endif
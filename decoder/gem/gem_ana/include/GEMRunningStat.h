@@ -0,0 +1,157 @@
+#ifndef GEM_RUNNING_STAT_H
+#define GEM_RUNNING_STAT_H
+
+////////////////////////////////////////////////////////////////////////////////
+// streaming mean and rms of a strip (or common mode) distribution for the
+// pedestal generation, it replaces keeping every sample in a vector and filling
+// them into a histogram at the end
+//
+// the variance is accumulated with the Welford algorithm, only the samples in
+// [low, high) enter the statistics, the same as a TH1 with that axis range
+// (GetRMS() is the population rms as TH1::GetRMS), while the entries and
+// min/max count all the samples
+// the mean is reported as sum/n (the running mean is only for the variance),
+// so it is exact for the integer ADC samples as in TH1
+//
+// optional outlier rejection: the first min_samples samples are also kept, and
+// once there are enough of them, the statistics restart from those within
+// nsigma of their median (sigma from the median absolute deviation), so the
+// outliers among them do not widen the window, after that a sample further than
+// nsigma*rms from the running mean is counted as rejected and does not enter
+// the statistics
+// the samples kept are a normal distribution truncated at +/- nsigma, whose
+// variance is smaller than sigma^2 (by 2.7% at 3 sigma, 23% at 2 sigma), so the
+// accumulated variance is scaled back by the truncated-normal factor, both for
+// the reported rms and for the rejection window, otherwise the window shrinks
+// with the rms it cuts, and the rms is biased low
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class GEMRunningStat
+{
+public:
+    GEMRunningStat(double l = -std::numeric_limits<double>::max(),
+                   double h = std::numeric_limits<double>::max())
+        : low(l), high(h)
+    {}
+
+    void SetRange(double l, double h) {low = l; high = h;}
+
+    // nsigma <= 0 disables the rejection
+    void SetOutlierRejection(double nsigma, uint32_t min_samples = 100)
+    {
+        clip2 = nsigma2 = 0.;
+        var_scale = 1.;
+        if(nsigma > 0.) {
+            nsigma2 = nsigma*nsigma;
+            // variance of the normal distribution truncated at +/- nsigma, in sigma^2
+            double trunc = 1. - nsigma*std::exp(-0.5*nsigma*nsigma)*std::sqrt(2./M_PI)
+                                /std::erf(nsigma/std::sqrt(2.));
+            var_scale = 1./trunc;
+            clip2 = nsigma2*var_scale;
+        }
+        clip_min = std::max(min_samples, 2u);
+        warmup.clear();
+    }
+
+    void Reset()
+    {
+        entries = n = rejected = 0;
+        sum = mean = m2 = min = max = 0.;
+        warmup.clear();
+    }
+
+    void Fill(double x)
+    {
+        if(entries++ == 0) {
+            min = max = x;
+        } else {
+            min = std::min(min, x);
+            max = std::max(max, x);
+        }
+
+        if(x < low || x >= high)
+            return;
+
+        if(clip2 > 0.) {
+            // warming up, the rejection starts from these samples
+            if(n + rejected < clip_min) {
+                add(x);
+                warmup.push_back(x);
+                if(warmup.size() == clip_min)
+                    startRejection();
+                return;
+            }
+
+            // compare the squares, (x - mean)^2 > nsigma^2*var_scale*m2/n, no sqrt per sample
+            double d = x - mean;
+            if(m2 > 0. && d*d*n > clip2*m2) {
+                rejected++;
+                return;
+            }
+        }
+
+        add(x);
+    }
+
+    uint64_t GetEntries() const {return entries;}
+    uint64_t GetN() const {return n;}
+    uint64_t GetRejected() const {return rejected;}
+    double GetMean() const {return n ? sum/n : 0.;}
+    double GetRMS() const {return n ? std::sqrt(var_scale*m2/n) : 0.;}
+    double GetMin() const {return min;}
+    double GetMax() const {return max;}
+
+private:
+    void add(double x)
+    {
+        double d = x - mean;
+        n++;
+        sum += x;
+        mean += d/n;
+        m2 += d*(x - mean);
+    }
+
+    // restart the statistics from the warm-up samples within nsigma of their
+    // median, 1.4826*MAD is sigma for a normal distribution, nothing is
+    // rejected if the MAD is 0 (more than half of the samples are the same)
+    void startRejection()
+    {
+        std::vector<float> dev(warmup);
+        size_t mid = dev.size()/2;
+        std::nth_element(dev.begin(), dev.begin() + mid, dev.end());
+        double median = dev[mid];
+        for(auto &v : dev)
+            v = std::abs(v - median);
+        std::nth_element(dev.begin(), dev.begin() + mid, dev.end());
+        double sigma = 1.4826*dev[mid];
+
+        n = 0;
+        sum = mean = m2 = 0.;
+        for(auto &v : warmup) {
+            double d = v - median;
+            if(sigma > 0. && d*d > nsigma2*sigma*sigma)
+                rejected++;
+            else
+                add(v);
+        }
+
+        warmup.clear();
+        warmup.shrink_to_fit();
+    }
+
+private:
+    double low, high;
+    double clip2 = 0., nsigma2 = 0., var_scale = 1.;
+    uint32_t clip_min = 100;
+    uint64_t entries = 0, n = 0, rejected = 0;
+    double sum = 0., mean = 0., m2 = 0.;
+    double min = 0., max = 0.;
+    std::vector<float> warmup;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef GEM_THREAD_POOL_H
+#define GEM_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// a persistent thread pool for the per-event APV processing
+//
+// Run(ntasks, task) splits the task indices into one contiguous range per
+// thread, each thread takes the tasks from the front of its own range and
+// steals from the ranges of the others once it is done, so uneven tasks
+// (planes with more fired APVs) do not leave threads idle
+//
+// the calling thread works as thread 0, the threads are started once and
+// sleep between the Run calls
+
+class GEMThreadPool
+{
+public:
+    GEMThreadPool(int nthreads = 1);
+    ~GEMThreadPool();
+
+    GEMThreadPool(const GEMThreadPool &) = delete;
+    GEMThreadPool &operator =(const GEMThreadPool &) = delete;
+
+    // run task(i) for i in [0, ntasks), returns when all the tasks are done
+    void Run(size_t ntasks, const std::function<void(size_t)> &task);
+
+    int GetNumberOfThreads() const {return nthreads;}
+
+private:
+    void workerLoop(int id);
+    void work(int id);
+
+private:
+    // task range of a thread, on its own cache line
+    struct alignas(64) TaskRange
+    {
+        std::atomic<size_t> next;
+        size_t end;
+    };
+
+    int nthreads;
+    std::vector<std::thread> workers;
+    std::unique_ptr<TaskRange[]> ranges;
+    const std::function<void(size_t)> *current_task = nullptr;
+
+    std::mutex locker;
+    std::condition_variable start_cv, done_cv;
+    unsigned long generation = 0;
+    int nbusy = 0;
+    bool stop = false;
+};
+
+#endif
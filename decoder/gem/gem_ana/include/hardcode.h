@@ -0,0 +1,16 @@
+#ifndef HARD_CODE_H
+#define HARD_CODE_H
+
+/*
+ * hard-coded define macros, when hardware development is finalized, this file 
+ * will be removed
+ */
+
+#define SORTING_ALGORITHM
+//#define DANNING_ALGORITHM
+#define DANNING_ALGORITHM_RMS_THRESHOLD 5.0 // Ben's firmware is using 5.0
+
+//#define USE_VME
+#define USE_SSP
+
+#endif
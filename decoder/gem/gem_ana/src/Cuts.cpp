@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
 
 using std::fstream;
 using std::cout;
@@ -40,6 +41,7 @@ void Cuts::Init()
     LoadFile();
 
     __convert_map();
+    __compile();
 }
 
 void Cuts::LoadFile()
@@ -268,9 +270,13 @@ float Cuts::__get_seed_strip_sum_adc(const StripCluster &c) const
 
 bool Cuts::max_time_bin(const StripHit &hit) const
 {
+    // disabled
+    if(m_compiled.max_time_bins.empty())
+        return true;
+
     int timebin = __get_max_timebin(hit);
 
-    for(auto &i: (m_cut.at("max time bin")).arr<int>())
+    for(auto &i: m_compiled.max_time_bins)
     {
         if(i == timebin)
             return true;
@@ -283,9 +289,7 @@ bool Cuts::strip_mean_time(const StripHit &hit) const
 {
     float mean_time = __get_mean_time(hit);
 
-    auto mean_time_range = m_cut.at("strip mean time range").arr<float>();
-
-    if(mean_time >= mean_time_range[0] && mean_time <= mean_time_range[1])
+    if(mean_time >= m_compiled.strip_mean_time_min && mean_time <= m_compiled.strip_mean_time_max)
         return true;
 
     return false;
@@ -298,7 +302,7 @@ bool Cuts::reject_max_first_timebin(const StripHit &hit) const
     if(max_bin != 0)
         return true;
 
-    if(m_cut.at("reject max first bin").val<bool>())
+    if(m_compiled.reject_max_first_bin)
         return false;
 
     return true;
@@ -313,7 +317,7 @@ bool Cuts::reject_max_last_timebin(const StripHit &hit) const
     if(max_bin != n_ts)
         return true;
 
-    if(m_cut.at("reject max last bin").val<bool>())
+    if(m_compiled.reject_max_last_bin)
         return false;
 
     return true;
@@ -323,9 +327,7 @@ bool Cuts::seed_strip_min_peak_adc(const StripCluster &cluster) const
 {
     float adc = __get_seed_strip_max_adc(cluster);
 
-    float minimum_adc = m_cut.at("seed strip min peak ADC").val<float>();
-
-    if(adc >= minimum_adc)
+    if(adc >= m_compiled.seed_strip_min_peak_adc)
         return true;
 
     return false;
@@ -335,9 +337,7 @@ bool Cuts::seed_strip_min_sum_adc(const StripCluster &cluster) const
 {
     float adc = __get_seed_strip_sum_adc(cluster);
 
-    float minimum_adc = m_cut.at("seed strip min sum ADC").val<float>();
-
-    if(adc >= minimum_adc)
+    if(adc >= m_compiled.seed_strip_min_sum_adc)
         return true;
     return false;
 }
@@ -347,10 +347,7 @@ bool Cuts::qualify_for_seed_strip(const StripHit &hit) const
     float peak_adc = __get_max_adc(hit);
     float sum_adc = __get_sum_adc(hit);
 
-    float min_peak = m_cut.at("seed strip min peak ADC").val<float>();
-    float min_sum = m_cut.at("seed strip min sum ADC").val<float>();
-
-    if( (peak_adc >= min_peak) && (sum_adc >= min_sum))
+    if( (peak_adc >= m_compiled.seed_strip_min_peak_adc) && (sum_adc >= m_compiled.seed_strip_min_sum_adc))
         return true;
 
     return false;
@@ -363,9 +360,7 @@ bool Cuts::strip_mean_time_agreement(const StripHit &hit1, const StripHit &hit2)
 
     float diff = abs(m1 - m2);
 
-    float criteria = m_cut.at("strip mean time agreement").val<float>();
-
-    if(diff <= criteria)
+    if(diff <= m_compiled.strip_mean_time_agreement)
         return true;
 
     return false;
@@ -377,9 +372,7 @@ bool Cuts::time_sample_correlation_coefficient(const StripHit &hit1, const Strip
     auto & bin_charge2 = hit2.ts_adc;
 
     float correlation = __correlation_coefficient(bin_charge1, bin_charge2);
-    float criteria = m_cut.at("time sample correlation coefficient").val<float>();
-
-    if(correlation >= criteria)
+    if(correlation >= m_compiled.time_sample_correlation_coefficient)
         return true;
     return false;
 }
@@ -388,9 +381,7 @@ bool Cuts::min_cluster_size(const StripCluster &cluster) const
 {
     int cluster_size = (int)cluster.hits.size();
 
-    int m = m_cut.at("min cluster size").val<int>();
-
-    if(cluster_size >= m)
+    if(cluster_size >= m_compiled.min_cluster_size)
         return true;
     return false;
 }
@@ -402,9 +393,7 @@ bool Cuts::cluster_adc_assymetry(const StripCluster &c1, const StripCluster &c2)
 
     float assymetry = abs(c1_adc - c2_adc) / abs(c1_adc + c2_adc);
     
-    float criteria = m_cut.at("2d cluster adc assymetry").val<float>();
-
-    if(assymetry <= criteria)
+    if(assymetry <= m_compiled.cluster_adc_assymetry)
         return true;
 
     return false;
@@ -418,15 +407,14 @@ bool Cuts::track_chi2([[maybe_unused]]const std::vector<StripCluster> &vc)
 bool Cuts::is_tracking_layer(const int &layer) const
 {
 	// if a layer not found, default it to participate tracking
-	if(m_tracking_layer_switch.find(layer) == m_tracking_layer_switch.end())
+	const block_t *block = GetLayerBlock(layer);
+	if(block == nullptr)
 	{
 		std::cout<<"Cuts::Warning: layer "<<layer<<" tracking config not found. Default to true."
 			<<std::endl;
 		return true;
 	}
-	if(!m_tracking_layer_switch.at(layer))
-		return false;
-	return true;
+	return block->is_tracker;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -620,6 +608,51 @@ void Cuts::__convert_map()
     }
 }
 
+// compile the cuts to typed values, and index the detector blocks by layer id
+void Cuts::__compile()
+{
+    // a missing cut is fatal (__get throws), same as looking it up at its first use
+    auto set_val = [&](const char *key, auto &v)
+    {
+        using T = typename std::decay<decltype(v)>::type;
+        v = __get(key).template val<T>();
+    };
+
+    m_compiled = compiled_t();
+
+    m_compiled.max_time_bins = __get("max time bin").arr<int>();
+
+    auto range = __get("strip mean time range").arr<float>();
+    if(range.size() < 2) {
+        std::cout<<"ERROR: cut \"strip mean time range\" needs 2 values in "<<path<<std::endl;
+        throw std::out_of_range("strip mean time range");
+    }
+    m_compiled.strip_mean_time_min = range[0];
+    m_compiled.strip_mean_time_max = range[1];
+
+    set_val("reject max first bin", m_compiled.reject_max_first_bin);
+    set_val("reject max last bin", m_compiled.reject_max_last_bin);
+    set_val("seed strip min peak ADC", m_compiled.seed_strip_min_peak_adc);
+    set_val("seed strip min sum ADC", m_compiled.seed_strip_min_sum_adc);
+    set_val("strip mean time agreement", m_compiled.strip_mean_time_agreement);
+    set_val("time sample correlation coefficient", m_compiled.time_sample_correlation_coefficient);
+    set_val("min cluster size", m_compiled.min_cluster_size);
+    set_val("max cluster size", m_compiled.max_cluster_size);
+    set_val("2d cluster adc assymetry", m_compiled.cluster_adc_assymetry);
+    set_val("use adc matching", m_compiled.use_adc_matching);
+
+    m_layer_block.clear();
+    for(auto &i: m_block)
+    {
+        int layer = i.second.layer_id;
+        if(layer < 0)
+            continue;
+        if(layer >= (int)m_layer_block.size())
+            m_layer_block.resize(layer + 1, nullptr);
+        m_layer_block[layer] = &i.second;
+    }
+}
+
 bool Cuts::__is_block_start(const std::string & line)
 {
     if(line.back() == '{')//(line.find("{") != std::string::npos)
@@ -634,7 +667,7 @@ bool Cuts::__is_block_end(const std::string & line)
     return false;
 }
 
-float Cuts::__arr_mean(const vector<float> &v) const
+float Cuts::__arr_mean(const ArrayView<float> &v) const
 {
     float res = 0;
 
@@ -649,7 +682,7 @@ float Cuts::__arr_mean(const vector<float> &v) const
     return res / n;
 }
 
-float Cuts::__arr_sigma(const vector<float> &v) const
+float Cuts::__arr_sigma(const ArrayView<float> &v) const
 {
     float sigma = 0;
 
@@ -670,8 +703,8 @@ float Cuts::__arr_sigma(const vector<float> &v) const
     return sigma;
 }
 
-float Cuts::__correlation_coefficient(const vector<float> &v1,
-        const vector<float> &v2) const
+float Cuts::__correlation_coefficient(const ArrayView<float> &v1,
+        const ArrayView<float> &v2) const
 {
     float coefficient = 0;
 
@@ -14,8 +14,7 @@
 #include "GEMPlane.h"
 #include "GEMAPV.h"
 #include "APVStripMapping.h"
-#include "TF1.h"
-#include "TH1.h"
+#include "GEMAPVKernels.h"
 #include "hardcode.h"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -23,10 +22,12 @@
 #define DATA_INDEX(ch, ts) (ts_begin + ch + ts*MPD_APV_TS_LEN)
 
 ////////////////////////////////////////////////////////////////////////////////
-// use vector or TH1I for storing temporal data for pedestal generation
-// vector is faster than TH1I
-#define USE_VEC 1
-//#include <TFile.h>
+// ranges of the strip offset/noise and the common mode distributions for the
+// pedestal generation, only the samples in the ranges enter the mean and rms
+#define PED_STAT_MIN -800.
+#define PED_STAT_MAX 2000.
+#define COMMON_MODE_STAT_MIN 0.
+#define COMMON_MODE_STAT_MAX 1500.
 
 //============================================================================//
 // constructor, assigment operator, destructor                                //
@@ -57,9 +58,13 @@ GEMAPV::GEMAPV(const int &o,
 
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
-        offset_hist[i] = nullptr;
-        noise_hist[i] = nullptr;
+        // same as the default Pedestal
+        ped_offset[i] = 0.;
+        ped_noise[i] = 5000.;
+        offset_stat[i].SetRange(PED_STAT_MIN, PED_STAT_MAX);
+        noise_stat[i].SetRange(PED_STAT_MIN, PED_STAT_MAX);
     }
+    common_mode_stat.SetRange(COMMON_MODE_STAT_MIN, COMMON_MODE_STAT_MAX);
 
     ClearData();
 }
@@ -110,23 +115,14 @@ GEMAPV::GEMAPV(const GEMAPV &that)
     // copy other arrays
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
-        pedestal[i] = that.pedestal[i];
+        ped_offset[i] = that.ped_offset[i];
+        ped_noise[i] = that.ped_noise[i];
         strip_map[i] = that.strip_map[i];
         hit_pos[i] = that.hit_pos[i];
-
-        // dangerous part, may fail due to lack of memory
-        if(that.offset_hist[i] != nullptr) {
-            offset_hist[i] = new TH1I(*that.offset_hist[i]);
-        } else {
-            offset_hist[i] = nullptr;
-        }
-
-        if(that.noise_hist[i] != nullptr) {
-            noise_hist[i] = new TH1I(*that.noise_hist[i]);
-        } else {
-            noise_hist[i] = nullptr;
-        }
+        offset_stat[i] = that.offset_stat[i];
+        noise_stat[i] = that.noise_stat[i];
     }
+    common_mode_stat = that.common_mode_stat;
 
     // copy offline common mode
     offline_common_mode.clear();
@@ -163,16 +159,14 @@ GEMAPV::GEMAPV(GEMAPV &&that)
     // static array, so no need to move, just copy elements
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
-        pedestal[i] = that.pedestal[i];
+        ped_offset[i] = that.ped_offset[i];
+        ped_noise[i] = that.ped_noise[i];
         strip_map[i] = that.strip_map[i];
         hit_pos[i] = that.hit_pos[i];
-
-        // these need to be moved
-        offset_hist[i] = that.offset_hist[i];
-        noise_hist[i] = that.noise_hist[i];
-        that.offset_hist[i] = nullptr;
-        that.noise_hist[i] = nullptr;
+        offset_stat[i] = that.offset_stat[i];
+        noise_stat[i] = that.noise_stat[i];
     }
+    common_mode_stat = that.common_mode_stat;
 
     // common mode
     offline_common_mode.clear();
@@ -190,7 +184,6 @@ GEMAPV::~GEMAPV()
 {
     UnsetMPD();
     UnsetDetectorPlane();
-    ReleasePedHist();
 
     delete[] raw_data;
 }
@@ -217,7 +210,6 @@ GEMAPV &GEMAPV::operator= (GEMAPV &&rhs)
         return *this;
 
     // release memory
-    ReleasePedHist();
     delete[] raw_data;
 
     // members
@@ -241,16 +233,14 @@ GEMAPV &GEMAPV::operator= (GEMAPV &&rhs)
     // static array, so no need to move, just copy elements
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
-        pedestal[i] = rhs.pedestal[i];
+        ped_offset[i] = rhs.ped_offset[i];
+        ped_noise[i] = rhs.ped_noise[i];
         strip_map[i] = rhs.strip_map[i];
         hit_pos[i] = rhs.hit_pos[i];
-
-        // these need to be moved
-        offset_hist[i] = rhs.offset_hist[i];
-        noise_hist[i] = rhs.noise_hist[i];
-        rhs.offset_hist[i] = nullptr;
-        rhs.noise_hist[i] = nullptr;
+        offset_stat[i] = rhs.offset_stat[i];
+        noise_stat[i] = rhs.noise_stat[i];
     }
+    common_mode_stat = rhs.common_mode_stat;
 
     // common mode
     offline_common_mode.clear();
@@ -351,75 +341,29 @@ void GEMAPV::UnsetDetectorPlane(bool force_unset)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// create ped histograms
-
-void GEMAPV::CreatePedHist()
-{
-    // we switched from using TH1I to using vector, no need to create histos
-    // anymore. This function was kept for future use
-#ifdef USE_VEC
-    return;
-#else
-    // obsolete
-    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
-    {
-        if(offset_hist[i] == nullptr) {
-            std::string name = "CH_" + std::to_string(i) + "_OFFSET_"
-                + std::to_string(crate_id) + "_"
-                + std::to_string(mpd_id) + "_"
-                + std::to_string(adc_ch);
-            offset_hist[i] = new TH1I(name.c_str(), "Offset", 1600, 400, 2000);
-        }
-        if(noise_hist[i] == nullptr) {
-            std::string name = "CH_" + std::to_string(i) + "_NOISE_"
-                + std::to_string(crate_id) + "_"
-                + std::to_string(mpd_id) + "_"
-                + std::to_string(adc_ch);
-            noise_hist[i] = new TH1I(name.c_str(), "Noise", 1600, -800, 800);
-        }
-    }
-#endif
-}
-
-////////////////////////////////////////////////////////////////////////////////
-// reset ped histograms
+// reset the pedestal statistics
 
 void GEMAPV::ResetPedHist()
 {
-#ifdef USE_VEC
-    // using vector instead of using TH1I
-    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
-    {
-        offset_vec[i].clear();
-        noise_vec[i].clear();
-    }
-#else
-    // obsolete
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
-        if(offset_hist[i])
-            offset_hist[i]->Reset();
-        if(noise_hist[i])
-            noise_hist[i]->Reset();
+        offset_stat[i].Reset();
+        noise_stat[i].Reset();
     }
-#endif
+    common_mode_stat.Reset();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// release the memory for histograms
+// reject the outliers (beyond nsigma from the running mean) in the pedestal
+// statistics, nsigma <= 0 disables it
 
-void GEMAPV::ReleasePedHist()
+void GEMAPV::SetPedestalOutlierRejection(const float &nsigma)
 {
-#ifdef USE_VEC
-    return;
-#else
-    // obsolete, histos should never be initialized
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
-        delete offset_hist[i], offset_hist[i] = nullptr;
-        delete noise_hist[i], noise_hist[i] = nullptr;
+        offset_stat[i].SetOutlierRejection(nsigma);
+        noise_stat[i].SetOutlierRejection(nsigma);
     }
-#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -449,12 +393,8 @@ void GEMAPV::ClearData()
 
     ResetHitPos();
 
-    commonModeDist.clear();
-
-    for(auto &i: offset_vec)
-        i.clear();
-    for(auto &i: noise_vec)
-        i.clear();
+    // the pedestal statistics are only reset by ResetPedHist, this is called
+    // for every event
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -472,7 +412,10 @@ void GEMAPV::ResetHitPos()
 void GEMAPV::ClearPedestal()
 {
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
-        pedestal[i] = Pedestal(0, 0);
+    {
+        ped_offset[i] = 0;
+        ped_noise[i] = 0;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -481,7 +424,10 @@ void GEMAPV::ClearPedestal()
 void GEMAPV::UpdatePedestal(std::vector<Pedestal> &ped)
 {
     for(uint32_t i = 0; (i < ped.size()) && (i < APV_STRIP_SIZE); ++i)
-        pedestal[i] = ped[i];
+    {
+        ped_offset[i] = ped[i].offset;
+        ped_noise[i] = ped[i].noise;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -492,7 +438,8 @@ void GEMAPV::UpdatePedestal(const Pedestal &ped, const uint32_t &index)
     if(index >= APV_STRIP_SIZE)
         return;
 
-    pedestal[index] = ped;
+    ped_offset[index] = ped.offset;
+    ped_noise[index] = ped.noise;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -503,8 +450,8 @@ void GEMAPV::UpdatePedestal(const float &offset, const float &noise, const uint3
     if(index >= APV_STRIP_SIZE)
         return;
 
-    pedestal[index].offset = offset;
-    pedestal[index].noise = noise;
+    ped_offset[index] = offset;
+    ped_noise[index] = noise;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -570,14 +517,23 @@ void GEMAPV::FillRawDataSRS(const uint32_t *buf, const uint32_t &size)
 
 void GEMAPV::FillRawDataMPD(const std::vector<int> &buf, const APVDataType &flags)
 {
-    if(buf.size() > buffer_size) {
-        std::cerr << "Received " << buf.size() << " adc words, "
+    FillRawDataMPD(buf.data(), buf.size(), flags);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fill raw data from a flat buffer (the MPD decoder's per-APV buffer)
+// this is for MPD.
+
+void GEMAPV::FillRawDataMPD(const int *buf, const uint32_t &size, const APVDataType &flags)
+{
+    if(size > buffer_size) {
+        std::cerr << "Received " << size << " adc words, "
             << "but APV " << adc_ch << " in MPD " << mpd_id
             << " has only " << buffer_size << " channels" << std::endl;
         return;
     }
 
-    for(uint32_t i = 0; i < buf.size(); ++i)
+    for(uint32_t i = 0; i < size; ++i)
     {
         raw_data[i] = static_cast<float>(buf[i]);
     }
@@ -594,11 +550,12 @@ void GEMAPV::FillRawDataMPD(const std::vector<int> &buf, const APVDataType &flag
 
 void GEMAPV::FillOnlineCommonMode(const std::vector<int> &cm)
 {
-    online_common_mode.clear();
+    FillOnlineCommonMode(cm.data(), cm.size());
+}
 
-    for(auto &i: cm) {
-        online_common_mode.push_back(i);
-    }
+void GEMAPV::FillOnlineCommonMode(const int *cm, const uint32_t &size)
+{
+    online_common_mode.assign(cm, cm + size);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -649,7 +606,7 @@ void GEMAPV::FillZeroSupData(const uint32_t &ch, const std::vector<float> &vals)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// fill pedestal histogram
+// fill pedestal statistics
 
 void GEMAPV::FillPedHist()
 {
@@ -669,99 +626,36 @@ void GEMAPV::FillPedHist()
             ch_average += raw_data[DATA_INDEX(i, j)];
             noise_average += raw_data[DATA_INDEX(i, j)] - average[j];
         }
-#ifdef USE_VEC
-        offset_vec[i].push_back(ch_average/time_samples);
-        noise_vec[i].push_back(noise_average/time_samples);
-#else
-        // obsolete
-        if(offset_hist[i])
-            offset_hist[i]->Fill(ch_average/time_samples);
-
-        // obsolete
-        if(noise_hist[i])
-            noise_hist[i]->Fill(noise_average/time_samples);
-#endif
+        // the averages are truncated to integer ADC values
+        offset_stat[i].Fill(static_cast<int>(ch_average/time_samples));
+        noise_stat[i].Fill(static_cast<int>(noise_average/time_samples));
     }
 
     // save common mode
-    commonModeDist.insert(commonModeDist.end(), average, average + time_samples);
+    for(uint32_t i = 0; i < time_samples; ++i)
+        common_mode_stat.Fill(average[i]);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// fit pedestal histogram
+// get pedestal from the statistics
 
 void GEMAPV::FitPedestal()
 {
-#ifdef USE_VEC
-    // a helper lambda
-    auto fit_vector = [&](const std::vector<int>& vec, double &mean, double &sigma)
-    {
-        TH1F h("h", "h", 2800, -800, 2000);
-
-        for(auto &i: vec)
-            h.Fill((float)i);
-
-        if(h.GetEntries() > 0) {
-            // 1) MPD is too noisy, fitting method is always giving odd result
-            //h.Fit("gaus", "Q0");
-            //TF1 *myfit = (TF1*)h.GetFunction("gaus");
-            //mean = myfit -> GetParameter(1);
-            //sigma = myfit -> GetParameter(2);
-
-            // 2) use rms value instead
-            mean = h.GetMean();
-            sigma = h.GetRMS();
-        }
-    };
-
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
-        // 1) SRS version (used for PRad)
-        //double mean = 0, sigma = 5000;
-        //fit_vector(offset_vec[i], mean, sigma);
-        //double p0 = mean;
-        //mean = 0, sigma = 5000;
-        //fit_vector(noise_vec[i], mean, sigma);
-        //double p1 = sigma;
-
-        // 2) MPD version (used for SSP online suppression)
-        double mean = 0, sigma = 5000;
-        fit_vector(noise_vec[i], mean, sigma);
-        double p0 = mean, p1 = sigma;
-        
-        UpdatePedestal((float)p0, (float)p1, i);
-    }
-    return;
-#else
-    // obsolete
-    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
-    {
-        if( (offset_hist[i] == nullptr) ||
-                (noise_hist[i] == nullptr) ||
-                (offset_hist[i]->Integral() < 100)// ||
-                //(noise_hist[i]->Integral() < 1000) 
-          )
-        {
-            continue;
+        // 1) SRS version (used for PRad): offset from the mean of offset_stat,
+        //    noise from the rms of noise_stat
+        // 2) MPD version (used for SSP online suppression): both from noise_stat
+        // MPD is too noisy, fitting gaussian is always giving odd result, so the
+        // mean and rms are used instead
+        float mean = 0, sigma = 5000;
+        if(noise_stat[i].GetEntries() > 0) {
+            mean = noise_stat[i].GetMean();
+            sigma = noise_stat[i].GetRMS();
         }
 
-        offset_hist[i]->Fit("gaus", "qww");
-        noise_hist[i]->Fit("gaus", "qww");
-        TF1 *myfit = (TF1*) offset_hist[i]->GetFunction("gaus");
-        double p0 = myfit->GetParameter(1);
-        myfit = (TF1*) noise_hist[i]->GetFunction("gaus");
-        double p1 = myfit->GetParameter(2);
-
-        //TFile *_F = new TFile("example.root", "recreate");
-        //offset_hist[i] -> Write();
-        //noise_hist[i] -> Write();
-        //_F->Close();
-        //std::cout<<"enter to continue..."<<std::endl;
-        //getchar();
-
-        UpdatePedestal((float)p0, (float)p1, i);
+        UpdatePedestal(mean, sigma, i);
     }
-#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -794,30 +688,18 @@ void GEMAPV::ZeroSuppression()
         CommonModeCorrection(&raw_data[DATA_INDEX(0, ts)], APV_STRIP_SIZE, ts);
     }
 
+    // the time samples are contiguous rows of strips
+    auto &kernels = apv_kernels::Get();
+
     // apv gain correction
-    for(uint32_t i=0; i < APV_STRIP_SIZE; ++i)
+    for(uint32_t j = 0; j < time_samples; ++j)
     {
-        for(uint32_t j=0; j < time_samples; ++j)
-        {
-            raw_data[DATA_INDEX(i, j)] *= gain_factor;
-        }
+        kernels.scale(&raw_data[DATA_INDEX(0, j)], gain_factor, APV_STRIP_SIZE);
     }
 
     // zero suppression
-    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
-    {
-        float average = 0.;
-        for(uint32_t j = 0; j < time_samples; ++j)
-        {
-            average += raw_data[DATA_INDEX(i, j)];
-        }
-        average /= time_samples;
-
-        if(average > pedestal[i].noise * zerosup_thres)
-            hit_pos[i] = true;
-        else
-            hit_pos[i] = false;
-    }
+    kernels.zero_sup_mask(&raw_data[DATA_INDEX(0, 0)], MPD_APV_TS_LEN, time_samples,
+            ped_noise, zerosup_thres, hit_pos, APV_STRIP_SIZE);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -841,6 +723,7 @@ void GEMAPV::CollectZeroSupHits(std::vector<GEM_Strip_Data> &hits)
 
 ////////////////////////////////////////////////////////////////////////////////
 // collect zero suppressed hit in raw data space, directly to connected Plane
+// the time samples are copied to the event arena of the plane
 
 void GEMAPV::CollectZeroSupHits()
 {
@@ -852,49 +735,26 @@ void GEMAPV::CollectZeroSupHits()
         if(!hit_pos[i])
             continue;
 
-        plane->AddStripHit(strip_map[i].plane,
+        StripHit &hit = plane->AddStripHit(strip_map[i].plane,
                 GetMaxCharge(i),
                 GetMaxTimeBin(i),
                 IsCrossTalkStrip(i),
                 crate_id,
                 mpd_id,
                 adc_ch,
-                GetRawTSADC(i)
+                time_samples
                 );
-    }
-}
 
-////////////////////////////////////////////////////////////////////////////////
-// a helper to find highest 20 adc strips
-// binary insert to a sorted vector and keep that vector to a fixed length
-// sorting costs too much running time
-
-static void binary_insert(std::vector<float> &vec, const float &val, size_t start, size_t end)
-{
-    if(start + 1 == end)
-    {
-        for(size_t i=0;i<start;i++)
-        {
-            vec[i] = vec[i+1];
-        }
-        vec[start] = val;
-        return;
+        for(uint32_t j = 0; j < time_samples; ++j)
+            hit.ts_adc[j] = raw_data[DATA_INDEX(i, j)];
     }
-
-    size_t pos = (start + end) / 2;
-    if(vec[pos] >= val)
-        binary_insert(vec, val, start, pos);
-    else
-        binary_insert(vec, val, pos, end);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // do common mode correction (bring the signal average to 0)
 
-#define NUM_HIGH_STRIPS 20
 void GEMAPV::CommonModeCorrection(float *buf, const uint32_t &size, [[maybe_unused]]const uint32_t &ts)
 {
-    int count = 0;
     float average = 0;
 
     //-----------------------------------------------------------
@@ -926,34 +786,17 @@ void GEMAPV::CommonModeCorrection(float *buf, const uint32_t &size, [[maybe_unus
     //     raw_data_flag has two states: 1) OnlineCommonModeSubtractioniEnabled &
     //                                   2) OnlineBuildAllSamples
     //if(!online_zero_suppression || TEST_BIT(raw_data_flags, OnlineBuildAllSamples))
+    auto &kernels = apv_kernels::Get();
     if(!online_zero_suppression)
     {
         // MPD algorithm -- TODO: needs to refine (absolutely)
-        for(uint32_t i = 0; i < size; ++i)
-        {
-            buf[i] = buf[i] - pedestal[i].offset;
-        }
+        kernels.subtract_pedestal(buf, ped_offset, size);
     }
 #ifdef SORTING_ALGORITHM
     if(!online_zero_suppression || !TEST_BIT(raw_data_flags.data_flag, OnlineCommonModeSubtractionEnabled))
     {
         // remove the highest 20 strips for common mode calculation
-        std::vector<float> high_adc(NUM_HIGH_STRIPS, -9999.);
-        for(uint32_t i = 0; i < size; ++i)
-        {
-            average += buf[i];
-            count++;
-            if(buf[i] > high_adc[0])
-                binary_insert(high_adc, buf[i], 0, NUM_HIGH_STRIPS);
-        }
-        for(uint32_t i = 0; i < NUM_HIGH_STRIPS; i++)
-        {
-            average -= high_adc[i];
-            count--;
-        }
-
-        if(count)
-            average /= (float)count;
+        average = kernels.common_mode_sorting(buf, size);
     }
     else {
         std::cout<<"!online_zero_suppression || TEST_BIT(raw_data_flags.data_flag, OnlineCommonModeSubtractionEnabled)"
@@ -962,32 +805,10 @@ void GEMAPV::CommonModeCorrection(float *buf, const uint32_t &size, [[maybe_unus
 #elif defined(DANNING_ALGORITHM)
     if(!online_zero_suppression || !TEST_BIT(raw_data_flags.data_flag, OnlineCommonModeSubtractionEnabled))
     {
-        // 1) average A
-        float averageA = 0;
-        for(uint32_t i=0; i < size; ++i)
-        {
-            if (buf[i] >= common_mode_range_min && buf[i] <= common_mode_range_max) {
-                averageA += buf[i];
-                count++;
-            }
-        }
-
-        // 2) average B
-        if(count > 0) {
-            averageA /= (float)count;
-            count = 0;
-            for(uint32_t i=0; i < size; ++i)
-            {
-                if(buf[i] < averageA + DANNING_ALGORITHM_RMS_THRESHOLD * pedestal[i].noise) {
-                    average += buf[i];
-                    count++;
-                }
-            }
-
-            if(count > 0) {
-                average /= (float)count;
-            }
-        }
+        // 1) average A from the strips in the common mode range
+        // 2) average B from the strips below average A + rms threshold * noise
+        average = kernels.common_mode_danning(buf, ped_noise, size,
+                common_mode_range_min, common_mode_range_max, DANNING_ALGORITHM_RMS_THRESHOLD);
     }
 #else
     std::cout<<"ERROR: must specifiy one common mode calculation method..."<<std::endl;
@@ -997,10 +818,7 @@ void GEMAPV::CommonModeCorrection(float *buf, const uint32_t &size, [[maybe_unus
     if(!online_zero_suppression || !TEST_BIT(raw_data_flags.data_flag, OnlineCommonModeSubtractionEnabled))
     {
         // common mode correction
-        for(uint32_t i = 0; i < size; ++i)
-        {
-            buf[i] -= average;
-        }
+        kernels.subtract_value(buf, average, size);
 
         // save offline common mode
         offline_common_mode.push_back(average);
@@ -1148,8 +966,8 @@ void GEMAPV::PrintOutPedestal(std::ofstream &out)
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
         out << std::setw(16) << i
-            << std::setw(16) << std::setprecision(4) << pedestal[i].offset
-            << std::setw(16) << std::setprecision(4) << pedestal[i].noise
+            << std::setw(16) << std::setprecision(4) << ped_offset[i]
+            << std::setw(16) << std::setprecision(4) << ped_noise[i]
             << std::endl;
     }
 }
@@ -1165,12 +983,9 @@ void GEMAPV::PrintOutCommonModeRange(std::ofstream &out)
 {
     float min = 0, max = 0;
 
-    if(commonModeDist.size() > 0) {
-        min = max = commonModeDist[0];
-        for(auto &i: commonModeDist) {
-            if(min > i) min = i;
-            if(max < i) max = i;
-        }
+    if(common_mode_stat.GetEntries() > 0) {
+        min = common_mode_stat.GetMin();
+        max = common_mode_stat.GetMax();
     }
 
     // follow Ben's suggestion, set all minimal common mode value to 0
@@ -1196,12 +1011,9 @@ void GEMAPV::PrintOutCommonModeDBAnaFormat(std::ofstream &out)
 {
     float avg = 0, rms = 0;
 
-    if(commonModeDist.size() > 0) {
-        TH1F h_temp("h_temp", "h_temp", 1500, 0, 1500);
-        for(auto &i: commonModeDist)
-            h_temp.Fill(i);
-        avg = h_temp.GetMean();
-        rms = h_temp.GetRMS();
+    if(common_mode_stat.GetEntries() > 0) {
+        avg = common_mode_stat.GetMean();
+        rms = common_mode_stat.GetRMS();
     }
 
     out << std::setw(12) << crate_id
@@ -1213,25 +1025,6 @@ void GEMAPV::PrintOutCommonModeDBAnaFormat(std::ofstream &out)
         << std::endl;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-// return all the existing histograms
-
-std::vector<TH1I *> GEMAPV::GetHistList()
-    const
-{
-    std::vector<TH1I *> hist_list;
-
-    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
-    {
-        if(offset_hist[i])
-            hist_list.push_back(offset_hist[i]);
-        if(noise_hist[i])
-            hist_list.push_back(noise_hist[i]);
-    }
-
-    return hist_list;
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 // pack all pedestal info into a vector and return
 
@@ -1241,7 +1034,7 @@ std::vector<GEMAPV::Pedestal> GEMAPV::GetPedestalList()
     std::vector<Pedestal> ped_list;
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
-        ped_list.push_back(pedestal[i]);
+        ped_list.emplace_back(ped_offset[i], ped_noise[i]);
     }
 
     return ped_list;
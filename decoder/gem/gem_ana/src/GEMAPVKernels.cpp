@@ -0,0 +1,533 @@
+//============================================================================//
+// vectorized kernels for the APV zero suppression                            //
+// the SIMD kernels are compiled with function target attributes so that the  //
+// library does not require any instruction set beyond the default one, the   //
+// kernel set is chosen at runtime by the CPU features                        //
+//============================================================================//
+
+#include "GEMAPVKernels.h"
+#include <atomic>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define APV_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace apv_kernels {
+
+////////////////////////////////////////////////////////////////////////////////
+// a helper to keep the highest adc strips
+// binary insert to a sorted array and keep that array to a fixed length
+// it places the value at the same position as the recursive version did
+
+static inline void binary_insert(float *vec, float val)
+{
+    size_t start = 0, end = NUM_HIGH_STRIPS;
+    while(start + 1 != end)
+    {
+        size_t pos = (start + end) / 2;
+        if(vec[pos] >= val)
+            end = pos;
+        else
+            start = pos;
+    }
+
+    for(size_t i = 0; i < start; i++)
+    {
+        vec[i] = vec[i+1];
+    }
+    vec[start] = val;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// the sorting common mode from the sum and the highest strips
+
+static inline float sorting_average(float sum, const float *high_adc, uint32_t size)
+{
+    int count = size;
+    for(uint32_t i = 0; i < NUM_HIGH_STRIPS; i++)
+    {
+        sum -= high_adc[i];
+        count--;
+    }
+
+    if(count)
+        sum /= (float)count;
+    return sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// sequential sum, the order is kept so the common mode does not depend on
+// the kernel set
+
+static inline float sequential_sum(const float *buf, uint32_t size)
+{
+    float sum = 0.;
+    for(uint32_t i = 0; i < size; ++i)
+        sum += buf[i];
+    return sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// scalar kernels, the reference implementation
+
+static void subtract_pedestal_scalar(float *buf, const float *offset, uint32_t size)
+{
+    for(uint32_t i = 0; i < size; ++i)
+        buf[i] = buf[i] - offset[i];
+}
+
+static void subtract_value_scalar(float *buf, float val, uint32_t size)
+{
+    for(uint32_t i = 0; i < size; ++i)
+        buf[i] -= val;
+}
+
+static void scale_scalar(float *buf, float val, uint32_t size)
+{
+    for(uint32_t i = 0; i < size; ++i)
+        buf[i] *= val;
+}
+
+static float common_mode_sorting_scalar(const float *buf, uint32_t size)
+{
+    float high_adc[NUM_HIGH_STRIPS];
+    for(auto &v : high_adc)
+        v = -9999.;
+
+    float sum = 0.;
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        sum += buf[i];
+        if(buf[i] > high_adc[0])
+            binary_insert(high_adc, buf[i]);
+    }
+
+    return sorting_average(sum, high_adc, size);
+}
+
+static float common_mode_danning_scalar(const float *buf, const float *noise, uint32_t size,
+        float range_min, float range_max, double rms_thres)
+{
+    int count = 0;
+    float average = 0., averageA = 0.;
+
+    // 1) average A
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        if(buf[i] >= range_min && buf[i] <= range_max) {
+            averageA += buf[i];
+            count++;
+        }
+    }
+    if(count == 0)
+        return average;
+
+    // 2) average B
+    averageA /= (float)count;
+    count = 0;
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        if(buf[i] < averageA + rms_thres * noise[i]) {
+            average += buf[i];
+            count++;
+        }
+    }
+
+    if(count > 0)
+        average /= (float)count;
+    return average;
+}
+
+static void zero_sup_mask_scalar(const float *buf, uint32_t stride, uint32_t nts,
+        const float *noise, float thres, bool *hits, uint32_t size)
+{
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        float average = 0.;
+        for(uint32_t j = 0; j < nts; ++j)
+            average += buf[i + j*stride];
+        average /= nts;
+
+        hits[i] = average > noise[i] * thres;
+    }
+}
+
+static const KernelSet scalar_kernels = {
+    "scalar",
+    subtract_pedestal_scalar,
+    subtract_value_scalar,
+    scale_scalar,
+    common_mode_sorting_scalar,
+    common_mode_danning_scalar,
+    zero_sup_mask_scalar,
+};
+
+#ifdef APV_KERNELS_X86
+////////////////////////////////////////////////////////////////////////////////
+// SSE4.1 kernels, 4 floats per vector
+
+#define SSE_TARGET __attribute__((target("sse4.1")))
+
+SSE_TARGET static void subtract_pedestal_sse(float *buf, const float *offset, uint32_t size)
+{
+    uint32_t i = 0;
+    for(; i + 4 <= size; i += 4)
+        _mm_storeu_ps(buf + i, _mm_sub_ps(_mm_loadu_ps(buf + i), _mm_loadu_ps(offset + i)));
+    subtract_pedestal_scalar(buf + i, offset + i, size - i);
+}
+
+SSE_TARGET static void subtract_value_sse(float *buf, float val, uint32_t size)
+{
+    uint32_t i = 0;
+    __m128 v = _mm_set1_ps(val);
+    for(; i + 4 <= size; i += 4)
+        _mm_storeu_ps(buf + i, _mm_sub_ps(_mm_loadu_ps(buf + i), v));
+    subtract_value_scalar(buf + i, val, size - i);
+}
+
+SSE_TARGET static void scale_sse(float *buf, float val, uint32_t size)
+{
+    uint32_t i = 0;
+    __m128 v = _mm_set1_ps(val);
+    for(; i + 4 <= size; i += 4)
+        _mm_storeu_ps(buf + i, _mm_mul_ps(_mm_loadu_ps(buf + i), v));
+    scale_scalar(buf + i, val, size - i);
+}
+
+// the highest strips are kept in a sorted array padded with +inf to whole vectors,
+// the insert position is the number of strips below the value
+#define HIGH_ADC_PADDED 24
+
+SSE_TARGET static inline void insert_high_sse(float *vec, float val)
+{
+    __m128 v = _mm_set1_ps(val);
+    int cnt = 0;
+    for(int b = 0; b < HIGH_ADC_PADDED; b += 4)
+        cnt += __builtin_popcount(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(vec + b), v)));
+
+    // shift the lower strips down by one and put the value at the last position below it
+    __m128i start = _mm_set1_epi32(cnt - 1);
+    for(int b = 0; b < HIGH_ADC_PADDED; b += 4)
+    {
+        __m128i idx = _mm_add_epi32(_mm_set1_epi32(b), _mm_setr_epi32(0, 1, 2, 3));
+        __m128 res = _mm_blendv_ps(_mm_loadu_ps(vec + b), _mm_loadu_ps(vec + b + 1),
+                                   _mm_castsi128_ps(_mm_cmplt_epi32(idx, start)));
+        res = _mm_blendv_ps(res, v, _mm_castsi128_ps(_mm_cmpeq_epi32(idx, start)));
+        _mm_storeu_ps(vec + b, res);
+    }
+}
+
+// a block of strips is skipped if none of them exceeds the lowest of the
+// highest strips, the threshold only grows so the skipped strips would not
+// have been inserted either
+SSE_TARGET static float common_mode_sorting_sse(const float *buf, uint32_t size)
+{
+    float high_adc[HIGH_ADC_PADDED + 4];
+    for(int i = 0; i < HIGH_ADC_PADDED + 4; ++i)
+        high_adc[i] = (i < NUM_HIGH_STRIPS) ? -9999. : __builtin_inff();
+
+    uint32_t i = 0;
+    for(; i + 4 <= size; i += 4)
+    {
+        int mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(buf + i), _mm_set1_ps(high_adc[0])));
+        for(; mask; mask &= mask - 1)
+        {
+            float val = buf[i + __builtin_ctz(mask)];
+            if(val > high_adc[0])
+                insert_high_sse(high_adc, val);
+        }
+    }
+    for(; i < size; ++i)
+    {
+        if(buf[i] > high_adc[0])
+            insert_high_sse(high_adc, buf[i]);
+    }
+
+    return sorting_average(sequential_sum(buf, size), high_adc, size);
+}
+
+// the selections are vectorized, the selected strips are summed in order
+SSE_TARGET static float common_mode_danning_sse(const float *buf, const float *noise, uint32_t size,
+        float range_min, float range_max, double rms_thres)
+{
+    int count = 0;
+    float average = 0., averageA = 0.;
+
+    // 1) average A
+    uint32_t i = 0;
+    for(; i + 4 <= size; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(buf + i);
+        int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(v, _mm_set1_ps(range_min)),
+                                              _mm_cmple_ps(v, _mm_set1_ps(range_max))));
+        for(; mask; mask &= mask - 1, count++)
+            averageA += buf[i + __builtin_ctz(mask)];
+    }
+    for(; i < size; ++i)
+    {
+        if(buf[i] >= range_min && buf[i] <= range_max) {
+            averageA += buf[i];
+            count++;
+        }
+    }
+    if(count == 0)
+        return average;
+
+    // 2) average B, the limit is in double precision as in the scalar version
+    averageA /= (float)count;
+    count = 0;
+    __m128d a = _mm_set1_pd(averageA), r = _mm_set1_pd(rms_thres);
+    for(i = 0; i + 2 <= size; i += 2)
+    {
+        __m128d v = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(buf + i))));
+        __m128d n = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(noise + i))));
+        int mask = _mm_movemask_pd(_mm_cmplt_pd(v, _mm_add_pd(a, _mm_mul_pd(r, n))));
+        for(; mask; mask &= mask - 1, count++)
+            average += buf[i + __builtin_ctz(mask)];
+    }
+    for(; i < size; ++i)
+    {
+        if(buf[i] < averageA + rms_thres * noise[i]) {
+            average += buf[i];
+            count++;
+        }
+    }
+
+    if(count > 0)
+        average /= (float)count;
+    return average;
+}
+
+// the strips are in the vector lanes, each lane sums its time samples in order
+SSE_TARGET static void zero_sup_mask_sse(const float *buf, uint32_t stride, uint32_t nts,
+        const float *noise, float thres, bool *hits, uint32_t size)
+{
+    uint32_t i = 0;
+    __m128 div = _mm_set1_ps((float)nts), th = _mm_set1_ps(thres);
+    for(; i + 4 <= size; i += 4)
+    {
+        __m128 average = _mm_setzero_ps();
+        for(uint32_t j = 0; j < nts; ++j)
+            average = _mm_add_ps(average, _mm_loadu_ps(buf + i + j*stride));
+        average = _mm_div_ps(average, div);
+
+        int mask = _mm_movemask_ps(_mm_cmpgt_ps(average, _mm_mul_ps(_mm_loadu_ps(noise + i), th)));
+        for(uint32_t k = 0; k < 4; ++k)
+            hits[i + k] = (mask >> k) & 1;
+    }
+    zero_sup_mask_scalar(buf + i, stride, nts, noise + i, thres, hits + i, size - i);
+}
+
+static const KernelSet sse_kernels = {
+    "sse4.1",
+    subtract_pedestal_sse,
+    subtract_value_sse,
+    scale_sse,
+    common_mode_sorting_sse,
+    common_mode_danning_sse,
+    zero_sup_mask_sse,
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2 kernels, 8 floats per vector
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static void subtract_pedestal_avx2(float *buf, const float *offset, uint32_t size)
+{
+    uint32_t i = 0;
+    for(; i + 8 <= size; i += 8)
+        _mm256_storeu_ps(buf + i, _mm256_sub_ps(_mm256_loadu_ps(buf + i), _mm256_loadu_ps(offset + i)));
+    subtract_pedestal_scalar(buf + i, offset + i, size - i);
+}
+
+AVX2_TARGET static void subtract_value_avx2(float *buf, float val, uint32_t size)
+{
+    uint32_t i = 0;
+    __m256 v = _mm256_set1_ps(val);
+    for(; i + 8 <= size; i += 8)
+        _mm256_storeu_ps(buf + i, _mm256_sub_ps(_mm256_loadu_ps(buf + i), v));
+    subtract_value_scalar(buf + i, val, size - i);
+}
+
+AVX2_TARGET static void scale_avx2(float *buf, float val, uint32_t size)
+{
+    uint32_t i = 0;
+    __m256 v = _mm256_set1_ps(val);
+    for(; i + 8 <= size; i += 8)
+        _mm256_storeu_ps(buf + i, _mm256_mul_ps(_mm256_loadu_ps(buf + i), v));
+    scale_scalar(buf + i, val, size - i);
+}
+
+AVX2_TARGET static inline void insert_high_avx2(float *vec, float val)
+{
+    __m256 v = _mm256_set1_ps(val);
+    int cnt = 0;
+    for(int b = 0; b < HIGH_ADC_PADDED; b += 8)
+        cnt += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(vec + b), v, _CMP_LT_OQ)));
+
+    __m256i start = _mm256_set1_epi32(cnt - 1);
+    for(int b = 0; b < HIGH_ADC_PADDED; b += 8)
+    {
+        __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(b), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        __m256 res = _mm256_blendv_ps(_mm256_loadu_ps(vec + b), _mm256_loadu_ps(vec + b + 1),
+                                      _mm256_castsi256_ps(_mm256_cmpgt_epi32(start, idx)));
+        res = _mm256_blendv_ps(res, v, _mm256_castsi256_ps(_mm256_cmpeq_epi32(idx, start)));
+        _mm256_storeu_ps(vec + b, res);
+    }
+}
+
+AVX2_TARGET static float common_mode_sorting_avx2(const float *buf, uint32_t size)
+{
+    float high_adc[HIGH_ADC_PADDED + 8];
+    for(int i = 0; i < HIGH_ADC_PADDED + 8; ++i)
+        high_adc[i] = (i < NUM_HIGH_STRIPS) ? -9999. : __builtin_inff();
+
+    uint32_t i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+        __m256 gt = _mm256_cmp_ps(_mm256_loadu_ps(buf + i), _mm256_set1_ps(high_adc[0]), _CMP_GT_OQ);
+        for(int mask = _mm256_movemask_ps(gt); mask; mask &= mask - 1)
+        {
+            float val = buf[i + __builtin_ctz(mask)];
+            if(val > high_adc[0])
+                insert_high_avx2(high_adc, val);
+        }
+    }
+    for(; i < size; ++i)
+    {
+        if(buf[i] > high_adc[0])
+            insert_high_avx2(high_adc, buf[i]);
+    }
+
+    return sorting_average(sequential_sum(buf, size), high_adc, size);
+}
+
+AVX2_TARGET static float common_mode_danning_avx2(const float *buf, const float *noise, uint32_t size,
+        float range_min, float range_max, double rms_thres)
+{
+    int count = 0;
+    float average = 0., averageA = 0.;
+
+    // 1) average A
+    uint32_t i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+        __m256 v = _mm256_loadu_ps(buf + i);
+        __m256 in = _mm256_and_ps(_mm256_cmp_ps(v, _mm256_set1_ps(range_min), _CMP_GE_OQ),
+                                  _mm256_cmp_ps(v, _mm256_set1_ps(range_max), _CMP_LE_OQ));
+        for(int mask = _mm256_movemask_ps(in); mask; mask &= mask - 1, count++)
+            averageA += buf[i + __builtin_ctz(mask)];
+    }
+    for(; i < size; ++i)
+    {
+        if(buf[i] >= range_min && buf[i] <= range_max) {
+            averageA += buf[i];
+            count++;
+        }
+    }
+    if(count == 0)
+        return average;
+
+    // 2) average B, the limit is in double precision as in the scalar version
+    averageA /= (float)count;
+    count = 0;
+    __m256d a = _mm256_set1_pd(averageA), r = _mm256_set1_pd(rms_thres);
+    for(i = 0; i + 4 <= size; i += 4)
+    {
+        __m256d v = _mm256_cvtps_pd(_mm_loadu_ps(buf + i));
+        __m256d n = _mm256_cvtps_pd(_mm_loadu_ps(noise + i));
+        __m256d lt = _mm256_cmp_pd(v, _mm256_add_pd(a, _mm256_mul_pd(r, n)), _CMP_LT_OQ);
+        for(int mask = _mm256_movemask_pd(lt); mask; mask &= mask - 1, count++)
+            average += buf[i + __builtin_ctz(mask)];
+    }
+    for(; i < size; ++i)
+    {
+        if(buf[i] < averageA + rms_thres * noise[i]) {
+            average += buf[i];
+            count++;
+        }
+    }
+
+    if(count > 0)
+        average /= (float)count;
+    return average;
+}
+
+AVX2_TARGET static void zero_sup_mask_avx2(const float *buf, uint32_t stride, uint32_t nts,
+        const float *noise, float thres, bool *hits, uint32_t size)
+{
+    uint32_t i = 0;
+    __m256 div = _mm256_set1_ps((float)nts), th = _mm256_set1_ps(thres);
+    for(; i + 8 <= size; i += 8)
+    {
+        __m256 average = _mm256_setzero_ps();
+        for(uint32_t j = 0; j < nts; ++j)
+            average = _mm256_add_ps(average, _mm256_loadu_ps(buf + i + j*stride));
+        average = _mm256_div_ps(average, div);
+
+        __m256 gt = _mm256_cmp_ps(average, _mm256_mul_ps(_mm256_loadu_ps(noise + i), th), _CMP_GT_OQ);
+        int mask = _mm256_movemask_ps(gt);
+        for(uint32_t k = 0; k < 8; ++k)
+            hits[i + k] = (mask >> k) & 1;
+    }
+    zero_sup_mask_scalar(buf + i, stride, nts, noise + i, thres, hits + i, size - i);
+}
+
+static const KernelSet avx2_kernels = {
+    "avx2",
+    subtract_pedestal_avx2,
+    subtract_value_avx2,
+    scale_avx2,
+    common_mode_sorting_avx2,
+    common_mode_danning_avx2,
+    zero_sup_mask_avx2,
+};
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// runtime dispatch
+
+std::vector<const KernelSet*> Available()
+{
+    std::vector<const KernelSet*> res{&scalar_kernels};
+#ifdef APV_KERNELS_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("sse4.1"))
+        res.push_back(&sse_kernels);
+    if(__builtin_cpu_supports("avx2"))
+        res.push_back(&avx2_kernels);
+#endif
+    return res;
+}
+
+static std::atomic<const KernelSet*> &current()
+{
+    static std::atomic<const KernelSet*> kernels(Available().back());
+    return kernels;
+}
+
+const KernelSet &Get()
+{
+    return *current().load(std::memory_order_relaxed);
+}
+
+const KernelSet &Scalar()
+{
+    return scalar_kernels;
+}
+
+bool Select(const std::string &name)
+{
+    for(auto k : Available())
+    {
+        if(name == k->name) {
+            current().store(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+};
@@ -63,11 +63,11 @@ void GEMCluster::Configure([[maybe_unused]]const std::string &path)
     gem_cuts = new Cuts();
     //gem_cuts -> Print();
 
-    min_cluster_hits = gem_cuts -> __get("min cluster size").val<int>();
-    max_cluster_hits = gem_cuts -> __get("max cluster size").val<int>();
+    min_cluster_hits = gem_cuts -> GetCompiled().min_cluster_size;
+    max_cluster_hits = gem_cuts -> GetCompiled().max_cluster_size;
 
     // X-Y cluster matching following their ADC values
-    use_adc_matching = gem_cuts -> __get("use adc matching").val<bool>();
+    use_adc_matching = gem_cuts -> GetCompiled().use_adc_matching;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -127,7 +127,7 @@ void GEMCluster::split_cluster(std::vector<StripHit>::iterator beg, std::vector<
 
     // disable cluster split when cluster size < 3
     if(size < 3) {
-        clusters.emplace_back(std::vector<StripHit>(beg, end));
+        clusters.emplace_back(&*beg, size);
         return;
     }
 
@@ -161,12 +161,12 @@ void GEMCluster::split_cluster(std::vector<StripHit>::iterator beg, std::vector<
         minimum->charge /= 2.;
 
         // new split cluster
-        clusters.emplace_back(std::vector<StripHit>(beg, minimum));
+        clusters.emplace_back(&*beg, minimum - beg);
 
         // check the leftover strips
         split_cluster(minimum, end, thres, clusters);
     } else {
-        clusters.emplace_back(std::vector<StripHit>(beg, end));
+        clusters.emplace_back(&*beg, size);
     }
 }
 
@@ -358,18 +358,17 @@ const
     };
 
     // TODO, probably add some criteria here to filter out some bad clusters
-    std::vector<StripCluster> temp_clusters;
-    auto it = clusters.begin();
-    for(; it != clusters.end(); it++)
+    // remove the bad clusters in place, the order is kept
+    size_t ngood = 0;
+    for(size_t i = 0; i < clusters.size(); ++i)
     {
-        if(!IsGoodCluster(*it))
+        if(!IsGoodCluster(clusters[i]))
             continue;
 
-        temp_clusters.push_back(*it);
+        clusters[ngood++] = clusters[i];
     }
 
-    clusters.clear();
-    clusters = temp_clusters;
+    clusters.resize(ngood);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
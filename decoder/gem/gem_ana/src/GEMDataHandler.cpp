@@ -125,11 +125,6 @@ void GEMDataHandler::ReplayEvent_test(const uint32_t *pBuf, const uint32_t &fBuf
     MPDVMERawEventDecoder* decoder = dynamic_cast<MPDVMERawEventDecoder*>(
             event_parser->GetRawDecoder(static_cast<int>(Bank_TagID::MPD_VME)) 
             );
-#else
-    MPDSSPRawEventDecoder* decoder = dynamic_cast<MPDSSPRawEventDecoder*>(
-            event_parser->GetRawDecoder(static_cast<int>(Bank_TagID::MPD_SSP)) 
-            );
-#endif
     const std::unordered_map<APVAddress, std::vector<int>> & decoded_data 
         = decoder->GetAPV();
     const std::unordered_map<APVAddress, APVDataType> & decoded_data_flags
@@ -137,40 +132,6 @@ void GEMDataHandler::ReplayEvent_test(const uint32_t *pBuf, const uint32_t &fBuf
     const std::unordered_map<APVAddress, std::vector<int>> &decoded_online_cm
         = decoder -> GetAPVOnlineCommonMode();
 
-#ifdef MULTI_THREAD
-    const auto & apvs = apv_strip_mapping::Mapping::Instance() -> GetAPVAddressVec();
-
-    // batch process apvs
-    auto batch_process_apvs = [&](const size_t &start, const size_t &end)
-    {
-        for(size_t i=start; i<end; ++i)
-        {
-            if(gem_sys -> GetAPV(apvs[i]) == nullptr) {
-                std::cout<<"Warning:: apv: "<<apvs[i]<<" not initialized."<<std::endl
-                    <<"          make sure the correct mapping file was loaded."<<std::endl
-                    <<"          skipped the current APV data."<<std::endl;
-                continue;
-            }
-            if(decoded_data.find(apvs[i]) != decoded_data.end()) {
-                if(decoded_online_cm.find(apvs[i]) != decoded_online_cm.end())
-                    FeedDataMPD(apvs[i], decoded_data.at(apvs[i]), decoded_data_flags.at(apvs[i]),
-                            decoded_online_cm.at(apvs[i]));
-                else
-                    FeedDataMPD(apvs[i], decoded_data.at(apvs[i]), decoded_data_flags.at(apvs[i]));
-            }
-        }
-    };
-
-    // use 4 threads
-    size_t NAPVs = apvs.size();
-    size_t batch[5] = {0, NAPVs/4, NAPVs/2, NAPVs/4*3, NAPVs};
-    std::thread th[4];
-    for(int i=0; i<4; ++i) {
-        th[i] = std::thread(batch_process_apvs, batch[i], batch[i+1]);
-    }
-    for(int i=0; i<4; ++i)
-        th[i].join();
-#else
     for(auto &i: decoded_data)
     {
         if(gem_sys->GetAPV(i.first) == nullptr) {
@@ -185,6 +146,15 @@ void GEMDataHandler::ReplayEvent_test(const uint32_t *pBuf, const uint32_t &fBuf
         else
             FeedDataMPD(i.first, i.second, decoded_data_flags.at(i.first));
     }
+#else
+    MPDSSPRawEventDecoder* decoder = dynamic_cast<MPDSSPRawEventDecoder*>(
+            event_parser->GetRawDecoder(static_cast<int>(Bank_TagID::MPD_SSP)) 
+            );
+
+    // the GEM system processes the decoded APVs by detector planes with its thread pool,
+    // set "APV Processing Threads" in the GEM configuration file
+    if(gem_sys)
+        gem_sys -> FillRawDataMPD(*decoder, *new_event);
 #endif
 
     EndofThisEvent(ev_number);
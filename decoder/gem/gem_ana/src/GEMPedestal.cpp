@@ -223,34 +223,44 @@ void GEMPedestal::RawAPVUnit_histo(const std::unordered_map<APVAddress, std::vec
 }
 
 ////////////////////////////////////////////////////////////////
-// process raw data in one APV, using std::vector (fast)
+// process raw data in one APV, using the streaming statistics (fast)
 
 void GEMPedestal::RawAPVUnit_vec(const std::unordered_map<APVAddress, std::vector<int>>::value_type & i)
 {
     const std::vector<StripRawADC> & apv_raw_data = DecodeAPV(i.second);
     auto apv_ts_commonMode = GetTimeSampleCommonMode(apv_raw_data);
 
+    // GetTimeSampleCommonMode guarantees APV_STRIP_SIZE strips
+    int offset[APV_STRIP_SIZE], noise[APV_STRIP_SIZE];
     for(auto &strip: apv_raw_data)
     {
-        APVStripAddress addr(i.first, strip.stripNo);
-
         int time_sample_size = strip.GetTimeSampleSize();
 
-        int offset = 0;
+        int _offset = 0;
         for(auto &adc: strip.v_adc)
-            offset += adc;
-        offset /= time_sample_size;
+            _offset += adc;
+        offset[strip.stripNo] = _offset / time_sample_size;
 
-        int noise = 0;
+        int _noise = 0;
         for(int ts = 0; ts<time_sample_size;ts++)
-            noise += (strip.v_adc[ts] - apv_ts_commonMode[ts]);
-        noise /= time_sample_size;
+            _noise += (strip.v_adc[ts] - apv_ts_commonMode[ts]);
+        noise[strip.stripNo] = _noise / time_sample_size;
+    }
 
-        mtx.lock();
-        mAPVStripNoiseVec[addr].push_back(noise);
-        mAPVStripOffsetVec[addr].push_back(offset); 
-        mtx.unlock();
+    // the ranges are the same as the TH1I of RawAPVUnit_histo
+    mtx.lock();
+    auto &noise_stat = mAPVStripNoiseStat[i.first];
+    auto &offset_stat = mAPVStripOffsetStat[i.first];
+    if(noise_stat.empty()) {
+        noise_stat.resize(APV_STRIP_SIZE, GEMRunningStat(-400, 400));
+        offset_stat.resize(APV_STRIP_SIZE, GEMRunningStat(400, 1400));
+    }
+    for(int strip = 0; strip < APV_STRIP_SIZE; ++strip)
+    {
+        noise_stat[strip].Fill(noise[strip]);
+        offset_stat[strip].Fill(offset[strip]);
     }
+    mtx.unlock();
 }
 
 
@@ -325,7 +335,7 @@ void GEMPedestal::GenerateAPVPedestal_using_histo()
 
 ////////////////////////////////////////////////////////////////
 // generate pedestal for each APV using the strip noise and offset
-// using vector (fast)
+// using the streaming statistics (fast)
 
 void GEMPedestal::GenerateAPVPedestal_using_vec()
 {
@@ -333,9 +343,8 @@ void GEMPedestal::GenerateAPVPedestal_using_vec()
     hOverallNoiseHisto = new TH1I("hOverallNoise", "RMS Noise", 400, 0, 400);
 
     // generate noise for each apv
-    for(auto &i: mAPVStripNoiseVec) {
-        APVAddress addr(i.first.crate_id, i.first.mpd_id, i.first.adc_ch);
-        int strip_no = i.first.strip_no;
+    for(auto &i: mAPVStripNoiseStat) {
+        const APVAddress &addr = i.first;
 
         if(mAPVNoiseHisto.find(addr) == mAPVNoiseHisto.end())
             mAPVNoiseHisto[addr] = new TH1I(
@@ -344,16 +353,17 @@ void GEMPedestal::GenerateAPVPedestal_using_vec()
                     APV_STRIP_SIZE+20, -10, APV_STRIP_SIZE+10
                     );
 
-        int noise = GetRMS(i.second);
-        mAPVNoiseHisto[addr] -> SetBinContent(strip_no+10, noise);
-        mAPVNoise[addr].push_back(noise);
-        hOverallNoiseHisto -> Fill(noise);
+        for(int strip_no = 0; strip_no < static_cast<int>(i.second.size()); ++strip_no) {
+            int noise = i.second[strip_no].GetRMS();
+            mAPVNoiseHisto[addr] -> SetBinContent(strip_no+10, noise);
+            mAPVNoise[addr].push_back(noise);
+            hOverallNoiseHisto -> Fill(noise);
+        }
     }
 
     // generate offset
-    for(auto &i: mAPVStripOffsetVec) {
-        APVAddress addr(i.first.crate_id, i.first.mpd_id, i.first.adc_ch);
-        int strip_no = i.first.strip_no;
+    for(auto &i: mAPVStripOffsetStat) {
+        const APVAddress &addr = i.first;
 
         if(mAPVOffsetHisto.find(addr) == mAPVOffsetHisto.end())
             mAPVOffsetHisto[addr] = new TH1I(
@@ -362,39 +372,14 @@ void GEMPedestal::GenerateAPVPedestal_using_vec()
                     APV_STRIP_SIZE+20, -10, APV_STRIP_SIZE+10
                     );
 
-        int offset = GetMean(i.second);
-        mAPVOffsetHisto[addr] -> SetBinContent(strip_no + 10, offset);
-        mAPVOffset[addr].push_back(offset);
+        for(int strip_no = 0; strip_no < static_cast<int>(i.second.size()); ++strip_no) {
+            int offset = i.second[strip_no].GetMean();
+            mAPVOffsetHisto[addr] -> SetBinContent(strip_no + 10, offset);
+            mAPVOffset[addr].push_back(offset);
+        }
     }
 }
 
-////////////////////////////////////////////////////////////////
-// a helper: get mean of a vector (for offset calculation)
-
-int GEMPedestal::GetMean(const std::vector<int> &data)
-{
-    TH1I h("h", "h", 1000, 400, 1400);
-    for(auto &i: data)
-        h.Fill(i);
-
-    int res = h.GetMean();
-    return res;
-}
-
-////////////////////////////////////////////////////////////////
-// a helper: get RMS of a vector (for noise calculation)
-
-int GEMPedestal::GetRMS(const std::vector<int> &data)
-{
-    TH1I h("h", "h", 800, -400, 400);
-    for(auto &i: data)
-        h.Fill(i);
-
-    int res = h.GetRMS();
-    return res;
-}
-
-
 ////////////////////////////////////////////////////////////////
 // decode raw apv data 
 
@@ -572,11 +557,8 @@ void GEMPedestal::Clear()
     for(auto &i: mAPVStripOffset)
         if(i.second) i.second->Delete();
 
-    for(auto &i: mAPVStripNoiseVec)
-        i.second.clear();
-
-    for(auto &i: mAPVStripOffsetVec)
-        i.second.clear();
+    mAPVStripNoiseStat.clear();
+    mAPVStripOffsetStat.clear();
 }
 
 
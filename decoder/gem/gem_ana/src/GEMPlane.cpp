@@ -14,6 +14,7 @@
 //============================================================================//
 
 #include <functional>
+#include <algorithm>
 
 #include "GEMPlane.h"
 #include "GEMDetector.h"
@@ -44,10 +45,11 @@ GEMPlane::GEMPlane(const std::string &n, const int &t, const float &s,
 ////////////////////////////////////////////////////////////////////////////////
 // copy constructor
 // connections between it and apv/detector won't be copied
+// the event data (hits and clusters) are not copied either, they are in the event arena of that plane
 
 GEMPlane::GEMPlane(const GEMPlane &that)
 : detector(nullptr), name(that.name), type(that.type), size(that.size), orient(that.orient),
-  direction(that.direction), strip_hits(that.strip_hits), strip_clusters(that.strip_clusters)
+  direction(that.direction)
 {
     apv_list.resize(that.apv_list.size(), nullptr);
 }
@@ -58,7 +60,7 @@ GEMPlane::GEMPlane(const GEMPlane &that)
 GEMPlane::GEMPlane(GEMPlane &&that)
 : detector(nullptr), name(std::move(that.name)), type(that.type), size(that.size),
   orient(that.orient), direction(that.direction), strip_hits(std::move(that.strip_hits)),
-  strip_clusters(std::move(that.strip_clusters))
+  strip_clusters(std::move(that.strip_clusters)), event_arena(std::move(that.event_arena))
 {
     apv_list.resize(that.apv_list.size(), nullptr);
 }
@@ -101,6 +103,7 @@ GEMPlane &GEMPlane::operator =(GEMPlane &&rhs)
 
     strip_hits = std::move(rhs.strip_hits);
     strip_clusters = std::move(rhs.strip_clusters);
+    event_arena = std::move(rhs.event_arena);
     return *this;
 }
 
@@ -323,24 +326,37 @@ float GEMPlane::GetStripPosition(const int &plane_strip)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// clear the stored plane hits
+// clear the stored plane hits, and the clusters since they are ranges of the hits
+// the containers and the event arena keep their memory for the next event
 
 void GEMPlane::ClearStripHits()
 {
     strip_hits.clear();
+    strip_clusters.clear();
+    event_arena.Reset();
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
-// add a plane hit
+// add a plane hit, the nts time samples are allocated in the event arena and
+// to be filled by the caller
 
-void GEMPlane::AddStripHit(int strip, float charge, short maxtime, bool xtalk, 
-        int crate, int mpd, int adc, const std::vector<float> &_ts_adc)
+StripHit &GEMPlane::AddStripHit(int strip, float charge, short maxtime, bool xtalk,
+        int crate, int mpd, int adc, size_t nts)
 {
     strip_hits.emplace_back(strip, charge, maxtime, GetStripPosition(strip),
             xtalk, crate, mpd, adc);
 
-    strip_hits.back().ts_adc = _ts_adc;
+    StripHit &hit = strip_hits.back();
+    hit.ts_adc = ArrayView<float>(event_arena.Allocate<float>(nts), nts);
+    return hit;
+}
+
+void GEMPlane::AddStripHit(int strip, float charge, short maxtime, bool xtalk,
+        int crate, int mpd, int adc, const std::vector<float> &_ts_adc)
+{
+    StripHit &hit = AddStripHit(strip, charge, maxtime, xtalk, crate, mpd, adc, _ts_adc.size());
+    std::copy(_ts_adc.begin(), _ts_adc.end(), hit.ts_adc.begin());
 }
 
 
@@ -0,0 +1,141 @@
+#include "GEMRootClusterReader.h"
+#include <TLeaf.h>
+
+#include <algorithm>
+#include <iostream>
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+GEMRootClusterReader::GEMRootClusterReader(const char *path, const char *tree_name)
+{
+    pFile = TFile::Open(path, "READ");
+    if(pFile == nullptr || pFile -> IsZombie()) {
+        std::cout<<"Error: cannot open cluster tree file: "<<path<<std::endl;
+        return;
+    }
+
+    pTree = dynamic_cast<TTree*>(pFile -> Get(tree_name));
+    if(pTree == nullptr) {
+        std::cout<<"Error: cannot find tree "<<tree_name<<" in "<<path<<std::endl;
+        return;
+    }
+
+    // the leaves keep the maximum of the counters, so the buffers are allocated once
+    auto get_max = [this](const char *name) -> size_t {
+        TLeaf *leaf = pTree -> GetLeaf(name);
+        return leaf ? static_cast<size_t>(std::max(leaf -> GetMaximum(), 1)) : 1;
+    };
+    size_t max_clusters = get_max("nCluster");
+    size_t max_apvs = get_max("nAPV");
+
+    flat_layout = (pTree -> GetBranch("nStrip") != nullptr);
+
+    pTree -> SetBranchAddress("evtID", &evtID);
+    pTree -> SetBranchAddress("nCluster", &nCluster);
+    setBranch("planeID", Plane, max_clusters);
+    setBranch("prodID", Prod, max_clusters);
+    setBranch("moduleID", Module, max_clusters);
+    setBranch("axis", Axis, max_clusters);
+    setBranch("size", Size, max_clusters);
+    setBranch("adc", Adc, max_clusters);
+    setBranch("pos", Pos, max_clusters);
+
+    if(flat_layout) {
+        size_t max_strips = get_max("nStrip");
+        setBranch("stripOffset", StripOffset, max_clusters);
+        pTree -> SetBranchAddress("nStrip", &nStrip);
+        setBranch("stripNo", StripNo, max_strips);
+        setBranch("stripAdc", StripADC, max_strips);
+    } else {
+        // StripNo[nCluster][N]
+        TLeaf *leaf = pTree -> GetLeaf("StripNo");
+        if(leaf && leaf -> GetLenStatic() > 0)
+            old_cluster_size = leaf -> GetLenStatic();
+        StripOffset.resize(max_clusters);
+        setBranch("stripNo", StripNo, max_clusters * old_cluster_size);
+        setBranch("stripAdc", StripADC, max_clusters * old_cluster_size);
+    }
+
+    if(pTree -> GetBranch("nAPV")) {
+        pTree -> SetBranchAddress("nAPV", &nAPV);
+        setBranch("apv_crate_id", apv_crate_id, max_apvs);
+        setBranch("apv_mpd_id", apv_mpd_id, max_apvs);
+        setBranch("apv_adc_ch", apv_adc_ch, max_apvs);
+        for(int i = 0; i < 6; ++i) {
+            setBranch(("CM" + std::to_string(i) + "_offline").c_str(), CM_offline[i], max_apvs);
+            setBranch(("CM" + std::to_string(i) + "_online").c_str(), CM_online[i], max_apvs);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// dtor
+
+GEMRootClusterReader::~GEMRootClusterReader()
+{
+    if(pFile) {
+        pFile -> Close();
+        delete pFile;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// allocate a buffer and set it as the branch address
+
+template<typename T>
+void GEMRootClusterReader::setBranch(const char *name, std::vector<T> &buf, size_t size)
+{
+    if(pTree -> GetBranch(name) == nullptr)
+        return;
+
+    buf.resize(size);
+    pTree -> SetBranchAddress(name, buf.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// entries
+
+Long64_t GEMRootClusterReader::GetEntries() const
+{
+    return pTree ? pTree -> GetEntries() : 0;
+}
+
+bool GEMRootClusterReader::GetEntry(Long64_t i)
+{
+    if(pTree == nullptr || pTree -> GetEntry(i) <= 0)
+        return false;
+
+    // the old layout has fixed strip slots for each cluster
+    if(!flat_layout) {
+        nStrip = 0;
+        for(int c = 0; c < nCluster; ++c) {
+            StripOffset[c] = c * old_cluster_size;
+            nStrip += std::min(Size[c], old_cluster_size);
+        }
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// strips of a cluster, the old layout only saved the first 100 strips
+
+int GEMRootClusterReader::GetStripNo(int icluster, int istrip) const
+{
+    return StripNo[StripOffset[icluster] + istrip];
+}
+
+float GEMRootClusterReader::GetStripAdc(int icluster, int istrip) const
+{
+    return StripADC[StripOffset[icluster] + istrip];
+}
+
+const int *GEMRootClusterReader::GetStripNoArray(int icluster) const
+{
+    return &StripNo[StripOffset[icluster]];
+}
+
+const float *GEMRootClusterReader::GetStripAdcArray(int icluster) const
+{
+    return &StripADC[StripOffset[icluster]];
+}
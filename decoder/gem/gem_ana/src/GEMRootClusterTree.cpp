@@ -12,40 +12,57 @@ GEMRootClusterTree::GEMRootClusterTree(const char* path)
     if(fPath.size() <= 0)
         fPath = "Rootfiles/cluster_replay.root";
 
-    pFile = new TFile(path, "RECREATE");
+    pFile = new TFile(fPath.c_str(), "RECREATE");
     pTree = new TTree("GEMCluster", "cluster list");
 
     pTree -> Branch("evtID", &evtID, "evtID/I"); 
     pTree -> Branch("nCluster", &nCluster, "nCluster/I");
-    pTree -> Branch("planeID", Plane, "planeID[nCluster]/I");
-    pTree -> Branch("prodID", Prod, "prodID[nCluster]/I");
-    pTree -> Branch("moduleID", Module, "moduleID[nCluster]/I");
-    pTree -> Branch("axis", Axis, "axis[nCluster]/I");
-    pTree -> Branch("size", Size, "size[nCluster]/I");
-    pTree -> Branch("adc", Adc, "adc[nCluster]/F");
-    pTree -> Branch("pos", Pos, "Pos[nCluster]/F");
-
-    // save strip information for each cluster
-    pTree -> Branch("stripNo", StripNo, "StripNo[nCluster][100]/I");
-    pTree -> Branch("stripAdc", StripADC, "StripADC[nCluster][100]/F");
+    addBranch(Plane, "planeID", "planeID[nCluster]/I");
+    addBranch(Prod, "prodID", "prodID[nCluster]/I");
+    addBranch(Module, "moduleID", "moduleID[nCluster]/I");
+    addBranch(Axis, "axis", "axis[nCluster]/I");
+    addBranch(Size, "size", "size[nCluster]/I");
+    addBranch(Adc, "adc", "adc[nCluster]/F");
+    addBranch(Pos, "pos", "Pos[nCluster]/F");
+
+    // save strip information for each cluster, flattened
+    addBranch(StripOffset, "stripOffset", "stripOffset[nCluster]/I");
+    pTree -> Branch("nStrip", &nStrip, "nStrip/I");
+    addBranch(StripNo, "stripNo", "stripNo[nStrip]/I");
+    addBranch(StripADC, "stripAdc", "stripAdc[nStrip]/F");
 
     // save apv common mode information
     pTree -> Branch("nAPV", &nAPV, "nAPV/I");
-    pTree -> Branch("apv_crate_id", apv_crate_id, "apv_crate_id[nAPV]/I");
-    pTree -> Branch("apv_mpd_id", apv_mpd_id, "apv_mpd_id[nAPV]/I");
-    pTree -> Branch("apv_adc_ch", apv_adc_ch, "apv_adc_ch[nAPV]/I");
-    pTree -> Branch("CM0_offline", CM0_offline, "CM0_offline[nAPV]/I");
-    pTree -> Branch("CM1_offline", CM1_offline, "CM1_offline[nAPV]/I");
-    pTree -> Branch("CM2_offline", CM2_offline, "CM2_offline[nAPV]/I");
-    pTree -> Branch("CM3_offline", CM3_offline, "CM3_offline[nAPV]/I");
-    pTree -> Branch("CM4_offline", CM4_offline, "CM4_offline[nAPV]/I");
-    pTree -> Branch("CM5_offline", CM5_offline, "CM5_offline[nAPV]/I");
-    pTree -> Branch("CM0_online", CM0_online, "CM0_online[nAPV]/I");
-    pTree -> Branch("CM1_online", CM1_online, "CM1_online[nAPV]/I");
-    pTree -> Branch("CM2_online", CM2_online, "CM2_online[nAPV]/I");
-    pTree -> Branch("CM3_online", CM3_online, "CM3_online[nAPV]/I");
-    pTree -> Branch("CM4_online", CM4_online, "CM4_online[nAPV]/I");
-    pTree -> Branch("CM5_online", CM5_online, "CM5_online[nAPV]/I");
+    addBranch(apv_crate_id, "apv_crate_id", "apv_crate_id[nAPV]/I");
+    addBranch(apv_mpd_id, "apv_mpd_id", "apv_mpd_id[nAPV]/I");
+    addBranch(apv_adc_ch, "apv_adc_ch", "apv_adc_ch[nAPV]/I");
+    for(int i = 0; i < 6; ++i) {
+        std::string name = "CM" + std::to_string(i) + "_offline";
+        addBranch(CM_offline[i], name.c_str(), (name + "[nAPV]/I").c_str());
+    }
+    for(int i = 0; i < 6; ++i) {
+        std::string name = "CM" + std::to_string(i) + "_online";
+        addBranch(CM_online[i], name.c_str(), (name + "[nAPV]/I").c_str());
+    }
+}
+
+template<typename T>
+void GEMRootClusterTree::addBranch(BranchBuffer<T> &buf, const char *name, const char *leaflist)
+{
+    buf.branch = pTree -> Branch(name, buf.data.data(), leaflist);
+}
+
+// the buffers may be reallocated when they grow
+void GEMRootClusterTree::updateAddresses()
+{
+    Plane.UpdateAddress(), Prod.UpdateAddress(), Module.UpdateAddress(), Axis.UpdateAddress();
+    Size.UpdateAddress(), Adc.UpdateAddress(), Pos.UpdateAddress(), StripOffset.UpdateAddress();
+    StripNo.UpdateAddress(), StripADC.UpdateAddress();
+    apv_crate_id.UpdateAddress(), apv_mpd_id.UpdateAddress(), apv_adc_ch.UpdateAddress();
+    for(int i = 0; i < 6; ++i) {
+        CM_offline[i].UpdateAddress();
+        CM_online[i].UpdateAddress();
+    }
 }
 
 GEMRootClusterTree::~GEMRootClusterTree()
@@ -84,15 +101,23 @@ void GEMRootClusterTree::Fill(GEMSystem *gem_sys, const uint32_t &evt_num)
     if(cluster_method == nullptr)
         cluster_method = new GEMCluster("config/gem_cluster.conf");
 
-    [[maybe_unused]]int ndet = apv_strip_mapping::Mapping::Instance()->GetTotalNumberOfDetectors();
-
     // set event id
     evtID = static_cast<int>(evt_num);
     nCluster = 0;
+    nStrip = 0;
+    for(auto *buf: {&Plane, &Prod, &Module, &Axis, &Size, &StripOffset, &StripNo})
+        buf -> data.clear();
+    for(auto *buf: {&Adc, &Pos, &StripADC})
+        buf -> data.clear();
 
     // for comon mode
-    nAPV = apv_strip_mapping::Mapping::Instance() -> GetTotalNumberOfAPVs();
-    int apv_index = 0;
+    nAPV = 0;
+    for(auto *buf: {&apv_crate_id, &apv_mpd_id, &apv_adc_ch})
+        buf -> data.clear();
+    for(int i = 0; i < 6; ++i) {
+        CM_offline[i].data.clear();
+        CM_online[i].data.clear();
+    }
 
     // get detector list
     std::vector<GEMDetector*> detectors = gem_sys -> GetDetectorList();
@@ -104,32 +129,32 @@ void GEMRootClusterTree::Fill(GEMSystem *gem_sys, const uint32_t &evt_num)
         {
             const std::vector<StripCluster> & clusters = pln -> GetStripClusters();
             int napvs_per_plane = pln -> GetCapacity();
+            int axis = static_cast<int>(pln -> GetType());
             for(auto &c: clusters) {
-                Plane[nCluster] = i -> GetLayerID();
-                Prod[nCluster] = i -> GetDetID();
-                Module[nCluster] = i -> GetDetLayerPositionIndex();
-                Axis[nCluster] = static_cast<int>(pln -> GetType());
-                Size[nCluster] = c.hits.size();
-                Adc[nCluster] = c.peak_charge;
-                Pos[nCluster] = c.position;
+                Plane.data.push_back(i -> GetLayerID());
+                Prod.data.push_back(i -> GetDetID());
+                Module.data.push_back(i -> GetDetLayerPositionIndex());
+                Axis.data.push_back(axis);
+                Size.data.push_back(c.hits.size());
+                Adc.data.push_back(c.peak_charge);
+                Pos.data.push_back(c.position);
+                StripOffset.data.push_back(nStrip);
 
                 // strips in this cluster
-                const std::vector<StripHit> &hits = c.hits;
-                for(size_t nS = 0; nS < hits.size() && nS < 100; ++nS)
+                for(auto &hit: c.hits)
                 {
                     // layer based strip no
-                    //StripNo[nCluster][nS] = hits[nS].strip;
+                    //StripNo.data.push_back(hit.strip);
 
                     // chamber based strip no
-                    StripNo[nCluster][nS] = getChamberBasedStripNo(hits[nS].strip, Axis[nCluster],
-                           napvs_per_plane, Module[nCluster]);
+                    StripNo.data.push_back(getChamberBasedStripNo(hit.strip, axis,
+                           napvs_per_plane, i -> GetDetLayerPositionIndex()));
  
-                    StripADC[nCluster][nS] = hits[nS].charge;
+                    StripADC.data.push_back(hit.charge);
                 }
 
+                nStrip += c.hits.size();
                 nCluster++;
-                if(nCluster >= MAXCLUSTERS)
-                    break;
             }
 
             // extract common mode for each apv on this plane
@@ -139,47 +164,22 @@ void GEMRootClusterTree::Fill(GEMSystem *gem_sys, const uint32_t &evt_num)
                 auto & online_common_mode = apv->GetOnlineCommonMode();
                 auto & offline_common_mode = apv->GetOfflineCommonMode();
 
-                apv_crate_id[apv_index] = apv->GetAddress().crate_id;
-                apv_mpd_id[apv_index] = apv->GetAddress().mpd_id;
-                apv_adc_ch[apv_index] = apv->GetAddress().adc_ch;
-
-                if(online_common_mode.size() != 6) {
-                    CM0_online[apv_index] = -9999;
-                    CM1_online[apv_index] = -9999;
-                    CM2_online[apv_index] = -9999;
-                    CM3_online[apv_index] = -9999;
-                    CM4_online[apv_index] = -9999;
-                    CM5_online[apv_index] = -9999;
-                } else {
-                    CM0_online[apv_index] = online_common_mode[0];
-                    CM1_online[apv_index] = online_common_mode[1]; 
-                    CM2_online[apv_index] = online_common_mode[2]; 
-                    CM3_online[apv_index] = online_common_mode[3]; 
-                    CM4_online[apv_index] = online_common_mode[4]; 
-                    CM5_online[apv_index] = online_common_mode[5]; 
-                }
+                apv_crate_id.data.push_back(apv->GetAddress().crate_id);
+                apv_mpd_id.data.push_back(apv->GetAddress().mpd_id);
+                apv_adc_ch.data.push_back(apv->GetAddress().adc_ch);
 
-                if(offline_common_mode.size() != 6) {
-                    CM0_offline[apv_index] = -9999;
-                    CM1_offline[apv_index] = -9999;
-                    CM2_offline[apv_index] = -9999;
-                    CM3_offline[apv_index] = -9999;
-                    CM4_offline[apv_index] = -9999;
-                    CM5_offline[apv_index] = -9999;
-                } else {
-                    CM0_offline[apv_index] = offline_common_mode[0];
-                    CM1_offline[apv_index] = offline_common_mode[1]; 
-                    CM2_offline[apv_index] = offline_common_mode[2]; 
-                    CM3_offline[apv_index] = offline_common_mode[3]; 
-                    CM4_offline[apv_index] = offline_common_mode[4]; 
-                    CM5_offline[apv_index] = offline_common_mode[5]; 
+                for(int k = 0; k < 6; ++k) {
+                    CM_online[k].data.push_back((online_common_mode.size() != 6) ? -9999 : online_common_mode[k]);
+                    CM_offline[k].data.push_back((offline_common_mode.size() != 6) ? -9999 : offline_common_mode[k]);
                 }
 
-                apv_index++;
+                nAPV++;
             }
         }
     }
 
-    if(nCluster > 0)
+    if(nCluster > 0) {
+        updateAddresses();
         pTree -> Fill();
+    }
 }
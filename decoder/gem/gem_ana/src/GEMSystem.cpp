@@ -17,13 +17,13 @@
 // 12/02/2020                                                                 //
 //============================================================================//
 
-#include <TFile.h>
-#include <TH1I.h>
 #include <cstdint>
+#include <algorithm>
 #include "GEMSystem.h"
 #include "GEMMPD.h"
 #include "GEMDetectorLayer.h"
 #include "GEMException.h"
+#include "MPDSSPRawEventDecoder.h"
 
 //============================================================================//
 // constructor, assigment operator, destructor                                //
@@ -52,7 +52,8 @@ GEMSystem::GEMSystem(const GEMSystem &that)
 : ConfigObject(that),
   gem_recon(that.gem_recon), PedestalMode(that.PedestalMode),
   def_ts(that.def_ts), def_cth(that.def_cth), def_zth(that.def_zth),
-  def_ctth(that.def_ctth), def_gain(that.def_gain)
+  def_ctth(that.def_ctth), def_gain(that.def_gain),
+  ped_outlier_sigma(that.ped_outlier_sigma), n_threads(that.n_threads)
 {
     // copy daq system first
     for(auto &mpd : that.mpd_slots)
@@ -99,7 +100,8 @@ GEMSystem::GEMSystem(GEMSystem &&that)
   mpd_slots(std::move(that.mpd_slots)), det_slots(std::move(that.det_slots)),
   det_name_map(std::move(that.det_name_map)), def_ts(that.def_ts),
   def_cth(that.def_cth), def_zth(that.def_zth), def_ctth(that.def_ctth),
-  def_gain(that.def_gain)
+  def_gain(that.def_gain), ped_outlier_sigma(that.ped_outlier_sigma),
+  n_threads(that.n_threads), thread_pool(std::move(that.thread_pool))
 {
     // reset the system for all components
     for(auto &mpd : mpd_slots)
@@ -165,6 +167,9 @@ GEMSystem &GEMSystem::operator =(GEMSystem &&rhs)
     def_zth = rhs.def_zth;
     def_ctth = rhs.def_ctth;
     def_gain = rhs.def_gain;
+    ped_outlier_sigma = rhs.ped_outlier_sigma;
+    n_threads = rhs.n_threads;
+    thread_pool = std::move(rhs.thread_pool);
 
     // reset the system for all components
     for(auto &mpd : mpd_slots)
@@ -203,6 +208,16 @@ void GEMSystem::Configure(const std::string &path)
     CONF_CONN(def_zth, "Default Zero Suppression Threshold", 5, verbose);
     CONF_CONN(def_ctth, "Default Cross Talk Threshold", 8, verbose);
     CONF_CONN(def_gain, "Default APV Gain Factor", 1, verbose);
+    CONF_CONN(ped_outlier_sigma, "Pedestal Outlier Rejection", 0, verbose);
+    // a narrower window cuts into the noise itself, the rms correction for
+    // the truncation grows quickly below 3 sigma
+    if(ped_outlier_sigma > 0. && ped_outlier_sigma < 3.) {
+        std::cout << " GEM System Warning: Pedestal Outlier Rejection at "
+                  << ped_outlier_sigma << " sigma is too narrow, use 3 sigma."
+                  << std::endl;
+        ped_outlier_sigma = 3.;
+    }
+    SetNumberOfThreads(Value<int>("APV Processing Threads", 1, verbose));
 
     SpecialAPVConfigure();
 
@@ -674,13 +689,7 @@ void GEMSystem::FillRawDataSRS(const GEMRawData &raw, EventData &event)
             apv->FillPedHist();
         else {
             apv->ZeroSuppression();
-#ifdef MULTI_THREAD
-            __gem_locker.lock();
-#endif
             apv->CollectZeroSupHits(event.get_gem_data());
-#ifdef MULTI_THREAD
-            __gem_locker.unlock();
-#endif
         }
     }
 }
@@ -700,13 +709,7 @@ void GEMSystem::FillRawDataMPD(const APVAddress &addr, const std::vector<int> &r
             apv->FillPedHist();
         else {
             apv->ZeroSuppression();
-#ifdef MULTI_THREAD
-            __gem_locker.lock();
-#endif
             apv->CollectZeroSupHits(event.get_gem_data());
-#ifdef MULTI_THREAD
-            __gem_locker.unlock();
-#endif
         }
     }
     else 
@@ -718,24 +721,25 @@ void GEMSystem::FillRawDataMPD(const APVAddress &addr, const std::vector<int> &r
 // fill raw data to a certain apv, online cm not availabe
 void GEMSystem::FillRawDataMPD(const APVAddress &addr, const std::vector<int> &raw,
         const APVDataType &flags, EventData &event)
+{
+    FillRawDataMPD(addr, raw.data(), raw.size(), flags, event);
+}
+
+// fill raw data to a certain apv from a flat buffer, online cm not availabe
+void GEMSystem::FillRawDataMPD(const APVAddress &addr, const int *raw, const uint32_t &size,
+        const APVDataType &flags, EventData &event)
 {
     GEMAPV *apv = GetAPV(addr);
 
     if(apv != nullptr) 
     {
-        apv->FillRawDataMPD(raw, flags);
+        apv->FillRawDataMPD(raw, size, flags);
 
         if(PedestalMode)
             apv->FillPedHist();
         else {
             apv->ZeroSuppression();
-#ifdef MULTI_THREAD
-            __gem_locker.lock();
-#endif
             apv->CollectZeroSupHits(event.get_gem_data());
-#ifdef MULTI_THREAD
-            __gem_locker.unlock();
-#endif
         }
     }
     else 
@@ -744,6 +748,84 @@ void GEMSystem::FillRawDataMPD(const APVAddress &addr, const std::vector<int> &r
     }
 }
 
+// fill raw data of all the decoded APVs, the APVs are grouped by their detector planes,
+// each plane is processed by one thread into its own hit buffer, so no lock is needed,
+// the hits are then merged in the plane order (independent of the number of threads)
+void GEMSystem::FillRawDataMPD(const MPDSSPRawEventDecoder &decoder, EventData &event,
+        bool use_online_cm)
+{
+    n_apv_groups = 0;
+    size_t last_group = 0;
+    for(auto &id : decoder.GetDecodedAPVs())
+    {
+        auto &addr = decoder.GetAPVAddress(id);
+        GEMAPV *apv = GetAPV(addr);
+        if(apv == nullptr) {
+            std::cout<<__func__<<" waring:: APV "<<addr<<" not found."<<std::endl;
+            continue;
+        }
+
+        // the APVs of a plane are usually decoded one after another
+        const GEMPlane *plane = apv->GetPlane();
+        if(last_group >= n_apv_groups || apv_groups[last_group].plane != plane) {
+            last_group = 0;
+            while(last_group < n_apv_groups && apv_groups[last_group].plane != plane)
+                last_group++;
+
+            if(last_group == n_apv_groups) {
+                if(apv_groups.size() <= n_apv_groups)
+                    apv_groups.emplace_back();
+                apv_groups[n_apv_groups].plane = plane;
+                apv_groups[n_apv_groups].apvs.clear();
+                n_apv_groups++;
+            }
+        }
+        apv_groups[last_group].apvs.emplace_back(apv, id);
+    }
+
+    auto process_group = [&](size_t i)
+    {
+        auto &group = apv_groups[i];
+        group.hits.clear();
+        for(auto &it : group.apvs)
+        {
+            const int *online_cm = use_online_cm ? decoder.GetAPVOnlineCommonMode(it.second) : nullptr;
+            processAPV(it.first, decoder.GetAPVData(it.second), decoder.GetAPVDataFlags(it.second),
+                    online_cm, group.hits);
+        }
+    };
+
+    if(n_threads > 1) {
+        if(!thread_pool || thread_pool->GetNumberOfThreads() != n_threads)
+            thread_pool.reset(new GEMThreadPool(n_threads));
+        thread_pool->Run(n_apv_groups, process_group);
+    } else {
+        for(size_t i = 0; i < n_apv_groups; ++i)
+            process_group(i);
+    }
+
+    // merge the hits
+    auto &gem_data = event.get_gem_data();
+    for(size_t i = 0; i < n_apv_groups; ++i)
+        gem_data.insert(gem_data.end(), apv_groups[i].hits.begin(), apv_groups[i].hits.end());
+}
+
+// process the raw data of one apv, the zero suppressed hits are added to hits
+void GEMSystem::processAPV(GEMAPV *apv, const int *raw, const APVDataType &flags,
+        const int *online_cm, std::vector<GEM_Strip_Data> &hits)
+{
+    apv->FillRawDataMPD(raw, MPDSSPRawEventDecoder::APV_DATA_SIZE, flags);
+    if(online_cm)
+        apv->FillOnlineCommonMode(online_cm, SSP_TIME_SAMPLE);
+
+    if(PedestalMode)
+        apv->FillPedHist();
+    else {
+        apv->ZeroSuppression();
+        apv->CollectZeroSupHits(hits);
+    }
+}
+
 // clear all APVs' raw data space
 void GEMSystem::Reset()
 {
@@ -780,18 +862,12 @@ void GEMSystem::FillZeroSupData(const std::vector<GEMZeroSupData> &data_pack,
     for(auto &data : data_pack)
         FillZeroSupData(data);
 
-#ifdef MULTI_THREAD
-    __gem_locker.lock();
-#endif
     // collect these zero-suppressed hits
     for(auto &mpd : mpd_slots)
     {
         if(mpd.second)
             mpd.second->APVControl(&GEMAPV::CollectZeroSupHits, event.get_gem_data());
     }
-#ifdef MULTI_THREAD
-    __gem_locker.unlock();
-#endif
 }
 
 // fill zero suppressed data
@@ -903,25 +979,28 @@ void GEMSystem::SaveCommonModeRange(const std::string &name)
 }
 
 // set pedestal mode on/off
-// if the pedestal mode is on, filling raw data will also fill the histograms in
-// APV for future pedestal fitting
-// turn on the pedestal mode will greatly slow down the raw data handling and
-// consume a significant amount of memories
+// if the pedestal mode is on, filling raw data will also fill the pedestal
+// statistics in APV (streaming mean and rms per strip) for future pedestal
+// fitting, the memory does not grow with the number of events
 void GEMSystem::SetPedestalMode(const bool &m)
 {
     PedestalMode = m;
     OnlineMode = !m;
     ReplayMode = !m;
 
+    if(!m)
+        return;
+
     for(auto &mpd : mpd_slots)
     {
         if(!mpd.second)
             continue;
 
-        if(m)
-            mpd.second->APVControl(&GEMAPV::CreatePedHist);
-        else
-            mpd.second->APVControl(&GEMAPV::ReleasePedHist);
+        for(auto apv : mpd.second->GetAPVList())
+        {
+            apv->ResetPedHist();
+            apv->SetPedestalOutlierRejection(ped_outlier_sigma);
+        }
     }
 }
 
@@ -943,6 +1022,12 @@ void GEMSystem::SetReplayMode(const bool &m)
     ReplayMode = m;
 }
 
+// number of threads for processing the APVs of an event, 1 means no extra threads
+void GEMSystem::SetNumberOfThreads(const int &n)
+{
+    n_threads = std::max(n, 1);
+}
+
 // collect the zero suppressed data from APV
 std::vector<GEM_Strip_Data> GEMSystem::GetZeroSupData()
     const
@@ -988,39 +1073,6 @@ void GEMSystem::SetUnivTimeSample(const uint32_t &ts)
     }
 }
 
-// save all APVs' histograms into a root file
-void GEMSystem::SaveHistograms(const std::string &path)
-    const
-{
-    if(path.size() <= 0)
-        return;
-
-    TFile *f = new TFile(path.c_str(), "recreate");
-
-    for(auto &mpd : mpd_slots)
-    {
-        if(!mpd.second)
-            continue;
-
-        std::string mpd_name = "MPD " + std::to_string(mpd.second->GetID());
-        TDirectory *cdtof = f->mkdir(mpd_name.c_str());
-        cdtof->cd();
-
-        for(auto apv : mpd.second->GetAPVList())
-        {
-            std::string adc_name = "ADC " + std::to_string(apv->GetADCChannel());
-            TDirectory *cur_dir = cdtof->mkdir(adc_name.c_str());
-            cur_dir->cd();
-
-            for(auto hist : apv->GetHistList())
-                hist->Write();
-        }
-    }
-
-    f->Close();
-    delete f;
-}
-
 // get the whole APV list
 std::vector<GEMAPV *> GEMSystem::GetAPVList()
     const
@@ -1038,6 +1090,17 @@ std::vector<GEMAPV *> GEMSystem::GetAPVList()
     return apv_list;
 }
 
+// addresses of all the APVs, in the same order as GetAPVList
+std::vector<APVAddress> GEMSystem::GetAPVAddressList()
+    const
+{
+    std::vector<APVAddress> addr_list;
+    for(auto &apv : GetAPVList())
+        addr_list.push_back(apv->GetAddress());
+
+    return addr_list;
+}
+
 std::vector<GEMMPD*> GEMSystem::GetMPDList()
     const
 {
@@ -0,0 +1,110 @@
+//============================================================================//
+// A persistent work-stealing thread pool for processing the APVs of an event //
+//============================================================================//
+
+#include "GEMThreadPool.h"
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+// constructor, the calling thread of Run is one of the threads
+
+GEMThreadPool::GEMThreadPool(int n)
+: nthreads(std::max(n, 1)), ranges(new TaskRange[std::max(n, 1)])
+{
+    for(int i = 0; i < nthreads; ++i) {
+        ranges[i].next = 0;
+        ranges[i].end = 0;
+    }
+
+    for(int i = 1; i < nthreads; ++i)
+        workers.emplace_back(&GEMThreadPool::workerLoop, this, i);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// destructor
+
+GEMThreadPool::~GEMThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(locker);
+        stop = true;
+    }
+    start_cv.notify_all();
+
+    for(auto &w : workers)
+        w.join();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// run the tasks, returns when all of them are done
+
+void GEMThreadPool::Run(size_t ntasks, const std::function<void(size_t)> &task)
+{
+    if(ntasks == 0)
+        return;
+
+    // not worth waking up the others
+    if(nthreads == 1 || ntasks == 1) {
+        for(size_t i = 0; i < ntasks; ++i)
+            task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(locker);
+        for(int i = 0; i < nthreads; ++i) {
+            ranges[i].next = ntasks * i / nthreads;
+            ranges[i].end = ntasks * (i + 1) / nthreads;
+        }
+        current_task = &task;
+        nbusy = nthreads - 1;
+        generation++;
+    }
+    start_cv.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(locker);
+    done_cv.wait(lock, [this] {return nbusy == 0;});
+    current_task = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// threads sleep until the next Run call
+
+void GEMThreadPool::workerLoop(int id)
+{
+    unsigned long seen = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(locker);
+            start_cv.wait(lock, [&] {return stop || generation != seen;});
+            if(stop)
+                return;
+            seen = generation;
+        }
+
+        work(id);
+
+        std::lock_guard<std::mutex> lock(locker);
+        if(--nbusy == 0)
+            done_cv.notify_one();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// take the tasks from its own range first, then steal from the others
+
+void GEMThreadPool::work(int id)
+{
+    const auto &task = *current_task;
+
+    for(int k = 0; k < nthreads; ++k)
+    {
+        auto &range = ranges[(id + k) % nthreads];
+        size_t i;
+        while((i = range.next.fetch_add(1, std::memory_order_relaxed)) < range.end)
+            task(i);
+    }
+}
@@ -7,6 +7,8 @@
 #include "TFile.h"
 #include "EvStruct.h"
 #include "EvChannel.h"
+#include "EvMappedChannel.h"
+#include "EvIndex.h"
 #include "Fadc250Decoder.h"
 #include "WfAnalyzer.h"
 #include "SSPDecoder.h"
@@ -16,7 +18,12 @@
 #include "EPICSystem.h"
 #include "epics_tree_struct.h"
 #include <chrono>
+#include <thread>
+#include <memory>
 #include "ReadDatabase.h"
+#include "event_pipeline.h"
+#include "split_replay.h"
+#include "TROOT.h"
 
 //#define USE_OLD_GEM_TRACKING
 
@@ -38,8 +45,20 @@
 #define PROGRESS_COUNT 1000
 #endif
 
+// settings of the output trees
+struct OutputOptions
+{
+    int compress = -1;              // ROOT compression setting (algorithm*100 + level), < 0 keeps the default
+    int basket_size = 32000;        // basket size of all branches (bytes), <= 0 keeps the branch settings
+    long long auto_flush = 0;       // TTree::SetAutoFlush, 0 keeps the default (30 MB)
+    int imt_threads = 0;            // threads for ROOT implicit multi-threading (basket compression)
+    bool async = false;             // fill the trees in a writer thread, separated from decoding
+};
+
 void write_raw_data(const std::string &dpath, const std::string &opath, const std::string &mpath, int nev,
-        int nskip=0, int res=3, double thres=10, int npeds=5, double flat=1.0, int usefixedped=0);
+        int nskip=0, int res=3, double thres=10, int npeds=5, double flat=1.0, int usefixedped=0,
+        int nthreads=1, int zerocopy=0, int use_index=0, int trigger=-1, const OutputOptions &oopts = OutputOptions());
+int parse_compression(const std::string &str);
 
 int GetRunNumber(std::string str);
 
@@ -69,6 +88,28 @@ int main(int argc, char*argv[])
     arg_parser.AddArg<int>("-p", "npeds", "sample window width for pedestal searching", 8);
     arg_parser.AddArg<double>("-f", "flat", "flatness requirement for pedestal searching", 1.0);
     arg_parser.AddArg<int>("-x", "usefixedped", "whether or not to use fixed FADC pedestals", 0);
+    arg_parser.AddArg<int>("-j", "nthreads", "number of worker threads for decoding and reconstruction"
+            " (> 1 enables the pipeline replay, < 1 means 1)", 1);
+    arg_parser.AddArg<int>("-z", "zerocopy", "read the evio file through a memory map (evio version 4 only)", 0);
+    arg_parser.AddArg<int>("-i", "index", "use the event index file <raw_data>.idx (built if missing) to skip events"
+            " without reading them, implies -z", 0);
+    arg_parser.AddArg<int>("-e", "trigger", "only replay the physics events of this trigger type (< 0 means all),"
+            " requires -i", -1);
+    arg_parser.AddArgs<int>({"-s", "--split-start"}, "split_start", "replay the split files of the run from"
+            " <raw_data>.<split_start> and merge the output (< 0 means raw_data is a single file)", -1);
+    arg_parser.AddArgs<int>({"-S", "--split-end"}, "split_end", "last split file (exclusive) of the run"
+            " (< 0 means until a split file is missing)", -1);
+    arg_parser.AddArgs<int>({"-w", "--workers"}, "nworkers", "number of worker processes for the split files", 4);
+    arg_parser.AddArgs<int>({"-a", "--async"}, "async", "fill the output trees in a writer thread, separated from"
+            " the decoding (always on with -j > 1)", 0);
+    arg_parser.AddArgs<std::string>({"-c", "--compress"}, "compress", "output compression, algorithm:level"
+            " (zlib, lzma, lz4, zstd) or the ROOT setting (e.g. 404), empty keeps the ROOT default", "");
+    arg_parser.AddArgs<int>({"-b", "--basket-size"}, "basket_size", "basket size of the output branches in bytes"
+            " (<= 0 keeps the branch defaults)", 32000);
+    arg_parser.AddArgs<int>({"-F", "--auto-flush"}, "auto_flush", "auto-flush of the output trees, > 0: entries,"
+            " < 0: bytes, 0 keeps the ROOT default", 0);
+    arg_parser.AddArgs<int>({"-I", "--imt"}, "imt", "number of threads for ROOT implicit multi-threading, used to"
+            " compress the baskets in parallel (0: off)", 0);
 
     auto args = arg_parser.ParseArgs(argc, argv);
 
@@ -77,16 +118,52 @@ int main(int argc, char*argv[])
         std::cout << it.first << ": " << it.second.String() << std::endl;
     }
 
-    write_raw_data(args["raw_data"].String(),
-            args["root_file"].String(),
-            args["module"].String(),
-            args["nev"].Int(),
-            args["nskip"].Int(),
-            args["res"].Int(),
-            args["thres"].Double(),
-            args["npeds"].Int(),
-            args["flat"].Double(),
-            args["usefixedped"].Int());
+    OutputOptions oopts;
+    oopts.compress = parse_compression(args["compress"].String());
+    oopts.basket_size = args["basket_size"].Int();
+    oopts.auto_flush = args["auto_flush"].Int();
+    oopts.imt_threads = args["imt"].Int();
+    oopts.async = (args["async"].Int() != 0);
+
+    auto replay = [&args, &oopts](const std::string &dpath, const std::string &opath) {
+        write_raw_data(dpath,
+                opath,
+                args["module"].String(),
+                args["nev"].Int(),
+                args["nskip"].Int(),
+                args["res"].Int(),
+                args["thres"].Double(),
+                args["npeds"].Int(),
+                args["flat"].Double(),
+                args["usefixedped"].Int(),
+                args["nthreads"].Int(),
+                args["zerocopy"].Int(),
+                args["index"].Int(),
+                args["trigger"].Int(),
+                oopts);
+    };
+
+    if (args["split_start"].Int() < 0) {
+        replay(args["raw_data"].String(), args["root_file"].String());
+        return 0;
+    }
+
+    // split file set, one worker process for each split file
+    auto splits = split_replay::FindSplits(args["raw_data"].String(), args["split_start"].Int(), args["split_end"].Int());
+    if (splits.empty()) {
+        std::cout << "Cannot find any split files for " << args["raw_data"].String() << std::endl;
+        return -1;
+    }
+    if (args["nev"].Int() >= 0 || args["nskip"].Int() > 0) {
+        std::cout << "Warning: the number of events to process and to skip are applied to each split file." << std::endl;
+    }
+    std::cout << "Replay " << splits.size() << " split files with " << args["nworkers"].Int() << " worker processes."
+              << std::endl;
+
+    auto outputs = split_replay::RunWorkers(splits, args["root_file"].String(), std::max(args["nworkers"].Int(), 1), replay);
+    if (outputs.empty() || !split_replay::MergeOutputs(outputs, args["root_file"].String(), oopts.compress)) {
+        return -1;
+    }
     return 0;
 }
 
@@ -246,13 +323,9 @@ void extract_new_gem_tracking_result(tracking_dev::TrackingDataHandler *tracking
 void extract_gem_cluster(GEMSystem *gem_sys, MPDSSPRawEventDecoder *gem_decoder, tracking_dev::TrackingDataHandler *tracking_data_handler,
         tracking_dev::Tracking *new_tracking, GEMTreeStruct &gem_data, int evtNum)
 {
-    auto &decoded_data = gem_decoder -> GetAPV();
-    auto &decoded_data_flags = gem_decoder -> GetAPVDataFlags();
-
     EventData event_data;
-    for(auto &i: decoded_data){
-        gem_sys -> FillRawDataMPD(i.first, i.second, decoded_data_flags.at(i.first), event_data);
-    }
+    // the online common modes are not used here
+    gem_sys -> FillRawDataMPD(*gem_decoder, event_data, false);
 
     gem_sys -> Reconstruct(event_data);
 
@@ -300,7 +373,7 @@ void extract_gem_cluster(GEMSystem *gem_sys, MPDSSPRawEventDecoder *gem_decoder,
                 gem_data.Pos[icluster] = c.position;
 
                 // strips in this cluster
-                const std::vector<StripHit> &hits = c.hits;
+                const auto &hits = c.hits;
                 for(size_t nS = 0; nS < hits.size() && nS < MAXCLUSTERSIZE; ++nS)
                 {
                     // layer based strip no
@@ -345,40 +418,28 @@ void extract_gem_cluster(GEMSystem *gem_sys, MPDSSPRawEventDecoder *gem_decoder,
 #endif
 
 // create an epics tree
+// the channel branches are bound to the epics system values (by channel id), they are updated in place by
+// FillRawData, so the epics map should not be changed after the tree is created
 TTree* create_epics_tree(EPICSystem *epic_sys, const std::string tname = "EpicsTree", const std::string name = "epics tree")
 {
     auto tree = new TTree(tname.c_str(), name.c_str());
 
-    epics_struct::EPICStruct *epic_dat = new epics_struct::EPICStruct();
-
-    auto & e_map = epic_sys -> GetEpicsMap();
-    for(auto &i: e_map) {
-        (epic_dat->data)[i.first] = -999999.9;
-    }
-
-    epics_struct::__g_epic_data = static_cast<epics_struct::EPICStruct*>(epic_dat);
+    epics_struct::__g_epic_data = new epics_struct::EPICStruct();
 
     std::string sname = "Epics_";
     tree -> Branch((sname + "event_number").c_str(), &epics_struct::__g_epic_data->event_number, "eventNo/I");
     tree -> Branch((sname + "timestamp").c_str(), &epics_struct::__g_epic_data->timestamp);
-    for(auto &entry: epics_struct::__g_epic_data->data)
+
+    float *values = epic_sys -> GetValueBuffer();
+    for(auto &ch: epic_sys -> GetSortedList())
     {
-        std::string branch_name = sname + entry.first;
+        std::string branch_name = sname + ch.name;
 
         // branch name does not allow "." and ":", which is in CODA epics name
-        size_t dot_pos = branch_name.find(".");
-        while(dot_pos != std::string::npos) {
-            branch_name = branch_name.replace(dot_pos, 1, "_");
-            dot_pos = branch_name.find(".");
-        }
-
-        dot_pos = branch_name.find(":");
-        while(dot_pos != std::string::npos){
-            branch_name = branch_name.replace(dot_pos, 1, "_");
-            dot_pos = branch_name.find(":");
-        }
+        std::replace(branch_name.begin(), branch_name.end(), '.', '_');
+        std::replace(branch_name.begin(), branch_name.end(), ':', '_');
 
-        tree -> Branch(branch_name.c_str(), &entry.second, Form("%s/F", branch_name.c_str()));
+        tree -> Branch(branch_name.c_str(), &values[ch.id], Form("%s/F", branch_name.c_str()));
     }
     return tree;
 }
@@ -386,29 +447,471 @@ TTree* create_epics_tree(EPICSystem *epic_sys, const std::string tname = "EpicsT
 // analyze event and fill epics tree
 void fill_epics_event(const uint32_t *buf, EPICSystem* epic_sys, const int event_number, TTree *T)
 {
-    // skip top level bank header information
-    auto evh = evc::BankHeader(&buf[0] + 2);
-    size_t len = evc::BankHeader::size();
-
-    // skip epics bank header information
+    // skip top level bank header and epics bank header information
+    // the channel values are parsed into the branch buffers
     epic_sys -> FillRawData( (const char*)(&buf[0] + 4) );
 
-    // fill epics event data
-
     epics_struct::__g_epic_data -> event_number = event_number;
     epics_struct::__g_epic_data -> timestamp = epic_sys -> GetCurrentTimeStamp();
 
-    for(auto &i: epics_struct::__g_epic_data -> data)
+    T -> Fill();
+}
+
+// walks through the events of a run
+// with the event index, it jumps over the skipped events and the physics events of the
+// unwanted trigger types without reading them
+class EventCursor
+{
+public:
+    EventCursor(evc::EvChannel &ch, const evc::EvIndex *idx = nullptr, int trg = -1)
+    : chan(ch), index(idx), trigger(trg), next(0), jump(false)
     {
-        i.second = epic_sys -> GetEpicsValueByName(i.first);
+        mapped = dynamic_cast<evc::EvMappedChannel*>(&chan);
+        if (!mapped) {
+            index = nullptr;
+        }
     }
 
-    T -> Fill();
+    bool Read()
+    {
+        if (!index) {
+            return chan.Read() == evc::status::success;
+        }
+
+        while ((next < index->Size()) && !selected((*index)[next])) {
+            next++;
+            jump = true;
+        }
+        if (next >= index->Size()) {
+            return false;
+        }
+        if (jump && (mapped->Seek((*index)[next]) != evc::status::success)) {
+            return false;
+        }
+        jump = false;
+        next++;
+        return mapped->Read() == evc::status::success;
+    }
+
+    // skip the next n events, returns the number of skipped events
+    int Skip(int n)
+    {
+        int nskipped = 0;
+        if (!index) {
+            for (; (nskipped < n) && (chan.Read() == evc::status::success); ++nskipped) {}
+            return nskipped;
+        }
+
+        for (; (nskipped < n) && (next < index->Size()); ++next) {
+            if (selected((*index)[next])) {
+                nskipped++;
+            }
+        }
+        jump = true;
+        return nskipped;
+    }
+
+private:
+    bool selected(const evc::EvIndexEntry &entry) const
+    {
+        return (trigger < 0) || !evc::EvIndex::IsPhysics(entry.tag) || ((int)entry.trigger == trigger);
+    }
+
+    evc::EvChannel &chan;
+    evc::EvMappedChannel *mapped;
+    const evc::EvIndex *index;
+    int trigger;
+    size_t next;
+    bool jump;
+};
+
+#ifndef USE_OLD_GEM_TRACKING
+//=============================================================================
+// pipeline replay
+// reader (one thread) -> workers (N threads, decode + reconstruct + track) -> writer (this thread)
+// the writer fills the trees in the reading order, so the output is identical to the serial replay
+//=============================================================================
+
+// results of one block level, the module copies own their event buffers
+struct BlockResult
+{
+    std::vector<Module> modules;
+    // whether the module data was found, a module without data keeps the previous content in the tree
+    std::vector<char> decoded;
+};
+
+// an event passed through the pipeline
+struct PipelineEvent
+{
+    uint64_t seq = 0;
+    // number of events dropped by the reader (nskip) right before this one
+    int nskipped = 0;
+    uint32_t tag = 0;
+    std::vector<uint32_t> buffer;
+
+    // filled by the worker
+    int trigger_type = -1;
+    uint64_t trigger_time = 0;
+    int nblocks = 0;
+    std::vector<BlockResult> blocks;
+};
+
+// copy the module list with private event buffers
+static std::vector<Module> clone_modules(const std::vector<Module> &modules)
+{
+    std::vector<Module> res = modules;
+    for (auto &m : res) {
+        switch (m.type) {
+        case kFADC250: m.event = static_cast<void*>(new fdec::Fadc250Event(0, 16)); break;
+        case kSSP: m.event = static_cast<void*>(new GEMTreeStruct()); break;
+        default: m.event = nullptr; break;
+        }
+    }
+    return res;
+}
+
+static void release_modules(std::vector<Module> &modules)
+{
+    for (auto &m : modules) {
+        switch (m.type) {
+        case kFADC250: delete static_cast<fdec::Fadc250Event*>(m.event); break;
+        case kSSP: delete static_cast<GEMTreeStruct*>(m.event); break;
+        default: break;
+        }
+        m.event = nullptr;
+    }
+}
+
+// move a decoded module event into the buffers bound to the tree branches
+static void take_module_event(Module &dst, Module &src, int event_number)
+{
+    switch (dst.type) {
+    case kFADC250:
+        {
+            auto &dch = static_cast<fdec::Fadc250Event*>(dst.event)->channels;
+            auto &sch = static_cast<fdec::Fadc250Event*>(src.event)->channels;
+            for (size_t i = 0; i < dch.size() && i < sch.size(); ++i) {
+                std::swap(dch[i].ped, sch[i].ped);
+                dch[i].peaks.swap(sch[i].peaks);
+                dch[i].raw.swap(sch[i].raw);
+            }
+        }
+        break;
+    case kSSP:
+        {
+            auto gem_data = static_cast<GEMTreeStruct*>(dst.event);
+            gem_data->Swap(*static_cast<GEMTreeStruct*>(src.event));
+            gem_data->event_number = event_number;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// everything a worker needs to decode and reconstruct events on its own
+struct EventWorker
+{
+    // only used to scan the event buffers handed over by the reader
+    evc::EvChannel evchan;
+    fdec::Fadc250Decoder fdecoder;
+    fdec::Analyzer analyzer;
+    fdec::AnalyzerBuffers ana_buffers;
+    GEMSystem gem_system;
+    MPDSSPRawEventDecoder gem_decoder;
+    tracking_dev::TrackingDataHandler *tracking_data_handler;
+    tracking_dev::Tracking *new_tracking;
+
+    EventWorker(int res, double thres, int npeds, double flat)
+    : evchan(0), analyzer(res, thres, npeds, flat)
+    {
+        gem_system.Configure("config/gem.conf");
+        // the events are already processed in parallel by the workers
+        gem_system.SetNumberOfThreads(1);
+        gem_system.ReadPedestalFile();
+        gem_decoder.SetAPVList(gem_system.GetAPVAddressList());
+        tracking_data_handler = new tracking_dev::TrackingDataHandler();
+        tracking_data_handler -> Init();
+        tracking_data_handler -> SetGEMSystem(&gem_system);
+        tracking_data_handler -> SetupDetector();
+        new_tracking = tracking_data_handler -> GetTrackingHandle();
+    }
+
+    // decode all block levels of a physics event, same procedures as the serial replay
+    void Process(PipelineEvent &ev, const std::vector<Module> &modules, const std::vector<uint32_t> &dbanks,
+            db::dbBlock *dbFADCPed, int usefixedped)
+    {
+        ev.nblocks = 0;
+        if (ev.tag != CODA_PHY1 && ev.tag != CODA_PHY2) {
+            return;
+        }
+
+        // borrow the event buffer, no copy
+        evchan.GetRawBufferVec().swap(ev.buffer);
+
+        evchan.ScanBanks(dbanks);
+        auto &ref = modules.front();
+        auto ref_buf = evchan.TryGetEvBuffer(ref.crate, ref.bank, ref.slot);
+        int blvl = ref_buf ? ref_buf->size() : 0;
+        ev.trigger_type = (int)(evchan.GetEventType());
+        ev.trigger_time = evchan.GetTriggerTime();
+
+        while ((int)ev.blocks.size() < blvl) {
+            ev.blocks.emplace_back();
+            ev.blocks.back().modules = clone_modules(modules);
+            ev.blocks.back().decoded.resize(modules.size());
+        }
+        ev.nblocks = blvl;
+
+        const uint32_t *dbuf;
+        size_t buflen;
+        for (int ii = 0; ii < blvl; ++ii) {
+            auto &blk = ev.blocks[ii];
+            int imod = -1;
+            for (size_t im = 0; im < blk.modules.size(); ++im) {
+                auto &mod = blk.modules[im];
+                blk.decoded[im] = 0;
+                dbuf = evchan.TryGetEvBuffer(mod.crate, mod.bank, mod.slot, ii, buflen);
+                if (!dbuf) {
+                    std::cout << "warning: No data found for ROC " << mod.crate << ", bank " << mod.bank
+                              << ", slot " << mod.slot << ", block_level " << ii << "\n";
+                    continue;
+                }
+                switch (mod.type) {
+                    case kFADC250:
+                        {
+                            auto event = static_cast<fdec::Fadc250Event*>(mod.event);
+                            fdecoder.DecodeEvent(*event, dbuf, buflen);
+                            imod++;
+                            size_t idx=16*imod;
+                            for (auto &ch : event->channels) {
+                                double fixedPed = 0.0, fixedPedErr = 0.0;
+                                if(usefixedped) {
+                                    if(idx >= dbFADCPed->Data.size()) {
+                                        std::cout<<"Error! Number of channels in FADC Pedestal file is less than that in the raw data, I quit ... \n";
+                                        exit(-1);
+                                    }
+                                    fixedPed = dbFADCPed->Data[idx];
+                                    fixedPedErr=1.5;
+                                }
+                                idx++;
+                                analyzer.Analyze(ch,ana_buffers,fixedPed,fixedPedErr);
+                            }
+                        }
+                        break;
+                    case kSSP:
+                        {
+                            std::vector<int> ivec{mod.bank, mod.crate};
+                            gem_decoder.Decode(dbuf, buflen, ivec);
+                            auto event = static_cast<GEMTreeStruct*>(mod.event);
+                            // event number is assigned by the writer
+                            extract_gem_cluster(&gem_system, &gem_decoder, tracking_data_handler, new_tracking, *event, -1);
+                        }
+                        break;
+                    default:
+                        std::cout << "Unsupported module type " << mod.type << std::endl;
+                        break;
+                }
+                blk.decoded[im] = 1;
+            }
+        }
+
+        // return the buffer
+        evchan.GetRawBufferVec().swap(ev.buffer);
+    }
+};
+
+// replay with one reader thread, nthreads workers, and the writer in the calling thread
+void replay_pipeline(evc::EvChannel &evchan, EventCursor &cursor, std::vector<Module> &modules, const std::vector<uint32_t> &dbanks,
+        int nev, int nskip, int res, double thres, int npeds, double flat, db::dbBlock *dbFADCPed, int usefixedped,
+        EPICSystem *epic_sys, TTree *tree, TTree *epics_tree, int &TriggerType, uint64_t &TriggerTime, int nthreads)
+{
+    ROOT::EnableThreadSafety();
+    // make sure the singleton is created before any worker touches it
+    apv_strip_mapping::Mapping::Instance();
+
+    std::cout << "Pipeline replay with " << nthreads << " worker threads." << std::endl;
+
+    // set up the workers one by one, configuration loading is not meant to be concurrent
+    std::vector<std::unique_ptr<EventWorker>> workers;
+    for (int i = 0; i < nthreads; ++i) {
+        workers.emplace_back(new EventWorker(res, thres, npeds, flat));
+        workers.back()->evchan.CompileLookup(module_addresses(modules));
+    }
+
+    // the event pool bounds the number of events in flight
+    size_t npool = 4*nthreads;
+    std::vector<PipelineEvent> pool(npool);
+    BoundedQueue<PipelineEvent*> free_events(npool), work(npool);
+    OrderedOutput<PipelineEvent> output(npool);
+    for (auto &ev : pool) {
+        free_events.Push(&ev);
+    }
+
+    // reader, it reproduces the nskip logic of the serial replay, which depends on the number of
+    // filled entries, so it scans the physics events until the skipping is over
+    int tail_skipped = 0;
+    std::thread reader([&] () {
+        uint64_t seq = 0;
+        int count = 0, nskipped = 0;
+        bool check_skip = (nskip > 0);
+        // the mapped reader swaps a byte-swapped file only when the banks are scanned
+        auto mapped = dynamic_cast<evc::EvMappedChannel*>(&evchan);
+        bool need_swap = mapped && mapped->IsSwapped();
+        if(nskip>0) nev += nskip;
+        auto &ref = modules.front();
+        while (cursor.Read() && (nev-- != 0)) {
+            if(check_skip && count>0 && count<nskip) {
+                // skip the rest at once, within the number of events to be read
+                int n = nskip - count - 1;
+                int nread = cursor.Skip((nev >= 0 && nev < n) ? nev : n);
+                nev -= nread;
+                count += nread + 1;
+                nskipped += nread + 1;
+                if (nev == 0) break;
+                continue;
+            }
+
+            PipelineEvent *ev;
+            free_events.Pop(ev);
+            auto evh = evchan.GetEvHeader();
+            ev->seq = seq++;
+            ev->nskipped = nskipped;
+            ev->tag = evh.tag;
+            if ((check_skip || need_swap) && (evh.tag == CODA_PHY1 || evh.tag == CODA_PHY2)) {
+                evchan.ScanBanks(dbanks);
+                if (check_skip) {
+                    auto ref_buf = evchan.TryGetEvBuffer(ref.crate, ref.bank, ref.slot);
+                    count += ref_buf ? ref_buf->size() : 0;
+                    check_skip = (count < nskip);
+                }
+            }
+            const uint32_t *raw = evchan.GetRawBuffer();
+            ev->buffer.assign(raw, raw + evh.length + 1);
+            // a null word behind the event, the epics text bank is parsed as a c string
+            ev->buffer.push_back(0);
+            nskipped = 0;
+            work.Push(ev);
+        }
+        tail_skipped = nskipped;
+        work.Close();
+        output.SetEnd(seq);
+    });
+
+    std::vector<std::thread> threads;
+    for (auto &w : workers) {
+        EventWorker *worker = w.get();
+        threads.emplace_back([&, worker] () {
+            PipelineEvent *ev;
+            while (work.Pop(ev)) {
+                worker->Process(*ev, modules, dbanks, dbFADCPed, usefixedped);
+                output.Put(ev);
+            }
+        });
+    }
+
+    // writer
+    auto time_1 = std::chrono::steady_clock::now();
+    auto time_2 = std::chrono::steady_clock::now();
+    int count = 0;
+    PipelineEvent *ev;
+    while (output.Next(ev)) {
+        count += ev->nskipped;
+        if(nskip>0 && count==nskip) {
+            std::cout << "First " << nskip <<" events were skipped." << std::endl;
+        }
+        if((count % PROGRESS_COUNT) == 0) {
+            time_2 = std::chrono::steady_clock::now();
+            auto time_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(time_2 - time_1).count();
+            std::cout << "Processed events - " << count << " - " << time_elapsed <<" milliseconds per " << PROGRESS_COUNT << " events." << "\r" << std::flush;
+            time_1 = time_2;
+        }
+
+        switch(ev->tag) {
+            case CODA_PHY1:
+            case CODA_PHY2:
+                for (int ii = 0; ii < ev->nblocks; ++ii) {
+                    auto &blk = ev->blocks[ii];
+                    for (size_t im = 0; im < modules.size(); ++im) {
+                        if (blk.decoded[im]) {
+                            take_module_event(modules[im], blk.modules[im], count);
+                        }
+                    }
+                    TriggerType = ev->trigger_type;
+                    TriggerTime = ev->trigger_time;
+                    tree->Fill();
+                    count ++;
+                }
+                break;
+            case CODA_EPICS:
+                fill_epics_event(ev->buffer.data(), epic_sys, count, epics_tree);
+                break;
+            default:
+                break;
+        }
+        free_events.Push(ev);
+    }
+
+    reader.join();
+    for (auto &t : threads) {
+        t.join();
+    }
+    count += tail_skipped;
+    std::cout << "Processed events - " << count << std::endl;
+
+    for (auto &p : pool) {
+        for (auto &blk : p.blocks) {
+            release_modules(blk.modules);
+        }
+    }
+}
+#endif
+
+// compression setting from "algorithm:level" or the ROOT number (algorithm*100 + level), -1 for empty
+int parse_compression(const std::string &str)
+{
+    if (str.empty()) {
+        return -1;
+    }
+
+    auto pos = str.find(':');
+    if (pos == std::string::npos) {
+        return std::stoi(str);
+    }
+
+    // same numbers as ROOT::RCompressionSetting::EAlgorithm
+    static const std::vector<std::pair<std::string, int>> algorithms = {
+        {"zlib", 1}, {"lzma", 2}, {"lz4", 4}, {"zstd", 5},
+    };
+    std::string name = str.substr(0, pos);
+    int level = std::stoi(str.substr(pos + 1));
+    for (auto &alg : algorithms) {
+        if (alg.first == name) {
+            return alg.second*100 + level;
+        }
+    }
+    std::cout << "Warning: unknown compression algorithm \"" << name << "\", use the ROOT default." << std::endl;
+    return -1;
+}
+
+// basket size, auto-flush and implicit multi-threading of an output tree, after all branches are created
+static void setup_output_tree(TTree *tree, const OutputOptions &oopts)
+{
+    if (oopts.basket_size > 0) {
+        tree->SetBasketSize("*", oopts.basket_size);
+    }
+    if (oopts.auto_flush != 0) {
+        tree->SetAutoFlush(oopts.auto_flush);
+    }
+#ifdef R__USE_IMT
+    tree->SetImplicitMT(oopts.imt_threads > 0);
+#endif
 }
 
 // read raw data in evio format, and extract information
 void write_raw_data(const std::string &dpath, const std::string &opath, const std::string &mpath, int nev,
-        int nskip, int res, double thres, int npeds, double flat, int usefixedped)
+        int nskip, int res, double thres, int npeds, double flat, int usefixedped, int nthreads, int zerocopy, int use_index, int trigger,
+        const OutputOptions &oopts)
 {
     // read modules
     auto modules = read_modules(mpath);
@@ -430,12 +933,25 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
     }
 
     // raw data
-    evc::EvChannel evchan;
+    std::unique_ptr<evc::EvChannel> evchan_ptr((zerocopy || use_index) ? new evc::EvMappedChannel() : new evc::EvChannel());
+    auto &evchan = *evchan_ptr;
     if (evchan.Open(dpath) != evc::status::success) {
         std::cout << "Cannot open evchannel at " << dpath << std::endl;
         return;
     }
 
+    // event index
+    evc::EvIndex index;
+    if (use_index && index.LoadOrBuild(dpath) != evc::status::success) {
+        std::cout << "Cannot load or build the event index for " << dpath << std::endl;
+        return;
+    }
+    if (trigger >= 0 && !use_index) {
+        std::cout << "Warning: selecting trigger type " << trigger << " requires the event index (-i), "
+                  << "all events will be replayed." << std::endl;
+    }
+    EventCursor cursor(evchan, use_index ? &index : nullptr, trigger);
+
     // get banks
     std::vector<uint32_t> dbanks;
     for (auto &m : modules) {
@@ -443,41 +959,34 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
             dbanks.push_back(m.bank);
         }
     }
-    // waveform analyzer
-    fdec::Analyzer analyzer(res, thres, npeds, flat);
-
+    // the module addresses are fixed, precompile the bank lookup
+    evchan.CompileLookup(module_addresses(modules));
 #ifdef USE_OLD_GEM_TRACKING
     EventWrapper evio_event_wrapper;
-#else
-    // gem analyzer
-    GEMSystem gem_system;
-    gem_system.Configure("config/gem.conf");
-    gem_system.ReadPedestalFile();
-    tracking_dev::TrackingDataHandler *tracking_data_handler = new tracking_dev::TrackingDataHandler();
-    tracking_data_handler -> Init();
-    tracking_data_handler -> SetGEMSystem(&gem_system);
-    tracking_data_handler -> SetupDetector();
-    tracking_dev::Tracking *new_tracking = tracking_data_handler -> GetTrackingHandle();
-#endif
-
-    // decoders
-    fdec::Fadc250Decoder fdecoder;
-    ssp::SSPDecoder sdecoder;
-
-#ifdef USE_OLD_GEM_TRACKING
     HCTracking *tracking = new HCTracking();
     tracking->LoadConfig(TDatime("2022-11-03 16:35:00"));
     tracking->CompleteInitialization();
     tracking -> Begin(9999);
-#else
-    MPDSSPRawEventDecoder gem_decoder;
 #endif
 
     // epics system
     EPICSystem epic_sys("config/epics_map.txt");
 
     // output
+    // implicit multi-threading, the baskets are compressed in parallel when the trees are flushed
+    if (oopts.imt_threads > 0) {
+#ifdef R__USE_IMT
+        ROOT::EnableImplicitMT(oopts.imt_threads);
+#else
+        std::cout << "Warning: ROOT is built without implicit multi-threading, baskets are compressed serially." << std::endl;
+#endif
+    }
+
+    // output, the branches take the compression setting of the file
     auto *hfile = new TFile(opath.c_str(), "RECREATE", "MAPMT test results");
+    if (oopts.compress >= 0) {
+        hfile->SetCompressionSettings(oopts.compress);
+    }
     auto tree = create_tree(modules);
 #ifdef USE_OLD_GEM_TRACKING
     tracking -> InitTrackingResultTree(tree);
@@ -489,14 +998,70 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
     tree -> Branch("trigger_time", &TriggerTime, "trigger_time/l");
 
     auto epics_tree = create_epics_tree(&epic_sys);
+    setup_output_tree(tree, oopts);
+    setup_output_tree(epics_tree, oopts);
+
+    // the async writer still needs one worker, and the pool is sized by the workers
+    nthreads = std::max(nthreads, 1);
+
+#ifndef USE_OLD_GEM_TRACKING
+    // the pipeline fills the trees in its own writer thread, the events are decoded by the workers
+    if (nthreads > 1 || oopts.async) {
+        replay_pipeline(evchan, cursor, modules, dbanks, nev, nskip, res, thres, npeds, flat, dbFADCPed, usefixedped,
+                &epic_sys, tree, epics_tree, TriggerType, TriggerTime, nthreads);
+        evchan.Close();
+        hfile->Write();
+        hfile->Close();
+        return;
+    }
+#else
+    if (nthreads > 1 || oopts.async) {
+        std::cout << "Pipeline replay is not available with the old GEM tracking, process events serially." << std::endl;
+    }
+#endif
+
+    // waveform analyzer
+    fdec::Analyzer analyzer(res, thres, npeds, flat);
+    fdec::AnalyzerBuffers ana_buffers;
+
+#ifndef USE_OLD_GEM_TRACKING
+    // gem analyzer
+    GEMSystem gem_system;
+    gem_system.Configure("config/gem.conf");
+    gem_system.ReadPedestalFile();
+    tracking_dev::TrackingDataHandler *tracking_data_handler = new tracking_dev::TrackingDataHandler();
+    tracking_data_handler -> Init();
+    tracking_data_handler -> SetGEMSystem(&gem_system);
+    tracking_data_handler -> SetupDetector();
+    tracking_dev::Tracking *new_tracking = tracking_data_handler -> GetTrackingHandle();
+#endif
+
+    // decoders
+    fdec::Fadc250Decoder fdecoder;
+    ssp::SSPDecoder sdecoder;
+
+#ifndef USE_OLD_GEM_TRACKING
+    MPDSSPRawEventDecoder gem_decoder;
+    gem_decoder.SetAPVList(gem_system.GetAPVAddressList());
+#endif
+
     auto time_1 = std::chrono::steady_clock::now();
     auto time_2 = std::chrono::steady_clock::now();
 
     int count = 0;
     if(nskip>0) nev += nskip;
     auto &ref = modules.front();
-    while ((evchan.Read() == evc::status::success) && (nev-- != 0)) {
-        if(count>0 && count<nskip)  {count++;continue;} //keep the first prestart event for absolute trigger time
+    while (cursor.Read() && (nev-- != 0)) {
+        //keep the first prestart event for absolute trigger time
+        if(count>0 && count<nskip) {
+            // skip the rest at once, within the number of events to be read
+            int n = nskip - count - 1;
+            int nread = cursor.Skip((nev >= 0 && nev < n) ? nev : n);
+            nev -= nread;
+            count += nread + 1;
+            if (nev == 0) break;
+            continue;
+        }
         if(nskip>0 && count==nskip) {
             std::cout << "First " << nskip <<" events were skipped." << std::endl;
         }
@@ -526,7 +1091,8 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
 
         evchan.ScanBanks(dbanks);
         // get block level
-        int blvl = evchan.GetEvBuffer(ref.crate, ref.bank, ref.slot).size();
+        auto ref_buf = evchan.TryGetEvBuffer(ref.crate, ref.bank, ref.slot);
+        int blvl = ref_buf ? ref_buf->size() : 0;
         uint16_t event_type = evchan.GetEventType();
         TriggerType = (int)(event_type);
         TriggerTime = evchan.GetTriggerTime();
@@ -538,10 +1104,10 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
             // parse module data
             for (auto &mod : modules) {
                 // get data buffer
-                try {
-                    dbuf = evchan.GetEvBuffer(mod.crate, mod.bank, mod.slot, ii, buflen);
-                } catch (std::exception &e) {
-                    std::cout << "warning: " << e.what() << "\n";
+                dbuf = evchan.TryGetEvBuffer(mod.crate, mod.bank, mod.slot, ii, buflen);
+                if (!dbuf) {
+                    std::cout << "warning: No data found for ROC " << mod.crate << ", bank " << mod.bank
+                              << ", slot " << mod.slot << ", block_level " << ii << "\n";
                     continue;
                 }
                 // decode by module type
@@ -565,15 +1131,14 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
 
                                 //std::cout<<"event = "<<count<<",  imod = "<<imod<<",  FADCPed["<<idx<<"] = "<<fixedPed<<", fixedPedErr="<<fixedPedErr<<std::endl;
                                 idx++;
-                                analyzer.Analyze(ch,fixedPed,fixedPedErr);
+                                analyzer.Analyze(ch,ana_buffers,fixedPed,fixedPedErr);
                             }
                         }
                         break;
                     case kSSP:
                         {
 #ifdef USE_OLD_GEM_TRACKING
-                            auto raw_vec = evchan.GetRawBufferVec();
-                            evio_event_wrapper.LoadEvent(raw_vec.data(), raw_vec.size());
+                            evio_event_wrapper.LoadEvent(evchan.GetRawBuffer(), evchan.GetRawBufferSize());
                             tracking->Decode(evio_event_wrapper);
                             tracking -> find_tracks();
 #else
@@ -155,13 +155,9 @@ TTree *create_tree(std::vector<Module> &modules, const std::string tname = "EvTr
 // do gem clustering
 void extract_gem_cluster(GEMSystem *gem_sys, MPDSSPRawEventDecoder *gem_decoder, GEMTreeStruct &gem_data, int evtNum)
 {
-    auto &decoded_data = gem_decoder -> GetAPV();
-    auto &decoded_data_flags = gem_decoder -> GetAPVDataFlags();
-
     EventData event_data;
-    for(auto &i: decoded_data){
-        gem_sys -> FillRawDataMPD(i.first, i.second, decoded_data_flags.at(i.first), event_data);
-    }
+    // the online common modes are not used here
+    gem_sys -> FillRawDataMPD(*gem_decoder, event_data, false);
 
     gem_sys -> Reconstruct(event_data);
 
@@ -209,7 +205,7 @@ void extract_gem_cluster(GEMSystem *gem_sys, MPDSSPRawEventDecoder *gem_decoder,
                 gem_data.Pos[icluster] = c.position;
 
                 // strips in this cluster
-                const std::vector<StripHit> &hits = c.hits;
+                const auto &hits = c.hits;
                 for(size_t nS = 0; nS < hits.size() && nS < MAXCLUSTERSIZE; ++nS)
                 {
                     // layer based strip no
@@ -248,40 +244,28 @@ void extract_gem_cluster(GEMSystem *gem_sys, MPDSSPRawEventDecoder *gem_decoder,
 #endif
 
 // create an epics tree
+// the channel branches are bound to the epics system values (by channel id), they are updated in place by
+// FillRawData, so the epics map should not be changed after the tree is created
 TTree* create_epics_tree(EPICSystem *epic_sys, const std::string tname = "EpicsTree", const std::string name = "epics tree")
 {
     auto tree = new TTree(tname.c_str(), name.c_str());
 
-    epics_struct::EPICStruct *epic_dat = new epics_struct::EPICStruct();
-
-    auto & e_map = epic_sys -> GetEpicsMap();
-    for(auto &i: e_map) {
-        (epic_dat->data)[i.first] = -999999.9;
-    }
-
-    epics_struct::__g_epic_data = static_cast<epics_struct::EPICStruct*>(epic_dat);
+    epics_struct::__g_epic_data = new epics_struct::EPICStruct();
 
     std::string sname = "Epics_";
     tree -> Branch((sname + "event_number").c_str(), &epics_struct::__g_epic_data->event_number, "eventNo/I");
     tree -> Branch((sname + "timestamp").c_str(), &epics_struct::__g_epic_data->timestamp);
-    for(auto &entry: epics_struct::__g_epic_data->data)
+
+    float *values = epic_sys -> GetValueBuffer();
+    for(auto &ch: epic_sys -> GetSortedList())
     {
-        std::string branch_name = sname + entry.first;
+        std::string branch_name = sname + ch.name;
 
         // branch name does not allow "." and ":", which is in CODA epics name
-        size_t dot_pos = branch_name.find(".");
-        while(dot_pos != std::string::npos) {
-            branch_name = branch_name.replace(dot_pos, 1, "_");
-            dot_pos = branch_name.find(".");
-        }
+        std::replace(branch_name.begin(), branch_name.end(), '.', '_');
+        std::replace(branch_name.begin(), branch_name.end(), ':', '_');
 
-        dot_pos = branch_name.find(":");
-        while(dot_pos != std::string::npos){
-            branch_name = branch_name.replace(dot_pos, 1, "_");
-            dot_pos = branch_name.find(":");
-        }
-
-        tree -> Branch(branch_name.c_str(), &entry.second, Form("%s/F", branch_name.c_str()));
+        tree -> Branch(branch_name.c_str(), &values[ch.id], Form("%s/F", branch_name.c_str()));
     }
     return tree;
 }
@@ -289,23 +273,13 @@ TTree* create_epics_tree(EPICSystem *epic_sys, const std::string tname = "EpicsT
 // analyze event and fill epics tree
 void fill_epics_event(const uint32_t *buf, EPICSystem* epic_sys, const int event_number, TTree *T)
 {
-    // skip top level bank header information
-    auto evh = evc::BankHeader(&buf[0] + 2);
-    size_t len = evc::BankHeader::size();
-
-    // skip epics bank header information
+    // skip top level bank header and epics bank header information
+    // the channel values are parsed into the branch buffers
     epic_sys -> FillRawData( (const char*)(&buf[0] + 4) );
 
-    // fill epics event data
-
     epics_struct::__g_epic_data -> event_number = event_number;
     epics_struct::__g_epic_data -> timestamp = epic_sys -> GetCurrentTimeStamp();
 
-    for(auto &i: epics_struct::__g_epic_data -> data)
-    {
-        i.second = epic_sys -> GetEpicsValueByName(i.first);
-    }
-
     T -> Fill();
 }
 
@@ -346,8 +320,11 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
             dbanks.push_back(m.bank);
         }
     }
+    // the module addresses are fixed, precompile the bank lookup
+    evchan.CompileLookup(module_addresses(modules));
     // waveform analyzer
     fdec::Analyzer analyzer(res, thres, npeds, flat);
+    fdec::AnalyzerBuffers ana_buffers;
 
 #ifdef USE_GEM_TRACKING
     EventWrapper evio_event_wrapper;
@@ -369,6 +346,7 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
     tracking -> Begin(9999);
 #else
     MPDSSPRawEventDecoder gem_decoder;
+    gem_decoder.SetAPVList(gem_system.GetAPVAddressList());
 #endif
 
     // epics system
@@ -420,7 +398,8 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
 
         evchan.ScanBanks(dbanks);
         // get block level
-        int blvl = evchan.GetEvBuffer(ref.crate, ref.bank, ref.slot).size();
+        auto ref_buf = evchan.TryGetEvBuffer(ref.crate, ref.bank, ref.slot);
+        int blvl = ref_buf ? ref_buf->size() : 0;
         uint16_t event_type = evchan.GetEventType();
         TriggerType = (int)(event_type);
 
@@ -431,10 +410,10 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
             // parse module data
             for (auto &mod : modules) {
                 // get data buffer
-                try {
-                    dbuf = evchan.GetEvBuffer(mod.crate, mod.bank, mod.slot, ii, buflen);
-                } catch (std::exception &e) {
-                    std::cout << "warning: " << e.what() << "\n";
+                dbuf = evchan.TryGetEvBuffer(mod.crate, mod.bank, mod.slot, ii, buflen);
+                if (!dbuf) {
+                    std::cout << "warning: No data found for ROC " << mod.crate << ", bank " << mod.bank
+                              << ", slot " << mod.slot << ", block_level " << ii << "\n";
                     continue;
                 }
                 // decode by module type
@@ -458,7 +437,7 @@ void write_raw_data(const std::string &dpath, const std::string &opath, const st
 
                             //std::cout<<"event = "<<count<<",  imod = "<<imod<<",  FADCPed["<<idx<<"] = "<<fixedPed<<", fixedPedErr="<<fixedPedErr<<std::endl;
                             idx++;
-                            analyzer.Analyze(ch,fixedPed,fixedPedErr);
+                            analyzer.Analyze(ch,ana_buffers,fixedPed,fixedPedErr);
                         }
                     }
                     break;
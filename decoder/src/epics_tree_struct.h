@@ -1,7 +1,6 @@
 #ifndef EPICS_TREE_STRUCT_H
 #define EPICS_TREE_STRUCT_H
 
-#include <unordered_map>
 #include <string>
 
 namespace epics_struct {
@@ -10,12 +9,11 @@ struct EPICStruct
 {
     int event_number;
     std::string timestamp;
-    std::unordered_map<std::string, float> data;
+    // the channel values are in EPICSystem::GetValueBuffer()
 
     EPICStruct() :
         event_number(0), timestamp("")
     {
-        data.clear();
     }
 };
 
@@ -0,0 +1,112 @@
+#pragma once
+
+//
+// Building blocks for the multi-threaded replay in analyze.cpp
+//   reader --> WorkQueue --> N workers --> OrderedOutput --> writer
+//                 ^                                            |
+//                 +-------------- free event pool <------------+
+// The event pool is preallocated, so the number of events in flight (and the memory) is bounded,
+// and the ring in OrderedOutput can never be overrun.
+//
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+
+// a blocking fifo with a fixed capacity
+template<class T>
+class BoundedQueue
+{
+public:
+    BoundedQueue(size_t cap) : capacity(cap), closed(false) {}
+
+    // blocks while the queue is full
+    void Push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        not_full.wait(lock, [this] { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+    }
+
+    // blocks while the queue is empty, returns false once the queue is closed and drained
+    bool Pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        not_empty.wait(lock, [this] { return !items.empty() || closed; });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // no more items will be pushed
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        not_empty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    bool closed;
+    std::deque<T> items;
+    std::mutex mtx;
+    std::condition_variable not_empty, not_full;
+};
+
+
+// re-establish the reading order of events that were processed out of order
+// T must provide a uint64_t member "seq", numbered consecutively from 0 by the reader
+// the ring must be at least as large as the number of events that can be in flight
+template<class T>
+class OrderedOutput
+{
+public:
+    OrderedOutput(size_t nslots) : ring(nslots, nullptr), next(0), end(UINT64_MAX) {}
+
+    void Put(T *item)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ring[item->seq % ring.size()] = item;
+        if (item->seq == next) {
+            ready.notify_one();
+        }
+    }
+
+    // total number of events, set by the reader when it reaches the end of input
+    void SetEnd(uint64_t nevents)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        end = nevents;
+        ready.notify_one();
+    }
+
+    // blocks until the next event in order is available, returns false after the last one
+    bool Next(T *&item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        auto &slot = ring[next % ring.size()];
+        ready.wait(lock, [&] { return next >= end || (slot && slot->seq == next); });
+        if (next >= end) {
+            return false;
+        }
+        item = slot;
+        slot = nullptr;
+        next++;
+        return true;
+    }
+
+private:
+    std::vector<T*> ring;
+    uint64_t next, end;
+    std::mutex mtx;
+    std::condition_variable ready;
+};
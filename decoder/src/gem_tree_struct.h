@@ -6,6 +6,8 @@
  */
 
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
 #include <iostream>
 #include <iomanip>
 
@@ -111,6 +113,42 @@ struct GEMTreeStruct
             apv_adc_ch.resize(MAXAPV, DEF_VAL);
     }
 
+    // exchange event contents with another struct
+    // the fixed-size arrays are exchanged element-wise, their storage must stay
+    // in place since the tree branches are bound to &Plane[0], &Prod[0], ...
+    void Swap(GEMTreeStruct &o)
+    {
+        auto swap_array = [](auto &a, auto &b) { std::swap_ranges(a.begin(), a.end(), b.begin()); };
+
+        std::swap(event_number, o.event_number);
+        std::swap(nCluster, o.nCluster);
+        swap_array(Plane, o.Plane), swap_array(Prod, o.Prod), swap_array(Module, o.Module),
+            swap_array(Axis, o.Axis), swap_array(Size, o.Size), swap_array(Adc, o.Adc),
+            swap_array(Pos, o.Pos);
+
+        StripNo.swap(o.StripNo), StripAdc.swap(o.StripAdc);
+        StripTs0.swap(o.StripTs0), StripTs1.swap(o.StripTs1), StripTs2.swap(o.StripTs2),
+            StripTs3.swap(o.StripTs3), StripTs4.swap(o.StripTs4), StripTs5.swap(o.StripTs5);
+
+        std::swap(besttrack, o.besttrack);
+        std::swap(fNtracks_found, o.fNtracks_found);
+        fNhitsOnTrack.swap(o.fNhitsOnTrack);
+        fXtrack.swap(o.fXtrack), fYtrack.swap(o.fYtrack);
+        fXptrack.swap(o.fXptrack), fYptrack.swap(o.fYptrack), fChi2Track.swap(o.fChi2Track);
+        std::swap(ngoodhits, o.ngoodhits);
+        fHitXlocal.swap(o.fHitXlocal), fHitYlocal.swap(o.fHitYlocal), fHitZlocal.swap(o.fHitZlocal);
+        hit_track_index.swap(o.hit_track_index), fHitModule.swap(o.fHitModule);
+        fHitLayer.swap(o.fHitLayer);
+        fHitXprojected.swap(o.fHitXprojected), fHitYprojected.swap(o.fHitYprojected);
+        fHitResidU.swap(o.fHitResidU), fHitResidV.swap(o.fHitResidV);
+        fHitUADC.swap(o.fHitUADC), fHitVADC.swap(o.fHitVADC);
+        fHitIsampMaxUstrip.swap(o.fHitIsampMaxUstrip), fHitIsampMaxVstrip.swap(o.fHitIsampMaxVstrip);
+
+        std::swap(nAPV, o.nAPV);
+        swap_array(apv_crate_id, o.apv_crate_id), swap_array(apv_mpd_id, o.apv_mpd_id),
+            swap_array(apv_adc_ch, o.apv_adc_ch);
+    }
+
     // get strip no. array for a given cluster
     vector<int> GetStripNoArrayForCluster(int i)
     {
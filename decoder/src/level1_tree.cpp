@@ -0,0 +1,1154 @@
+/*  Create the level1 tree "T" from a level0 replay file (EvTree), the compiled version of ReadEvTree::Loop in
+ *  CreateLevel1Tree/ReadEvTree_*.C
+ *  The channel layout, the peak windows of the trigger bits and the variant behavior (copied tracking branches, Ecal
+ *  channels, GEM plane ids, ...) are read from a json file, the files in database/level1 reproduce the tracking,
+ *  highrate, cosmic4 and old_tracking macros
+ *  Only the needed EvTree branches are read, the entries are processed in blocks by the worker threads (each one has
+ *  its own reader of the input file), and the writer fills the output tree in the entry order
+ *  The pedestals and the peak positions are read from FADCPedestal.txt and FADCPeak.txt as GetPedNPeakPos, and the
+ *  EpicsTree entries within the event number range of the processed entries are copied with the selected branches
+ */
+
+#include "ConfigArgs.h"
+#include "Fadc250Data.h"
+#include "ReadDatabase.h"
+#include "event_pipeline.h"
+#include "nlohmann/json.hpp"
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TClass.h"
+#include "TROOT.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define FADC_NCH 16
+#define FADC_SATURATION 4095
+#define N_TRIGGER_BITS 6
+// GEM layout of the macros (GEM_Cluster_Matching.C), the chamber index is the GEM_moduleID and the axis is x/y
+#define N_CHAMBERS_PER_LAYER 2
+#define MIN_CLUSTER_BUFFER 2000
+
+using namespace std::chrono;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// configuration
+
+// slot7 channels summed to a branch (CerASum, ...)
+struct SumGroup
+{
+    std::string name;
+    std::vector<int> channels;
+};
+
+// a level1 GEM plane, filled with the 2D hits of gem_id = layer*10 + chamber
+struct GEMPlaneConfig
+{
+    std::string name;
+    int gem_id;
+};
+
+struct Level1Config
+{
+    // EvTree branches of the FADC channels
+    std::string slot7[FADC_NCH], slot8[FADC_NCH];
+    // slot8 channels analyzed and written as branches
+    std::vector<int> slot8_outputs;
+    // peak search window (samples) around the peak position of the trigger bit
+    double slot7_window[N_TRIGGER_BITS], slot8_window[N_TRIGGER_BITS];
+    std::vector<SumGroup> cer_sums;
+    std::string cer_total;
+    float cer_nch_threshold;
+    // slot8 channels of the Ecal cluster
+    int presh_l, presh_r, presh_t, shower_l, shower_r, shower_t;
+    std::vector<GEMPlaneConfig> gem_planes;
+    int gem_min_clusters, gem_max_hits;
+    // the LEVEL1_Tree_DEBUG branches
+    bool debug_branches;
+    std::vector<std::string> copy_branches, epics_branches;
+
+    bool Load(const std::string &path);
+};
+
+template<typename T, size_t N>
+static bool read_array(const nlohmann::json &j, const std::string &key, T (&arr)[N])
+{
+    if (!j.contains(key) || !j[key].is_array() || (j[key].size() != N)) {
+        std::cerr << "Level1 config: \"" << key << "\" must be an array of " << N << " elements." << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < N; ++i) {
+        arr[i] = j[key][i].get<T>();
+    }
+    return true;
+}
+
+static bool valid_channel(int ch, const std::string &key)
+{
+    if ((ch < 0) || (ch >= FADC_NCH)) {
+        std::cerr << "Level1 config: channel " << ch << " of \"" << key << "\" is out of range." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Level1Config::Load(const std::string &path)
+{
+    std::ifstream inf(path);
+    if (!inf.is_open()) {
+        std::cerr << "Cannot open level1 config " << path << std::endl;
+        return false;
+    }
+
+    nlohmann::json j;
+    try {
+        inf >> j;
+        if (!read_array(j, "slot7", slot7) || !read_array(j, "slot8", slot8) ||
+            !read_array(j["peak_window"], "slot7", slot7_window) ||
+            !read_array(j["peak_window"], "slot8", slot8_window)) {
+            return false;
+        }
+
+        slot8_outputs = j["slot8_outputs"].get<std::vector<int>>();
+        for (auto ch : slot8_outputs) {
+            if (!valid_channel(ch, "slot8_outputs")) {
+                return false;
+            }
+        }
+
+        cer_sums.clear();
+        for (auto &g : j["cer_sums"]) {
+            cer_sums.push_back(SumGroup{g["name"].get<std::string>(), g["channels"].get<std::vector<int>>()});
+            for (auto ch : cer_sums.back().channels) {
+                if (!valid_channel(ch, "cer_sums")) {
+                    return false;
+                }
+            }
+        }
+        cer_total = j["cer_total"].get<std::string>();
+        cer_nch_threshold = j["cer_nch_threshold"].get<float>();
+
+        auto &ecal = j["ecal"];
+        presh_l = ecal["PreSh_l"].get<int>();
+        presh_r = ecal["PreSh_r"].get<int>();
+        presh_t = ecal["PreSh_t"].get<int>();
+        shower_l = ecal["Shower_l"].get<int>();
+        shower_r = ecal["Shower_r"].get<int>();
+        shower_t = ecal["Shower_t"].get<int>();
+        for (auto ch : {presh_l, presh_r, presh_t, shower_l, shower_r, shower_t}) {
+            if (!valid_channel(ch, "ecal")) {
+                return false;
+            }
+        }
+
+        gem_planes.clear();
+        for (auto &p : j["gem_planes"]) {
+            gem_planes.push_back(GEMPlaneConfig{p["name"].get<std::string>(), p["id"].get<int>()});
+        }
+        gem_min_clusters = j.value("gem_min_clusters", 2);
+        gem_max_hits = j.value("gem_max_hits", 2000);
+        debug_branches = j.value("debug_branches", false);
+        copy_branches = j.value("copy_branches", std::vector<std::string>());
+        epics_branches = j.value("epics_branches", std::vector<std::string>());
+    } catch (std::exception &e) {
+        std::cerr << "Failed to read level1 config " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// pedestals and peak positions of the trigger bits from the database, as GetPedNPeakPos in the macros
+struct Calibration
+{
+    double ped7[FADC_NCH], ped8[FADC_NCH];
+    double peak7[N_TRIGGER_BITS][FADC_NCH], peak8[N_TRIGGER_BITS][FADC_NCH];
+
+    bool Load(int run)
+    {
+        std::fill_n(ped7, FADC_NCH, 0.);
+        std::fill_n(ped8, FADC_NCH, 0.);
+        db::dbBlock *ped = db::FindBlock("FADCPedestal", run);
+        if (ped && (ped->Data.size() >= 2*FADC_NCH)) {
+            for (int i = 0; i < FADC_NCH; ++i) {
+                ped7[i] = ped->Data[i];
+                ped8[i] = ped->Data[FADC_NCH + i];
+            }
+        } else {
+            std::cout << "Warning: no FADC pedestals for run " << run << ", use 0." << std::endl;
+        }
+
+        db::dbBlock *peak = db::FindBlock("FADCPeakPos", run);
+        if (!peak || (peak->Data.size() < 2*N_TRIGGER_BITS*FADC_NCH)) {
+            std::cerr << "No FADC peak positions for run " << run << " in the database." << std::endl;
+            return false;
+        }
+        for (int i = 0; i < N_TRIGGER_BITS; ++i) {
+            for (int j = 0; j < FADC_NCH; ++j) {
+                peak7[i][j] = peak->Data[FADC_NCH*i + j];
+                peak8[i][j] = peak->Data[N_TRIGGER_BITS*FADC_NCH + FADC_NCH*i + j];
+            }
+        }
+        return true;
+    }
+};
+
+// run number from the level0 file name, "../ROOTFILE/beamtest_hallc_3032_1.root" -> 3032 (ReadEvTree::GetRunNumber)
+int get_run_number(const std::string &path)
+{
+    std::string file0 = path.substr(path.find_last_of("/\\") + 1);
+    std::string file1 = file0.substr(0, file0.find_last_of("."));
+    auto found = file1.find("_debug");
+    if (found != std::string::npos) {
+        file1 = file1.substr(0, found);
+    }
+
+    // remove all the letters
+    std::string file;
+    for (auto c : file1) {
+        if (!(c >= 'a' && c <= 'z') && !(c >= 'A' && c <= 'Z')) {
+            file.append(1, c);
+        }
+    }
+
+    found = file.find_last_of("_");
+    std::string file2 = file.substr(0, found);
+    std::string fileN = file.substr(found + 1);
+    if (file2.length() >= 4) {
+        fileN = file2.substr(file2.find_last_of("_") + 1);
+    }
+    return fileN.empty() ? 0 : std::atoi(fileN.c_str());
+}
+
+// "_hallc" -> "_level1" or ".root" -> "_level1.root" in the same directory
+std::string level1_path(const std::string &path)
+{
+    auto pos = path.find_last_of("/\\");
+    std::string dir = (pos == std::string::npos) ? "" : path.substr(0, pos + 1);
+    std::string file = path.substr(dir.size());
+
+    auto replace_all = [] (std::string &str, const std::string &from, const std::string &to) {
+        for (auto p = str.find(from); p != std::string::npos; p = str.find(from, p + to.size())) {
+            str.replace(p, from.size(), to);
+        }
+    };
+    if (file.find("_hallc") != std::string::npos) {
+        replace_all(file, "_hallc", "_level1");
+    } else {
+        replace_all(file, ".root", "_level1.root");
+    }
+    return dir + file;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// level1 quantities
+
+// level1 values of the 16 channels of a FADC slot
+struct SlotResult
+{
+    float adc[FADC_NCH], integral0[FADC_NCH];
+    int pos[FADC_NCH], height[FADC_NCH], left[FADC_NCH], right[FADC_NCH];
+
+    void Reset()
+    {
+        std::fill_n(adc, FADC_NCH, 0.f);
+        std::fill_n(integral0, FADC_NCH, 0.f);
+        std::fill_n(pos, FADC_NCH, 0);
+        std::fill_n(height, FADC_NCH, 0);
+        std::fill_n(left, FADC_NCH, 0);
+        std::fill_n(right, FADC_NCH, 0);
+    }
+};
+
+// find the first peak within the window around the peak position of the trigger bit, and integrate the pedestal
+// subtracted samples between its left and right, -100 for a saturated pulse
+// returns false if there is no such peak, the channel is left as reset
+static bool analyze_channel(const fdec::Fadc250Data &data, double ped, double peak_pos, double window,
+                            SlotResult &res, int ich)
+{
+    int idx = -1, pos = 0;
+    for (size_t ii = 0; ii < data.peaks.size(); ++ii) {
+        pos = static_cast<int>(data.peaks[ii].pos);
+        if (std::fabs(pos - peak_pos) <= window) {
+            idx = ii;
+            break;
+        }
+    }
+    if (idx < 0) {
+        return false;
+    }
+
+    auto &peak = data.peaks[idx];
+    auto &raw = data.raw;
+    int left = static_cast<int>(peak.left), right = static_cast<int>(peak.right);
+    // the samples beyond the waveform are not integrated
+    int last = std::min(right, static_cast<int>(raw.size()) - 1);
+    float adc_sum = 0.;
+    for (int iw = std::max(left, 0); iw <= last; ++iw) {
+        if (raw[iw] >= FADC_SATURATION) {
+            adc_sum = -100.;
+            break;
+        }
+        float adc = raw[iw] - ped;
+        if (adc < 0) {
+            adc = 0;
+        }
+        adc_sum += adc;
+    }
+
+    res.adc[ich] = adc_sum;
+    res.pos[ich] = pos;
+    res.height[ich] = (pos >= 0 && pos < static_cast<int>(raw.size())) ? static_cast<int>(static_cast<int>(raw[pos]) - ped) : 0;
+    res.left[ich] = left;
+    res.right[ich] = right;
+    res.integral0[ich] = peak.integral;
+    return true;
+}
+
+// center of gravity of the Shower and PreShower modules with logarithmic weighting (GravityWeight.h)
+// origin is the corner where all 3 modules contact, unit is cm
+static const double kLogWeightBase = 3.6;
+static const float kShowerX[3] = {-5.28, 0.00, 5.28}, kShowerY[3] = {-3.05, 6.10, -3.05}, kShowerZ[3] = {3, 3, 3};
+static const float kPreShX[3] = {0.00, -5.28, 5.28}, kPreShY[3] = {6.10, -3.05, -3.05}, kPreShZ[3] = {0, 0, 0};
+
+struct EcalCluster
+{
+    float shower_sum, shower_x, shower_y, shower_z;
+    float presh_sum, presh_x, presh_y, presh_z;
+
+    // the weights of both clusters are normalized by the Shower sum, as in GravityWeight.h
+    static void weighted_center(const float adc[3], float norm, const float *cx, const float *cy, const float *cz,
+                                float &x, float &y, float &z)
+    {
+        float tw = 0., sx = 0., sy = 0., sz = 0.;
+        for (int i = 0; i < 3; ++i) {
+            // suppress low energy contributions
+            float w = std::max(0., kLogWeightBase + std::log(adc[i]/norm));
+            tw += w;
+            sx += cx[i]*w;
+            sy += cy[i]*w;
+            sz += cz[i]*w;
+        }
+        x = sx/tw;
+        y = sy/tw;
+        z = sz/tw;
+    }
+
+    void DoWeighting(float presh_l, float presh_r, float presh_t, float shower_l, float shower_r, float shower_t)
+    {
+        float shower[3] = {shower_l, shower_t, shower_r};
+        shower_sum = shower[0] + shower[1] + shower[2];
+        weighted_center(shower, shower_sum, kShowerX, kShowerY, kShowerZ, shower_x, shower_y, shower_z);
+
+        float presh[3] = {presh_t, presh_l, presh_r};
+        presh_sum = presh[0] + presh[1] + presh[2];
+        weighted_center(presh, shower_sum, kPreShX, kPreShY, kPreShZ, presh_x, presh_y, presh_z);
+    }
+};
+
+struct GEMPlaneHits
+{
+    std::vector<float> x, y, x_adc, y_adc;
+
+    void Clear() { x.clear(), y.clear(), x_adc.clear(), y_adc.clear(); }
+};
+
+// the level1 values of one selected entry
+struct Level1Event
+{
+    int entry, event_number, trigger_type;
+    uint64_t trigger_time;
+    SlotResult slot7, slot8;
+    std::vector<float> cer_sums;
+    float cer_total;
+    int cer_nch;
+    EcalCluster ecal;
+    // the GEM planes are only updated with enough clusters, otherwise the writer keeps the previous hits (as the macros)
+    bool gem_updated;
+    std::vector<GEMPlaneHits> gem;
+    std::vector<std::vector<double>> copies;
+};
+
+// a block of consecutive entries, the unit of work of the threads
+struct EntryBlock
+{
+    uint64_t seq;
+    Long64_t begin, end;
+    // the first nevents in events are the selected entries of this block
+    size_t nevents = 0;
+    std::vector<Level1Event> events;
+    long read_errors = 0, unknown_gem_hits = 0, bad_gem_clusters = 0;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// branches copied as they are
+
+// a scalar or a std::vector of int, float or double
+struct CopyBranch
+{
+    std::string name;
+    char type;
+    bool vec;
+};
+
+// find the type of the branch, returns false if it is not available or not supported
+static bool copy_branch_type(TTree *tree, const std::string &name, CopyBranch &cb)
+{
+    auto br = tree->GetBranch(name.c_str());
+    if (!br) {
+        return false;
+    }
+
+    TClass *cl = nullptr;
+    EDataType dt = kNoType_t;
+    if (br->GetExpectedType(cl, dt) != 0) {
+        return false;
+    }
+    cb.name = name;
+    if (cl) {
+        std::string cname = cl->GetName();
+        cb.vec = true;
+        if (cname == "vector<int>") {
+            cb.type = 'I';
+        } else if (cname == "vector<float>") {
+            cb.type = 'F';
+        } else if (cname == "vector<double>") {
+            cb.type = 'D';
+        } else {
+            std::cout << "Warning: branch " << name << " of " << cname << " is not supported, skip it." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    cb.vec = false;
+    switch (dt) {
+    case kInt_t: cb.type = 'I'; return true;
+    case kFloat_t: cb.type = 'F'; return true;
+    case kDouble_t: cb.type = 'D'; return true;
+    default:
+        std::cout << "Warning: branch " << name << " of data type " << dt << " is not supported, skip it." << std::endl;
+        return false;
+    }
+}
+
+// reading or writing buffer of a copied branch, the values are passed between them as doubles (exact for int32,
+// float and double)
+struct CopyBuffer
+{
+    int i = 0;
+    float f = 0.;
+    double d = 0.;
+    std::vector<int> vi;
+    std::vector<float> vf;
+    std::vector<double> vd;
+    std::vector<int> *pvi = &vi;
+    std::vector<float> *pvf = &vf;
+    std::vector<double> *pvd = &vd;
+
+    void *Address(const CopyBranch &cb)
+    {
+        if (cb.vec) {
+            return (cb.type == 'I') ? (void*)&pvi : (cb.type == 'F') ? (void*)&pvf : (void*)&pvd;
+        }
+        return (cb.type == 'I') ? (void*)&i : (cb.type == 'F') ? (void*)&f : (void*)&d;
+    }
+
+    void Get(const CopyBranch &cb, std::vector<double> &vals) const
+    {
+        if (!cb.vec) {
+            vals.assign(1, (cb.type == 'I') ? i : (cb.type == 'F') ? f : d);
+        } else if (cb.type == 'I') {
+            vals.assign(vi.begin(), vi.end());
+        } else if (cb.type == 'F') {
+            vals.assign(vf.begin(), vf.end());
+        } else {
+            vals.assign(vd.begin(), vd.end());
+        }
+    }
+
+    void Set(const CopyBranch &cb, const std::vector<double> &vals)
+    {
+        if (!cb.vec) {
+            double val = vals.empty() ? 0. : vals[0];
+            i = val, f = val, d = val;
+        } else if (cb.type == 'I') {
+            vi.assign(vals.begin(), vals.end());
+        } else if (cb.type == 'F') {
+            vf.assign(vals.begin(), vals.end());
+        } else {
+            vd.assign(vals.begin(), vals.end());
+        }
+    }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// worker, reads the needed EvTree branches and computes the level1 values of a block of entries
+
+struct GEMCluster
+{
+    float adc, pos;
+};
+
+// clusters of one chamber (gem_id = layer*10 + chamber) on the two axes
+struct ChamberClusters
+{
+    int gem_id;
+    std::vector<GEMCluster> axis[2];
+};
+
+class Level1Worker
+{
+public:
+    Level1Worker(const Level1Config &c, const Calibration &ca, const std::vector<CopyBranch> &cbs)
+        : cfg(c), cal(ca), copies(cbs)
+    {}
+
+    ~Level1Worker() { Close(); }
+
+    bool Open(const std::string &path, int max_clusters)
+    {
+        file = new TFile(path.c_str(), "READ");
+        if (!file || file->IsZombie() || !(tree = dynamic_cast<TTree*>(file->Get("EvTree")))) {
+            std::cerr << "Cannot read EvTree from " << path << std::endl;
+            return false;
+        }
+
+        // only the needed branches are read
+        tree->SetBranchStatus("*", 0);
+        bool ok = true;
+        auto connect = [&] (const std::string &name, void *addr) {
+            if (!tree->GetBranch(name.c_str())) {
+                std::cerr << "Cannot find branch " << name << " in EvTree" << std::endl;
+                ok = false;
+                return;
+            }
+            tree->SetBranchStatus(name.c_str(), 1);
+            tree->SetBranchAddress(name.c_str(), addr);
+        };
+
+        for (int i = 0; i < FADC_NCH; ++i) {
+            pdata7[i] = &data7[i];
+            pdata8[i] = &data8[i];
+            connect(cfg.slot7[i], &pdata7[i]);
+        }
+        for (auto ch : cfg.slot8_outputs) {
+            connect(cfg.slot8[ch], &pdata8[ch]);
+        }
+        connect("event_number", &event_number);
+        connect("trigger_type", &trigger_type);
+        connect("trigger_time", &trigger_time);
+
+        if (!cfg.gem_planes.empty()) {
+            size_t nbuf = std::max(max_clusters, MIN_CLUSTER_BUFFER);
+            gem_layer.resize(nbuf), gem_chamber.resize(nbuf), gem_axis.resize(nbuf);
+            gem_adc.resize(nbuf), gem_pos.resize(nbuf);
+            connect("GEM_nCluster", &gem_ncluster);
+            connect("GEM_planeID", gem_layer.data());
+            connect("GEM_moduleID", gem_chamber.data());
+            connect("GEM_axis", gem_axis.data());
+            connect("GEM_adc", gem_adc.data());
+            connect("GEM_pos", gem_pos.data());
+        }
+
+        for (auto &cb : copies) {
+            copy_bufs.emplace_back(new CopyBuffer);
+            connect(cb.name, copy_bufs.back()->Address(cb));
+        }
+        return ok;
+    }
+
+    void Close()
+    {
+        if (file) {
+            if (tree) {
+                tree->ResetBranchAddresses();
+            }
+            file->Close();
+            delete file;
+        }
+        file = nullptr;
+        tree = nullptr;
+    }
+
+    void Process(EntryBlock &blk)
+    {
+        blk.nevents = 0;
+        blk.read_errors = blk.unknown_gem_hits = blk.bad_gem_clusters = 0;
+        for (Long64_t entry = blk.begin; entry < blk.end; ++entry) {
+            if (blk.events.size() <= blk.nevents) {
+                blk.events.emplace_back();
+                auto &ev = blk.events.back();
+                ev.cer_sums.resize(cfg.cer_sums.size());
+                ev.gem.resize(cfg.gem_planes.size());
+                ev.copies.resize(copies.size());
+            }
+            if (ProcessEntry(entry, blk.events[blk.nevents], blk)) {
+                blk.nevents++;
+            }
+        }
+    }
+
+private:
+    // ReadEvTree::Loop for one entry, returns false if the entry is not selected
+    bool ProcessEntry(Long64_t entry, Level1Event &ev, EntryBlock &blk)
+    {
+        if (tree->GetEntry(entry) <= 0) {
+            blk.read_errors++;
+            return false;
+        }
+
+        if (trigger_type >= 127) {
+            return false;
+        }
+        // will be 1-6, always take the highest bit
+        int trigbit = 0;
+        for (int ib = N_TRIGGER_BITS - 1; ib >= 0; --ib) {
+            if (trigger_type & (1 << ib)) {
+                trigbit = ib + 1;
+                break;
+            }
+        }
+        if (!trigbit) {
+            return false;
+        }
+
+        ev.entry = entry;
+        ev.event_number = event_number;
+        ev.trigger_type = trigger_type;
+        ev.trigger_time = trigger_time;
+
+        ev.slot7.Reset();
+        ev.cer_nch = 0;
+        for (int ich = 0; ich < FADC_NCH; ++ich) {
+            if (analyze_channel(data7[ich], cal.ped7[ich], cal.peak7[trigbit - 1][ich],
+                                cfg.slot7_window[trigbit - 1], ev.slot7, ich) &&
+                (ev.slot7.adc[ich] > cfg.cer_nch_threshold)) {
+                ev.cer_nch++;
+            }
+        }
+        ev.cer_total = 0.;
+        for (size_t i = 0; i < cfg.cer_sums.size(); ++i) {
+            auto &chs = cfg.cer_sums[i].channels;
+            float sum = chs.empty() ? 0. : ev.slot7.adc[chs[0]];
+            for (size_t k = 1; k < chs.size(); ++k) {
+                sum += ev.slot7.adc[chs[k]];
+            }
+            ev.cer_sums[i] = sum;
+            ev.cer_total += sum;
+        }
+
+        ev.slot8.Reset();
+        for (auto ich : cfg.slot8_outputs) {
+            analyze_channel(data8[ich], cal.ped8[ich], cal.peak8[trigbit - 1][ich], cfg.slot8_window[trigbit - 1],
+                            ev.slot8, ich);
+        }
+
+        auto &adc8 = ev.slot8.adc;
+        ev.ecal.DoWeighting(adc8[cfg.presh_l], adc8[cfg.presh_r], adc8[cfg.presh_t],
+                            adc8[cfg.shower_l], adc8[cfg.shower_r], adc8[cfg.shower_t]);
+
+        ev.gem_updated = !cfg.gem_planes.empty() && (gem_ncluster >= cfg.gem_min_clusters);
+        if (ev.gem_updated) {
+            MatchGEM(ev, blk);
+        }
+
+        for (size_t i = 0; i < copies.size(); ++i) {
+            copy_bufs[i]->Get(copies[i], ev.copies[i]);
+        }
+        return true;
+    }
+
+    // pair the clusters of the two axes of a chamber in the descending order of their adc (GEM_Cluster_Matching.C)
+    void MatchGEM(Level1Event &ev, EntryBlock &blk)
+    {
+        for (auto &plane : ev.gem) {
+            plane.Clear();
+        }
+
+        nchambers = 0;
+        int ncluster = std::min(gem_ncluster, static_cast<int>(gem_adc.size()));
+        for (int i = 0; i < ncluster; ++i) {
+            int chamber = gem_chamber[i], axis = gem_axis[i];
+            if ((chamber < 0) || (chamber >= N_CHAMBERS_PER_LAYER) || (axis < 0) || (axis > 1)) {
+                blk.bad_gem_clusters++;
+                continue;
+            }
+            int gem_id = gem_layer[i]*10 + chamber;
+            size_t k = 0;
+            for (; (k < nchambers) && (chambers[k].gem_id != gem_id); ++k) {}
+            if (k == nchambers) {
+                if (chambers.size() <= nchambers) {
+                    chambers.emplace_back();
+                }
+                auto &ch = chambers[nchambers++];
+                ch.gem_id = gem_id;
+                ch.axis[0].clear();
+                ch.axis[1].clear();
+            }
+            chambers[k].axis[axis].push_back(GEMCluster{gem_adc[i], gem_pos[i]});
+        }
+
+        auto by_adc = [] (const GEMCluster &c1, const GEMCluster &c2) { return c1.adc > c2.adc; };
+        for (size_t k = 0; k < nchambers; ++k) {
+            auto &ch = chambers[k];
+            size_t nhits = std::min(ch.axis[0].size(), ch.axis[1].size());
+            if (!nhits) {
+                continue;
+            }
+            size_t ip = 0;
+            for (; (ip < cfg.gem_planes.size()) && (cfg.gem_planes[ip].gem_id != ch.gem_id); ++ip) {}
+            if (ip == cfg.gem_planes.size()) {
+                blk.unknown_gem_hits += nhits;
+                continue;
+            }
+
+            std::sort(ch.axis[0].begin(), ch.axis[0].end(), by_adc);
+            std::sort(ch.axis[1].begin(), ch.axis[1].end(), by_adc);
+            auto &plane = ev.gem[ip];
+            nhits = std::min(nhits, static_cast<size_t>(cfg.gem_max_hits));
+            for (size_t i = 0; i < nhits; ++i) {
+                plane.x.push_back(ch.axis[0][i].pos);
+                plane.y.push_back(ch.axis[1][i].pos);
+                plane.x_adc.push_back(ch.axis[0][i].adc);
+                plane.y_adc.push_back(ch.axis[1][i].adc);
+            }
+        }
+    }
+
+    const Level1Config &cfg;
+    const Calibration &cal;
+    const std::vector<CopyBranch> &copies;
+
+    TFile *file = nullptr;
+    TTree *tree = nullptr;
+
+    // EvTree buffers
+    fdec::Fadc250Data data7[FADC_NCH], data8[FADC_NCH];
+    fdec::Fadc250Data *pdata7[FADC_NCH], *pdata8[FADC_NCH];
+    int event_number = 0, trigger_type = 0, gem_ncluster = 0;
+    ULong64_t trigger_time = 0;
+    std::vector<int> gem_layer, gem_chamber, gem_axis;
+    std::vector<float> gem_adc, gem_pos;
+    std::vector<std::unique_ptr<CopyBuffer>> copy_bufs;
+
+    std::vector<ChamberClusters> chambers;
+    size_t nchambers = 0;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// writer, the branch buffers of the level1 tree
+
+struct Level1Output
+{
+    int event_number = 0, entry_num = 0, trig_type = 0, cer_nch = 0;
+    ULong64_t trigger_time = 0;
+    SlotResult slot7, slot8;
+    std::vector<float> cer_sums;
+    float cer_total = 0.;
+    EcalCluster ecal;
+    std::vector<int> gem_n;
+    std::vector<std::vector<float>> gem_x, gem_y, gem_x_adc, gem_y_adc;
+    std::vector<std::unique_ptr<CopyBuffer>> copy_bufs;
+
+    // the branches in the order of the macros
+    void Setup(TTree *T, const Level1Config &cfg, const std::vector<CopyBranch> &copies)
+    {
+        for (auto &cb : copies) {
+            copy_bufs.emplace_back(new CopyBuffer);
+            auto &buf = *copy_bufs.back();
+            if (!cb.vec) {
+                T->Branch(cb.name.c_str(), buf.Address(cb), (cb.name + "/" + cb.type).c_str());
+            } else if (cb.type == 'I') {
+                T->Branch(cb.name.c_str(), &buf.vi);
+            } else if (cb.type == 'F') {
+                T->Branch(cb.name.c_str(), &buf.vf);
+            } else {
+                T->Branch(cb.name.c_str(), &buf.vd);
+            }
+        }
+
+        slot7.Reset();
+        slot8.Reset();
+        T->Branch("Slot7Pos", slot7.pos, "Slot7Pos[16]/I");
+        T->Branch("Slot7Height", slot7.height, "Slot7Height[16]/I");
+        T->Branch("Slot8Height", slot8.height, "Slot8Height[16]/I");
+        T->Branch("Slot8Pos", slot8.pos, "Slot8Pos[16]/I");
+        if (cfg.debug_branches) {
+            T->Branch("Slot7Integral0", slot7.integral0, "Slot7Integral0[16]/F");
+            T->Branch("Slot8Integral0", slot8.integral0, "Slot8Integral0[16]/F");
+            T->Branch("Slot7Left", slot7.left, "Slot7Left[16]/I");
+            T->Branch("Slot7Right", slot7.right, "Slot7Right[16]/I");
+            T->Branch("Slot7ADC", slot7.adc, "Slot7ADC[16]/F");
+            T->Branch("Slot8Left", slot8.left, "Slot8Left[16]/I");
+            T->Branch("Slot8Right", slot8.right, "Slot8Right[16]/I");
+            T->Branch("Slot8ADC", slot8.adc, "Slot8ADC[16]/F");
+        }
+
+        T->Branch("event_number", &event_number, "event_number/I");
+        T->Branch("Cer", slot7.adc, "Cer[16]/F");
+        for (auto ch : cfg.slot8_outputs) {
+            T->Branch(cfg.slot8[ch].c_str(), &slot8.adc[ch], (cfg.slot8[ch] + "/F").c_str());
+        }
+
+        cer_sums.resize(cfg.cer_sums.size(), 0.);
+        for (size_t i = 0; i < cfg.cer_sums.size(); ++i) {
+            T->Branch(cfg.cer_sums[i].name.c_str(), &cer_sums[i], (cfg.cer_sums[i].name + "/F").c_str());
+        }
+        T->Branch(cfg.cer_total.c_str(), &cer_total, (cfg.cer_total + "/F").c_str());
+        T->Branch("Cer_NCh", &cer_nch, "Cer_NCh/I");
+        T->Branch("EntryNum", &entry_num, "EntryNum/I");
+        T->Branch("TrigType", &trig_type, "TrigType/I");
+        T->Branch("trigger_time", &trigger_time, "trigger_time/l");
+
+        T->Branch("Shower_Cluster_AdcSum", &ecal.shower_sum, "Shower_Cluster_AdcSum/F");
+        T->Branch("Shower_Cluster_x", &ecal.shower_x, "Shower_Cluster_x/F");
+        T->Branch("Shower_Cluster_y", &ecal.shower_y, "Shower_Cluster_y/F");
+        T->Branch("Shower_Cluster_z", &ecal.shower_z, "Shower_Cluster_z/F");
+        T->Branch("PreSh_Cluster_AdcSum", &ecal.presh_sum, "PreSh_Cluster_AdcSum/F");
+        T->Branch("PreSh_Cluster_x", &ecal.presh_x, "PreSh_Cluster_x/F");
+        T->Branch("PreSh_Cluster_y", &ecal.presh_y, "PreSh_Cluster_y/F");
+        T->Branch("PreSh_Cluster_z", &ecal.presh_z, "PreSh_Cluster_z/F");
+
+        size_t np = cfg.gem_planes.size();
+        gem_n.assign(np, 0);
+        gem_x.assign(np, std::vector<float>(cfg.gem_max_hits, -9999.));
+        gem_y.assign(np, std::vector<float>(cfg.gem_max_hits, -9999.));
+        gem_x_adc.assign(np, std::vector<float>(cfg.gem_max_hits, 0.));
+        gem_y_adc.assign(np, std::vector<float>(cfg.gem_max_hits, 0.));
+        for (size_t i = 0; i < np; ++i) {
+            auto &name = cfg.gem_planes[i].name;
+            T->Branch((name + "_n").c_str(), &gem_n[i], (name + "_n/I").c_str());
+            T->Branch((name + "_x").c_str(), gem_x[i].data(), (name + "_x[" + name + "_n]/F").c_str());
+            T->Branch((name + "_y").c_str(), gem_y[i].data(), (name + "_y[" + name + "_n]/F").c_str());
+        }
+        if (cfg.debug_branches) {
+            for (size_t i = 0; i < np; ++i) {
+                auto &name = cfg.gem_planes[i].name;
+                T->Branch((name + "_x_adc").c_str(), gem_x_adc[i].data(), (name + "_x_adc[" + name + "_n]/F").c_str());
+                T->Branch((name + "_y_adc").c_str(), gem_y_adc[i].data(), (name + "_y_adc[" + name + "_n]/F").c_str());
+            }
+        }
+    }
+
+    void Set(const Level1Event &ev, const std::vector<CopyBranch> &copies)
+    {
+        for (size_t i = 0; i < copies.size(); ++i) {
+            copy_bufs[i]->Set(copies[i], ev.copies[i]);
+        }
+        event_number = ev.event_number;
+        entry_num = ev.entry;
+        trig_type = ev.trigger_type;
+        trigger_time = ev.trigger_time;
+        slot7 = ev.slot7;
+        slot8 = ev.slot8;
+        std::copy(ev.cer_sums.begin(), ev.cer_sums.end(), cer_sums.begin());
+        cer_total = ev.cer_total;
+        cer_nch = ev.cer_nch;
+        ecal = ev.ecal;
+
+        if (!ev.gem_updated) {
+            return;
+        }
+        for (size_t i = 0; i < ev.gem.size(); ++i) {
+            auto &hits = ev.gem[i];
+            gem_n[i] = hits.x.size();
+            std::copy(hits.x.begin(), hits.x.end(), gem_x[i].begin());
+            std::copy(hits.y.begin(), hits.y.end(), gem_y[i].begin());
+            std::copy(hits.x_adc.begin(), hits.x_adc.end(), gem_x_adc[i].begin());
+            std::copy(hits.y_adc.begin(), hits.y_adc.end(), gem_y_adc[i].begin());
+        }
+    }
+};
+
+// the epics entries within the event number range, with the selected branches only
+static void copy_epics_tree(TFile *fin, TFile *fout, const std::vector<std::string> &branches,
+                            int ev_start, int ev_end)
+{
+    auto old_tree = dynamic_cast<TTree*>(fin->Get("EpicsTree"));
+    if (!old_tree) {
+        return;
+    }
+    if (!old_tree->GetBranch("Epics_event_number")) {
+        std::cout << "Warning: no Epics_event_number in EpicsTree, it is not copied." << std::endl;
+        return;
+    }
+
+    old_tree->SetBranchStatus("*", 0);
+    for (auto &name : branches) {
+        if (old_tree->GetBranch(name.c_str())) {
+            old_tree->SetBranchStatus(name.c_str(), 1);
+        } else {
+            std::cout << "Warning: cannot find branch " << name << " in EpicsTree." << std::endl;
+        }
+    }
+    int epics_event_number = 0;
+    old_tree->SetBranchStatus("Epics_event_number", 1);
+    old_tree->SetBranchAddress("Epics_event_number", &epics_event_number);
+
+    fout->cd();
+    auto new_tree = old_tree->CloneTree(0);
+    new_tree->SetDirectory(fout);
+    Long64_t nentries = old_tree->GetEntries();
+    for (Long64_t i = 0; i < nentries; ++i) {
+        old_tree->GetEntry(i);
+        if (epics_event_number >= ev_start) {
+            if (epics_event_number > ev_end) {
+                break;
+            }
+            new_tree->Fill();
+        }
+    }
+    std::cout << "Copied " << new_tree->GetEntries() << " epics entries." << std::endl;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// create the level1 tree of one level0 file
+
+struct RunOptions
+{
+    int run = 0;
+    Long64_t start = 0, nev = -1;
+    int nthreads = 1, block_size = 2000, imt = 0;
+};
+
+bool create_level1_tree(const std::string &path, const std::string &out_path, const Level1Config &cfg,
+                        const RunOptions &opt)
+{
+    auto time_start = steady_clock::now();
+    std::unique_ptr<TFile> fin(new TFile(path.c_str(), "READ"));
+    TTree *ev_tree = nullptr;
+    if (fin->IsZombie() || !(ev_tree = dynamic_cast<TTree*>(fin->Get("EvTree")))) {
+        std::cerr << "Cannot read EvTree from " << path << std::endl;
+        return false;
+    }
+
+    Long64_t istart = std::max(opt.start, 0LL), iend = ev_tree->GetEntries();
+    if ((opt.nev >= 0) && (istart + opt.nev < iend)) {
+        iend = istart + opt.nev;
+    }
+    if (iend <= istart) {
+        std::cerr << "No entries to process in " << path << ", " << ev_tree->GetEntries() << " entries." << std::endl;
+        return false;
+    }
+
+    int run = (opt.run > 0) ? opt.run : get_run_number(path);
+    std::cout << "file = \"" << path << "\"  --> RunNumber = " << run << std::endl;
+    Calibration cal;
+    if (!cal.Load(run)) {
+        return false;
+    }
+
+    // the copied branches that are available in this file
+    std::vector<CopyBranch> copies;
+    for (auto &name : cfg.copy_branches) {
+        CopyBranch cb;
+        if (copy_branch_type(ev_tree, name, cb)) {
+            copies.push_back(cb);
+        }
+    }
+    if (copies.size() != cfg.copy_branches.size()) {
+        std::cout << "Copy " << copies.size() << " of the " << cfg.copy_branches.size()
+                  << " configured branches that are available in EvTree." << std::endl;
+    }
+
+    // event number range for the epics tree, from the first and the last entries
+    int ev_number = 0, ev_start = 0, ev_end = 0;
+    ev_tree->SetBranchStatus("*", 0);
+    ev_tree->SetBranchStatus("event_number", 1);
+    ev_tree->SetBranchAddress("event_number", &ev_number);
+    ev_tree->GetEntry(istart);
+    ev_start = ev_number;
+    ev_tree->GetEntry(iend - 1);
+    ev_end = ev_number;
+    ev_tree->ResetBranchAddresses();
+
+    int max_clusters = 0;
+    if (auto leaf = ev_tree->GetLeaf("GEM_nCluster")) {
+        max_clusters = leaf->GetMaximum();
+    }
+
+    // workers, the input files are opened one by one
+    std::vector<std::unique_ptr<Level1Worker>> workers;
+    for (int i = 0; i < opt.nthreads; ++i) {
+        workers.emplace_back(new Level1Worker(cfg, cal, copies));
+        if (!workers.back()->Open(path, max_clusters)) {
+            return false;
+        }
+    }
+
+    std::unique_ptr<TFile> fout(new TFile(out_path.c_str(), "RECREATE"));
+    if (fout->IsZombie()) {
+        std::cerr << "Cannot create " << out_path << std::endl;
+        return false;
+    }
+    fout->cd();
+    TTree *T = new TTree("T", "solid hallc beamtest level1 tree");
+    Level1Output out;
+    out.Setup(T, cfg, copies);
+    if (opt.imt > 0) {
+        T->SetImplicitMT(true);
+    }
+
+    // blocks of entries, the number of blocks in flight is bounded by the pool
+    uint64_t block_size = std::max(opt.block_size, 1);
+    uint64_t nblocks = (iend - istart + block_size - 1)/block_size;
+    size_t npool = std::min<uint64_t>(nblocks, 2*workers.size() + 2);
+    std::vector<EntryBlock> pool(npool);
+    BoundedQueue<EntryBlock*> work(npool);
+    OrderedOutput<EntryBlock> output(npool);
+    output.SetEnd(nblocks);
+
+    uint64_t next_block = 0;
+    auto submit = [&] (EntryBlock *blk) {
+        blk->seq = next_block;
+        blk->begin = istart + next_block*block_size;
+        blk->end = std::min<Long64_t>(blk->begin + block_size, iend);
+        work.Push(blk);
+        if (++next_block == nblocks) {
+            work.Close();
+        }
+    };
+    for (auto &blk : pool) {
+        submit(&blk);
+    }
+
+    std::vector<std::thread> threads;
+    for (auto &w : workers) {
+        Level1Worker *worker = w.get();
+        threads.emplace_back([&, worker] () {
+            EntryBlock *blk;
+            while (work.Pop(blk)) {
+                worker->Process(*blk);
+                output.Put(blk);
+            }
+        });
+    }
+
+    // writer
+    long nfilled = 0, read_errors = 0, unknown_gem_hits = 0, bad_gem_clusters = 0;
+    EntryBlock *blk;
+    while (output.Next(blk)) {
+        for (size_t i = 0; i < blk->nevents; ++i) {
+            out.Set(blk->events[i], copies);
+            T->Fill();
+        }
+        nfilled += blk->nevents;
+        read_errors += blk->read_errors;
+        unknown_gem_hits += blk->unknown_gem_hits;
+        bad_gem_clusters += blk->bad_gem_clusters;
+        std::cout << blk->end - istart << "/" << iend - istart << " events processed \r" << std::flush;
+        if (next_block < nblocks) {
+            submit(blk);
+        }
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    workers.clear();
+    std::cout << std::endl;
+
+    if (read_errors) {
+        std::cout << "Warning: failed to read " << read_errors << " entries." << std::endl;
+    }
+    if (unknown_gem_hits || bad_gem_clusters) {
+        std::cout << "Warning: " << unknown_gem_hits << " GEM hits of unknown gem_id and " << bad_gem_clusters
+                  << " GEM clusters of invalid chamber or axis are not used." << std::endl;
+    }
+
+    copy_epics_tree(fin.get(), fout.get(), cfg.epics_branches, ev_start, ev_end);
+
+    fout->Write(nullptr, TObject::kOverwrite);
+    fout->Close();
+
+    double sec = duration_cast<duration<double>>(steady_clock::now() - time_start).count();
+    std::cout << "Created " << out_path << " with " << nfilled << " of " << iend - istart << " entries in "
+              << std::fixed << std::setprecision(2) << sec << " s, " << std::setprecision(0)
+              << (iend - istart)/sec << " entries/s." << std::endl;
+    return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddPositional("root_file", "level0 root file (EvTree) from the replay");
+    arg_parser.SetFlexiblePositionals("more level0 root files");
+    arg_parser.AddArg<std::string>("-c", "config", "json file of the level1 layout and variant",
+                                   "database/level1/tracking.json");
+    arg_parser.AddArg<std::string>("-d", "db_dir", "directory of FADCPedestal.txt and FADCPeak.txt", "database");
+    arg_parser.AddArg<std::string>("-o", "output", "output root file, only for a single input"
+                                   " (default replaces _hallc by _level1 in the input)", "");
+    arg_parser.AddArg<int>("-r", "run", "run number for the database (<= 0 means from the file name)", 0);
+    arg_parser.AddArg<int>("-s", "start", "first entry to process", 0);
+    arg_parser.AddArg<int>("-n", "nev", "number of entries to process (< 0 means all)", -1);
+    arg_parser.AddArg<int>("-j", "threads", "number of worker threads (<= 0 means the number of cores)", 0);
+    arg_parser.AddArg<int>("-b", "block", "number of entries in a block of work", 2000);
+    arg_parser.AddArg<int>("-I", "imt", "threads for ROOT implicit multi-threading, used to compress the output"
+                           " baskets in parallel (0: off)", 0);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+
+    std::vector<std::string> files;
+    for (auto &pos : arg_parser.GetPositionals()) {
+        files.push_back(pos.String());
+    }
+    std::string out_path = args["output"].String();
+    if (!out_path.empty() && (files.size() > 1)) {
+        std::cerr << "The output path only works with a single input file." << std::endl;
+        return -1;
+    }
+
+    Level1Config cfg;
+    if (!cfg.Load(args["config"].String())) {
+        return -1;
+    }
+
+    std::string db_dir = args["db_dir"].String();
+    db::DetMap.clear();
+    if (!db::ReadFile((db_dir + "/FADCPedestal.txt").c_str()) || !db::ReadFile((db_dir + "/FADCPeak.txt").c_str())) {
+        std::cerr << "Cannot read the FADC database in " << db_dir << std::endl;
+        return -1;
+    }
+
+    RunOptions opt;
+    opt.run = args["run"].Int();
+    opt.start = args["start"].Int();
+    opt.nev = args["nev"].Int();
+    opt.nthreads = args["threads"].Int();
+    if (opt.nthreads <= 0) {
+        opt.nthreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    opt.block_size = args["block"].Int();
+    opt.imt = args["imt"].Int();
+
+    ROOT::EnableThreadSafety();
+    if (opt.imt > 0) {
+        ROOT::EnableImplicitMT(opt.imt);
+    }
+    std::cout << "Level1 tree with " << opt.nthreads << " worker threads, config " << args["config"].String() << std::endl;
+
+    int nfailed = 0;
+    for (auto &path : files) {
+        if (!create_level1_tree(path, out_path.empty() ? level1_path(path) : out_path, cfg, opt)) {
+            nfailed++;
+        }
+    }
+    return nfailed ? -1 : 0;
+}
@@ -6,6 +6,7 @@
 #include "ConfigObject.h"
 #include "Fadc250Decoder.h"
 #include "SSPDecoder.h"
+#include "EvChannel.h"
 #include "nlohmann/json.hpp"
 
 
@@ -96,3 +97,13 @@ std::vector<Module> read_modules(const std::string &path, bool verbose = false)
     return res;
 }
 
+
+// addresses of the module data, to compile the bank lookup of an event channel
+std::vector<evc::BufferAddress> module_addresses(const std::vector<Module> &modules)
+{
+    std::vector<evc::BufferAddress> res;
+    for (auto &m : modules) {
+        res.emplace_back(m.crate, m.bank, m.slot);
+    }
+    return res;
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+//
+// Run-level replay of a split evio file set (run.evio.0, run.evio.1, ...) in analyze.cpp
+//   splits --> N worker processes (each with its own decoders, GEM system and output file) --> merge
+// The per-split outputs are merged in the split order into one root file, the event numbers of a split
+// (event_number in EvTree and Epics_event_number in EpicsTree) are shifted by the number of events in the
+// previous splits, so the epics events stay aligned with the event tree as in a serial replay.
+// The offsets depend on the entries filled by the previous splits, so the shift is done in the merge: the trees
+// are fast cloned without the event number, which is then written again as the last branch.
+// The per-split files are removed after merging (or when a worker fails).
+//
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <chrono>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "TChain.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+
+
+namespace split_replay {
+
+// path of a split file, the split number goes after "evio" (or "dat"), same as GEMDataHandler::ReadFromSplitEvio
+inline std::string SplitPath(const std::string &path, int i)
+{
+    size_t pos = path.find("evio");
+    if (pos != std::string::npos) {
+        pos += 4;
+    } else if ((pos = path.find("dat")) != std::string::npos) {
+        pos += 3;
+    } else {
+        pos = path.size();
+    }
+    return path.substr(0, pos) + "." + std::to_string(i);
+}
+
+inline bool FileExists(const std::string &path)
+{
+    std::ifstream f(path);
+    return f.good();
+}
+
+// the split files [start, end), end < 0 means until a split file is missing
+inline std::vector<std::string> FindSplits(const std::string &path, int start, int end)
+{
+    std::vector<std::string> res;
+    for (int i = start; (end < 0) || (i < end); ++i) {
+        std::string split = SplitPath(path, i);
+        if (!FileExists(split)) {
+            if (end >= 0) {
+                std::cout << "Warning: cannot find split file " << split << ", skipped." << std::endl;
+                continue;
+            }
+            break;
+        }
+        res.push_back(split);
+    }
+    return res;
+}
+
+// remove the per-split outputs
+inline void RemoveOutputs(const std::vector<std::string> &outputs)
+{
+    for (auto &f : outputs) {
+        std::remove(f.c_str());
+    }
+}
+
+// replay the splits with at most nworkers processes at the same time, replay(split, output) is called in the
+// worker process, returns the per-split outputs in the split order (empty if any worker failed)
+inline std::vector<std::string> RunWorkers(const std::vector<std::string> &splits, const std::string &opath,
+        int nworkers, const std::function<void(const std::string&, const std::string&)> &replay)
+{
+    std::vector<std::string> outputs;
+    for (size_t i = 0; i < splits.size(); ++i) {
+        outputs.push_back(opath + ".split" + std::to_string(i));
+    }
+
+    // do not duplicate the buffered output in the workers
+    std::cout << std::flush;
+    std::fflush(nullptr);
+
+    std::map<pid_t, size_t> jobs;
+    size_t next = 0;
+    bool ok = true;
+    while ((ok && next < splits.size()) || !jobs.empty()) {
+        if (ok && (next < splits.size()) && ((int)jobs.size() < nworkers)) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                std::perror("Error: cannot start a worker process");
+                ok = false;
+                continue;
+            }
+            // worker
+            if (pid == 0) {
+                replay(splits[next], outputs[next]);
+                std::cout << std::flush;
+                std::fflush(nullptr);
+                _exit(FileExists(outputs[next]) ? 0 : 1);
+            }
+            jobs[pid] = next++;
+            continue;
+        }
+
+        int status = 0;
+        pid_t pid = wait(&status);
+        if (pid < 0) {
+            break;
+        }
+        auto it = jobs.find(pid);
+        if (it == jobs.end()) {
+            continue;
+        }
+        if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+            std::cout << "Error: failed to replay split file " << splits[it->second] << std::endl;
+            ok = false;
+        } else {
+            std::cout << "Finished split file " << splits[it->second] << std::endl;
+        }
+        jobs.erase(it);
+    }
+
+    if (!ok) {
+        RemoveOutputs(outputs);
+        return {};
+    }
+    return outputs;
+}
+
+// copy a tree from all the outputs in order, the int branch counter is shifted by the offset of its file
+// the other branches are fast cloned (the compressed baskets are copied without unzipping), and only the counter
+// is read back and written as a new branch, so the merge does not decompress and recompress the whole replay
+inline Long64_t MergeTree(const std::vector<std::string> &outputs, const char *name, const char *counter,
+        const std::vector<Long64_t> &offsets, TFile *hfile)
+{
+    TChain chain(name);
+    for (auto &f : outputs) {
+        chain.Add(f.c_str());
+    }
+    if (chain.GetNtrees() == 0) {
+        return 0;
+    }
+
+    std::string leaflist;
+    bool shift = (counter != nullptr) && (chain.GetBranch(counter) != nullptr);
+    if (shift) {
+        leaflist = chain.GetBranch(counter)->GetTitle();
+        chain.SetBranchStatus(counter, 0);
+    }
+
+    hfile->cd();
+    TTree *tree = chain.CloneTree(-1, "fast");
+    if (!tree) {
+        return 0;
+    }
+    Long64_t nentries = tree->GetEntries();
+
+    if (shift) {
+        int value = 0;
+        chain.SetBranchStatus("*", 0);
+        chain.SetBranchStatus(counter, 1);
+        chain.SetBranchAddress(counter, &value);
+        TBranch *branch = tree->Branch(counter, &value, leaflist.c_str());
+        for (Long64_t i = 0; i < nentries; ++i) {
+            if (chain.GetEntry(i) <= 0) {
+                std::cout << "Warning: cannot read " << counter << " of entry " << i << " in " << name << std::endl;
+            }
+            value += (int)offsets[chain.GetTreeNumber()];
+            branch->Fill();
+        }
+        chain.ResetBranchAddresses();
+    }
+
+    tree->Write("", TObject::kOverwrite);
+    tree->ResetBranchAddresses();
+    return nentries;
+}
+
+// merge the per-split outputs into one root file, and remove them
+// compress is the ROOT compression setting of the merged file (< 0 keeps the default), the fast cloned baskets
+// keep the compression of the split outputs, which are written with the same setting
+inline bool MergeOutputs(const std::vector<std::string> &outputs, const std::string &opath, int compress = -1)
+{
+    auto time_start = std::chrono::steady_clock::now();
+
+    // event offset of each split
+    std::vector<Long64_t> offsets;
+    Long64_t total = 0;
+    for (auto &f : outputs) {
+        offsets.push_back(total);
+        std::unique_ptr<TFile> file(TFile::Open(f.c_str(), "READ"));
+        if (!file || file->IsZombie()) {
+            std::cout << "Error: cannot open the output of a split " << f << std::endl;
+            RemoveOutputs(outputs);
+            return false;
+        }
+        auto tree = dynamic_cast<TTree*>(file->Get("EvTree"));
+        total += tree ? tree->GetEntries() : 0;
+    }
+
+    auto *hfile = new TFile(opath.c_str(), "RECREATE", "MAPMT test results");
+    if (compress >= 0) {
+        hfile->SetCompressionSettings(compress);
+    }
+    Long64_t nev = MergeTree(outputs, "EvTree", "event_number", offsets, hfile);
+    Long64_t nepics = MergeTree(outputs, "EpicsTree", "Epics_event_number", offsets, hfile);
+    hfile->Close();
+    delete hfile;
+
+    auto sec = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - time_start);
+    std::cout << "Merged " << outputs.size() << " split files to " << opath << ", "
+              << nev << " events, " << nepics << " epics events in " << sec.count() << " s." << std::endl;
+    RemoveOutputs(outputs);
+    return true;
+}
+
+} // namespace split_replay
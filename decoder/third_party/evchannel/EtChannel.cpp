@@ -1,5 +1,6 @@
 #include "EtChannel.h"
 #include <iostream>
+#include <algorithm>
 #include <cstring>
 
 using namespace evc;
@@ -20,10 +21,12 @@ static inline status et_status(int code, bool verbose = false)
 
 
 EtChannel::EtChannel(size_t chunk_buf)
-: EvChannel(0), et_id(nullptr), stat_id(ID_NULL), att_id(ID_NULL)
+: EvChannel(0), et_id(nullptr), stat_id(ID_NULL), att_id(ID_NULL), read_mode(EtReadMode::copy),
+  ncopies(0), icopy(0), ring_slots(1024), slot_words(4096), fetch_stop(false),
+  fetch_status(static_cast<int>(status::success))
 {
     // large enough chunk
-    pe.resize(chunk_buf);
+    chunk.pe.resize(chunk_buf);
     sconf.set_cue(ET_STATION_CUE);
     sconf.set_user(ET_STATION_USER_MULTI);
     sconf.set_restore(ET_STATION_RESTORE_OUT);
@@ -52,6 +55,17 @@ status EtChannel::Connect(const std::string &ip, int port, const std::string &et
     return et_status(status, true);
 }
 
+void EtChannel::SetReadMode(EtReadMode mode, size_t nslots, size_t nwords)
+{
+    if (att_id != ID_NULL) {
+        std::cout << "EtChannel Warning: the channel is already opened, cannot change the read mode.\n";
+        return;
+    }
+    read_mode = mode;
+    ring_slots = nslots;
+    slot_words = nwords;
+}
+
 // create a station and attach to it
 status EtChannel::Open(const std::string &station)
 {
@@ -67,13 +81,30 @@ status EtChannel::Open(const std::string &station)
         free(sname);
     }
 
-    return et_status(et_station_attach(et_id, stat_id, &att_id), true);
+    auto stat = et_status(et_station_attach(et_id, stat_id, &att_id), true);
+    if (stat != status::success) {
+        return stat;
+    }
+
+    chunk.nread = 0;
+    chunk.pos = chunk.end = 0;
+    ncopies = icopy = 0;
+    if (read_mode == EtReadMode::threaded) {
+        ring.Init(ring_slots, slot_words);
+        fetch_stop = false;
+        fetch_status = static_cast<int>(status::success);
+        fetcher = std::thread(&EtChannel::fetchLoop, this);
+    }
+    return stat;
 }
 
 // detach from the station
 void EtChannel::Close()
 {
+    stopFetch();
     if (IsETOpen() && (att_id != ID_NULL)) {
+        // the events held by the direct mode
+        putChunk(chunk);
         et_status(et_station_detach(et_id, att_id), true);
         att_id = ID_NULL;
         et_status(et_station_remove(et_id, stat_id), true);
@@ -93,44 +124,70 @@ void EtChannel::Disconnect()
 // read an event
 status EtChannel::Read()
 {
-    // buffers are not empty, just get the first element from it
-    if (!buffers.empty()) {
-        buffer = std::move(buffers.front());
-        buffers.pop_front();
-        return status::success;
-    // read from ET system
-    } else {
-        int nread = 0;
-        int chunk = sconf.get_cue();
-        if (chunk > static_cast<int>(pe.size())) {
-            pe.resize(chunk);
-        }
-        auto status = et_events_get(et_id, att_id, &pe[0], ET_ASYNC, nullptr, chunk, &nread);
+    switch (read_mode) {
+    case EtReadMode::direct:
+        return readDirect();
+    case EtReadMode::threaded:
+        return readRing();
+    case EtReadMode::copy:
+    default:
+        return readCopy();
+    }
+}
 
-        switch (status) {
-        case ET_OK:
-            if (!copyEvent(&pe[0], nread)) {
-                return status::empty;
-            }
-            if (et_events_put(et_id, att_id, &pe[0], nread) != ET_OK) {
-                std::cerr << "EtChannel Error: failed to put back et_event after reading.\n";
-                return status::eof;
-            }
-            // get an event from the buffers
-            buffer = std::move(buffers.front());
-            buffers.pop_front();
-            break;
-        case ET_ERROR_BUSY:
-        case ET_ERROR_TIMEOUT:
-        case ET_ERROR_WAKEUP:
-            std::cout << "EtChannel Warning: " << et_wrap::get_error_str(status) << "\n";
-        case ET_ERROR_EMPTY:
+// get a chunk of events from the ET system, wait is ET_ASYNC or ET_TIMED (100 ms)
+status EtChannel::getChunk(ChunkCursor &cur, int wait)
+{
+    int chunk_size = sconf.get_cue();
+    if (chunk_size > static_cast<int>(cur.pe.size())) {
+        cur.pe.resize(chunk_size);
+    }
+
+    struct timespec timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_nsec = 100000000;
+
+    cur.nread = 0;
+    cur.iev = 0;
+    cur.pos = cur.end = 0;
+    auto status = et_events_get(et_id, att_id, &cur.pe[0], wait, (wait == ET_TIMED) ? &timeout : nullptr,
+                                chunk_size, &cur.nread);
+
+    switch (status) {
+    case ET_OK:
+        if (cur.nread <= 0) {
+            cur.nread = 0;
             return status::empty;
-        // fatal errors
-        default:
-            std::cerr << "EtChannel Error: " << et_wrap::get_error_str(status) << "\n";
-            return status::failure;
         }
+        return status::success;
+    case ET_ERROR_BUSY:
+    case ET_ERROR_WAKEUP:
+        std::cout << "EtChannel Warning: " << et_wrap::get_error_str(status) << "\n";
+    case ET_ERROR_TIMEOUT:
+    case ET_ERROR_EMPTY:
+        cur.nread = 0;
+        return status::empty;
+    // fatal errors
+    default:
+        cur.nread = 0;
+        std::cerr << "EtChannel Error: " << et_wrap::get_error_str(status) << "\n";
+        return status::failure;
+    }
+}
+
+// put the events of a chunk back to the ET system
+status EtChannel::putChunk(ChunkCursor &cur)
+{
+    if (cur.nread <= 0) {
+        return status::success;
+    }
+    auto status = et_events_put(et_id, att_id, &cur.pe[0], cur.nread);
+    cur.nread = 0;
+    cur.iev = 0;
+    cur.pos = cur.end = 0;
+    if (status != ET_OK) {
+        std::cerr << "EtChannel Error: failed to put back et_event after reading.\n";
+        return status::eof;
     }
     return status::success;
 }
@@ -145,77 +202,209 @@ inline bool ev_filter(Func beg, Func end, Args&&... args)
     return true;
 }
 
-template<class Func>
-std::vector<uint32_t> copy_event(const uint32_t *buf, bool swap, Func fil_beg, Func fil_end)
+// the next event of the chunk that passes the filters, it points to the ET event memory (in the ET endianness)
+bool EtChannel::nextEvent(ChunkCursor &cur, uint32_t *&ev, size_t &len, bool &swap)
+{
+    while (true) {
+        // events in the current ET event
+        while (cur.pos < cur.end) {
+            uint32_t *buf = cur.data + cur.pos;
+            uint32_t words[2] = {buf[0], (cur.pos + 1 < cur.end) ? buf[1] : 0};
+            if (cur.swap) {
+                words[0] = ET_SWAP32(words[0]);
+                words[1] = ET_SWAP32(words[1]);
+            }
+            auto header = BankHeader(words);
+            cur.pos += static_cast<size_t>(header.length) + 1;
+
+            // invalid header
+            if (header.length < 1) {
+                continue;
+            }
+            // the event exceeds the ET event
+            if (cur.pos > cur.end) {
+                std::cerr << "EtChannel Error: event length " << header.length + 1 << " exceeds the ET event.\n";
+                cur.pos = cur.end;
+                break;
+            }
+            // cannot pass filters
+            if (!ev_filter(filters.begin(), filters.end(), header)) {
+                continue;
+            }
+
+            ev = buf;
+            len = header.length + 1;
+            swap = cur.swap;
+            return true;
+        }
+
+        if (cur.iev >= cur.nread) {
+            return false;
+        }
+
+        // get event data and attributes from ET
+        void *data;
+        size_t bytes, nbytes = sizeof(uint32_t);
+        int need_swap;
+        et_event_getdata(cur.pe[cur.iev], &data);
+        et_event_getlength(cur.pe[cur.iev], &bytes);
+        et_event_needtoswap(cur.pe[cur.iev], &need_swap);
+        cur.iev++;
+
+        // size of the buffer
+        size_t nwords = bytes / nbytes + ((bytes % nbytes) ? 1 : 0);
+        cur.data = static_cast<uint32_t*>(data);
+        cur.swap = (need_swap == ET_SWAP);
+        auto word = [&cur](size_t i) { return cur.swap ? ET_SWAP32(cur.data[i]) : cur.data[i]; };
+
+        // check if it is a block
+        if ((nwords > 7) && (0xc0da0100 == word(7))) {
+            // skip the block header (size 8)
+            cur.pos = 8;
+            cur.end = std::min<size_t>(word(0), nwords);
+        // a single event
+        } else {
+            cur.pos = 0;
+            cur.end = nwords ? std::min<size_t>(static_cast<size_t>(word(0)) + 1, nwords) : 0;
+        }
+    }
+}
+
+// copy the events of a chunk, and then hand them out one by one
+status EtChannel::readCopy()
 {
-    std::vector<uint32_t> event;
-    auto header = BankHeader(buf);
+    ext_buf = nullptr;
+    if (icopy >= ncopies) {
+        auto stat = getChunk(chunk, ET_ASYNC);
+        if (stat != status::success) {
+            return stat;
+        }
 
-    // invalid header
-    if (header.length < 1) {
-        return event;
+        ncopies = icopy = 0;
+        uint32_t *ev;
+        size_t len;
+        bool swap;
+        while (nextEvent(chunk, ev, len, swap)) {
+            if (ncopies >= copies.size()) {
+                copies.emplace_back();
+            }
+            auto &event = copies[ncopies++];
+            event.assign(ev, ev + len);
+            if (swap) {
+                for (auto &val : event) {
+                    val = ET_SWAP32(val);
+                }
+            }
+        }
+
+        stat = putChunk(chunk);
+        if (stat != status::success) {
+            return stat;
+        }
+        if (!ncopies) {
+            return status::empty;
+        }
     }
 
-    // cannot pass filters
-    for (auto it = fil_beg; it != fil_end; ++it) {
-        if (!(*it)(header)) {
-            return event;
+    // the slot gets the storage of the previous event
+    std::swap(buffer, copies[icopy++]);
+    return status::success;
+}
+
+// hand out the events in place, the chunk is put back once all its events are read
+status EtChannel::readDirect()
+{
+    uint32_t *ev;
+    size_t len;
+    bool swap;
+    while (!nextEvent(chunk, ev, len, swap)) {
+        auto stat = putChunk(chunk);
+        if (stat != status::success) {
+            return stat;
+        }
+        stat = getChunk(chunk, ET_ASYNC);
+        if (stat != status::success) {
+            return stat;
         }
     }
 
-    // good event, copy it!
-    event.assign(buf, buf + header.length + 1);
+    // the ET event memory is not changed, a swapped event is copied
     if (swap) {
-        for (auto &val : event) {
+        buffer.assign(ev, ev + len);
+        for (auto &val : buffer) {
             val = ET_SWAP32(val);
         }
+        ev = &buffer[0];
     }
-
-    return event;
+    ext_buf = ev;
+    ext_len = len;
+    return status::success;
 }
 
-// copy event to the buffer
-bool EtChannel::copyEvent(et_event **pe, int nread)
+// take an event from the ring filled by the fetch thread
+status EtChannel::readRing()
 {
-    if (nread <= 0) {
-        return false;
+    ext_buf = nullptr;
+    auto slot = ring.Front();
+    if (!slot) {
+        auto stat = static_cast<status>(fetch_status.load());
+        return (stat == status::success) ? status::empty : stat;
     }
+    // the slot gets the storage of the previous event, and is returned to the fetch thread right away
+    std::swap(buffer, *slot);
+    ring.Pop();
+    return status::success;
+}
 
-    void *data;
-    size_t len, bytes = sizeof(uint32_t);
-    int endian, swap;
-
-    for (int i = 0; i < nread; ++i) {
-        // get event data and attributes from ET
-        et_event_getdata(pe[i], &data);
-        et_event_getlength(pe[i], &len);
-        // et_event_getendian(pe[i], &endian);
-        et_event_needtoswap(pe[i], &swap);
+// the fetch thread, it keeps the ring full and puts the ET events back as soon as they are copied
+void EtChannel::fetchLoop()
+{
+    ChunkCursor cur;
+    cur.pe.resize(chunk.pe.size());
 
-        // size of the buffer
-        len = len / bytes + ((len % bytes) ? 1 : 0);
-        uint32_t *dbuf = static_cast<uint32_t*>(data);
+    while (!fetch_stop) {
+        // timed wait to check the stop flag
+        auto stat = getChunk(cur, ET_TIMED);
+        if (stat == status::empty) {
+            continue;
+        } else if (stat != status::success) {
+            fetch_status = static_cast<int>(stat);
+            break;
+        }
 
-        // check if it is a block
-        if ((len > 6) && (0xc0da0100 == (swap ? ET_SWAP32(dbuf[7]) : dbuf[7]))) {
-            // skip the block header (size 8)
-            uint32_t index = 8;
-            while (index < dbuf[0]) {
-                auto event = copy_event(&dbuf[index], swap, filters.begin(), filters.end());
-                index += dbuf[index] + 1;
-                if (event.size()) {
-                    buffers.emplace_back(std::move(event));
-                }
+        uint32_t *ev;
+        size_t len;
+        bool swap;
+        while (nextEvent(cur, ev, len, swap)) {
+            // wait for the reader if the ring is full
+            std::vector<uint32_t> *slot;
+            while (!(slot = ring.Claim()) && !fetch_stop) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
             }
-        // a single event
-        } else {
-            auto event = copy_event(dbuf, swap, filters.begin(), filters.end());
-            if (event.size()) {
-                buffers.emplace_back(std::move(event));
+            if (!slot) {
+                break;
+            }
+            slot->assign(ev, ev + len);
+            if (swap) {
+                for (auto &val : *slot) {
+                    val = ET_SWAP32(val);
+                }
             }
+            ring.Publish();
         }
-    }
 
-    return true;
+        stat = putChunk(cur);
+        if (stat != status::success) {
+            fetch_status = static_cast<int>(stat);
+            break;
+        }
+    }
 }
 
+void EtChannel::stopFetch()
+{
+    if (fetcher.joinable()) {
+        fetch_stop = true;
+        fetcher.join();
+    }
+}
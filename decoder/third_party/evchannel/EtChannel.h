@@ -11,12 +11,13 @@
 #include "EtConfigWrapper.h"
 #include "EvChannel.h"
 #include "EvStruct.h"
+#include "EtEventRing.h"
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <chrono>
 #include <string>
 #include <thread>
-#include <list>
 #include <vector>
 
 
@@ -24,6 +25,18 @@
 
 namespace evc {
 
+// how the events are handed out by EtChannel::Read
+enum class EtReadMode : int
+{
+    // a chunk of ET events is copied into reused event slots and put back to ET right away
+    copy = 0,
+    // events are read in place from the ET event memory (copied only if they need swapping), the chunk is put back
+    // when all its events are read, so the channel holds up to a chunk of ET events while the reader works
+    direct = 1,
+    // a background thread keeps fetching chunks from ET and copies the events into a ring of preallocated slots
+    threaded = 2,
+};
+
 class EtChannel : public EvChannel
 {
 public:
@@ -40,21 +53,55 @@ public:
     status Connect(const std::string &ip, int port, const std::string &et_file);
     void Disconnect();
     bool IsETOpen() const { return (et_id != nullptr) && et_alive(et_id); }
+    // the filters run in the fetch thread for the threaded mode, add them before Open
     void AddEvFilter(std::function<bool(const BankHeader &)> &&func) { filters.emplace_back(func); }
 
+    // set it before Open, the ring settings are only used by the threaded mode
+    void SetReadMode(EtReadMode mode, size_t ring_slots = 1024, size_t slot_words = 4096);
+    EtReadMode GetReadMode() const { return read_mode; }
+
     et_wrap::StationConfig &GetConfig() { return sconf; }
     const et_wrap::StationConfig &GetConfig() const { return sconf; }
 
 private:
-    bool copyEvent(et_event **pe, int nread);
+    // events in the ET events of a chunk, an ET event is either a single event or an evio block of events
+    struct ChunkCursor
+    {
+        std::vector<et_event*> pe;
+        int nread = 0, iev = 0;
+        uint32_t *data = nullptr;
+        size_t pos = 0, end = 0;
+        bool swap = false;
+    };
+
+    status getChunk(ChunkCursor &cur, int wait);
+    status putChunk(ChunkCursor &cur);
+    bool nextEvent(ChunkCursor &cur, uint32_t *&ev, size_t &len, bool &swap);
+    status readCopy();
+    status readDirect();
+    status readRing();
+    void fetchLoop();
+    void stopFetch();
 
     et_wrap::StationConfig sconf;
     et_sys_id et_id;
     et_stat_id stat_id;
     et_att_id att_id;
-    std::list<std::vector<uint32_t>> buffers;
     std::vector<std::function<bool(const BankHeader &)>> filters;
-    std::vector<et_event*> pe;
+    EtReadMode read_mode;
+    ChunkCursor chunk;
+
+    // copy mode, the events of the last chunk, the slots are swapped with the event buffer
+    std::vector<std::vector<uint32_t>> copies;
+    size_t ncopies, icopy;
+
+    // threaded mode
+    EtEventRing ring;
+    size_t ring_slots, slot_words;
+    bool ring_front;
+    std::thread fetcher;
+    std::atomic<bool> fetch_stop;
+    std::atomic<int> fetch_status;
 };
 
 }   // namespace evc
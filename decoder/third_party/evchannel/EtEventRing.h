@@ -0,0 +1,75 @@
+//=============================================================================
+// Class EtEventRing                                                         ||
+// A single-producer/single-consumer ring of preallocated event slots        ||
+// The fetch thread of EtChannel copies events into the slots, and the       ||
+// reader takes them out without locking                                     ||
+//=============================================================================
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+
+namespace evc {
+
+class EtEventRing
+{
+public:
+    EtEventRing() : mask(0), head(0), tail(0) {}
+
+    EtEventRing(const EtEventRing &)  = delete;
+    void operator =(const EtEventRing &)  = delete;
+
+    // the number of slots is rounded up to a power of 2, every slot reserves slot_words
+    // an event larger than that grows its slot once, the capacity stays for the next events
+    // not thread-safe, only call it when there is no producer or consumer
+    void Init(size_t nslots, size_t slot_words)
+    {
+        size_t n = 1;
+        while (n < nslots) { n <<= 1; }
+        slots.resize(n);
+        for (auto &s : slots) {
+            s.clear();
+            s.reserve(slot_words);
+        }
+        mask = n - 1;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    size_t Capacity() const { return slots.size(); }
+    size_t Size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+    // producer: the next free slot, nullptr if the ring is full, it is handed to the consumer by Publish
+    std::vector<uint32_t> *Claim()
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= slots.size()) {
+            return nullptr;
+        }
+        return &slots[h & mask];
+    }
+    void Publish() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // consumer: the oldest filled slot, nullptr if the ring is empty, it is returned to the producer by Pop
+    // the slot content can be swapped out, the producer only needs a vector back
+    std::vector<uint32_t> *Front()
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots[t & mask];
+    }
+    void Pop() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+private:
+    std::vector<std::vector<uint32_t>> slots;
+    size_t mask;
+    // the producer and the consumer indices are on different cache lines
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+}   // namespace evc
@@ -26,7 +26,7 @@ static inline status evio_status (int code)
 }
 
 EvChannel::EvChannel(size_t buflen)
-: fHandle(-1)
+: fHandle(-1), ext_buf(nullptr), ext_len(0), lut_nbanks(0), generation(0)
 {
     buffer.resize(buflen);
 }
@@ -54,18 +54,69 @@ status EvChannel::Read()
     return evio_status(evRead(fHandle, &buffer[0], buffer.size()));
 }
 
+void EvChannel::CompileLookup(const std::vector<BufferAddress> &addrs)
+{
+    ClearLookup();
+
+    for (auto &a : addrs) {
+        if (a.slot >= LOOKUP_NSLOTS) {
+            std::cout << "Ev Channel Warning: slot " << a.slot << " is out of range, " << a
+                      << " is not added to the lookup." << std::endl;
+            continue;
+        }
+        if (a.roc >= lut_roc.size()) { lut_roc.resize(a.roc + 1, -1); }
+        if (a.bank >= lut_bank.size()) { lut_bank.resize(a.bank + 1, -1); }
+        if (lut_roc[a.roc] < 0) { lut_roc[a.roc] = *std::max_element(lut_roc.begin(), lut_roc.end()) + 1; }
+        if (lut_bank[a.bank] < 0) { lut_bank[a.bank] = *std::max_element(lut_bank.begin(), lut_bank.end()) + 1; }
+    }
+
+    int nrocs = lut_roc.empty() ? 0 : *std::max_element(lut_roc.begin(), lut_roc.end()) + 1;
+    lut_nbanks = lut_bank.empty() ? 0 : *std::max_element(lut_bank.begin(), lut_bank.end()) + 1;
+    lut.resize(nrocs*lut_nbanks*LOOKUP_NSLOTS, -1);
+
+    for (auto &a : addrs) {
+        if (a.slot >= LOOKUP_NSLOTS) {
+            continue;
+        }
+        int &idx = lut[(lut_roc[a.roc]*lut_nbanks + lut_bank[a.bank])*LOOKUP_NSLOTS + a.slot];
+        if (idx < 0) {
+            idx = lut_slots.size();
+            lut_slots.emplace_back(LookupSlot{0, {}});
+        }
+    }
+}
+
+void EvChannel::ClearLookup()
+{
+    lut_roc.clear();
+    lut_bank.clear();
+    lut.clear();
+    lut_slots.clear();
+    lut_nbanks = 0;
+}
+
 bool EvChannel::ScanBanks(const std::vector<uint32_t> &banks)
 {
     buffer_info.clear();
+    // invalidate the compiled slots
+    if (++generation == 0) {
+        for (auto &ls : lut_slots) {
+            ls.gen = 0;
+        }
+        generation = 1;
+    }
+    prepareScan(banks);
 
-    auto evh = BankHeader(&buffer[0]);
+    const uint32_t *buf = GetRawBuffer();
+    size_t buflen = GetRawBufferSize();
+    auto evh = BankHeader(buf);
     // skip the header
     size_t iword = BankHeader::size();
 
     // sanity checks
-    if (evh.length > buffer.size()) {
+    if (evh.length > buflen) {
         std::cout << "Ev Channel Error: Incomplete or corrupted event: event length = " << evh.length
-                  << ", while buffer size is only " << buffer.size() << std::endl;
+                  << ", while buffer size is only " << buflen << std::endl;
         return false;
     }
 
@@ -77,11 +128,11 @@ bool EvChannel::ScanBanks(const std::vector<uint32_t> &banks)
 
     // scan event, first one is the trigger bank
     try {
-        iword += scanTriggerBank(&buffer[iword], iword);
+        iword += scanTriggerBank(&buf[iword], iword);
 
         // scan ROC banks
         while (iword < evh.length + 1) {
-            iword += scanRocBank(&buffer[iword], iword, banks);
+            iword += scanRocBank(&buf[iword], iword, banks);
         }
 
     } catch (std::exception const& e) {
@@ -198,7 +249,10 @@ size_t EvChannel::scanRocBank(const uint32_t *buf, size_t gindex, const std::vec
 void EvChannel::scanDataBank(const uint32_t *buf, size_t buflen, uint32_t roc, uint32_t bank, size_t gindex)
 {
     uint32_t slot, type, iev = 0;
-    std::vector<BufferInfo> event_buffers;
+    // the block info is written into the slot directly if the address is compiled
+    LookupSlot *lslot = nullptr;
+    std::vector<BufferInfo> *event_buffers = &scan_buffers;
+    scan_buffers.clear();
     // scan the data bank
     for (size_t iword = 0; iword < buflen; ++iword) {
         // not a defininition word
@@ -210,8 +264,11 @@ void EvChannel::scanDataBank(const uint32_t *buf, size_t buflen, uint32_t roc, u
         case BLOCK_HEADER:
             {
                 BlockHeader blk(buf + iword);
-                event_buffers.clear();
                 slot = blk.slot;
+                int idx = lookupIndex(roc, bank, slot);
+                lslot = (idx >= 0) ? &lut_slots[idx] : nullptr;
+                event_buffers = lslot ? &lslot->blocks : &scan_buffers;
+                event_buffers->clear();
             }
             break;
         case BLOCK_TRAILER:
@@ -223,9 +280,13 @@ void EvChannel::scanDataBank(const uint32_t *buf, size_t buflen, uint32_t roc, u
                                     + std::to_string(roc) + " bank " + std::to_string(bank);
                     throw(std::runtime_error(mes));
                 }
-                if (event_buffers.size()) {
-                    event_buffers.back().len = iword - event_buffers.back().len;
-                    buffer_info[BufferAddress(roc, bank, slot)] = event_buffers;
+                if (event_buffers->size()) {
+                    event_buffers->back().len = iword - event_buffers->back().len;
+                    if (lslot) {
+                        lslot->gen = generation;
+                    } else {
+                        buffer_info[BufferAddress(roc, bank, slot)] = *event_buffers;
+                    }
                 }
             }
             break;
@@ -238,10 +299,10 @@ void EvChannel::scanDataBank(const uint32_t *buf, size_t buflen, uint32_t roc, u
                                     + std::to_string(roc) + " bank " + std::to_string(bank);
                     throw(std::runtime_error(mes));
                 }
-                if (event_buffers.size()) {
-                    event_buffers.back().len = iword - event_buffers.back().len;
+                if (event_buffers->size()) {
+                    event_buffers->back().len = iword - event_buffers->back().len;
                 }
-                event_buffers.emplace_back(gindex + iword, iword);
+                event_buffers->emplace_back(gindex + iword, iword);
             }
             break;
         // skip other headers
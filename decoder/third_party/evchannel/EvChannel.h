@@ -68,22 +68,56 @@ public:
     bool ScanBanks(const std::vector<uint32_t> &banks);
     bool Scan() { return ScanBanks({}); }
 
-    uint32_t *GetRawBuffer() { return &buffer[0]; }
-    const uint32_t *GetRawBuffer() const { return &buffer[0]; }
+    // the current event, it does not necessarily live in the internal buffer (see EvMappedChannel)
+    uint32_t *GetRawBuffer() { return ext_buf ? ext_buf : &buffer[0]; }
+    const uint32_t *GetRawBuffer() const { return ext_buf ? ext_buf : &buffer[0]; }
+    size_t GetRawBufferSize() const { return ext_buf ? ext_len : buffer.size(); }
 
+    // the internal buffer, only holds the current event for the copying readers (EvChannel, EtChannel except the
+    // direct mode)
     std::vector<uint32_t> &GetRawBufferVec() { return buffer; }
     const std::vector<uint32_t> &GetRawBufferVec() const { return buffer; }
 
-    BankHeader GetEvHeader() const { return BankHeader(&buffer[0]); }
+    BankHeader GetEvHeader() const { return BankHeader(GetRawBuffer()); }
+    // buffers of the addresses that are not in the compiled lookup (all of them if there is no lookup)
     const std::unordered_map<BufferAddress, std::vector<BufferInfo>, BufferHash> &GetEvBuffers() const
     {
         return buffer_info;
     }
-    const std::vector<BufferInfo> &GetEvBuffer(uint32_t roc, uint32_t bank, uint32_t slot) const
+
+    // a fixed set of addresses (usually from the module configuration) are stored in preallocated slots,
+    // which are invalidated by a generation counter for every event instead of being cleared
+    void CompileLookup(const std::vector<BufferAddress> &addrs);
+    void ClearLookup();
+
+    // return nullptr if no data found
+    const std::vector<BufferInfo> *TryGetEvBuffer(uint32_t roc, uint32_t bank, uint32_t slot) const
     {
+        int idx = lookupIndex(roc, bank, slot);
+        if (idx >= 0) {
+            auto &ls = lut_slots[idx];
+            return (ls.gen == generation) ? &ls.blocks : nullptr;
+        }
         auto it = buffer_info.find(BufferAddress{roc, bank, slot});
-        if (it != buffer_info.end()) {
-            return it->second;
+        return (it != buffer_info.end()) ? &it->second : nullptr;
+    }
+
+    const uint32_t *TryGetEvBuffer(uint32_t roc, uint32_t bank, uint32_t slot, uint32_t blk, size_t &len) const
+    {
+        auto infos = TryGetEvBuffer(roc, bank, slot);
+        if (!infos || blk >= infos->size()) {
+            return nullptr;
+        }
+        auto &info = (*infos)[blk];
+        len = info.len;
+        return GetRawBuffer() + info.iword;
+    }
+
+    const std::vector<BufferInfo> &GetEvBuffer(uint32_t roc, uint32_t bank, uint32_t slot) const
+    {
+        auto infos = TryGetEvBuffer(roc, bank, slot);
+        if (infos) {
+            return *infos;
         }
         std::string error = "No data found for ROC " + std::to_string(roc)
                           + ", bank " + std::to_string(bank)
@@ -93,11 +127,9 @@ public:
 
     const uint32_t *GetEvBuffer(uint32_t roc, uint32_t bank, uint32_t slot, uint32_t blk, size_t &len) const
     {
-        auto it = buffer_info.find(BufferAddress{roc, bank, slot});
-        if (it != buffer_info.end()) {
-            auto &info = it->second[blk];
-            len = info.len;
-            return &buffer[info.iword];
+        auto buf = TryGetEvBuffer(roc, bank, slot, blk, len);
+        if (buf) {
+            return buf;
         }
         std::string error = "No data found for ROC " + std::to_string(roc)
                           + ", bank " + std::to_string(bank)
@@ -117,14 +149,47 @@ public:
     }
 
 protected:
+    // called at the beginning of ScanBanks, a reader can prepare the event buffer for the interested banks
+    virtual void prepareScan(const std::vector<uint32_t> & /* banks */) {}
     size_t scanTriggerBank(const uint32_t *buf, size_t gindex);
     size_t scanRocBank(const uint32_t *buf, size_t gindex, const std::vector<uint32_t> &banks);
     void scanDataBank(const uint32_t *buf, size_t buflen, uint32_t roc, uint32_t bank, size_t gindex);
 
+    // dense index of a compiled address, -1 if it is not compiled
+    int lookupIndex(uint32_t roc, uint32_t bank, uint32_t slot) const
+    {
+        if ((roc >= lut_roc.size()) || (bank >= lut_bank.size()) || (slot >= LOOKUP_NSLOTS)) {
+            return -1;
+        }
+        int r = lut_roc[roc], b = lut_bank[bank];
+        if ((r < 0) || (b < 0)) {
+            return -1;
+        }
+        return lut[(r*lut_nbanks + b)*LOOKUP_NSLOTS + slot];
+    }
+
     int fHandle;
     std::vector<uint32_t> buffer;
+    // event data outside of the internal buffer, nullptr means the event is in buffer
+    uint32_t *ext_buf;
+    size_t ext_len;
     std::unordered_map<BufferAddress, std::vector<BufferInfo>, BufferHash> buffer_info;
 
+    // compiled lookup, roc and bank tags are mapped to dense indices, then (roc, bank, slot) to a slot
+    struct LookupSlot
+    {
+        uint32_t gen;
+        std::vector<BufferInfo> blocks;
+    };
+    // slot number is 5 bits in the block header
+    static constexpr uint32_t LOOKUP_NSLOTS = 32;
+    std::vector<int> lut_roc, lut_bank, lut;
+    int lut_nbanks;
+    std::vector<LookupSlot> lut_slots;
+    uint32_t generation;
+    // block info of the addresses that are not compiled, before they are moved into buffer_info
+    std::vector<BufferInfo> scan_buffers;
+
     uint16_t event_type;
     uint64_t trigger_time;
 };
@@ -0,0 +1,159 @@
+#include "EvIndex.h"
+#include "EvMappedChannel.h"
+#include <sys/stat.h>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+using namespace evc;
+
+
+#define EVINDEX_MAGIC 0x58495645    // "EVIX"
+#define EVINDEX_VERSION 2
+
+struct EvIndexHeader
+{
+    uint32_t magic, version;
+    uint64_t file_size, nevents;
+    int64_t file_mtime;
+    uint32_t first_block[8];
+};
+
+// size, modification time and the first block header of an evio file
+static bool get_file_stamp(const std::string &path, uint64_t &size, int64_t &mtime, uint32_t *blk)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    size = st.st_size;
+    mtime = (int64_t)st.st_mtim.tv_sec*1000000000LL + st.st_mtim.tv_nsec;
+
+    std::memset(blk, 0, 8*sizeof(uint32_t));
+    std::ifstream evio_file(path, std::ios::binary);
+    if (!evio_file.is_open()) {
+        return false;
+    }
+    evio_file.read(reinterpret_cast<char*>(blk), 8*sizeof(uint32_t));
+    return true;
+}
+
+
+status EvIndex::Build(const std::string &evio_path)
+{
+    entries.clear();
+    file_size = 0;
+
+    // taken before reading, so a file changed during the build does not match its index
+    if (!get_file_stamp(evio_path, file_size, file_mtime, first_block)) {
+        return status::failure;
+    }
+
+    EvMappedChannel chan;
+    auto stat = chan.Open(evio_path);
+    if (stat != status::success) {
+        return stat;
+    }
+
+    while ((stat = chan.Read()) == status::success) {
+        auto evh = chan.GetEvHeader();
+        EvIndexEntry entry{};
+        entry.offset = chan.GetEventOffset();
+        entry.blkpos = chan.GetEventBlockPos();
+        entry.length = evh.length + 1;
+        entry.tag = evh.tag;
+        // only the trigger bank is needed, no data bank is scanned
+        if (IsPhysics(evh.tag) && chan.Scan()) {
+            entry.trigger = chan.GetEventType();
+            entry.timestamp = chan.GetTriggerTime();
+        }
+        entries.push_back(entry);
+    }
+    chan.Close();
+
+    // a truncated file (e.g., still being written) is indexed up to the last complete event
+    if (stat == status::failure) {
+        entries.clear();
+        return stat;
+    }
+    return status::success;
+}
+
+status EvIndex::Load(const std::string &evio_path)
+{
+    entries.clear();
+    file_size = 0;
+
+    uint64_t size;
+    int64_t mtime;
+    uint32_t blk[8];
+    std::ifstream idx_file(IndexPath(evio_path), std::ios::binary);
+    if (!get_file_stamp(evio_path, size, mtime, blk) || !idx_file.is_open()) {
+        return status::failure;
+    }
+
+    EvIndexHeader header;
+    if (!idx_file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || (header.magic != EVINDEX_MAGIC) || (header.version != EVINDEX_VERSION)) {
+        std::cout << "Ev Index Warning: " << IndexPath(evio_path) << " is not a valid index file." << std::endl;
+        return status::failure;
+    }
+
+    // the evio file has changed since the index was built, a file rewritten with the same size
+    // has a different modification time
+    if ((header.file_size != size) || (header.file_mtime != mtime)
+        || (std::memcmp(header.first_block, blk, sizeof(blk)) != 0)) {
+        std::cout << "Ev Index Warning: " << IndexPath(evio_path) << " does not match "
+                  << evio_path << ", it is outdated." << std::endl;
+        return status::failure;
+    }
+
+    entries.resize(header.nevents);
+    if (!idx_file.read(reinterpret_cast<char*>(entries.data()), entries.size()*sizeof(EvIndexEntry))) {
+        std::cout << "Ev Index Warning: " << IndexPath(evio_path) << " is incomplete." << std::endl;
+        entries.clear();
+        return status::incomplete;
+    }
+    file_size = header.file_size;
+    file_mtime = header.file_mtime;
+    std::memcpy(first_block, header.first_block, sizeof(first_block));
+    return status::success;
+}
+
+status EvIndex::Save(const std::string &evio_path) const
+{
+    std::ofstream idx_file(IndexPath(evio_path), std::ios::binary | std::ios::trunc);
+    if (!idx_file.is_open()) {
+        return status::failure;
+    }
+
+    EvIndexHeader header{EVINDEX_MAGIC, EVINDEX_VERSION, file_size, entries.size(), file_mtime, {}};
+    std::memcpy(header.first_block, first_block, sizeof(first_block));
+    idx_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    idx_file.write(reinterpret_cast<const char*>(entries.data()), entries.size()*sizeof(EvIndexEntry));
+    return idx_file.good() ? status::success : status::failure;
+}
+
+status EvIndex::LoadOrBuild(const std::string &evio_path, bool verbose)
+{
+    if (Load(evio_path) == status::success) {
+        if (verbose) {
+            std::cout << "Loaded event index " << IndexPath(evio_path) << " with "
+                      << entries.size() << " events." << std::endl;
+        }
+        return status::success;
+    }
+
+    auto stat = Build(evio_path);
+    if (stat != status::success) {
+        return stat;
+    }
+    if (verbose) {
+        std::cout << "Built event index for " << evio_path << " with " << entries.size() << " events." << std::endl;
+    }
+    // the index is still usable if it cannot be saved (e.g., a read-only data directory)
+    if (Save(evio_path) != status::success) {
+        std::cout << "Ev Index Warning: cannot save the event index to " << IndexPath(evio_path) << std::endl;
+    }
+    return status::success;
+}
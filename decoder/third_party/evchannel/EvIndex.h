@@ -0,0 +1,59 @@
+//=============================================================================
+// Class EvIndex                                                             ||
+// Event index of a CODA evio file, saved as a sidecar file <evio_file>.idx  ||
+// It records the location, tag, trigger type and TI timestamp of every     ||
+// event, so that a reader can jump to an event or select the events to     ||
+// read without reading through the file                                     ||
+//=============================================================================
+#pragma once
+
+#include "EvChannel.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+namespace evc {
+
+struct EvIndexEntry
+{
+    uint64_t offset;        // byte offset of the event in the evio file
+    uint64_t timestamp;     // TI timestamp (physics events only)
+    uint32_t length;        // event length in words, including the bank header
+    uint32_t blkpos;        // distance in words from the block header to the event
+    uint16_t tag;           // event tag
+    uint16_t trigger;       // trigger type (physics events only)
+    uint32_t reserved;
+};
+
+class EvIndex
+{
+public:
+    EvIndex() : file_size(0), file_mtime(0), first_block{} {}
+
+    // build the index by reading through an evio file (version 4)
+    status Build(const std::string &evio_path);
+    // load the index file of an evio file, it fails if the index does not match the evio file
+    // (size, modification time and first block header)
+    status Load(const std::string &evio_path);
+    status Save(const std::string &evio_path) const;
+    // load the index, or build and save it if there is no valid index file
+    status LoadOrBuild(const std::string &evio_path, bool verbose = true);
+
+    size_t Size() const { return entries.size(); }
+    const EvIndexEntry &operator [] (size_t i) const { return entries[i]; }
+    const std::vector<EvIndexEntry> &GetEntries() const { return entries; }
+
+    static std::string IndexPath(const std::string &evio_path) { return evio_path + ".idx"; }
+    // CODA 3 physics events (built events with a trigger bank)
+    static bool IsPhysics(uint32_t tag) { return (tag >= 0xFF50) && (tag <= 0xFF8F); }
+
+private:
+    // the evio file that was indexed
+    uint64_t file_size;
+    int64_t file_mtime;         // modification time in ns
+    uint32_t first_block[8];    // the first block header
+    std::vector<EvIndexEntry> entries;
+};
+
+}   // namespace evc
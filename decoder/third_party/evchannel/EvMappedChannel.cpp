@@ -0,0 +1,354 @@
+#include "EvMappedChannel.h"
+#include "evio.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+using namespace evc;
+
+
+#define EVIO_MAGIC 0xc0da0100
+#define EVIO_BLKHD_SIZE 8
+// the pages behind the current block are released in chunks of this size (bytes)
+#define RELEASE_CHUNK (64UL*1024*1024)
+
+static inline uint32_t swap32(uint32_t w)
+{
+    return __builtin_bswap32(w);
+}
+
+static inline void swap_words(uint32_t *buf, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        buf[i] = swap32(buf[i]);
+    }
+}
+
+// swap the data content according to its evio type
+static void swap_data(uint32_t *buf, size_t n, uint32_t type)
+{
+    switch (type) {
+    // 8-bit data is not affected
+    case DATA_CHARSTAR8:
+    case DATA_CHAR8:
+    case DATA_UCHAR8:
+        break;
+    // 16-bit data, swap the bytes of each half word and keep their order
+    case DATA_SHORT16:
+    case DATA_USHORT16:
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t w = swap32(buf[i]);
+            buf[i] = (w << 16) | (w >> 16);
+        }
+        break;
+    // 64-bit data, swap the bytes of each pair of words and exchange the pair
+    case DATA_DOUBLE64:
+    case DATA_LONG64:
+    case DATA_ULONG64:
+        for (size_t i = 0; i + 1 < n; i += 2) {
+            uint32_t w = swap32(buf[i]);
+            buf[i] = swap32(buf[i + 1]);
+            buf[i + 1] = w;
+        }
+        break;
+    default:
+        swap_words(buf, n);
+        break;
+    }
+}
+
+
+EvMappedChannel::EvMappedChannel()
+: EvChannel(0), fd(-1), words(nullptr), nwords(0), map_bytes(0), pos(0), blk_end(0), blk_next(0), released(0),
+  cur_pos(0), cur_blk(0), blk_beg(0), swapped(false), last_block(false), skip_dict(false), struct_swapped(false),
+  all_swapped(false)
+{
+    // do nothing
+}
+
+status EvMappedChannel::Open(const std::string &path)
+{
+    if (fd >= 0) {
+        Close();
+    }
+
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Ev Mapped Channel Error: cannot open file " << path << ": " << strerror(errno) << std::endl;
+        return status::failure;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)(EVIO_BLKHD_SIZE*sizeof(uint32_t)))) {
+        std::cout << "Ev Mapped Channel Error: " << path << " is not a valid evio file." << std::endl;
+        Close();
+        return status::failure;
+    }
+
+    map_bytes = st.st_size;
+    void *addr = mmap(nullptr, map_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        std::cout << "Ev Mapped Channel Error: cannot map file " << path << ": " << strerror(errno) << std::endl;
+        map_bytes = 0;
+        Close();
+        return status::failure;
+    }
+    madvise(addr, map_bytes, MADV_SEQUENTIAL);
+    words = static_cast<uint32_t*>(addr);
+    nwords = map_bytes/sizeof(uint32_t);
+
+    // check the first block header for endianness and version
+    if (words[7] == EVIO_MAGIC) {
+        swapped = false;
+    } else if (swap32(words[7]) == EVIO_MAGIC) {
+        swapped = true;
+    } else {
+        std::cout << "Ev Mapped Channel Error: " << path << " has a bad magic number in the block header." << std::endl;
+        Close();
+        return status::failure;
+    }
+
+    uint32_t version = (swapped ? swap32(words[5]) : words[5]) & 0xFF;
+    if (version != 4) {
+        std::cout << "Ev Mapped Channel Error: evio version " << version << " is not supported by the mapped "
+                  << "reader, use the evio library reader instead." << std::endl;
+        Close();
+        return status::failure;
+    }
+
+    pos = blk_end = blk_next = released = 0;
+    cur_pos = cur_blk = blk_beg = 0;
+    last_block = false;
+    skip_dict = false;
+    return status::success;
+}
+
+void EvMappedChannel::Close()
+{
+    if (words) {
+        munmap(words, map_bytes);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    words = nullptr;
+    nwords = map_bytes = 0;
+    fd = -1;
+    ext_buf = nullptr;
+    ext_len = 0;
+}
+
+// move to the next block
+status EvMappedChannel::nextBlock()
+{
+    if (last_block || (blk_next + EVIO_BLKHD_SIZE > nwords)) {
+        return status::eof;
+    }
+
+    const uint32_t *hdr = words + blk_next;
+    auto word = [this, hdr] (int i) { return swapped ? swap32(hdr[i]) : hdr[i]; };
+
+    if (word(7) != EVIO_MAGIC) {
+        std::cout << "Ev Mapped Channel Error: bad magic number in the block header at word "
+                  << blk_next << std::endl;
+        return status::failure;
+    }
+
+    uint32_t blklen = word(0), hdrlen = word(2), info = word(5);
+    if ((hdrlen < EVIO_BLKHD_SIZE) || (blklen < hdrlen)) {
+        std::cout << "Ev Mapped Channel Error: corrupted block header at word " << blk_next << std::endl;
+        return status::failure;
+    }
+    if (blk_next + blklen > nwords) {
+        return status::incomplete;
+    }
+
+    // the dictionary is the first event of the first block
+    skip_dict = (blk_next == 0) && (info & 0x100);
+    last_block = (info & 0x200);
+    pos = blk_next + hdrlen;
+    blk_beg = blk_next;
+    blk_end = blk_next + blklen;
+    blk_next = blk_end;
+    releasePages();
+    return status::success;
+}
+
+// the pages behind the current block will not be accessed again
+void EvMappedChannel::releasePages()
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t upto = (pos*sizeof(uint32_t)/page)*page;
+    if (upto >= released + RELEASE_CHUNK) {
+        madvise(reinterpret_cast<char*>(words) + released, upto - released, MADV_DONTNEED);
+        released = upto;
+    }
+}
+
+status EvMappedChannel::Read()
+{
+    if (!words) {
+        return status::failure;
+    }
+
+    while (true) {
+        while (pos >= blk_end) {
+            auto stat = nextBlock();
+            if (stat != status::success) {
+                return stat;
+            }
+        }
+
+        size_t len = static_cast<size_t>(swapped ? swap32(words[pos]) : words[pos]) + 1;
+        // events never span blocks in evio version 4
+        if (pos + len > blk_end) {
+            std::cout << "Ev Mapped Channel Error: event at word " << pos << " exceeds its block." << std::endl;
+            return status::incomplete;
+        }
+
+        uint32_t *ev = words + pos;
+        cur_pos = pos;
+        cur_blk = blk_beg;
+        pos += len;
+        if (skip_dict) {
+            skip_dict = false;
+            continue;
+        }
+
+        ext_buf = ev;
+        ext_len = len;
+        // swapping in place would copy every touched page of the private mapping, it is cheaper to copy the event
+        // only the event header is swapped here, the rest is swapped on demand by ScanBanks
+        if (swapped) {
+            if (buffer.size() < len) {
+                buffer.resize(len);
+            }
+            std::copy(ev, ev + len, buffer.begin());
+            ext_buf = &buffer[0];
+            swap_words(ext_buf, BankHeader::size());
+            struct_swapped = false;
+            all_swapped = false;
+            data_banks.clear();
+        }
+        return status::success;
+    }
+}
+
+status EvMappedChannel::Seek(const EvIndexEntry &entry)
+{
+    size_t ev = entry.offset/sizeof(uint32_t);
+    if (!words || (entry.offset % sizeof(uint32_t)) || (ev >= nwords) || (ev < entry.blkpos)) {
+        return status::failure;
+    }
+
+    blk_next = ev - entry.blkpos;
+    last_block = false;
+    auto stat = nextBlock();
+    if (stat != status::success) {
+        return stat;
+    }
+    // the index does not point to the dictionary
+    skip_dict = false;
+    if (ev >= blk_end) {
+        return status::failure;
+    }
+    pos = ev;
+    return status::success;
+}
+
+void EvMappedChannel::SwapEvent()
+{
+    if (!swapped || !ext_buf || all_swapped) {
+        return;
+    }
+
+    all_swapped = true;
+    // nothing but the event header has been swapped, let evio swap the event according to its structure
+    if (!struct_swapped) {
+        swap_words(ext_buf, BankHeader::size());
+        evioswap(ext_buf, 1, nullptr);
+        return;
+    }
+
+    // the structure of a physics event is known, swap the rest of data banks
+    for (auto &db : data_banks) {
+        if (!db.swapped) {
+            swap_data(ext_buf + db.iword, db.len, db.type);
+            db.swapped = true;
+        }
+    }
+}
+
+// swap the trigger bank, and the headers of ROC banks and data banks
+void EvMappedChannel::swapStructure(uint32_t *buf, size_t evend)
+{
+    size_t iword = BankHeader::size();
+
+    // trigger bank
+    if (iword + BankHeader::size() > evend) {
+        return;
+    }
+    swap_words(buf + iword, BankHeader::size());
+    BankHeader tbank(buf + iword);
+    size_t tend = std::min<size_t>(iword + tbank.length + 1, evend);
+    iword += BankHeader::size();
+    if ((tbank.type == DATA_SEGMENT) || (tbank.type == DATA_ALSOSEGMENT)) {
+        while (iword < tend) {
+            swap_words(buf + iword, SegmentHeader::size());
+            SegmentHeader seg(buf + iword);
+            iword += SegmentHeader::size();
+            swap_data(buf + iword, std::min<size_t>(seg.num, tend - iword), seg.type);
+            iword += seg.num;
+        }
+    } else {
+        swap_words(buf + iword, tend - iword);
+    }
+    iword = tend;
+
+    // ROC banks
+    while (iword + BankHeader::size() <= evend) {
+        swap_words(buf + iword, BankHeader::size());
+        BankHeader roc(buf + iword);
+        size_t rend = std::min<size_t>(iword + roc.length + 1, evend);
+        iword += BankHeader::size();
+        if ((roc.type == DATA_BANK) || (roc.type == DATA_ALSOBANK)) {
+            while (iword + BankHeader::size() <= rend) {
+                swap_words(buf + iword, BankHeader::size());
+                BankHeader bh(buf + iword);
+                iword += BankHeader::size();
+                size_t len = std::min<size_t>(bh.length ? bh.length - 1 : 0, rend - iword);
+                data_banks.push_back(DataBankRef{iword, len, bh.tag, bh.type, false});
+                iword += len;
+            }
+        } else {
+            swap_words(buf + iword, rend - iword);
+        }
+        iword = rend;
+    }
+}
+
+void EvMappedChannel::prepareScan(const std::vector<uint32_t> &banks)
+{
+    if (!swapped || !ext_buf || all_swapped) {
+        return;
+    }
+
+    if (!struct_swapped) {
+        swapStructure(ext_buf, std::min<size_t>(ext_buf[0] + 1, ext_len));
+        struct_swapped = true;
+    }
+
+    // only the data banks to be scanned are swapped
+    for (auto &db : data_banks) {
+        if (db.swapped || (std::find(banks.begin(), banks.end(), db.tag) == banks.end())) {
+            continue;
+        }
+        swap_data(ext_buf + db.iword, db.len, db.type);
+        db.swapped = true;
+    }
+}
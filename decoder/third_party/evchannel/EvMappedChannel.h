@@ -0,0 +1,76 @@
+//=============================================================================
+// Class EvMappedChannel                                                     ||
+// Read event from CODA evio file through a memory map, events are handed    ||
+// out in place without copying                                              ||
+// A byte-swapped file is copied event by event, and only the banks touched  ||
+// by ScanBanks are swapped                                                  ||
+//                                                                           ||
+// Only evio version 4 block headers are parsed here, other versions should  ||
+// use the evio library reader (EvChannel)                                   ||
+//=============================================================================
+#pragma once
+
+#include "EvChannel.h"
+#include "EvIndex.h"
+#include <string>
+#include <vector>
+
+
+namespace evc {
+
+class EvMappedChannel : public EvChannel
+{
+public:
+    EvMappedChannel();
+    virtual ~EvMappedChannel() { Close(); }
+
+    EvMappedChannel(const EvMappedChannel &)  = delete;
+    void operator =(const EvMappedChannel &)  = delete;
+
+    virtual status Open(const std::string &path);
+    virtual void Close();
+    virtual status Read();
+
+    // position the channel so that the next Read returns the indexed event
+    status Seek(const EvIndexEntry &entry);
+    // swap the whole current event, for the users that parse the raw buffer by themselves
+    void SwapEvent();
+
+    // the file was written with a different endianness
+    bool IsSwapped() const { return swapped; }
+    uint64_t GetFileSize() const { return map_bytes; }
+    // location of the current event in the file
+    uint64_t GetEventOffset() const { return cur_pos*sizeof(uint32_t); }
+    uint32_t GetEventBlockPos() const { return cur_pos - cur_blk; }
+
+protected:
+    // swap the structure and the interested data banks of the current event (swapped files only)
+    virtual void prepareScan(const std::vector<uint32_t> &banks);
+
+private:
+    // a data bank inside a ROC bank, recorded when the event structure is swapped
+    struct DataBankRef
+    {
+        size_t iword, len;
+        uint32_t tag, type;
+        bool swapped;
+    };
+
+    status nextBlock();
+    void releasePages();
+    void swapStructure(uint32_t *buf, size_t evend);
+
+    int fd;
+    uint32_t *words;
+    size_t nwords, map_bytes;
+    // word offsets of the next event, the end of current block, and the next block header
+    size_t pos, blk_end, blk_next, released;
+    // word offsets of the current event and its block header
+    size_t cur_pos, cur_blk, blk_beg;
+    bool swapped, last_block, skip_dict;
+    // lazy swapping status of the current event
+    bool struct_swapped, all_swapped;
+    std::vector<DataBankRef> data_banks;
+};
+
+}   // namespace evc
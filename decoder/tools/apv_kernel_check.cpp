@@ -0,0 +1,279 @@
+/*  A program to check the vectorized APV zero suppression kernels against the scalar ones on recorded data
+ *  Every decoded APV is zero suppressed once with each kernel set supported by this CPU, the hit strips,
+ *  their time sample values and the offline common modes must be identical to those from the scalar kernels
+ *  It also reports the time spent in the zero suppression with each kernel set
+ *  With --synthetic, no input file or configuration is needed: random APV frames (pedestals, noise, common
+ *  modes and signal pulses) go through the zero suppression steps with each kernel set, and the buffers,
+ *  common modes and hit masks must be identical to those from the scalar kernels
+ */
+
+#include "ConfigArgs.h"
+#include "EvChannel.h"
+#include "GEMSystem.h"
+#include "GEMAPV.h"
+#include "GEMAPVKernels.h"
+#include "hardcode.h"
+#include "MPDSSPRawEventDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+#define CODA_PHY1 0xFF50
+#define CODA_PHY2 0xFF70
+#define PROGRESS_COUNT 1000
+#define SYNTHETIC_FRAMES 100000
+
+using namespace std::chrono;
+
+
+struct ZeroSupResult
+{
+    std::vector<GEM_Strip_Data> hits;
+    std::vector<int> common_mode;
+};
+
+bool same_result(const ZeroSupResult &r1, const ZeroSupResult &r2)
+{
+    if ((r1.hits.size() != r2.hits.size()) || (r1.common_mode != r2.common_mode)) {
+        return false;
+    }
+    for (size_t i = 0; i < r1.hits.size(); ++i) {
+        if ((r1.hits[i].addr.strip != r2.hits[i].addr.strip) || (r1.hits[i].values != r2.hits[i].values)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// the zero suppression steps of GEMAPV on a random frame with a kernel set
+struct SyntheticResult
+{
+    std::vector<float> buf;
+    std::vector<float> sorting_cm, danning_cm;
+    bool hits[APV_STRIP_SIZE];
+};
+
+static void synthetic_zero_sup(const apv_kernels::KernelSet &kernels, const std::vector<float> &raw, uint32_t nts,
+                               const float *offset, const float *noise, float gain, float thres,
+                               float range_min, float range_max, SyntheticResult &res)
+{
+    res.buf = raw;
+    res.sorting_cm.clear();
+    res.danning_cm.clear();
+    for (uint32_t ts = 0; ts < nts; ++ts) {
+        float *buf = &res.buf[ts*MPD_APV_TS_LEN];
+        kernels.subtract_pedestal(buf, offset, APV_STRIP_SIZE);
+        res.danning_cm.push_back(kernels.common_mode_danning(buf, noise, APV_STRIP_SIZE,
+                                                             range_min, range_max, DANNING_ALGORITHM_RMS_THRESHOLD));
+        float average = kernels.common_mode_sorting(buf, APV_STRIP_SIZE);
+        res.sorting_cm.push_back(average);
+        kernels.subtract_value(buf, average, APV_STRIP_SIZE);
+        kernels.scale(buf, gain, APV_STRIP_SIZE);
+    }
+    kernels.zero_sup_mask(res.buf.data(), MPD_APV_TS_LEN, nts, noise, thres, res.hits, APV_STRIP_SIZE);
+}
+
+static bool same_result(const SyntheticResult &r1, const SyntheticResult &r2)
+{
+    // bitwise, the kernels must give identical floats
+    return (std::memcmp(r1.buf.data(), r2.buf.data(), r1.buf.size()*sizeof(float)) == 0)
+        && (std::memcmp(r1.sorting_cm.data(), r2.sorting_cm.data(), r1.sorting_cm.size()*sizeof(float)) == 0)
+        && (std::memcmp(r1.danning_cm.data(), r2.danning_cm.data(), r1.danning_cm.size()*sizeof(float)) == 0)
+        && (std::memcmp(r1.hits, r2.hits, sizeof(r1.hits)) == 0);
+}
+
+int check_synthetic(int nframes, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uni(0., 1.);
+    std::normal_distribution<float> gaus(0., 1.);
+
+    auto kernels = apv_kernels::Available();
+    std::vector<double> elapsed(kernels.size(), 0.);
+    std::vector<size_t> nbad(kernels.size(), 0);
+    std::vector<SyntheticResult> results(kernels.size());
+    size_t nhits = 0;
+
+    float offset[APV_STRIP_SIZE], noise[APV_STRIP_SIZE];
+    std::vector<float> raw;
+    for (int i = 0; i < nframes; ++i) {
+        // a new APV (pedestals) every 100 frames
+        if (i % 100 == 0) {
+            for (uint32_t s = 0; s < APV_STRIP_SIZE; ++s) {
+                offset[s] = std::round(400. + 800.*uni(rng)) + 0.01f*std::round(100.*uni(rng));
+                noise[s] = 5. + 25.*uni(rng);
+            }
+        }
+        // 3, 6 or 9 time samples, like the MPD settings
+        uint32_t nts = 3*(1 + rng() % 3);
+        float gain = 0.8 + 0.4*uni(rng);
+        float thres = (i % 2) ? 5. : 3.;
+        float range_min = (i % 3) ? -200. : 0., range_max = (i % 3) ? 200. : 5000.;
+
+        // pedestal + noise + common mode per time sample + a few pulses, integer ADC as decoded
+        raw.assign(nts*MPD_APV_TS_LEN, 0.);
+        int npulses = rng() % 8;
+        std::vector<int> pulse_strip(npulses), pulse_peak(npulses);
+        std::vector<float> pulse_amp(npulses);
+        for (int k = 0; k < npulses; ++k) {
+            pulse_strip[k] = rng() % APV_STRIP_SIZE;
+            pulse_peak[k] = rng() % nts;
+            pulse_amp[k] = 50. + 1500.*uni(rng);
+        }
+        for (uint32_t ts = 0; ts < nts; ++ts) {
+            float cm = 300.*gaus(rng);
+            for (uint32_t s = 0; s < APV_STRIP_SIZE; ++s) {
+                float val = offset[s] + cm + noise[s]*gaus(rng);
+                for (int k = 0; k < npulses; ++k) {
+                    int ds = (int)s - pulse_strip[k], dt = (int)ts - pulse_peak[k];
+                    if (std::abs(ds) <= 2) {
+                        val += pulse_amp[k]*std::exp(-0.5*ds*ds - 0.5*dt*dt);
+                    }
+                }
+                raw[ts*MPD_APV_TS_LEN + s] = std::round(std::min(std::max(val, 0.f), 4095.f));
+            }
+        }
+
+        for (size_t k = 0; k < kernels.size(); ++k) {
+            auto start = steady_clock::now();
+            synthetic_zero_sup(*kernels[k], raw, nts, offset, noise, gain, thres, range_min, range_max, results[k]);
+            elapsed[k] += duration_cast<duration<double>>(steady_clock::now() - start).count();
+            if ((k > 0) && !same_result(results[0], results[k])) {
+                if (nbad[k]++ < 10) {
+                    std::cout << "Frame " << i << ": " << kernels[k]->name
+                              << " kernels differ from the scalar kernels." << std::endl;
+                }
+            }
+        }
+        nhits += std::count(results[0].hits, results[0].hits + APV_STRIP_SIZE, true);
+    }
+
+    std::cout << "Checked " << nframes << " synthetic APV frames (seed " << seed << "), "
+              << nhits << " hit strips." << std::endl;
+    int ret = 0;
+    for (size_t k = 0; k < kernels.size(); ++k) {
+        std::cout << std::setw(10) << kernels[k]->name << ": "
+                  << nbad[k] << " mismatched frames, "
+                  << std::fixed << std::setprecision(1) << (nframes ? elapsed[k]/nframes*1e9 : 0.) << " ns per frame"
+                  << std::endl;
+        if (nbad[k]) { ret = -1; }
+    }
+    return ret;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // the synthetic check needs no input file
+    bool synthetic = std::find(argv + 1, argv + argc, std::string("--synthetic")) != argv + argc;
+
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    if (!synthetic) {
+        arg_parser.AddPositional("evio_file", "input evio file");
+    }
+    arg_parser.AddSwitch("--synthetic", "synthetic", "check the kernels on random APV frames instead of an evio file");
+    arg_parser.AddArg<int>("--seed", "seed", "random seed of the synthetic frames", 12345);
+    arg_parser.AddArg<std::string>("-c", "gem_config", "gem system configuration file", "config/gem.conf");
+    arg_parser.AddArg<int>("-b", "bank", "data bank tag of the MPD (SSP) data", 10);
+    arg_parser.AddArg<int>("-n", "nev", "number of events (synthetic frames) to check (< 0 means all, or "
+                           + std::to_string(SYNTHETIC_FRAMES) + " frames)", -1);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    if (synthetic) {
+        int nframes = args["nev"].Int();
+        return check_synthetic((nframes < 0) ? SYNTHETIC_FRAMES : nframes, args["seed"].Int());
+    }
+
+    std::string path = args["evio_file"].String();
+    uint32_t bank = args["bank"].Int();
+    int nev = args["nev"].Int();
+
+    GEMSystem gem_sys;
+    gem_sys.Configure(args["gem_config"].String());
+    gem_sys.ReadPedestalFile();
+    MPDSSPRawEventDecoder gem_decoder;
+    gem_decoder.SetAPVList(gem_sys.GetAPVAddressList());
+
+    evc::EvChannel chan;
+    if (chan.Open(path) != evc::status::success) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
+        return -1;
+    }
+
+    auto kernels = apv_kernels::Available();
+    std::vector<double> elapsed(kernels.size(), 0.);
+    std::vector<size_t> nbad(kernels.size(), 0);
+    size_t napvs = 0;
+    int count = 0;
+
+    std::vector<ZeroSupResult> results(kernels.size());
+    while (((nev < 0) || (count < nev)) && (chan.Read() == evc::status::success)) {
+        auto tag = chan.GetEvHeader().tag;
+        if (((tag != CODA_PHY1) && (tag != CODA_PHY2)) || !chan.ScanBanks({bank})) {
+            continue;
+        }
+        if (++count % PROGRESS_COUNT == 0) {
+            std::cout << "Checked " << count << " events, " << napvs << " APVs.\r" << std::flush;
+        }
+
+        for (auto &it : chan.GetEvBuffers()) {
+            if (it.first.bank != bank) {
+                continue;
+            }
+            for (size_t iblk = 0; iblk < it.second.size(); ++iblk) {
+                size_t buflen;
+                const uint32_t *dbuf = chan.GetEvBuffer(it.first.roc, it.first.bank, it.first.slot, iblk, buflen);
+                std::vector<int> ivec{(int)it.first.bank, (int)it.first.roc};
+                gem_decoder.Decode(dbuf, buflen, ivec);
+
+                for (auto &id : gem_decoder.GetDecodedAPVs()) {
+                    auto &addr = gem_decoder.GetAPVAddress(id);
+                    GEMAPV *apv = gem_sys.GetAPV(addr);
+                    if (!apv) {
+                        continue;
+                    }
+                    napvs++;
+
+                    // the raw data is refilled for each kernel set since the zero suppression works in place
+                    for (size_t k = 0; k < kernels.size(); ++k) {
+                        apv_kernels::Select(kernels[k]->name);
+                        apv->FillRawDataMPD(gem_decoder.GetAPVData(id), MPDSSPRawEventDecoder::APV_DATA_SIZE,
+                                            gem_decoder.GetAPVDataFlags(id));
+                        auto start = steady_clock::now();
+                        apv->ZeroSuppression();
+                        elapsed[k] += duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+                        results[k].hits.clear();
+                        apv->CollectZeroSupHits(results[k].hits);
+                        results[k].common_mode = apv->GetOfflineCommonMode();
+                        if ((k > 0) && !same_result(results[0], results[k])) {
+                            if (nbad[k]++ < 10) {
+                                std::cout << "Event " << count << ", APV " << addr << ": " << kernels[k]->name
+                                          << " kernels differ from the scalar kernels." << std::endl;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    chan.Close();
+
+    std::cout << "Checked " << count << " events, " << napvs << " APVs." << std::endl;
+    int ret = 0;
+    for (size_t k = 0; k < kernels.size(); ++k) {
+        std::cout << std::setw(10) << kernels[k]->name << ": "
+                  << nbad[k] << " mismatched APVs, "
+                  << std::fixed << std::setprecision(1) << (napvs ? elapsed[k]/napvs*1e9 : 0.) << " ns per APV"
+                  << std::endl;
+        if (nbad[k]) { ret = -1; }
+    }
+    return ret;
+}
@@ -0,0 +1,200 @@
+/*  A program to measure the parsing of the EPICS events
+ *  The EPICS text banks are loaded from an evio file into the memory, then they are parsed for a few passes by the
+ *  previous parser (lines and tokens copied to strings, values by std::stod, channels updated and copied to the tree
+ *  data by name) and by EPICSystem::FillRawData
+ *  It reports the time and the memory allocations per event, and checks that both give the same channel values
+ */
+
+#include "ConfigArgs.h"
+#include "EvChannel.h"
+#include "EPICSystem.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <unordered_map>
+
+#define CODA_EPICS 0x83
+#define EPICS_UNDEFINED_VALUE -9999.9
+
+using namespace std::chrono;
+
+
+// count the memory allocations of the program
+static std::atomic<size_t> n_allocs{0};
+
+void *operator new(size_t size)
+{
+    n_allocs++;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+
+// the previous parser and tree filling, for comparison
+struct LegacyParser
+{
+    std::unordered_map<std::string, uint32_t> epics_map;
+    std::vector<float> epics_values;
+    std::string current_timestamp;
+    std::unordered_map<std::string, float> tree_data;
+
+    LegacyParser(const EPICSystem &sys)
+        : epics_map(sys.GetEpicsMap()), epics_values(sys.GetCurrentValues())
+    {
+        for (auto &it : epics_map) {
+            tree_data[it.first] = EPICS_UNDEFINED_VALUE;
+        }
+    }
+
+    void Fill(const char *data)
+    {
+        std::string raw_data(data);
+
+        std::vector<std::string> vec;
+        size_t start = 0, end = 0;
+        for (; end <= raw_data.size(); end++) {
+            if ((int)raw_data[end] != 10 && end != raw_data.size())
+                continue;
+            if (end == start)
+                continue;
+            vec.push_back(raw_data.substr(start, end - start));
+            start = end + 1;
+        }
+        if (vec.empty()) {
+            return;
+        }
+
+        current_timestamp = vec[0];
+
+        std::vector<std::pair<std::string, float>> cache;
+        for (size_t i = 1; i < vec.size(); i++) {
+            std::istringstream iss(vec[i]);
+            std::string tmp;
+            std::vector<std::string> v_split;
+            while (iss >> tmp) {
+                v_split.push_back(tmp);
+            }
+            if (v_split.size() == 2) {
+                float val = 0;
+                try {
+                    val = std::stod(v_split[1]);
+                } catch (...) {
+                }
+                cache.emplace_back(v_split[0], val);
+            }
+        }
+
+        for (auto &c : cache) {
+            auto it = epics_map.find(c.first);
+            if (it != epics_map.end()) {
+                epics_values[it->second] = c.second;
+            }
+        }
+
+        for (auto &i : tree_data) {
+            auto it = epics_map.find(i.first);
+            i.second = (it != epics_map.end()) ? epics_values[it->second] : EPICS_UNDEFINED_VALUE;
+        }
+    }
+};
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddPositional("evio_file", "input evio file");
+    arg_parser.AddArg<std::string>("-m", "epics_map", "epics channel map", "config/epics_map.txt");
+    arg_parser.AddArg<int>("-n", "nev", "number of epics events to load (< 0 means all)", -1);
+    arg_parser.AddArg<int>("-r", "repeat", "number of passes over the loaded events", 100);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    std::string path = args["evio_file"].String();
+    int nev = args["nev"].Int();
+    int repeat = std::max(args["repeat"].Int(), 2);
+
+    EPICSystem epic_sys(args["epics_map"].String());
+    LegacyParser legacy(epic_sys);
+
+    // load the epics events, with a null word behind each one as in the replay
+    evc::EvChannel chan;
+    if (chan.Open(path) != evc::status::success) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
+        return -1;
+    }
+
+    std::vector<std::vector<uint32_t>> events;
+    while (((nev < 0) || ((int)events.size() < nev)) && (chan.Read() == evc::status::success)) {
+        auto evh = chan.GetEvHeader();
+        if (evh.tag != CODA_EPICS) {
+            continue;
+        }
+        auto raw = chan.GetRawBuffer();
+        std::vector<uint32_t> buf(raw, raw + evh.length + 1);
+        buf.push_back(0);
+        events.push_back(std::move(buf));
+    }
+    chan.Close();
+
+    std::cout << "Loaded " << events.size() << " epics events, " << epic_sys.GetEpicsMap().size()
+              << " channels in the map." << std::endl;
+    if (events.empty()) {
+        return -1;
+    }
+
+    // the text starts behind the event and bank headers
+    auto text = [](const std::vector<uint32_t> &buf) { return (const char*)(buf.data() + 4); };
+
+    // compare the values event by event
+    size_t mismatches = 0;
+    for (auto &buf : events) {
+        legacy.Fill(text(buf));
+        epic_sys.FillRawData(text(buf));
+        auto &values = epic_sys.GetCurrentValues();
+        for (auto &it : epic_sys.GetEpicsMap()) {
+            if (std::memcmp(&values[it.second], &legacy.tree_data[it.first], sizeof(float)) != 0) {
+                mismatches++;
+            }
+        }
+        if (legacy.current_timestamp != epic_sys.GetCurrentTimeStamp()) {
+            mismatches++;
+        }
+    }
+
+    auto run = [&](const char *name, const std::function<void(const char*)> &parse) {
+        double sec = 0.;
+        size_t allocs = 0;
+        for (int r = 0; r < repeat; ++r) {
+            size_t nalloc = n_allocs;
+            auto start = steady_clock::now();
+            for (auto &buf : events) {
+                parse(text(buf));
+            }
+            sec += duration_cast<duration<double>>(steady_clock::now() - start).count();
+            if (r > 0) {
+                allocs += n_allocs - nalloc;
+            }
+        }
+        std::cout << std::setw(8) << name << ": " << std::fixed << std::setprecision(2)
+                  << sec/(events.size()*repeat)*1e6 << " us per event, "
+                  << (double)allocs/(events.size()*(repeat - 1)) << " allocations per event" << std::endl;
+    };
+
+    run("legacy", [&](const char *buf) { legacy.Fill(buf); });
+    run("parser", [&](const char *buf) { epic_sys.FillRawData(buf); });
+
+    std::cout << mismatches << " mismatched values" << std::endl;
+    return mismatches ? -1 : 0;
+}
@@ -0,0 +1,123 @@
+/*  A program to measure the sustained reading rate from an ET system
+ *  One should start an ET system first (et_start with JLab ET library) and run this program, then use the et_feeder
+ *  to feed an evio file to the same ET system
+ *  The events are read with the chosen EtChannel mode (copy, direct or threaded) and scanned for the data banks,
+ *  the rate is reported every second and for the whole run
+ */
+
+#include "ConfigArgs.h"
+#include "EtConfigWrapper.h"
+#include "EtChannel.h"
+#include <csignal>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+using namespace std::chrono;
+
+
+volatile std::sig_atomic_t gSignalStatus;
+
+
+void signal_handler(int signal) {
+    gSignalStatus = signal;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddArg<std::string>("-h", "host", "host address of the ET system", "localhost");
+    arg_parser.AddArg<int>("-p", "port", "port to connect ET system", 11111);
+    arg_parser.AddArg<std::string>("-f", "et_file", "path to the memory mapped et file", "/tmp/et_feeder");
+    arg_parser.AddArg<std::string>("-s", "station", "name of the ET station", "MONITOR");
+    arg_parser.AddArg<std::string>("-m", "mode", "read mode: copy, direct or threaded", "threaded");
+    arg_parser.AddArg<int>("-c", "chunk", "number of ET events to get at a time", 100);
+    arg_parser.AddArg<int>("-r", "ring", "number of event slots for the threaded mode", 1024);
+    arg_parser.AddArg<int>("-t", "time", "seconds to run after the first event (<= 0 means until control-C)", 0);
+    arg_parser.AddSwitch("-b", "blocking", "blocking station, so no events are skipped for this reader");
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    std::string mode = args["mode"].String();
+
+    evc::EtChannel et_chan;
+    if (mode == "direct") {
+        et_chan.SetReadMode(evc::EtReadMode::direct);
+    } else if (mode == "threaded") {
+        et_chan.SetReadMode(evc::EtReadMode::threaded, args["ring"].Int());
+    } else if (mode != "copy") {
+        std::cerr << "Unknown read mode " << mode << std::endl;
+        return -1;
+    }
+    et_chan.GetConfig().set_cue(args["chunk"].Int());
+    if (args["blocking"].Bool()) {
+        et_chan.GetConfig().set_block(ET_STATION_BLOCKING);
+    }
+
+    if (et_chan.Connect(args["host"].String(), args["port"].Int(), args["et_file"].String()) != evc::status::success ||
+        et_chan.Open(args["station"].String()) != evc::status::success) {
+        std::cerr << "Failed to open ET channel" << std::endl;
+        return -1;
+    }
+
+    // install signal handler
+    std::signal(SIGINT, signal_handler);
+    std::cout << "Listening to ET system with the " << mode << " mode, now you can feed the data to it." << std::endl;
+
+    long count = 0, last_count = 0, nwords = 0;
+    int run_time = args["time"].Int();
+    steady_clock::time_point start, last, end;
+    bool loop = true;
+    while (loop) {
+        if (gSignalStatus == SIGINT) {
+            std::cout << "\nReceived control-C, exiting..." << std::endl;
+            break;
+        }
+        // the run time is also checked when the ET system is drained
+        auto now = steady_clock::now();
+        if ((count > 0) && (run_time > 0) && (now - start >= seconds(run_time))) {
+            break;
+        }
+
+        switch (et_chan.Read()) {
+        case evc::status::success:
+            break;
+        case evc::status::empty:
+            std::this_thread::sleep_for(microseconds(100));
+            continue;
+        default:
+            loop = false;
+            continue;
+        }
+
+        if (count == 0) {
+            start = last = now;
+        }
+        end = now;
+        // touch the event structure as a decoder would
+        et_chan.Scan();
+        nwords += et_chan.GetEvHeader().length + 1;
+        count++;
+
+        if (now - last >= seconds(1)) {
+            double sec = duration_cast<duration<double>>(now - last).count();
+            std::cout << "Received " << count << " events, " << std::fixed << std::setprecision(0)
+                      << (count - last_count)/sec << " events/s.\r" << std::flush;
+            last = now;
+            last_count = count;
+        }
+    }
+
+    // the time between the first and the last event
+    double sec = duration_cast<duration<double>>(end - start).count();
+    std::cout << "\nReceived " << count << " events (" << std::fixed << std::setprecision(1) << nwords*4./1e6
+              << " MB) in " << std::setprecision(2) << sec
+              << " s, " << std::setprecision(0) << ((sec > 0.) ? count/sec : 0.) << " events/s." << std::endl;
+
+    et_chan.Close();
+    et_chan.Disconnect();
+    return 0;
+}
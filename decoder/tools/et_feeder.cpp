@@ -1,16 +1,22 @@
 /*  A program to feed evio file to an ET system event-by-event
  *  ET system can be opened with et_start with the JLab ET library and its executables
+ *  The events are fed in chunks (et_events_new/et_events_put), paced by an interval, a target rate, or as fast as
+ *  possible, and the file can be looped over (optionally preloaded into memory) to stress-test the ET consumers
+ *  It reports the achieved rates and the percentiles of the chunk latency (from getting the new ET events to putting
+ *  them back) and of the lag behind the pacing schedule
  */
 #include "ConfigArgs.h"
 #include "EtConfigWrapper.h"
 #include "EvChannel.h"
+#include <algorithm>
 #include <csignal>
+#include <cstring>
 #include <thread>
 #include <chrono>
 #include <iostream>
 #include <iomanip>
-
-#define PROGRESS_COUNT 100
+#include <random>
+#include <vector>
 
 using namespace std::chrono;
 
@@ -23,6 +29,51 @@ void signal_handler(int signal) {
 }
 
 
+// sleep until the time point, the last part is a busy wait for a precise pacing
+void wait_until(steady_clock::time_point t)
+{
+    auto spin = microseconds(100);
+    if (t - steady_clock::now() > spin) {
+        std::this_thread::sleep_until(t - spin);
+    }
+    while (steady_clock::now() < t) {}
+}
+
+// latencies in microseconds, a fixed size random sample is kept (reservoir sampling) for the long runs
+struct LatencySample
+{
+    std::vector<double> values;
+    size_t n = 0, max_size = 1000000;
+    std::mt19937_64 rng{12345};
+
+    void Add(double val)
+    {
+        n++;
+        if (values.size() < max_size) {
+            values.push_back(val);
+        } else {
+            size_t i = std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+            if (i < max_size) {
+                values[i] = val;
+            }
+        }
+    }
+};
+
+void print_percentiles(const std::string &name, LatencySample &sample)
+{
+    auto &lat = sample.values;
+    if (lat.empty()) {
+        return;
+    }
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&lat] (double p) { return lat[std::min(lat.size() - 1, static_cast<size_t>(p*lat.size()))]; };
+    std::cout << name << " (us): p50 = " << std::fixed << std::setprecision(1) << pct(0.50)
+              << ", p90 = " << pct(0.90) << ", p99 = " << pct(0.99) << ", p99.9 = " << pct(0.999)
+              << ", max = " << lat.back() << std::endl;
+}
+
+
 int main(int argc, char* argv[])
 {
     // setup input arguments
@@ -32,9 +83,27 @@ int main(int argc, char* argv[])
     arg_parser.AddArg<std::string>("-h", "host", "host address of the ET system", "localhost");
     arg_parser.AddArg<int>("-p", "port", "port to connect ET system", 11111);
     arg_parser.AddArg<std::string>("-f", "et_file", "path to the memory mapped et file", "/tmp/et_feeder");
-    arg_parser.AddArg<int>("-i", "interval", "interval in milliseconds to write data", 100);
+    arg_parser.AddArg<int>("-i", "interval", "interval in milliseconds to write data (if no rate is given)", 100);
+    arg_parser.AddArg<double>("-r", "rate", "target rate in Hz (<= 0 means using the interval)", 0.);
+    arg_parser.AddArg<int>("-c", "chunk", "number of events fed to the ET system at a time", 1);
+    arg_parser.AddArg<int>("-l", "loops", "number of passes over the file (<= 0 means until control-C)", 1);
+    arg_parser.AddArg<int>("-n", "nev", "number of events to feed (< 0 means no limit)", -1);
+    arg_parser.AddSwitch("-m", "max_speed", "feed the events as fast as possible, no pacing");
+    arg_parser.AddSwitch("--preload", "preload", "load the events into the memory first, so the file reading is not timed");
 
     auto args = arg_parser.ParseArgs(argc, argv);
+    std::string path = args["evio_file"].String();
+    int loops = args["loops"].Int();
+    long nev = args["nev"].Int();
+    size_t chunk = std::max(args["chunk"].Int(), 1);
+    bool preload = args["preload"].Bool();
+
+    // time between two events
+    duration<double> period(0.);
+    if (!args["max_speed"].Bool()) {
+        double rate = args["rate"].Double();
+        period = (rate > 0.) ? duration<double>(1./rate) : duration<double>(args["interval"].Int()*1e-3);
+    }
 
     et_sys_id et_id;
     et_att_id att_id;
@@ -64,62 +133,154 @@ int main(int argc, char* argv[])
 
     // evio file reader
     evc::EvChannel chan;
-    if (chan.Open(args["evio_file"].String()) != evc::status::success) {
-        std::cerr << "Failed to open coda file \"" << args["evio_file"] << "\"." << std::endl;
+    if (chan.Open(path) != evc::status::success) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
         return -1;
     }
 
+    // preloaded events
+    std::vector<std::vector<uint32_t>> events;
+    if (preload) {
+        while (((nev < 0) || ((long)events.size() < nev)) && (chan.Read() == evc::status::success)) {
+            auto buf = chan.GetRawBuffer();
+            events.emplace_back(buf, buf + buf[0] + 1);
+        }
+        chan.Close();
+        std::cout << "Preloaded " << events.size() << " events." << std::endl;
+        if (events.empty()) {
+            return -1;
+        }
+    }
+
+    // the next event to feed, loop over the file
+    int pass = 1;
+    size_t iev = 0;
+    auto next_event = [&] () -> const uint32_t* {
+        if (preload) {
+            if (iev >= events.size()) {
+                if ((loops > 0) && (pass >= loops)) {
+                    return nullptr;
+                }
+                pass++;
+                iev = 0;
+            }
+            return events[iev++].data();
+        }
+        if (chan.Read() == evc::status::success) {
+            return chan.GetRawBuffer();
+        }
+        if ((loops > 0) && (pass >= loops)) {
+            return nullptr;
+        }
+        chan.Close();
+        pass++;
+        if ((chan.Open(path) != evc::status::success) || (chan.Read() != evc::status::success)) {
+            return nullptr;
+        }
+        return chan.GetRawBuffer();
+    };
+
     // install signal handler
     std::signal(SIGINT, signal_handler);
-    int count = 0;
-    et_event *ev;
-    while ((chan.Read() == evc::status::success) && et_alive(et_id)) {
+    long count = 0, last_count = 0;
+    double nbytes_total = 0.;
+    std::vector<et_event*> pe(chunk);
+    // events of the current chunk, copied from the file reader since its buffer is reused by the next read
+    std::vector<const uint32_t*> pending(chunk);
+    std::vector<std::vector<uint32_t>> copies(preload ? 0 : chunk);
+    LatencySample latency, lag;
+
+    auto start = steady_clock::now(), last = start;
+    bool done = false;
+    while (!done && et_alive(et_id)) {
         if (gSignalStatus == SIGINT) {
             std::cout << "Received control-C, exiting..." << std::endl;
             break;
         }
-        system_clock::time_point start(system_clock::now());
-        system_clock::time_point next(start + std::chrono::milliseconds(args["interval"].Int()));
 
-        if (++count % PROGRESS_COUNT == 0) {
-            std::cout << "Read and fed " << count << " events to ET.\r" << std::flush;
+        // collect a chunk
+        size_t nchunk = 0, max_bytes = 0;
+        for (; (nchunk < chunk) && ((nev < 0) || (count + (long)nchunk < nev)); ++nchunk) {
+            auto buf = next_event();
+            if (!buf) {
+                done = true;
+                break;
+            }
+            if (!preload) {
+                copies[nchunk].assign(buf, buf + buf[0] + 1);
+                buf = copies[nchunk].data();
+            }
+            pending[nchunk] = buf;
+            max_bytes = std::max(max_bytes, (buf[0] + 1)*sizeof(uint32_t));
         }
-
-        uint32_t *buf = chan.GetRawBuffer();
-        size_t nbytes = (buf[0] + 1)*sizeof(uint32_t);
-
-        /*
-        std::cout << std::hex << std::setfill('0');
-        for (size_t i = 0; i < buf[0] + 1; ++i) {
-            std::cout << "0x" << std::setw(8) << buf[i] << "\n";
+        if (!nchunk) {
+            break;
+        }
+        if ((nev >= 0) && (count + (long)nchunk >= nev)) {
+            done = true;
         }
-        std::cout << std::dec;
-        */
 
-        status = et_event_new(et_id, att_id, &ev, ET_SLEEP, nullptr, nbytes);
-        if (status != ET_OK) {
-            std::cerr << "Failed to add new event to the ET system." << std::endl;
-            return -1;
+        // pacing by the schedule of the first event in the chunk, so the rate does not drift
+        auto scheduled = start + duration_cast<steady_clock::duration>(period*count);
+        if (period.count() > 0.) {
+            wait_until(scheduled);
         }
-        // build et event
-        void *data;
-        et_event_getdata(ev, &data);
-        memcpy((void *) data, (const void *)buf, nbytes);
-        et_event_setlength(ev, nbytes);
-
-        // put back the event
-        status = et_event_put(et_id, att_id, ev);
-        if (status != ET_OK) {
-            std::cerr << "Failed to put event back to the ET system." << std::endl;
-            return -1;
+        auto t0 = steady_clock::now();
+        if (period.count() > 0.) {
+            lag.Add(duration_cast<duration<double, std::micro>>(t0 - scheduled).count());
+        }
+
+        // the ET system may give less events than requested
+        for (size_t i = 0; i < nchunk;) {
+            int nread = 0;
+            status = et_events_new(et_id, att_id, &pe[0], ET_SLEEP, nullptr, max_bytes, nchunk - i, &nread);
+            if (status != ET_OK) {
+                std::cerr << "Failed to add new events to the ET system." << std::endl;
+                return -1;
+            }
+            // build et events
+            for (int k = 0; k < nread; ++k, ++i) {
+                void *data;
+                size_t bytes = (pending[i][0] + 1)*sizeof(uint32_t);
+                et_event_getdata(pe[k], &data);
+                memcpy(data, (const void *)pending[i], bytes);
+                et_event_setlength(pe[k], bytes);
+                nbytes_total += bytes;
+            }
+
+            // put back the events
+            status = et_events_put(et_id, att_id, &pe[0], nread);
+            if (status != ET_OK) {
+                std::cerr << "Failed to put events back to the ET system." << std::endl;
+                return -1;
+            }
         }
+        auto t1 = steady_clock::now();
+        latency.Add(duration_cast<duration<double, std::micro>>(t1 - t0).count());
+        count += nchunk;
 
-        std::this_thread::sleep_until(next);
+        if (t1 - last >= seconds(1)) {
+            double sec = duration_cast<duration<double>>(t1 - last).count();
+            std::cout << "Read and fed " << count << " events to ET, " << std::fixed << std::setprecision(0)
+                      << (count - last_count)/sec << " Hz.\r" << std::flush;
+            last = t1;
+            last_count = count;
+        }
     }
-    std::cout << "Read and fed " << count << " events to ET" << std::endl;
 
-    chan.Close();
+    double sec = duration_cast<duration<double>>(steady_clock::now() - start).count();
+    std::cout << "Read and fed " << count << " events to ET in " << std::fixed << std::setprecision(2) << sec
+              << " s (" << pass << " pass" << ((pass > 1) ? "es" : "") << " over the file), "
+              << std::setprecision(0) << count/sec << " Hz, " << std::setprecision(1)
+              << nbytes_total/sec/1e6 << " MB/s." << std::endl;
+    print_percentiles("Chunk latency", latency);
+    print_percentiles("Schedule lag", lag);
+
+    if (!preload) {
+        chan.Close();
+    }
+    et_station_detach(et_id, att_id);
+    et_close(et_id);
     return 0;
 
 }
-
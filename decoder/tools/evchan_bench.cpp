@@ -0,0 +1,234 @@
+/*  A program to compare the evio library reader (EvChannel) and the memory-mapped reader (EvMappedChannel)
+ *  It first reads the two channels side by side to check that they deliver the same events and bank buffers,
+ *  then measures the throughput of each reader separately
+ *  With banks to scan, the buffers of the addresses found in the first physics event are retrieved for every
+ *  event, optionally through the compiled bank lookup (-l)
+ *  The file is read through the page cache, drop the caches (or read a file larger than the memory)
+ *  before each run to measure the cold-cache performance, with one reader per run (-m)
+ */
+
+#include "ConfigArgs.h"
+#include "EvChannel.h"
+#include "EvMappedChannel.h"
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+
+#define CODA_PHY1 0xFF50
+#define CODA_PHY2 0xFF70
+
+using namespace std::chrono;
+
+
+// comma separated bank tags
+std::vector<uint32_t> parse_banks(const std::string &str)
+{
+    std::vector<uint32_t> res;
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.size()) {
+            res.push_back(std::stoul(item, nullptr, 0));
+        }
+    }
+    return res;
+}
+
+inline bool is_physics(const evc::EvChannel &chan)
+{
+    auto tag = chan.GetEvHeader().tag;
+    return (tag == CODA_PHY1) || (tag == CODA_PHY2);
+}
+
+// read both channels event by event, returns the number of mismatched events
+int compare(const std::string &path, const std::vector<uint32_t> &banks, int nev, bool lookup)
+{
+    evc::EvChannel ev_chan;
+    evc::EvMappedChannel map_chan;
+    if ((ev_chan.Open(path) != evc::status::success) || (map_chan.Open(path) != evc::status::success)) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
+        return -1;
+    }
+
+    int count = 0, nbad = 0;
+    bool compiled = false;
+    while ((nev < 0) || (count < nev)) {
+        auto st1 = ev_chan.Read();
+        auto st2 = map_chan.Read();
+        if (st1 != st2) {
+            std::cout << "Event " << count << ": different read status " << (int)st1 << " vs. " << (int)st2 << std::endl;
+            nbad++;
+            break;
+        }
+        if (st1 != evc::status::success) {
+            break;
+        }
+
+        auto h1 = ev_chan.GetEvHeader(), h2 = map_chan.GetEvHeader();
+        bool same = (h1.length == h2.length) && (h1.tag == h2.tag) && (h1.type == h2.type);
+        // a swapped file is only partially swapped by the mapped reader, compare the scanned banks instead
+        if (same && !map_chan.IsSwapped()) {
+            same = !std::memcmp(ev_chan.GetRawBuffer(), map_chan.GetRawBuffer(), (h1.length + 1)*sizeof(uint32_t));
+        }
+        if (same && banks.size() && is_physics(ev_chan)) {
+            bool scanned = ev_chan.ScanBanks(banks);
+            // the buffers of compiled addresses are not in the map
+            if (lookup && !compiled) {
+                std::vector<evc::BufferAddress> addrs;
+                for (auto &it : ev_chan.GetEvBuffers()) {
+                    addrs.push_back(it.first);
+                }
+                map_chan.CompileLookup(addrs);
+                compiled = true;
+            }
+            same = (scanned == map_chan.ScanBanks(banks))
+                && (ev_chan.GetEventType() == map_chan.GetEventType())
+                && (ev_chan.GetTriggerTime() == map_chan.GetTriggerTime());
+            for (auto &it : map_chan.GetEvBuffers()) {
+                same = same && ev_chan.TryGetEvBuffer(it.first.roc, it.first.bank, it.first.slot);
+            }
+            for (auto &it : ev_chan.GetEvBuffers()) {
+                if (!same) { break; }
+                auto &a = it.first;
+                auto &infos = it.second;
+                auto minfos = map_chan.TryGetEvBuffer(a.roc, a.bank, a.slot);
+                if (!minfos || (minfos->size() != infos.size())) {
+                    same = false;
+                    break;
+                }
+                for (size_t i = 0; i < infos.size() && same; ++i) {
+                    size_t len1, len2;
+                    auto b1 = ev_chan.GetEvBuffer(a.roc, a.bank, a.slot, i, len1);
+                    auto b2 = map_chan.GetEvBuffer(a.roc, a.bank, a.slot, i, len2);
+                    same = (len1 == len2) && !std::memcmp(b1, b2, len1*sizeof(uint32_t));
+                }
+            }
+        }
+
+        if (!same) {
+            std::cout << "Event " << count << ": mismatched data between the two readers." << std::endl;
+            nbad++;
+        }
+        count++;
+    }
+
+    std::cout << "Compared " << count << " events, " << nbad << " mismatched." << std::endl;
+    return nbad;
+}
+
+// read through the file, returns the elapsed time in seconds
+double bench(evc::EvChannel &chan, const std::string &path, const std::vector<uint32_t> &banks, int nev, bool lookup,
+             size_t &nevents, size_t &nbytes)
+{
+    std::vector<evc::BufferAddress> addrs;
+    nevents = nbytes = 0;
+    auto start = steady_clock::now();
+    if (chan.Open(path) != evc::status::success) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
+        return -1.;
+    }
+
+    // touch every word so the mapped reader actually pages in the data
+    uint32_t sum = 0;
+    while (((nev < 0) || ((int)nevents < nev)) && (chan.Read() == evc::status::success)) {
+        auto evh = chan.GetEvHeader();
+        if (banks.size()) {
+            if (is_physics(chan)) {
+                chan.ScanBanks(banks);
+                if (addrs.empty()) {
+                    for (auto &it : chan.GetEvBuffers()) {
+                        addrs.push_back(it.first);
+                    }
+                    if (lookup) {
+                        chan.CompileLookup(addrs);
+                    }
+                }
+                for (auto &a : addrs) {
+                    auto infos = chan.TryGetEvBuffer(a.roc, a.bank, a.slot);
+                    for (size_t i = 0; infos && i < infos->size(); ++i) {
+                        size_t len;
+                        sum += *chan.TryGetEvBuffer(a.roc, a.bank, a.slot, i, len) + len;
+                    }
+                }
+            }
+        } else {
+            auto buf = chan.GetRawBuffer();
+            for (size_t i = 0; i <= evh.length; ++i) {
+                sum += buf[i];
+            }
+        }
+        nevents++;
+        nbytes += (evh.length + 1)*sizeof(uint32_t);
+    }
+    chan.Close();
+
+    double sec = duration_cast<duration<double>>(steady_clock::now() - start).count();
+    // keep the checksum alive
+    if (sum == 0xFFFFFFFF) { std::cout << " "; }
+    return sec;
+}
+
+void print_result(const std::string &name, double sec, size_t nevents, size_t nbytes)
+{
+    std::cout << std::setw(10) << name << ": "
+              << nevents << " events, "
+              << std::fixed << std::setprecision(1) << nbytes/1024./1024. << " MB in "
+              << std::setprecision(3) << sec << " s, "
+              << std::setprecision(1) << nbytes/1024./1024./sec << " MB/s, "
+              << std::setprecision(0) << nevents/sec << " events/s"
+              << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddPositional("evio_file", "input evio file");
+    arg_parser.AddArg<int>("-n", "nev", "number of events to read (< 0 means all)", -1);
+    arg_parser.AddArg<std::string>("-b", "banks", "comma separated data bank tags to scan, "
+                                   "empty means only reading through the raw events", "");
+    arg_parser.AddArg<int>("-r", "repeat", "number of repeated measurements for each reader", 1);
+    arg_parser.AddArg<int>("-c", "check", "compare the events from the two readers before measuring", 1);
+    arg_parser.AddArg<int>("-l", "lookup", "use the compiled bank lookup when scanning banks", 0);
+    arg_parser.AddArg<std::string>("-m", "reader", "reader to measure, evread, mmap or both", "both");
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    std::string path = args["evio_file"].String();
+    auto banks = parse_banks(args["banks"].String());
+    int nev = args["nev"].Int();
+    bool lookup = args["lookup"].Int();
+    std::string reader = args["reader"].String();
+    bool use_evread = (reader == "evread") || (reader == "both");
+    bool use_mmap = (reader == "mmap") || (reader == "both");
+    if (!use_evread && !use_mmap) {
+        std::cerr << "Unknown reader " << reader << std::endl;
+        return -1;
+    }
+
+    if (args["check"].Int() && (compare(path, banks, nev, lookup) != 0)) {
+        return -1;
+    }
+
+    for (int i = 0; i < args["repeat"].Int(); ++i) {
+        size_t nevents, nbytes;
+        if (use_evread) {
+            evc::EvChannel ev_chan;
+            double sec = bench(ev_chan, path, banks, nev, lookup, nevents, nbytes);
+            if (sec < 0.) { return -1; }
+            print_result("evRead", sec, nevents, nbytes);
+        }
+
+        if (use_mmap) {
+            evc::EvMappedChannel map_chan;
+            double sec = bench(map_chan, path, banks, nev, lookup, nevents, nbytes);
+            if (sec < 0.) { return -1; }
+            print_result("mmap", sec, nevents, nbytes);
+        }
+    }
+
+    return 0;
+}
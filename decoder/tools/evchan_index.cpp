@@ -0,0 +1,70 @@
+/*  A program to build the event index file (<evio_file>.idx) for CODA evio files
+ *  The index records the location, tag, trigger type and TI timestamp of every event,
+ *  analyze_tracking (-i) and EvioFileReader::ReadEventNum use it to jump to events directly
+ */
+
+#include "ConfigArgs.h"
+#include "EvIndex.h"
+#include <map>
+#include <iostream>
+#include <iomanip>
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddPositional("evio_file", "input evio file");
+    arg_parser.AddArg<int>("-f", "force", "rebuild the index even if a valid index file exists", 0);
+    arg_parser.AddArg<int>("-p", "print", "print the first N index entries", 0);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    std::string path = args["evio_file"].String();
+
+    evc::EvIndex index;
+    if (args["force"].Int() || (index.Load(path) != evc::status::success)) {
+        if (index.Build(path) != evc::status::success) {
+            std::cerr << "Failed to build the event index for \"" << path << "\"." << std::endl;
+            return -1;
+        }
+        if (index.Save(path) != evc::status::success) {
+            std::cerr << "Failed to save the event index to \"" << evc::EvIndex::IndexPath(path) << "\"." << std::endl;
+            return -1;
+        }
+        std::cout << "Saved event index to " << evc::EvIndex::IndexPath(path) << std::endl;
+    }
+
+    // summary
+    std::map<uint32_t, size_t> tags, triggers;
+    for (auto &entry : index.GetEntries()) {
+        tags[entry.tag]++;
+        if (evc::EvIndex::IsPhysics(entry.tag)) {
+            triggers[entry.trigger]++;
+        }
+    }
+
+    std::cout << index.Size() << " events indexed." << std::endl;
+    std::cout << std::hex;
+    for (auto &it : tags) {
+        std::cout << "  tag 0x" << it.first << ": " << std::dec << it.second << std::hex << " events" << std::endl;
+    }
+    std::cout << std::dec;
+    for (auto &it : triggers) {
+        std::cout << "  trigger type " << it.first << ": " << it.second << " physics events" << std::endl;
+    }
+
+    int nprint = std::min<int>(args["print"].Int(), index.Size());
+    for (int i = 0; i < nprint; ++i) {
+        auto &entry = index[i];
+        std::cout << std::setw(8) << i
+                  << " offset " << std::setw(12) << entry.offset
+                  << " length " << std::setw(8) << entry.length
+                  << " tag 0x" << std::hex << entry.tag << std::dec
+                  << " trigger " << std::setw(3) << entry.trigger
+                  << " timestamp " << entry.timestamp
+                  << std::endl;
+    }
+
+    return 0;
+}
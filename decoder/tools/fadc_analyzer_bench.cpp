@@ -0,0 +1,276 @@
+/*  A program to measure the FADC250 decoding and waveform analysis speed on recorded window raw data
+ *  The FADC250 data blocks are loaded into the memory first, the decoding into one reused event is timed and the
+ *  memory allocations counted (should be zero after the first pass), then the waveforms are analyzed in three ways:
+ *      brute: the brute-force peak search and pedestal windows only (every window computed from scratch)
+ *      fresh: the analyzer with new scratch buffers for every waveform
+ *      reuse: the analyzer with one set of scratch buffers reused for all the waveforms
+ *  The peak candidates and pedestals from the analyzer are checked against the brute-force ones first
+ */
+
+#include "ConfigArgs.h"
+#include "EvChannel.h"
+#include "Fadc250Decoder.h"
+#include "WfAnalyzer.h"
+#include "TSpectrum.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <new>
+
+#define CODA_PHY1 0xFF50
+#define CODA_PHY2 0xFF70
+
+using namespace std::chrono;
+
+
+// count the memory allocations of the program
+static std::atomic<size_t> n_allocs{0};
+
+void *operator new(size_t size)
+{
+    n_allocs++;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+
+// brute-force peak candidates search, the peak range is searched from every candidate
+std::vector<fdec::Peak> brute_maxima(const std::vector<double> &buffer, double height_thres)
+{
+    std::vector<fdec::Peak> candidates;
+    if (buffer.size() < 3) { return candidates; }
+
+    auto trend = [] (double v1, double v2, double thr = 0.1) {
+        return std::abs(v1 - v2) < thr ? 0 : (v1 > v2 ? 1 : -1);
+    };
+    for (uint32_t i = 1; i < buffer.size() - 1; ++i) {
+        int tr1 = trend(buffer[i], buffer[i - 1]);
+        int tr2 = trend(buffer[i], buffer[i + 1]);
+        if ((tr1 * tr2 >= 0) && (std::abs(tr1) > 0)) {
+            uint32_t left = 1, right = 1;
+            while ((i > left + 1) && (trend(buffer[i - left], buffer[i - left - 1]) == tr1)) {
+                left ++;
+            }
+            while ((i + right < buffer.size() - 1) && (trend(buffer[i + right], buffer[i + right + 1])*tr1 >= 0)) {
+                right ++;
+            }
+            double base = (buffer[i - left] * right + buffer[i + right] * left) / static_cast<double>(left + right);
+            double height = std::abs(buffer[i] - base);
+            if (height > height_thres) {
+                candidates.emplace_back(buffer[i] - base, 0., 0., i, i - left, i + right);
+            }
+        }
+    }
+    return candidates;
+}
+
+// brute-force pedestal search, the mean and error are computed from scratch for every window
+fdec::Pedestal brute_pedestal(const std::vector<double> &buffer, size_t npeds, double flat, uint32_t overflow)
+{
+    fdec::Pedestal ped{0., 0.};
+    if (buffer.size() < npeds) {
+        fdec::_calc_mean_err(ped.mean, ped.err, &buffer[0], buffer.size());
+        for (auto &val : buffer) {
+            if (val < ped.mean) { ped.mean = val; }
+        }
+        return ped;
+    }
+
+    size_t ntrails = std::max(npeds, buffer.size()/12);
+    double max_mean = overflow*0.95;
+    bool find_baseline = false;
+    ped.mean = max_mean;
+    for (size_t i = 0; i <= buffer.size() - ntrails; ++i) {
+        double mean = 0., err = 100.*flat;
+        fdec::_calc_mean_err(mean, err, &buffer[i], ntrails);
+        if (err < flat && mean < max_mean) {
+            find_baseline = true;
+            if (mean < ped.mean) { ped.mean = mean; ped.err = err; }
+        }
+    }
+    if (find_baseline) {
+        return ped;
+    }
+
+    auto ybuf = buffer;
+    TSpectrum s;
+    s.Background(&ybuf[0], ybuf.size(), ybuf.size()/4, TSpectrum::kBackDecreasingWindow,
+                    TSpectrum::kBackOrder2, false, TSpectrum::kBackSmoothing3, false);
+    return fdec::Analyzer::CalcPedestal(&ybuf[ybuf.size()/5], 3*ybuf.size()/5, 1.0, 3, npeds);
+}
+
+bool same_peaks(const std::vector<fdec::Peak> &p1, const std::vector<fdec::Peak> &p2)
+{
+    if (p1.size() != p2.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < p1.size(); ++i) {
+        if ((p1[i].height != p2[i].height) || (p1[i].pos != p2[i].pos)
+            || (p1[i].left != p2[i].left) || (p1[i].right != p2[i].right)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void print_result(const std::string &name, double sec, size_t nwaveforms)
+{
+    std::cout << std::setw(6) << name << ": "
+              << nwaveforms << " waveforms in " << std::fixed << std::setprecision(3) << sec << " s, "
+              << std::setprecision(1) << sec/nwaveforms*1e9 << " ns per waveform"
+              << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddPositional("evio_file", "input evio file");
+    arg_parser.AddArg<int>("-n", "nev", "number of physics events to load (< 0 means all)", 10000);
+    arg_parser.AddArg<int>("-b", "bank", "data bank tag of the FADC250 data", 3);
+    arg_parser.AddArg<int>("-l", "loops", "number of passes over the loaded waveforms", 5);
+    arg_parser.AddArg<int>("-r", "res", "resolution for waveform analysis", 3);
+    arg_parser.AddArg<double>("-t", "thres", "peak threshold for waveform analysis", 10.0);
+    arg_parser.AddArg<int>("-p", "npeds", "sample window width for pedestal searching", 8);
+    arg_parser.AddArg<double>("-f", "flat", "flatness requirement for pedestal searching", 1.0);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    std::string path = args["evio_file"].String();
+    uint32_t bank = args["bank"].Int();
+    int nev = args["nev"].Int();
+    int loops = args["loops"].Int();
+    fdec::Analyzer analyzer(args["res"].Int(), args["thres"].Double(), args["npeds"].Int(), args["flat"].Double());
+
+    // load the waveforms
+    evc::EvChannel chan;
+    if (chan.Open(path) != evc::status::success) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
+        return -1;
+    }
+
+    fdec::Fadc250Decoder decoder;
+    fdec::Fadc250Event event(0, 16);
+    std::vector<std::vector<uint32_t>> blocks, waveforms;
+    int count = 0;
+    while (((nev < 0) || (count < nev)) && (chan.Read() == evc::status::success)) {
+        auto tag = chan.GetEvHeader().tag;
+        if (((tag != CODA_PHY1) && (tag != CODA_PHY2)) || !chan.ScanBanks({bank})) {
+            continue;
+        }
+        count++;
+        for (auto &it : chan.GetEvBuffers()) {
+            if (it.first.bank != bank) {
+                continue;
+            }
+            for (size_t iblk = 0; iblk < it.second.size(); ++iblk) {
+                size_t buflen;
+                auto buf = chan.GetEvBuffer(it.first.roc, it.first.bank, it.first.slot, iblk, buflen);
+                blocks.emplace_back(buf, buf + buflen);
+                decoder.DecodeEvent(event, buf, buflen);
+                for (auto &ch : event.channels) {
+                    if (ch.raw.size()) {
+                        waveforms.push_back(ch.raw);
+                    }
+                }
+            }
+        }
+    }
+    chan.Close();
+    std::cout << "Loaded " << count << " events, " << blocks.size() << " data blocks, "
+              << waveforms.size() << " waveforms." << std::endl;
+    if (waveforms.empty()) {
+        return -1;
+    }
+
+    // decoding into the same event, the first pass is not counted in case the buffers need to grow
+    size_t nblocks = blocks.size()*loops, nsamples = 0;
+    for (auto &blk : blocks) {
+        decoder.DecodeEvent(event, blk.data(), blk.size());
+    }
+    size_t allocs = n_allocs;
+    auto start = steady_clock::now();
+    for (int l = 0; l < loops; ++l) {
+        for (auto &blk : blocks) {
+            decoder.DecodeEvent(event, blk.data(), blk.size());
+            for (auto &ch : event.channels) {
+                nsamples += ch.raw.size();
+            }
+        }
+    }
+    double sec = duration_cast<duration<double>>(steady_clock::now() - start).count();
+    allocs = n_allocs - allocs;
+    std::cout << "decode: " << nblocks << " blocks in " << std::fixed << std::setprecision(3) << sec << " s, "
+              << std::setprecision(1) << sec/nblocks*1e9 << " ns per block, "
+              << nsamples << " samples, " << allocs << " allocations" << std::endl;
+
+    // check the analyzer against the brute-force search
+    fdec::AnalyzerBuffers bufs;
+    size_t nbad = 0;
+    for (auto &raw : waveforms) {
+        auto buffer = fdec::Analyzer::SmoothSpectrum(raw.data(), raw.size(), analyzer.GetResolution());
+        auto candidates = brute_maxima(buffer, analyzer.GetThreshold());
+        auto ped = brute_pedestal(buffer, analyzer.GetNSamplesPed(), args["flat"].Double(),
+                                  analyzer.GetOverflowValue());
+
+        analyzer.SearchMaxima(buffer.data(), buffer.size(), analyzer.GetThreshold(), bufs);
+        auto ped2 = analyzer.FindPedestal(buffer.data(), buffer.size(), bufs);
+        if (!same_peaks(candidates, bufs.candidates) || (ped.mean != ped2.mean) || (ped.err != ped2.err)) {
+            if (nbad++ < 10) {
+                std::cout << "Waveform " << &raw - &waveforms[0] << ": pedestal " << ped.mean << " +- " << ped.err
+                          << " vs. " << ped2.mean << " +- " << ped2.err << ", " << candidates.size()
+                          << " vs. " << bufs.candidates.size() << " peak candidates." << std::endl;
+            }
+        }
+    }
+    std::cout << "Checked " << waveforms.size() << " waveforms, " << nbad << " mismatched." << std::endl;
+
+    // timing, the checksum keeps the results alive
+    double checksum = 0.;
+    size_t nwaveforms = waveforms.size()*loops;
+    fdec::Fadc250Data data;
+
+    start = steady_clock::now();
+    for (int l = 0; l < loops; ++l) {
+        for (auto &raw : waveforms) {
+            auto buffer = fdec::Analyzer::SmoothSpectrum(raw.data(), raw.size(), analyzer.GetResolution());
+            auto candidates = brute_maxima(buffer, analyzer.GetThreshold());
+            auto ped = brute_pedestal(buffer, analyzer.GetNSamplesPed(), args["flat"].Double(),
+                                      analyzer.GetOverflowValue());
+            checksum += ped.mean + candidates.size();
+        }
+    }
+    print_result("brute", duration_cast<duration<double>>(steady_clock::now() - start).count(), nwaveforms);
+
+    start = steady_clock::now();
+    for (int l = 0; l < loops; ++l) {
+        for (auto &raw : waveforms) {
+            fdec::AnalyzerBuffers fresh;
+            data.raw.assign(raw.begin(), raw.end());
+            analyzer.Analyze(data, fresh);
+            checksum += data.ped.mean + data.peaks.size();
+        }
+    }
+    print_result("fresh", duration_cast<duration<double>>(steady_clock::now() - start).count(), nwaveforms);
+
+    start = steady_clock::now();
+    for (int l = 0; l < loops; ++l) {
+        for (auto &raw : waveforms) {
+            data.raw.assign(raw.begin(), raw.end());
+            analyzer.Analyze(data, bufs);
+            checksum += data.ped.mean + data.peaks.size();
+        }
+    }
+    print_result("reuse", duration_cast<duration<double>>(steady_clock::now() - start).count(), nwaveforms);
+
+    std::cout << "Checksum " << std::setprecision(3) << checksum << std::endl;
+    return (nbad || allocs) ? -1 : 0;
+}
@@ -0,0 +1,150 @@
+/*  A program to measure the GEM hit collection and clustering per event
+ *  The GEM data banks are loaded into the memory and the zero suppressed hits of each event are prepared first, then
+ *  the events are reconstructed (strip hits collected from the APVs, clustered and matched to 2D hits) for a few passes
+ *  It reports the time and the memory allocations per event (the first pass is not counted for the allocations since
+ *  the containers grow in it), and a checksum of the clusters to compare the results between builds
+ */
+
+#include "ConfigArgs.h"
+#include "EvChannel.h"
+#include "GEMSystem.h"
+#include "GEMDetector.h"
+#include "GEMPlane.h"
+#include "MPDSSPRawEventDecoder.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <new>
+
+#define CODA_PHY1 0xFF50
+#define CODA_PHY2 0xFF70
+
+using namespace std::chrono;
+
+
+// count the memory allocations of the program
+static std::atomic<size_t> n_allocs{0};
+
+void *operator new(size_t size)
+{
+    n_allocs++;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+
+// checksum of the clusters of all the planes
+double clusters_checksum(GEMSystem &gem_sys, size_t &nclusters)
+{
+    double sum = 0.;
+    for (auto &det : gem_sys.GetDetectorList()) {
+        for (auto &pln : det->GetPlaneList()) {
+            for (auto &c : pln->GetStripClusters()) {
+                nclusters++;
+                sum += c.position*1.1 + c.peak_charge*1.3 + c.total_charge*1.7 + c.hits.size()*3. + c.max_timebin;
+                for (auto &hit : c.hits) {
+                    sum += hit.strip*0.01 + hit.charge*0.001;
+                    for (auto &val : hit.ts_adc) {
+                        sum += val*1e-4;
+                    }
+                }
+            }
+        }
+    }
+    return sum;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddPositional("evio_file", "input evio file");
+    arg_parser.AddArg<std::string>("-c", "gem_config", "gem system configuration file", "config/gem.conf");
+    arg_parser.AddArg<int>("-n", "nev", "number of physics events to load (< 0 means all)", 5000);
+    arg_parser.AddArg<int>("-b", "bank", "data bank tag of the MPD (SSP) data", 10);
+    arg_parser.AddArg<int>("-r", "repeat", "number of passes over the loaded events", 3);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    std::string path = args["evio_file"].String();
+    uint32_t bank = args["bank"].Int();
+    int nev = args["nev"].Int();
+    int repeat = std::max(args["repeat"].Int(), 2);
+
+    GEMSystem gem_sys;
+    gem_sys.Configure(args["gem_config"].String());
+    gem_sys.ReadPedestalFile();
+    MPDSSPRawEventDecoder decoder;
+    decoder.SetAPVList(gem_sys.GetAPVAddressList());
+
+    // load the events and prepare their zero suppressed hits
+    evc::EvChannel chan;
+    if (chan.Open(path) != evc::status::success) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
+        return -1;
+    }
+
+    std::vector<EventData> events;
+    while (((nev < 0) || ((int)events.size() < nev)) && (chan.Read() == evc::status::success)) {
+        auto tag = chan.GetEvHeader().tag;
+        if (((tag != CODA_PHY1) && (tag != CODA_PHY2)) || !chan.ScanBanks({bank})) {
+            continue;
+        }
+        EventData event;
+        for (auto &it : chan.GetEvBuffers()) {
+            if (it.first.bank != bank) {
+                continue;
+            }
+            for (size_t iblk = 0; iblk < it.second.size(); ++iblk) {
+                size_t buflen;
+                auto buf = chan.GetEvBuffer(it.first.roc, it.first.bank, it.first.slot, iblk, buflen);
+                std::vector<int> ivec{(int)it.first.bank, (int)it.first.roc};
+                decoder.Decode(buf, buflen, ivec);
+                gem_sys.FillRawDataMPD(decoder, event, false);
+            }
+        }
+        events.push_back(std::move(event));
+    }
+    chan.Close();
+
+    size_t nhits = 0;
+    for (auto &event : events) {
+        nhits += event.gem_data.size();
+    }
+    std::cout << "Loaded " << events.size() << " events, " << nhits << " zero suppressed strips." << std::endl;
+    if (events.empty()) {
+        return -1;
+    }
+
+    double sec = 0., checksum = 0.;
+    size_t allocs = 0, nclusters = 0;
+    for (int r = 0; r < repeat; ++r) {
+        for (auto &event : events) {
+            size_t nalloc = n_allocs;
+            auto start = steady_clock::now();
+            gem_sys.Reconstruct(event);
+            sec += duration_cast<duration<double>>(steady_clock::now() - start).count();
+            if (r > 0) {
+                allocs += n_allocs - nalloc;
+            } else {
+                checksum += clusters_checksum(gem_sys, nclusters);
+            }
+        }
+    }
+
+    size_t nevents = events.size()*repeat;
+    std::cout << "Reconstructed " << nevents << " events: " << std::fixed
+              << std::setprecision(2) << sec/nevents*1e6 << " us per event, "
+              << (double)allocs/(events.size()*(repeat - 1)) << " allocations per event" << std::endl;
+    std::cout << nclusters << " clusters in the first pass, checksum "
+              << std::setprecision(6) << checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,332 @@
+/*  A program to measure the GEM pedestal generation
+ *  The raw APV data are read from an evio file (pedestal run, zero suppression disabled), decoded and filled to the
+ *  APVs, then the pedestal of every strip and the common mode distribution of every APV are accumulated by
+ *      legacy: every sample is kept in the vectors and filled into TH1F at the end (the previous implementation)
+ *      stream: the streaming statistics of GEMAPV (GEMAPV::FillPedHist and GEMAPV::FitPedestal)
+ *      compare: both, the results are compared as they are written to the gem_ped_*.dat and CommonModeRange_*.txt
+ *  It reports the time of accumulating and fitting, the memory held by the accumulated data and the peak memory of the
+ *  process, so run one mode at a time for the peak memory
+ *  With --check, no input file or configuration is needed: the outlier rejection of the streaming statistics is
+ *  checked on gaussian samples mixed with outliers (signal-like, one-sided), the mean and rms kept must be those of
+ *  the gaussian
+ */
+
+#include "ConfigArgs.h"
+#include "EvChannel.h"
+#include "GEMSystem.h"
+#include "GEMAPV.h"
+#include "GEMRunningStat.h"
+#include "MPDSSPRawEventDecoder.h"
+#include "TH1F.h"
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+#define CODA_PHY1 0xFF50
+#define CODA_PHY2 0xFF70
+#define CHECK_SAMPLES 100000
+
+using namespace std::chrono;
+
+
+// the previous pedestal accumulation of one APV, every sample is kept
+struct LegacyAPVPedestal
+{
+    std::vector<int> offset_vec[APV_STRIP_SIZE];
+    std::vector<int> noise_vec[APV_STRIP_SIZE];
+    std::vector<float> common_mode;
+    float offset[APV_STRIP_SIZE], noise[APV_STRIP_SIZE];
+    float cm_max = 0., cm_avg = 0., cm_rms = 0.;
+
+    void Fill(const GEMAPV &apv)
+    {
+        uint32_t time_samples = apv.GetNTimeSamples();
+        float average[time_samples];
+        for (uint32_t j = 0; j < time_samples; ++j) {
+            auto buf = apv.GetRawTimeSample(j);
+            average[j] = 0.;
+            for (uint32_t i = 0; i < APV_STRIP_SIZE; ++i) {
+                average[j] += buf[i];
+            }
+            average[j] /= (float)APV_STRIP_SIZE;
+        }
+
+        for (uint32_t i = 0; i < APV_STRIP_SIZE; ++i) {
+            float ch_average = 0., noise_average = 0.;
+            for (uint32_t j = 0; j < time_samples; ++j) {
+                float val = apv.GetRawTimeSample(j)[i];
+                ch_average += val;
+                noise_average += val - average[j];
+            }
+            offset_vec[i].push_back(ch_average/time_samples);
+            noise_vec[i].push_back(noise_average/time_samples);
+        }
+        common_mode.insert(common_mode.end(), average, average + time_samples);
+    }
+
+    void Fit()
+    {
+        for (uint32_t i = 0; i < APV_STRIP_SIZE; ++i) {
+            TH1F h("h", "h", 2800, -800, 2000);
+            for (auto &val : noise_vec[i]) {
+                h.Fill((float)val);
+            }
+            double mean = 0, sigma = 5000;
+            if (h.GetEntries() > 0) {
+                mean = h.GetMean();
+                sigma = h.GetRMS();
+            }
+            offset[i] = mean;
+            noise[i] = sigma;
+        }
+
+        if (common_mode.size() > 0) {
+            cm_max = common_mode[0];
+            TH1F h_temp("h_temp", "h_temp", 1500, 0, 1500);
+            for (auto &val : common_mode) {
+                cm_max = std::max(cm_max, val);
+                h_temp.Fill(val);
+            }
+            cm_avg = h_temp.GetMean();
+            cm_rms = h_temp.GetRMS();
+        }
+    }
+
+    size_t Bytes() const
+    {
+        size_t bytes = common_mode.capacity()*sizeof(float);
+        for (uint32_t i = 0; i < APV_STRIP_SIZE; ++i) {
+            bytes += (offset_vec[i].capacity() + noise_vec[i].capacity())*sizeof(int);
+        }
+        return bytes;
+    }
+};
+
+// the pedestal and common mode values as they are written to the files
+std::string format_apv(const float *offset, const float *noise, float cm_max, float cm_avg, float cm_rms)
+{
+    std::ostringstream ss;
+    for (uint32_t i = 0; i < APV_STRIP_SIZE; ++i) {
+        ss << std::setw(16) << std::setprecision(4) << offset[i]
+           << std::setw(16) << std::setprecision(4) << noise[i] << "\n";
+    }
+    ss << std::setprecision(6) << std::setw(12) << static_cast<int>(cm_max)
+       << std::setw(12) << cm_avg << std::setw(12) << cm_rms << "\n";
+    return ss.str();
+}
+
+// values of the APV after GEMAPV::FitPedestal, the common mode is read back from the printout
+std::string format_apv(GEMAPV &apv, const std::string &tmp_path)
+{
+    float offset[APV_STRIP_SIZE], noise[APV_STRIP_SIZE];
+    auto peds = apv.GetPedestalList();
+    for (uint32_t i = 0; i < APV_STRIP_SIZE; ++i) {
+        offset[i] = peds[i].offset;
+        noise[i] = peds[i].noise;
+    }
+
+    int crate, slot, mpd, adc, cm_min, cm_max;
+    float cm_avg, cm_rms;
+    {
+        std::ofstream out(tmp_path);
+        apv.PrintOutCommonModeRange(out);
+        apv.PrintOutCommonModeDBAnaFormat(out);
+    }
+    std::ifstream in(tmp_path);
+    in >> crate >> slot >> mpd >> adc >> cm_min >> cm_max >> crate >> slot >> mpd >> adc >> cm_avg >> cm_rms;
+    return format_apv(offset, noise, cm_max, cm_avg, cm_rms);
+}
+
+
+// the outlier rejection of GEMRunningStat on a gaussian (the strip noise) mixed with outliers (signal hits), the
+// mean and rms kept must be within 1% of the gaussian sigma (mean) and 3% (rms), the statistical errors are ~0.3%
+int check_outlier_rejection(unsigned int seed)
+{
+    const double mean = 0., sigma = 20.;
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> gaus(mean, sigma);
+    std::uniform_real_distribution<double> uni(0., 1.);
+
+    // gem.conf raises nsigma to 3, the narrower windows check the truncation correction where it is large
+    int nbad = 0;
+    for (double nsigma : {0., 2., 2.5, 3., 4., 5.}) {
+        for (double fout : {0., 0.01, 0.05}) {
+            GEMRunningStat stat(-400, 400);
+            stat.SetOutlierRejection(nsigma);
+            for (int i = 0; i < CHECK_SAMPLES; ++i) {
+                double x = (uni(rng) < fout) ? 5.*sigma + 300.*uni(rng) : gaus(rng);
+                stat.Fill(std::round(x));
+            }
+            // no rejection, only the gaussian samples are checked
+            bool checked = (nsigma > 0.) || (fout == 0.);
+            bool good = std::abs(stat.GetMean() - mean) < 0.01*sigma && std::abs(stat.GetRMS()/sigma - 1.) < 0.03;
+            nbad += checked && !good;
+            std::cout << "nsigma " << std::setw(3) << nsigma << ", outliers " << std::setw(4) << fout*100. << "%: "
+                      << std::fixed << std::setprecision(3) << "mean " << std::setw(7) << stat.GetMean()
+                      << ", rms " << std::setw(7) << stat.GetRMS()
+                      << std::setprecision(2) << ", rejected " << 100.*stat.GetRejected()/stat.GetEntries() << "%"
+                      << (checked ? (good ? "" : ", FAILED") : ", not checked") << std::endl;
+            std::cout.unsetf(std::ios::fixed);
+        }
+    }
+
+    std::cout << "Expected mean " << mean << " and rms " << sigma << " of " << CHECK_SAMPLES
+              << " samples (seed " << seed << "), " << nbad << " failed." << std::endl;
+    return nbad ? -1 : 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // the check needs no input file
+    bool check = std::find(argv + 1, argv + argc, std::string("--check")) != argv + argc;
+
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    if (!check) {
+        arg_parser.AddPositional("evio_file", "input evio file");
+    }
+    arg_parser.AddSwitch("--check", "check", "check the outlier rejection on random samples instead of an evio file");
+    arg_parser.AddArg<int>("--seed", "seed", "random seed of the check samples", 12345);
+    arg_parser.AddArg<std::string>("-c", "gem_config", "gem system configuration file", "config/gem.conf");
+    arg_parser.AddArg<int>("-n", "nev", "number of physics events to use (< 0 means all)", 5000);
+    arg_parser.AddArg<int>("-b", "bank", "data bank tag of the MPD (SSP) data", 10);
+    arg_parser.AddArg<std::string>("-m", "mode", "legacy, stream or compare", "compare");
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    if (check) {
+        return check_outlier_rejection(args["seed"].Int());
+    }
+    std::string path = args["evio_file"].String();
+    uint32_t bank = args["bank"].Int();
+    int nev = args["nev"].Int();
+    std::string mode = args["mode"].String();
+    bool legacy = (mode == "legacy") || (mode == "compare");
+    bool stream = (mode == "stream") || (mode == "compare");
+    if (!legacy && !stream) {
+        std::cerr << "Unknown mode " << mode << std::endl;
+        return -1;
+    }
+
+    GEMSystem gem_sys;
+    gem_sys.Configure(args["gem_config"].String());
+    gem_sys.SetPedestalMode(true);
+    MPDSSPRawEventDecoder decoder;
+    decoder.SetAPVList(gem_sys.GetAPVAddressList());
+
+    std::unordered_map<const GEMAPV*, LegacyAPVPedestal> legacy_peds;
+    if (legacy) {
+        for (auto apv : gem_sys.GetAPVList()) {
+            legacy_peds[apv];
+        }
+    }
+
+    evc::EvChannel chan;
+    if (chan.Open(path) != evc::status::success) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
+        return -1;
+    }
+
+    // the events are read and decoded one by one, only the accumulation is timed
+    auto start = steady_clock::now();
+    double sec_legacy = 0., sec_stream = 0.;
+    int count = 0;
+    while (((nev < 0) || (count < nev)) && (chan.Read() == evc::status::success)) {
+        auto tag = chan.GetEvHeader().tag;
+        if (((tag != CODA_PHY1) && (tag != CODA_PHY2)) || !chan.ScanBanks({bank})) {
+            continue;
+        }
+        count++;
+        for (auto &it : chan.GetEvBuffers()) {
+            if (it.first.bank != bank) {
+                continue;
+            }
+            for (size_t iblk = 0; iblk < it.second.size(); ++iblk) {
+                size_t buflen;
+                auto buf = chan.GetEvBuffer(it.first.roc, it.first.bank, it.first.slot, iblk, buflen);
+                std::vector<int> ivec{(int)it.first.bank, (int)it.first.roc};
+                decoder.Decode(buf, buflen, ivec);
+
+                for (auto &id : decoder.GetDecodedAPVs()) {
+                    GEMAPV *apv = gem_sys.GetAPV(decoder.GetAPVAddress(id));
+                    if (!apv) {
+                        continue;
+                    }
+                    apv->FillRawDataMPD(decoder.GetAPVData(id), MPDSSPRawEventDecoder::APV_DATA_SIZE,
+                                        decoder.GetAPVDataFlags(id));
+                    if (legacy) {
+                        auto &ped = legacy_peds[apv];
+                        auto t0 = steady_clock::now();
+                        ped.Fill(*apv);
+                        sec_legacy += duration_cast<duration<double>>(steady_clock::now() - t0).count();
+                    }
+                    if (stream) {
+                        auto t0 = steady_clock::now();
+                        apv->FillPedHist();
+                        sec_stream += duration_cast<duration<double>>(steady_clock::now() - t0).count();
+                    }
+                }
+            }
+        }
+    }
+    chan.Close();
+    std::cout << "Accumulated " << count << " events for " << gem_sys.GetAPVList().size() << " APVs." << std::endl;
+    if (count == 0) {
+        return -1;
+    }
+
+    auto report = [](const std::string &name, double fill_sec, double fit_sec, size_t bytes) {
+        std::cout << std::setw(8) << name << ": " << std::fixed << std::setprecision(3)
+                  << fill_sec << " s accumulating, " << fit_sec << " s fitting, "
+                  << std::setprecision(1) << bytes/1024./1024. << " MB accumulated data" << std::endl;
+    };
+
+    if (legacy) {
+        auto t0 = steady_clock::now();
+        size_t bytes = 0;
+        for (auto &it : legacy_peds) {
+            bytes += it.second.Bytes();
+            it.second.Fit();
+        }
+        report("legacy", sec_legacy, duration_cast<duration<double>>(steady_clock::now() - t0).count(), bytes);
+    }
+    if (stream) {
+        auto t0 = steady_clock::now();
+        gem_sys.FitPedestal();
+        size_t bytes = gem_sys.GetAPVList().size()*(2*APV_STRIP_SIZE + 1)*sizeof(GEMRunningStat);
+        report("stream", sec_stream, duration_cast<duration<double>>(steady_clock::now() - t0).count(), bytes);
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "Total " << std::setprecision(2) << duration_cast<duration<double>>(steady_clock::now() - start).count()
+              << " s, peak memory " << std::setprecision(1) << usage.ru_maxrss/1024. << " MB" << std::endl;
+
+    if (mode != "compare") {
+        return 0;
+    }
+
+    // compare the values written to the pedestal and common mode files
+    int mismatches = 0;
+    std::string tmp_path = "/tmp/gem_pedestal_bench_" + std::to_string(getpid()) + ".txt";
+    for (auto apv : gem_sys.GetAPVList()) {
+        auto &ped = legacy_peds[apv];
+        if (format_apv(ped.offset, ped.noise, ped.cm_max, ped.cm_avg, ped.cm_rms) != format_apv(*apv, tmp_path)) {
+            std::cout << "APV " << apv->GetAddress() << " differs from the legacy results." << std::endl;
+            mismatches++;
+        }
+    }
+    std::remove(tmp_path.c_str());
+    std::cout << mismatches << " mismatched APVs" << std::endl;
+    return mismatches ? -1 : 0;
+}
@@ -0,0 +1,162 @@
+/*  A program to measure the scaling of the GEM APV processing (zero suppression) with the number of threads
+ *  The GEM data banks are loaded into the memory and decoded once for each pass, the decoded APVs of every bank
+ *  are then processed by the GEM system with 1, 2, 4, ... threads (up to -m)
+ *  The hits must be the same as those from processing the APVs one by one (checked with a checksum that does not
+ *  depend on the hit order)
+ */
+
+#include "ConfigArgs.h"
+#include "EvChannel.h"
+#include "GEMSystem.h"
+#include "MPDSSPRawEventDecoder.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#define CODA_PHY1 0xFF50
+#define CODA_PHY2 0xFF70
+
+using namespace std::chrono;
+
+
+struct GEMBank
+{
+    int roc, bank;
+    std::vector<uint32_t> words;
+};
+
+// order-independent checksum of the hits
+uint64_t hits_checksum(const std::vector<GEM_Strip_Data> &hits)
+{
+    uint64_t sum = 0;
+    for (auto &hit : hits) {
+        uint64_t h = (((uint64_t)hit.addr.crate*1000 + hit.addr.mpd)*100 + hit.addr.adc)*1000 + hit.addr.strip;
+        for (auto &val : hit.values) {
+            h = h*1000003 + (uint64_t)(int64_t)(val*1000.);
+        }
+        sum += h*0x9E3779B97F4A7C15ULL;
+    }
+    return sum;
+}
+
+// process all the banks, returns the elapsed time in seconds (decoding excluded)
+double process_banks(GEMSystem &gem_sys, MPDSSPRawEventDecoder &decoder, const std::vector<GEMBank> &banks,
+                     int repeat, bool per_apv, size_t &nhits, uint64_t &checksum)
+{
+    EventData event;
+    double sec = 0.;
+    nhits = 0;
+    checksum = 0;
+    for (int r = 0; r < repeat; ++r) {
+        for (auto &b : banks) {
+            std::vector<int> ivec{b.bank, b.roc};
+            decoder.Decode(b.words.data(), b.words.size(), ivec);
+            event.Clear();
+
+            auto start = steady_clock::now();
+            if (per_apv) {
+                for (auto &id : decoder.GetDecodedAPVs()) {
+                    gem_sys.FillRawDataMPD(decoder.GetAPVAddress(id), decoder.GetAPVData(id),
+                            MPDSSPRawEventDecoder::APV_DATA_SIZE, decoder.GetAPVDataFlags(id), event);
+                }
+            } else {
+                gem_sys.FillRawDataMPD(decoder, event, false);
+            }
+            sec += duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+            nhits += event.gem_data.size();
+            checksum += hits_checksum(event.gem_data);
+        }
+    }
+    return sec;
+}
+
+void print_result(const std::string &name, double sec, size_t nbanks, double ref_sec)
+{
+    std::cout << std::setw(10) << name << ": "
+              << std::fixed << std::setprecision(3) << sec << " s, "
+              << std::setprecision(0) << nbanks/sec << " banks/s, speedup "
+              << std::setprecision(2) << ref_sec/sec
+              << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddPositional("evio_file", "input evio file");
+    arg_parser.AddArg<std::string>("-c", "gem_config", "gem system configuration file", "config/gem.conf");
+    arg_parser.AddArg<int>("-n", "nev", "number of physics events to load (< 0 means all)", 5000);
+    arg_parser.AddArg<int>("-b", "bank", "data bank tag of the MPD (SSP) data", 10);
+    arg_parser.AddArg<int>("-r", "repeat", "number of passes over the loaded events", 3);
+    arg_parser.AddArg<int>("-m", "max_threads", "maximum number of threads, doubled from 1", 32);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    std::string path = args["evio_file"].String();
+    uint32_t bank = args["bank"].Int();
+    int nev = args["nev"].Int();
+    int repeat = args["repeat"].Int();
+    int max_threads = args["max_threads"].Int();
+
+    GEMSystem gem_sys;
+    gem_sys.Configure(args["gem_config"].String());
+    gem_sys.ReadPedestalFile();
+    MPDSSPRawEventDecoder decoder;
+    decoder.SetAPVList(gem_sys.GetAPVAddressList());
+
+    // load the gem banks
+    evc::EvChannel chan;
+    if (chan.Open(path) != evc::status::success) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
+        return -1;
+    }
+
+    std::vector<GEMBank> banks;
+    int count = 0;
+    while (((nev < 0) || (count < nev)) && (chan.Read() == evc::status::success)) {
+        auto tag = chan.GetEvHeader().tag;
+        if (((tag != CODA_PHY1) && (tag != CODA_PHY2)) || !chan.ScanBanks({bank})) {
+            continue;
+        }
+        count++;
+        for (auto &it : chan.GetEvBuffers()) {
+            if (it.first.bank != bank) {
+                continue;
+            }
+            for (size_t iblk = 0; iblk < it.second.size(); ++iblk) {
+                size_t buflen;
+                auto buf = chan.GetEvBuffer(it.first.roc, it.first.bank, it.first.slot, iblk, buflen);
+                banks.push_back(GEMBank{(int)it.first.roc, (int)it.first.bank, std::vector<uint32_t>(buf, buf + buflen)});
+            }
+        }
+    }
+    chan.Close();
+    std::cout << "Loaded " << count << " events, " << banks.size() << " MPD banks." << std::endl;
+    if (banks.empty()) {
+        return -1;
+    }
+
+    size_t nbanks = banks.size()*repeat;
+    size_t ref_hits;
+    uint64_t ref_sum;
+    double ref_sec = process_banks(gem_sys, decoder, banks, repeat, true, ref_hits, ref_sum);
+    std::cout << "Processed " << nbanks << " banks, " << ref_hits << " hits." << std::endl;
+    print_result("per-APV", ref_sec, nbanks, ref_sec);
+
+    int ret = 0;
+    for (int nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+        gem_sys.SetNumberOfThreads(nthreads);
+        size_t nhits;
+        uint64_t sum;
+        double sec = process_banks(gem_sys, decoder, banks, repeat, false, nhits, sum);
+        print_result(std::to_string(nthreads) + " threads", sec, nbanks, ref_sec);
+        if ((nhits != ref_hits) || (sum != ref_sum)) {
+            std::cout << "    hits differ from the per-APV processing: " << nhits << " vs. " << ref_hits << std::endl;
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
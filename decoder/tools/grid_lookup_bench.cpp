@@ -0,0 +1,122 @@
+/*  A program to measure the grid hit sorting and lookup speed of the tracking detectors
+ *  For each hit occupancy (hits per layer), random hits are added to a detector for every event, then random
+ *  projected points are looked up for the hits in their home and neighbor grids (as in the track finding)
+ *  The hits found are checked against a brute-force search over all the hits of the event
+ */
+
+#include "ConfigArgs.h"
+#include "AbstractDetector.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+using namespace std::chrono;
+using namespace tracking_dev;
+
+
+// brute-force search, the hits in each search grid in the order they were added
+std::vector<int> brute_lookup(AbstractDetector &det, const point_t &p)
+{
+    std::vector<int> res;
+    for (auto &addr : det.GetPointHomeGrids(p)) {
+        for (int i = 0; i < (int)det.Get2DHitCounts(); ++i) {
+            int index = det.GetGridIndex(det.Get2DHit(i));
+            if (index == addr.x*det.GetNGridsY() + addr.y) {
+                res.push_back(i);
+            }
+        }
+    }
+    return res;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddArg<int>("-e", "events", "number of events for each occupancy", 2000);
+    arg_parser.AddArg<int>("-q", "queries", "number of projected points looked up per event", 2000);
+    arg_parser.AddArg<double>("-w", "grid_width", "grid width (mm)", 17.2);
+    arg_parser.AddArg<double>("-s", "grid_shift", "grid shift (mm)", 0.4);
+    arg_parser.AddArg<double>("-d", "dimension", "detector size (mm)", 102.4);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    int nev = args["events"].Int();
+    int nqueries = args["queries"].Int();
+    double size = args["dimension"].Double();
+
+    AbstractDetector det;
+    det.SetGridWidth(args["grid_width"].Double(), args["grid_width"].Double());
+    det.SetGridShift(args["grid_shift"].Double());
+    det.SetDimension(point_t(size, size, 0.1));
+    std::cout << "Grids: " << det.GetNGridsX() << " x " << det.GetNGridsY() << std::endl;
+
+    std::mt19937_64 rng(20221);
+    std::uniform_real_distribution<double> pos(-size/2., size/2.);
+
+    int ret = 0;
+    for (int nhits : {50, 100, 200, 500}) {
+        // check first
+        size_t nbad = 0;
+        for (int ev = 0; ev < 20; ++ev) {
+            det.Reset();
+            for (int i = 0; i < nhits; ++i) {
+                det.AddHit(pos(rng), pos(rng));
+            }
+            for (int q = 0; q < 100; ++q) {
+                point_t p(pos(rng), pos(rng), 0.);
+                std::vector<int> found;
+                const int *grids;
+                int ngrids = det.GetPointSearchGrids(p, grids);
+                for (int g = 0; g < ngrids; ++g) {
+                    int n;
+                    const int *hits = det.GetGridHits(grids[g], n);
+                    found.insert(found.end(), hits, hits + n);
+                }
+                nbad += (found != brute_lookup(det, p));
+            }
+        }
+
+        // timing, the checksum keeps the results alive
+        long checksum = 0;
+        double fill_sec = 0., lookup_sec = 0.;
+        for (int ev = 0; ev < nev; ++ev) {
+            auto start = steady_clock::now();
+            det.Reset();
+            for (int i = 0; i < nhits; ++i) {
+                det.AddHit(pos(rng), pos(rng));
+            }
+            // the first lookup sorts the hits
+            int n;
+            det.GetGridHits(0, n);
+            checksum += n;
+            auto mid = steady_clock::now();
+            for (int q = 0; q < nqueries; ++q) {
+                point_t p(pos(rng), pos(rng), 0.);
+                const int *grids;
+                int ngrids = det.GetPointSearchGrids(p, grids);
+                for (int g = 0; g < ngrids; ++g) {
+                    const int *hits = det.GetGridHits(grids[g], n);
+                    checksum += n ? hits[n - 1] : 0;
+                }
+            }
+            auto end = steady_clock::now();
+            fill_sec += duration_cast<duration<double>>(mid - start).count();
+            lookup_sec += duration_cast<duration<double>>(end - mid).count();
+        }
+
+        std::cout << std::setw(4) << nhits << " hits/layer: "
+                  << std::fixed << std::setprecision(1)
+                  << fill_sec/nev*1e9 << " ns per event fill, "
+                  << lookup_sec/nev/nqueries*1e9 << " ns per lookup, "
+                  << nbad << " mismatched (checksum " << checksum << ")"
+                  << std::endl;
+        if (nbad) {
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,147 @@
+/*  A program to measure the MPD (SSP) raw data decoding speed in decoded APV frames per second
+ *  The GEM data banks are loaded into the memory first, then every thread decodes all of them with its own decoder
+ *  Two ways of getting the decoded data are compared:
+ *      flat: the dense APV ids and the flat per-APV buffers (GetDecodedAPVs, GetAPVData)
+ *      map:  the maps keyed by the APV address (GetAPV, GetAPVDataFlags), copied from the flat buffers
+ */
+
+#include "ConfigArgs.h"
+#include "EvChannel.h"
+#include "MPDSSPRawEventDecoder.h"
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <iomanip>
+
+#define CODA_PHY1 0xFF50
+#define CODA_PHY2 0xFF70
+
+using namespace std::chrono;
+
+
+struct GEMBank
+{
+    int roc, bank;
+    std::vector<uint32_t> words;
+};
+
+// decode all banks with one decoder, returns the number of decoded APV frames
+size_t decode_banks(const std::vector<GEMBank> &banks, const std::vector<APVAddress> &apvs, int repeat, bool flat,
+                    int64_t &checksum)
+{
+    MPDSSPRawEventDecoder decoder;
+    decoder.SetAPVList(apvs);
+
+    size_t nframes = 0;
+    int64_t sum = 0;
+    for (int r = 0; r < repeat; ++r) {
+        for (auto &b : banks) {
+            std::vector<int> ivec{b.bank, b.roc};
+            decoder.Decode(b.words.data(), b.words.size(), ivec);
+            if (flat) {
+                for (auto &id : decoder.GetDecodedAPVs()) {
+                    sum += decoder.GetAPVData(id)[0] + decoder.GetAPVDataFlags(id).data_flag;
+                    nframes++;
+                }
+            } else {
+                auto &flags = decoder.GetAPVDataFlags();
+                for (auto &it : decoder.GetAPV()) {
+                    sum += it.second[0] + flags.at(it.first).data_flag;
+                    nframes++;
+                }
+            }
+        }
+    }
+    checksum = sum;
+    return nframes;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddPositional("evio_file", "input evio file");
+    arg_parser.AddArg<int>("-n", "nev", "number of physics events to load (< 0 means all)", 10000);
+    arg_parser.AddArg<int>("-b", "bank", "data bank tag of the MPD (SSP) data", 10);
+    arg_parser.AddArg<int>("-r", "repeat", "number of passes over the loaded events", 5);
+    arg_parser.AddArg<int>("-t", "threads", "number of threads, each with its own decoder", 1);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    std::string path = args["evio_file"].String();
+    uint32_t bank = args["bank"].Int();
+    int nev = args["nev"].Int();
+    int repeat = args["repeat"].Int();
+    int nthreads = std::max(1, args["threads"].Int());
+
+    // load the gem banks
+    evc::EvChannel chan;
+    if (chan.Open(path) != evc::status::success) {
+        std::cerr << "Failed to open coda file \"" << path << "\"." << std::endl;
+        return -1;
+    }
+
+    std::vector<GEMBank> banks;
+    int count = 0;
+    while (((nev < 0) || (count < nev)) && (chan.Read() == evc::status::success)) {
+        auto tag = chan.GetEvHeader().tag;
+        if (((tag != CODA_PHY1) && (tag != CODA_PHY2)) || !chan.ScanBanks({bank})) {
+            continue;
+        }
+        count++;
+        for (auto &it : chan.GetEvBuffers()) {
+            if (it.first.bank != bank) {
+                continue;
+            }
+            for (size_t iblk = 0; iblk < it.second.size(); ++iblk) {
+                size_t buflen;
+                auto buf = chan.GetEvBuffer(it.first.roc, it.first.bank, it.first.slot, iblk, buflen);
+                banks.push_back(GEMBank{(int)it.first.roc, (int)it.first.bank, std::vector<uint32_t>(buf, buf + buflen)});
+            }
+        }
+    }
+    chan.Close();
+
+    // the APVs in the data take the place of the GEM map here
+    std::vector<APVAddress> apvs;
+    {
+        MPDSSPRawEventDecoder decoder;
+        for (auto &b : banks) {
+            std::vector<int> ivec{b.bank, b.roc};
+            decoder.Decode(b.words.data(), b.words.size(), ivec);
+        }
+        for (uint32_t id = 0; id < decoder.GetNumberOfAPVs(); ++id) {
+            apvs.push_back(decoder.GetAPVAddress(id));
+        }
+    }
+    std::cout << "Loaded " << count << " events, " << banks.size() << " MPD banks, " << apvs.size() << " APVs."
+              << std::endl;
+
+    for (int flat = 1; flat >= 0; --flat) {
+        std::vector<size_t> nframes(nthreads);
+        std::vector<int64_t> sums(nthreads);
+        std::vector<std::thread> workers;
+        auto start = steady_clock::now();
+        for (int i = 0; i < nthreads; ++i) {
+            workers.emplace_back([&, i] () {
+                nframes[i] = decode_banks(banks, apvs, repeat, flat, sums[i]);
+            });
+        }
+        for (auto &w : workers) {
+            w.join();
+        }
+        double sec = duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+        size_t total = 0;
+        for (auto n : nframes) {
+            total += n;
+        }
+        std::cout << std::setw(6) << (flat ? "flat" : "map") << ": "
+                  << total << " APV frames in " << std::fixed << std::setprecision(3) << sec << " s, "
+                  << std::setprecision(0) << total/sec << " frames/s (checksum " << sums[0] << ")"
+                  << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,910 @@
+/*  A program to reduce the GEMC simulation files of the beam test for the AI/ML studies (aiml/Pencil_Beam)
+ *  It is the compiled version of aiml/Script_Sim/fileReducer_beamtest_v2.0.C with the same physics, a list of files is
+ *  reduced in parallel (one file at a time per worker thread), only the needed branches are read, and the GEM hits are
+ *  kept in growable buffers instead of the arrays of MAX_CLUSTERS_PER_PLANE (2000)
+ *  Outputs of every input file <name>.root (in the same directory, or in the one given by -d)
+ *      <name>_reduce_tree_rate.root: tree "T" with the same branches as the macro
+ *      <name>_reduce.npz: the same variables as numpy arrays (numpy.load), uncompressed for a fast loading, the GEM
+ *                         hits of all events are concatenated in GEMxx_x/y/vx/vy, GEMxx_n is the number of hits of
+ *                         every event
+ *  A merged npz of all the files (in the order of input, with a file_index column) can be written with -o
+ */
+
+#include "ConfigArgs.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TRandom3.h"
+#include "TROOT.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+
+// ============================================================================
+// npz output, a zip archive of .npy files without compression (numpy.savez)
+// ============================================================================
+
+// a column of 4-byte values, descr is the numpy type string
+struct Column
+{
+    std::string name, descr;
+    std::vector<char> data;
+
+    Column(const std::string &n, const std::string &d) : name(n), descr(d) {}
+
+    template<typename T>
+    void Append(const T *vals, size_t n)
+    {
+        static_assert(sizeof(T) == 4, "columns are 4-byte values");
+        auto p = reinterpret_cast<const char*>(vals);
+        data.insert(data.end(), p, p + n*sizeof(T));
+    }
+    size_t Size() const { return data.size()/4; }
+};
+
+uint32_t crc32_update(uint32_t crc, const char *buf, size_t len)
+{
+    static const auto table = [] () {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            t[i] = c;
+        }
+        return t;
+    } ();
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ static_cast<uint8_t>(buf[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+class NpzWriter
+{
+    struct Entry { std::string name; uint32_t crc; uint64_t size, offset; };
+
+public:
+    // data of an array, it can be split in several columns (the merged output)
+    struct Chunk { const char *data; size_t bytes; };
+
+    bool Open(const std::string &path)
+    {
+        out.open(path, std::ios::binary | std::ios::trunc);
+        entries.clear();
+        pos = 0;
+        return out.is_open();
+    }
+
+    bool Add(const Column &col) { return Add(col.name, col.descr, {{col.data.data(), col.data.size()}}); }
+
+    // the array is the concatenation of the chunks, every element has 4 bytes
+    bool Add(const std::string &name, const std::string &descr, const std::vector<Chunk> &chunks)
+    {
+        uint64_t bytes = 0;
+        for (auto &c : chunks) {
+            bytes += c.bytes;
+        }
+
+        // npy format 1.0, the header is padded to a multiple of 64 bytes
+        std::string header = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': ("
+                           + std::to_string(bytes/4) + ",), }";
+        size_t total = 10 + header.size() + 1;
+        header.append((64 - total%64)%64, ' ');
+        header += '\n';
+        std::string npy = std::string("\x93NUMPY\x01\x00", 8);
+        npy += static_cast<char>(header.size() & 0xFF);
+        npy += static_cast<char>(header.size() >> 8);
+        npy += header;
+
+        Entry e{name + ".npy", 0, npy.size() + bytes, pos};
+        e.crc = crc32_update(0, npy.data(), npy.size());
+        for (auto &c : chunks) {
+            e.crc = crc32_update(e.crc, c.data, c.bytes);
+        }
+
+        // local file header, the sizes go to the zip64 extra field for the large arrays
+        bool zip64 = (e.size >= 0xFFFFFFFFu);
+        std::string buf;
+        put(buf, 0x04034b50u, 4);
+        put(buf, zip64 ? 45 : 20, 2);
+        put(buf, 0, 2);                     // flags
+        put(buf, 0, 2);                     // stored
+        put(buf, 0, 2);                     // time
+        put(buf, 0x21, 2);                  // date, 1980-01-01
+        put(buf, e.crc, 4);
+        put(buf, zip64 ? 0xFFFFFFFFu : e.size, 4);
+        put(buf, zip64 ? 0xFFFFFFFFu : e.size, 4);
+        put(buf, e.name.size(), 2);
+        put(buf, zip64 ? 20 : 0, 2);
+        buf += e.name;
+        if (zip64) {
+            put(buf, 0x0001, 2);
+            put(buf, 16, 2);
+            put(buf, e.size, 8);
+            put(buf, e.size, 8);
+        }
+        write(buf.data(), buf.size());
+        write(npy.data(), npy.size());
+        for (auto &c : chunks) {
+            write(c.data, c.bytes);
+        }
+        entries.push_back(e);
+        return out.good();
+    }
+
+    bool Close()
+    {
+        uint64_t cd_offset = pos;
+        for (auto &e : entries) {
+            // the zip64 extra field has the values that do not fit in the 32-bit fields
+            std::string extra;
+            if (e.size >= 0xFFFFFFFFu) {
+                put(extra, e.size, 8);
+                put(extra, e.size, 8);
+            }
+            if (e.offset >= 0xFFFFFFFFu) {
+                put(extra, e.offset, 8);
+            }
+            std::string buf;
+            put(buf, 0x02014b50u, 4);
+            put(buf, 45, 2);                // made by
+            put(buf, extra.empty() ? 20 : 45, 2);
+            put(buf, 0, 2);
+            put(buf, 0, 2);
+            put(buf, 0, 2);
+            put(buf, 0x21, 2);
+            put(buf, e.crc, 4);
+            put(buf, std::min<uint64_t>(e.size, 0xFFFFFFFFu), 4);
+            put(buf, std::min<uint64_t>(e.size, 0xFFFFFFFFu), 4);
+            put(buf, e.name.size(), 2);
+            put(buf, extra.empty() ? 0 : extra.size() + 4, 2);
+            put(buf, 0, 2);                 // comment
+            put(buf, 0, 2);                 // disk
+            put(buf, 0, 2);                 // internal attributes
+            put(buf, 0, 4);                 // external attributes
+            put(buf, std::min<uint64_t>(e.offset, 0xFFFFFFFFu), 4);
+            buf += e.name;
+            if (!extra.empty()) {
+                put(buf, 0x0001, 2);
+                put(buf, extra.size(), 2);
+                buf += extra;
+            }
+            write(buf.data(), buf.size());
+        }
+        uint64_t cd_size = pos - cd_offset;
+
+        std::string buf;
+        bool zip64 = (cd_offset >= 0xFFFFFFFFu) || (entries.size() >= 0xFFFF);
+        if (zip64) {
+            uint64_t eocd64 = pos;
+            put(buf, 0x06064b50u, 4);
+            put(buf, 44, 8);
+            put(buf, 45, 2);
+            put(buf, 45, 2);
+            put(buf, 0, 4);
+            put(buf, 0, 4);
+            put(buf, entries.size(), 8);
+            put(buf, entries.size(), 8);
+            put(buf, cd_size, 8);
+            put(buf, cd_offset, 8);
+            // locator
+            put(buf, 0x07064b50u, 4);
+            put(buf, 0, 4);
+            put(buf, eocd64, 8);
+            put(buf, 1, 4);
+        }
+        put(buf, 0x06054b50u, 4);
+        put(buf, 0, 2);
+        put(buf, 0, 2);
+        put(buf, std::min<uint64_t>(entries.size(), 0xFFFF), 2);
+        put(buf, std::min<uint64_t>(entries.size(), 0xFFFF), 2);
+        put(buf, std::min<uint64_t>(cd_size, 0xFFFFFFFFu), 4);
+        put(buf, std::min<uint64_t>(cd_offset, 0xFFFFFFFFu), 4);
+        put(buf, 0, 2);
+        write(buf.data(), buf.size());
+
+        out.close();
+        return !out.fail();
+    }
+
+private:
+    // little endian values
+    static void put(std::string &buf, uint64_t val, int nbytes)
+    {
+        for (int i = 0; i < nbytes; ++i) {
+            buf += static_cast<char>((val >> (8*i)) & 0xFF);
+        }
+    }
+
+    void write(const char *data, size_t bytes)
+    {
+        out.write(data, bytes);
+        pos += bytes;
+    }
+
+    std::ofstream out;
+    std::vector<Entry> entries;
+    uint64_t pos = 0;
+};
+
+
+// ============================================================================
+// reduction of a GEMC file, see aiml/Script_Sim/fileReducer_beamtest_v2.0.C
+// ============================================================================
+
+// Cherenkov photon energies (eV) and the quantum efficiency of the LAPPD with WLS, from analysis_tree_solid_hgc.C
+static const int n_qe = 41;
+static const double photon_energy[n_qe + 1] = {
+    2.04358, 2.0664, 2.09046, 2.14023, 2.16601, 2.20587, 2.23327, 2.26137, 2.31972, 2.35005, 2.38116, 2.41313,
+    2.44598, 2.47968, 2.53081, 2.58354, 2.6194, 2.69589, 2.73515, 2.79685, 2.86139, 2.95271, 3.04884, 3.12665,
+    3.2393, 3.39218, 3.52508, 3.66893, 3.82396, 3.99949, 4.13281, 4.27679, 4.48244, 4.65057, 4.89476, 5.02774,
+    5.16816, 5.31437, 5.63821, 5.90401, 6.19921, 6.49921,
+};
+static const double qe_lappd_wls[n_qe] = {
+    2.87e-2, 3.23e-2, 3.48e-2, 4.20e-2, 5.42e-2, 6.39e-2, 7.26e-2, 9.06e-2, 10.68e-2, 11.52e-2, 12.05e-2, 12.88e-2,
+    13.59e-2, 14.36e-2, 14.77e-2, 15.06e-2, 15.54e-2, 16.12e-2, 16.45e-2, 16.19e-2, 15.77e-2, 15.47e-2, 15.31e-2,
+    15.35e-2, 15.43e-2, 15.32e-2, 15.12e-2, 15.17e-2, 14.48e-2, 13.92e-2, 13.23e-2, 13.57e-2, 14.43e-2, 14.23e-2,
+    13.93e-2, 14.23e-2, 14.02e-2, 14.36e-2, 14.74e-2, 15.14e-2, 13.09e-2
+};
+// safety factor for the PMT and assembly effective area
+static const double qe_factor = 0.8;
+// quad readout, 4x4 sensors in the sector
+static const int hgc_sensors = 16, hgc_sensors_1d = 4;
+
+// a branch of std::vector in the GEMC trees, the vector is owned here instead of allocated by ROOT
+template<typename T>
+struct BranchVec
+{
+    std::vector<T> data, *ptr = &data;
+
+    BranchVec() = default;
+    BranchVec(const BranchVec &) = delete;
+    void operator =(const BranchVec &) = delete;
+
+    bool Connect(TTree *tree, const char *name)
+    {
+        tree->SetBranchStatus(name, 1);
+        return tree->SetBranchAddress(name, &ptr) >= 0;
+    }
+    size_t size() const { return data.size(); }
+    T operator [](size_t i) const { return data[i]; }
+};
+
+struct GEMPlaneHits
+{
+    int n = 0, np = 0;
+    std::vector<float> x, y, vx, vy;
+
+    GEMPlaneHits() { Clear(); }
+    // the capacity is kept, it is reserved so the branch addresses are never null
+    void Clear()
+    {
+        n = 0;
+        for (auto v : {&x, &y, &vx, &vy}) {
+            v->clear();
+            v->reserve(64);
+        }
+    }
+    void Add(float lx, float ly, float gx, float gy)
+    {
+        x.push_back(lx);
+        y.push_back(ly);
+        vx.push_back(gx);
+        vy.push_back(gy);
+        n++;
+    }
+};
+
+// variables of the reduced tree, the values are kept through the events as in the macro (e.g., the SCx_Eend are
+// only updated when the primary particle hits the plane)
+struct ReducedEvent
+{
+    float rate = 0., vx = 0., vy = 0., vz = 0., px = 0., py = 0., pz = 0., p = 0.;
+    int pid = 0;
+    float PreShP = 0., PreShPx = 0., PreShPy = 0., PreShPz = 0., PreShSum = 0., PreSh_l = 0., PreSh_r = 0., PreSh_t = 0.;
+    float ShowerSum = 0., Shower_l = 0., Shower_r = 0., Shower_t = 0.;
+    float SC0_P = 0., SC0_Eendsum = 0., SC0_Eend = 0., SC1_P = 0., SC1_Eendsum = 0., SC1_Eend = 0.;
+    float SPD_P = 0., SPD_Eendsum = 0., SPD_Eend = 0., LASPD_P = 0., LASPD_Eendsum = 0., LASPD_Eend = 0.;
+    GEMPlaneHits gem[2];
+    float Npesum = 0.;
+};
+
+// the scalar branches before the GEM planes, in the order of the macro
+struct ScalarVar { const char *name; float ReducedEvent::*fval; int ReducedEvent::*ival; };
+static const std::vector<ScalarVar> scalar_vars = {
+    {"rate", &ReducedEvent::rate, nullptr}, {"vx", &ReducedEvent::vx, nullptr}, {"vy", &ReducedEvent::vy, nullptr},
+    {"vz", &ReducedEvent::vz, nullptr}, {"px", &ReducedEvent::px, nullptr}, {"py", &ReducedEvent::py, nullptr},
+    {"pz", &ReducedEvent::pz, nullptr}, {"p", &ReducedEvent::p, nullptr}, {"pid", nullptr, &ReducedEvent::pid},
+    {"PreShP", &ReducedEvent::PreShP, nullptr}, {"PreShPx", &ReducedEvent::PreShPx, nullptr},
+    {"PreShPy", &ReducedEvent::PreShPy, nullptr}, {"PreShPz", &ReducedEvent::PreShPz, nullptr},
+    {"PreShSum", &ReducedEvent::PreShSum, nullptr}, {"PreSh_l", &ReducedEvent::PreSh_l, nullptr},
+    {"PreSh_r", &ReducedEvent::PreSh_r, nullptr}, {"PreSh_t", &ReducedEvent::PreSh_t, nullptr},
+    {"ShowerSum", &ReducedEvent::ShowerSum, nullptr}, {"Shower_l", &ReducedEvent::Shower_l, nullptr},
+    {"Shower_r", &ReducedEvent::Shower_r, nullptr}, {"Shower_t", &ReducedEvent::Shower_t, nullptr},
+    {"SC0_P", &ReducedEvent::SC0_P, nullptr}, {"SC0_Eendsum", &ReducedEvent::SC0_Eendsum, nullptr},
+    {"SC0_Eend", &ReducedEvent::SC0_Eend, nullptr}, {"SC1_P", &ReducedEvent::SC1_P, nullptr},
+    {"SC1_Eendsum", &ReducedEvent::SC1_Eendsum, nullptr}, {"SC1_Eend", &ReducedEvent::SC1_Eend, nullptr},
+    {"SPD_P", &ReducedEvent::SPD_P, nullptr}, {"SPD_Eendsum", &ReducedEvent::SPD_Eendsum, nullptr},
+    {"SPD_Eend", &ReducedEvent::SPD_Eend, nullptr}, {"LASPD_P", &ReducedEvent::LASPD_P, nullptr},
+    {"LASPD_Eendsum", &ReducedEvent::LASPD_Eendsum, nullptr}, {"LASPD_Eend", &ReducedEvent::LASPD_Eend, nullptr},
+};
+static const char *gem_planes[2] = {"GEM00", "GEM10"};
+
+// columns of the reduced events, in the order of the tree branches
+struct ReducedColumns
+{
+    std::vector<Column> scalars;
+    std::vector<Column> gem_n, gem_np, gem_hits;        // hits: x, y, vy, vx of every plane
+    Column npesum{"Npesum", "<f4"};
+
+    ReducedColumns()
+    {
+        for (auto &var : scalar_vars) {
+            scalars.emplace_back(var.name, var.fval ? "<f4" : "<i4");
+        }
+        for (auto plane : gem_planes) {
+            std::string p(plane);
+            gem_n.emplace_back(p + "_n", "<i4");
+            gem_np.emplace_back(p + "_np", "<i4");
+            for (auto v : {"_x", "_y", "_vy", "_vx"}) {
+                gem_hits.emplace_back(p + v, "<f4");
+            }
+        }
+    }
+
+    void Fill(const ReducedEvent &ev)
+    {
+        for (size_t i = 0; i < scalar_vars.size(); ++i) {
+            if (scalar_vars[i].fval) {
+                scalars[i].Append(&(ev.*scalar_vars[i].fval), 1);
+            } else {
+                scalars[i].Append(&(ev.*scalar_vars[i].ival), 1);
+            }
+        }
+        for (int k = 0; k < 2; ++k) {
+            auto &gem = ev.gem[k];
+            gem_n[k].Append(&gem.n, 1);
+            gem_np[k].Append(&gem.np, 1);
+            gem_hits[4*k].Append(gem.x.data(), gem.n);
+            gem_hits[4*k + 1].Append(gem.y.data(), gem.n);
+            gem_hits[4*k + 2].Append(gem.vy.data(), gem.n);
+            gem_hits[4*k + 3].Append(gem.vx.data(), gem.n);
+        }
+        npesum.Append(&ev.Npesum, 1);
+    }
+
+    std::vector<const Column*> List() const
+    {
+        std::vector<const Column*> res;
+        for (auto &col : scalars) {
+            res.push_back(&col);
+        }
+        for (int k = 0; k < 2; ++k) {
+            res.push_back(&gem_n[k]);
+            res.push_back(&gem_np[k]);
+            for (int i = 0; i < 4; ++i) {
+                res.push_back(&gem_hits[4*k + i]);
+            }
+        }
+        res.push_back(&npesum);
+        return res;
+    }
+
+    size_t Bytes() const
+    {
+        size_t bytes = 0;
+        for (auto col : List()) {
+            bytes += col->data.size();
+        }
+        return bytes;
+    }
+};
+
+struct ReduceOptions
+{
+    int number_of_file = 1, evgen = -1;
+    double event_actual = 1.;
+    uint32_t seed = 0;
+    bool root_output = true, npz_output = true, keep_columns = false;
+    std::string out_dir;
+};
+
+struct FileResult
+{
+    bool ok = false;
+    long events = 0;
+    // hits with unknown flux ids and Cherenkov photons outside of the sensors
+    long bad_flux = 0, bad_hgc = 0;
+    double sec = 0.;
+    ReducedColumns columns;
+    std::string message;
+};
+
+// <dir>/<name> of the input <dir>/<name>.root, the directory can be replaced
+std::string output_stem(const std::string &path, const std::string &out_dir)
+{
+    size_t slash = path.rfind('/');
+    size_t dot = path.rfind('.');
+    std::string stem = ((dot != std::string::npos) && ((slash == std::string::npos) || (dot > slash)))
+                     ? path.substr(0, dot) : path;
+    if (out_dir.empty()) {
+        return stem;
+    }
+    return out_dir + "/" + ((slash == std::string::npos) ? stem : stem.substr(slash + 1));
+}
+
+bool reduce_file(const std::string &path, const ReduceOptions &opt, uint32_t seed, FileResult &res)
+{
+    auto start = steady_clock::now();
+    std::unique_ptr<TFile> file(TFile::Open(path.c_str(), "READ"));
+    if (!file || file->IsZombie()) {
+        res.message = "cannot open file";
+        return false;
+    }
+
+    auto get_tree = [&file, &res] (const char *name) {
+        auto tree = dynamic_cast<TTree*>(file->Get(name));
+        if (tree) {
+            tree->SetBranchStatus("*", 0);
+        } else {
+            res.message += std::string("cannot find tree ") + name + "; ";
+        }
+        return tree;
+    };
+    TTree *tree_header = get_tree("userHeader");
+    TTree *tree_generated = get_tree("generated");
+    TTree *tree_flux = get_tree("flux");
+    TTree *tree_ec = get_tree("solid_ec");
+    TTree *tree_ec_ps = get_tree("solid_ec_ps");
+    TTree *tree_spd = get_tree("solid_spd");
+    TTree *tree_hgc = get_tree("solid_hgc");
+    if (!tree_header || !tree_generated || !tree_flux || !tree_ec || !tree_ec_ps || !tree_spd || !tree_hgc) {
+        return false;
+    }
+
+    // only the branches used are read
+    BranchVec<double> var5, var6, var10;
+    BranchVec<int> gen_pid;
+    BranchVec<double> gen_px, gen_py, gen_pz, gen_vx, gen_vy, gen_vz;
+    BranchVec<double> flux_id, flux_tid, flux_px, flux_py, flux_pz, flux_x, flux_y, flux_lx, flux_ly;
+    BranchVec<int> ec_id, ec_ps_id, spd_id, hgc_id, hgc_pid;
+    BranchVec<double> ec_Eend, ec_ps_Eend, spd_Edep, hgc_E, hgc_lx, hgc_ly;
+
+    bool header = (opt.evgen == 2) || (opt.evgen == 3);
+    bool ok = (opt.evgen != 2 || (var5.Connect(tree_header, "userVar005") && var6.Connect(tree_header, "userVar006")))
+           && (opt.evgen != 3 || var10.Connect(tree_header, "userVar010"))
+           && gen_pid.Connect(tree_generated, "pid")
+           && gen_px.Connect(tree_generated, "px") && gen_py.Connect(tree_generated, "py")
+           && gen_pz.Connect(tree_generated, "pz") && gen_vx.Connect(tree_generated, "vx")
+           && gen_vy.Connect(tree_generated, "vy") && gen_vz.Connect(tree_generated, "vz")
+           && flux_id.Connect(tree_flux, "id") && flux_tid.Connect(tree_flux, "tid")
+           && flux_px.Connect(tree_flux, "px") && flux_py.Connect(tree_flux, "py") && flux_pz.Connect(tree_flux, "pz")
+           && flux_x.Connect(tree_flux, "avg_x") && flux_y.Connect(tree_flux, "avg_y")
+           && flux_lx.Connect(tree_flux, "avg_lx") && flux_ly.Connect(tree_flux, "avg_ly")
+           && ec_id.Connect(tree_ec, "id") && ec_Eend.Connect(tree_ec, "totEend")
+           && ec_ps_id.Connect(tree_ec_ps, "id") && ec_ps_Eend.Connect(tree_ec_ps, "totEend")
+           && spd_id.Connect(tree_spd, "id") && spd_Edep.Connect(tree_spd, "totEdep")
+           && hgc_id.Connect(tree_hgc, "id") && hgc_pid.Connect(tree_hgc, "pid")
+           && hgc_E.Connect(tree_hgc, "trackE") && hgc_lx.Connect(tree_hgc, "avg_lx") && hgc_ly.Connect(tree_hgc, "avg_ly");
+    if (!ok) {
+        res.message = "missing branches in the simulation trees";
+        return false;
+    }
+
+    // output tree
+    ReducedEvent ev;
+    std::unique_ptr<TFile> out_file;
+    TTree *out_tree = nullptr;
+    TBranch *gem_branches[2][4];
+    std::string stem = output_stem(path, opt.out_dir);
+    if (opt.root_output) {
+        out_file.reset(new TFile((stem + "_reduce_tree_rate.root").c_str(), "RECREATE"));
+        if (!out_file || out_file->IsZombie()) {
+            res.message = "cannot create the output root file";
+            return false;
+        }
+        out_tree = new TTree("T", "HallC beam test simulation tree");
+        for (auto &var : scalar_vars) {
+            if (var.fval) {
+                out_tree->Branch(var.name, &(ev.*var.fval), (std::string(var.name) + "/F").c_str());
+            } else {
+                out_tree->Branch(var.name, &(ev.*var.ival), (std::string(var.name) + "/I").c_str());
+            }
+        }
+        for (int k = 0; k < 2; ++k) {
+            std::string p = gem_planes[k];
+            auto &gem = ev.gem[k];
+            out_tree->Branch((p + "_n").c_str(), &gem.n, (p + "_n/I").c_str());
+            out_tree->Branch((p + "_np").c_str(), &gem.np, (p + "_np/I").c_str());
+            gem_branches[k][0] = out_tree->Branch((p + "_x").c_str(), gem.x.data(), (p + "_x[" + p + "_n]/F").c_str());
+            gem_branches[k][1] = out_tree->Branch((p + "_y").c_str(), gem.y.data(), (p + "_y[" + p + "_n]/F").c_str());
+            gem_branches[k][2] = out_tree->Branch((p + "_vy").c_str(), gem.vy.data(), (p + "_vy[" + p + "_n]/F").c_str());
+            gem_branches[k][3] = out_tree->Branch((p + "_vx").c_str(), gem.vx.data(), (p + "_vx[" + p + "_n]/F").c_str());
+        }
+        out_tree->Branch("Npesum", &ev.Npesum, "Npesum/F");
+    }
+
+    TRandom3 rand(seed);
+    long nev = tree_generated->GetEntries();
+    for (long i = 0; i < nev; ++i) {
+        // rate by the event generator
+        if (header) {
+            tree_header->GetEntry(i);
+        }
+        switch (opt.evgen) {
+        // new eDIS and eAll generator, the rate is kept from the previous event if Q2 <= 0.01
+        case 2: if (var5.size() && var6.size() && (var5[0] > 0.01)) { ev.rate = var6[0]/opt.number_of_file; } break;
+        // beam on target
+        case 0: ev.rate = 80e-6/1.6e-19/opt.event_actual; break;
+        // bggen
+        case 3: if (var10.size()) { ev.rate = var10[0]/opt.number_of_file; } break;
+        // even event
+        default: ev.rate = 1; break;
+        }
+
+        // generated particle, the last one is used
+        tree_generated->GetEntry(i);
+        for (size_t j = 0; j < gen_pid.size(); ++j) {
+            ev.pid = gen_pid[j];
+            ev.px = gen_px[j]/1e3;
+            ev.py = gen_py[j]/1e3;
+            ev.pz = gen_pz[j]/1e3;
+            ev.vx = gen_vx[j]*0.1;
+            ev.vy = gen_vy[j]*0.1;
+            ev.vz = gen_vz[j]*0.1;
+            ev.p = std::sqrt(ev.px*ev.px + ev.py*ev.py + ev.pz*ev.pz);
+        }
+
+        // virtual planes
+        tree_flux->GetEntry(i);
+        double px_max = 0., py_max = 0., pz_max = 0., p_max = 0.;
+        double sc0_p = 0., sc1_p = 0., spd_p = 0., laspd_p = 0.;
+        ev.gem[0].Clear();
+        ev.gem[1].Clear();
+        // an unknown id keeps the plane of the previous hit, as in the macro
+        int hit_id = -1;
+        for (size_t j = 0; j < flux_id.size(); ++j) {
+            double hit_p = std::sqrt(flux_px[j]*flux_px[j] + flux_py[j]*flux_py[j] + flux_pz[j]*flux_pz[j])/1e3;
+            switch (static_cast<int>(flux_id[j])) {
+            case 1: hit_id = 0; break;      // SC0 front
+            case 2: hit_id = 1; break;      // SC1 front
+            case 3: hit_id = 2; break;      // EC front
+            case 9: hit_id = 9; break;      // EC shower front
+            case 4: hit_id = 3; break;      // EC back
+            case 5: hit_id = 4; break;      // GEM 1
+            case 6: hit_id = 5; break;      // GEM 2
+            case 7: hit_id = 7; break;      // spd 1
+            case 8: hit_id = 8; break;      // spd 2
+            case 10: hit_id = 6; break;     // Cherenkov front window
+            default: res.bad_flux++; break;
+            }
+            // primary particle
+            if (flux_tid[j] == 1) {
+                switch (hit_id) {
+                case 2:
+                    p_max = hit_p;
+                    px_max = flux_px[j]/1e3;
+                    py_max = flux_py[j]/1e3;
+                    pz_max = flux_pz[j]/1e3;
+                    break;
+                case 0: sc0_p = hit_p; break;
+                case 1: sc1_p = hit_p; break;
+                case 7: spd_p = hit_p; break;
+                case 8: laspd_p = hit_p; break;
+                case 4: ev.gem[0].np = j; break;
+                case 5: ev.gem[1].np = j; break;
+                default: break;
+                }
+            }
+            if ((hit_id == 4) || (hit_id == 5)) {
+                ev.gem[hit_id - 4].Add(flux_lx[j]*0.1, flux_ly[j]*0.1, flux_x[j]*0.1, flux_y[j]*0.1);
+            }
+        }
+
+        // ec, the module is the component id (1 top, 2 left, 3 right)
+        tree_ec->GetEntry(i);
+        tree_ec_ps->GetEntry(i);
+        double ec_sum = 0., ec_ps_sum = 0., ec[4] = {0.}, ec_ps[4] = {0.};
+        for (size_t j = 0; j < ec_id.size(); ++j) {
+            int comp = ec_id[j]%10000;
+            ec_sum += ec_Eend[j];
+            if (comp < 4) {
+                ec[comp] += ec_Eend[j];
+            }
+        }
+        for (size_t j = 0; j < ec_ps_id.size(); ++j) {
+            int comp = ec_ps_id[j]%10000;
+            ec_ps_sum += ec_ps_Eend[j];
+            if (comp < 4) {
+                ec_ps[comp] += ec_ps_Eend[j];
+            }
+        }
+        ev.PreShSum = ec_ps_sum;
+        ev.PreSh_l = ec_ps[2];
+        ev.PreSh_r = ec_ps[3];
+        ev.PreSh_t = ec_ps[1];
+        ev.ShowerSum = ec_sum;
+        ev.Shower_l = ec[2];
+        ev.Shower_r = ec[3];
+        ev.Shower_t = ec[1];
+        ev.PreShP = p_max;
+        ev.PreShPx = px_max;
+        ev.PreShPy = py_max;
+        ev.PreShPz = pz_max;
+
+        // scintillators and spd
+        tree_spd->GetEntry(i);
+        double edep[5] = {0.};
+        for (size_t j = 0; j < spd_id.size(); ++j) {
+            if ((spd_id[j] >= 1) && (spd_id[j] <= 4)) {
+                edep[spd_id[j]] += spd_Edep[j];
+            }
+        }
+        auto set_plane = [] (float &P, float &Eendsum, float &Eend, double p, double e) {
+            P = p;
+            Eendsum = e;
+            if (P > 0) {
+                Eend = e;
+            }
+        };
+        set_plane(ev.SC0_P, ev.SC0_Eendsum, ev.SC0_Eend, sc0_p, edep[1]);
+        set_plane(ev.SC1_P, ev.SC1_Eendsum, ev.SC1_Eend, sc1_p, edep[2]);
+        set_plane(ev.SPD_P, ev.SPD_Eendsum, ev.SPD_Eend, spd_p, edep[3]);
+        set_plane(ev.LASPD_P, ev.LASPD_Eendsum, ev.LASPD_Eend, laspd_p, edep[4]);
+
+        // Cherenkov, optical photons detected by the quantum efficiency, counted on the 4x4 sensors
+        tree_hgc->GetEntry(i);
+        double hit_hgc[hgc_sensors] = {0.};
+        for (size_t j = 0; j < hgc_pid.size(); ++j) {
+            if (hgc_pid[j] != -22) {
+                continue;
+            }
+            if (hgc_id[j]/1000000 != 2) {
+                res.bad_hgc++;
+                continue;
+            }
+            double e_photon = hgc_E[j]*1e6;
+            bool pass = false;
+            for (int k = 0; k < n_qe; ++k) {
+                if ((photon_energy[k] <= e_photon) && (e_photon < photon_energy[k + 1])) {
+                    pass = (rand.Uniform(0, 1) < qe_lappd_wls[k]*qe_factor);
+                    break;
+                }
+            }
+            if (!pass) {
+                continue;
+            }
+            int pmt_x = int((hgc_lx[j] + 53.)/(53./(hgc_sensors_1d/2)));
+            int pmt_y = int((hgc_ly[j] + 53.)/(53./(hgc_sensors_1d/2)));
+            if ((0 <= pmt_x) && (pmt_x < hgc_sensors_1d) && (0 <= pmt_y) && (pmt_y < hgc_sensors_1d)) {
+                hit_hgc[hgc_sensors_1d*pmt_y + pmt_x] += 1;
+            } else {
+                res.bad_hgc++;
+            }
+        }
+        double npe = 0.;
+        for (int k = 0; k < hgc_sensors; ++k) {
+            npe += hit_hgc[k];
+        }
+        ev.Npesum = npe;
+
+        if (out_tree) {
+            // the hit buffers may have been reallocated
+            for (int k = 0; k < 2; ++k) {
+                auto &gem = ev.gem[k];
+                gem_branches[k][0]->SetAddress(gem.x.data());
+                gem_branches[k][1]->SetAddress(gem.y.data());
+                gem_branches[k][2]->SetAddress(gem.vy.data());
+                gem_branches[k][3]->SetAddress(gem.vx.data());
+            }
+            out_tree->Fill();
+        }
+        if (opt.npz_output) {
+            res.columns.Fill(ev);
+        }
+    }
+    res.events = nev;
+
+    if (out_file) {
+        out_file->cd();
+        out_tree->Write();
+        out_file->Close();
+    }
+    if (opt.npz_output) {
+        NpzWriter npz;
+        bool written = npz.Open(stem + "_reduce.npz");
+        for (auto col : res.columns.List()) {
+            written = written && npz.Add(*col);
+        }
+        if (!(written && npz.Close())) {
+            res.message = "failed to write " + stem + "_reduce.npz";
+            return false;
+        }
+        // the merged output keeps the columns
+        if (!opt.keep_columns) {
+            res.columns = ReducedColumns();
+        }
+    }
+    res.sec = duration_cast<duration<double>>(steady_clock::now() - start).count();
+    return true;
+}
+
+// all the files in one npz, the columns of the files are concatenated in the order of input
+bool write_merged(const std::string &path, const std::vector<FileResult> &results)
+{
+    NpzWriter npz;
+    if (!npz.Open(path)) {
+        return false;
+    }
+
+    std::vector<std::vector<int>> file_index(results.size());
+    std::vector<std::vector<const Column*>> lists;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].ok) {
+            file_index[i].assign(results[i].events, static_cast<int>(i));
+            lists.push_back(results[i].columns.List());
+        }
+    }
+    if (lists.empty()) {
+        return false;
+    }
+
+    bool ok = true;
+    for (size_t c = 0; c < lists[0].size(); ++c) {
+        std::vector<NpzWriter::Chunk> chunks;
+        for (auto &list : lists) {
+            chunks.push_back({list[c]->data.data(), list[c]->data.size()});
+        }
+        ok = ok && npz.Add(lists[0][c]->name, lists[0][c]->descr, chunks);
+    }
+    std::vector<NpzWriter::Chunk> chunks;
+    for (auto &idx : file_index) {
+        chunks.push_back({reinterpret_cast<const char*>(idx.data()), idx.size()*sizeof(int)});
+    }
+    ok = ok && npz.Add("file_index", "<i4", chunks);
+    return npz.Close() && ok;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddPositional("root_file", "input GEMC root file");
+    arg_parser.SetFlexiblePositionals("more input root files");
+    arg_parser.AddArg<std::string>("-l", "file_list", "text file of input root files (one per line, # for comments)", "");
+    arg_parser.AddArg<int>("-g", "evgen", "event type, 0 beam on target, 2 eDIS/eAll, 3 bggen, 4 even", -1);
+    arg_parser.AddArg<int>("-n", "number_of_file", "number of files the rate is divided by (evgen 2 and 3)", 1);
+    arg_parser.AddArg<double>("-e", "event_actual", "number of events for the beam on target rate (evgen 0)", 1.);
+    arg_parser.AddArg<int>("-j", "threads", "number of worker threads (<= 0 means the number of cores)", 0);
+    arg_parser.AddArg<std::string>("-f", "format", "output format: root, npz or both", "both");
+    arg_parser.AddArg<std::string>("-d", "out_dir", "output directory (default is the directory of the input)", "");
+    arg_parser.AddArg<std::string>("-o", "merged", "path of an npz with all the input files merged", "");
+    arg_parser.AddArg<int>("-s", "seed", "seed of the Cherenkov photon detection (0 means random)", 0);
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+
+    std::vector<std::string> files;
+    for (auto &pos : arg_parser.GetPositionals()) {
+        files.push_back(pos.String());
+    }
+    std::string list_path = args["file_list"].String();
+    if (!list_path.empty()) {
+        std::ifstream list(list_path);
+        if (!list.is_open()) {
+            std::cerr << "Cannot open file list " << list_path << std::endl;
+            return -1;
+        }
+        std::string line;
+        while (std::getline(list, line)) {
+            auto first = line.find_first_not_of(" \t");
+            if ((first == std::string::npos) || (line[first] == '#')) {
+                continue;
+            }
+            files.push_back(line.substr(first, line.find_last_not_of(" \t\r") - first + 1));
+        }
+    }
+
+    ReduceOptions opt;
+    opt.evgen = args["evgen"].Int();
+    opt.number_of_file = args["number_of_file"].Int();
+    opt.event_actual = args["event_actual"].Double();
+    opt.out_dir = args["out_dir"].String();
+    std::string format = args["format"].String();
+    opt.root_output = (format == "root") || (format == "both");
+    opt.npz_output = (format == "npz") || (format == "both");
+    std::string merged = args["merged"].String();
+    opt.keep_columns = !merged.empty();
+    if (opt.keep_columns) {
+        opt.npz_output = true;
+    }
+    if ((opt.evgen != 0) && (opt.evgen != 2) && (opt.evgen != 3) && (opt.evgen != 4)) {
+        std::cerr << "Not right filemode (-g): " << opt.evgen << ", it should be 0, 2, 3 or 4." << std::endl;
+        return -1;
+    }
+    if (!opt.root_output && !opt.npz_output) {
+        std::cerr << "Unknown output format " << format << std::endl;
+        return -1;
+    }
+
+    int nthreads = args["threads"].Int();
+    if (nthreads <= 0) {
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    nthreads = std::min<int>(nthreads, files.size());
+    std::cout << "Reducing " << files.size() << " files with " << nthreads << " threads, numberOfFile = "
+              << opt.number_of_file << ", event_actual = " << opt.event_actual << ", evgen = " << opt.evgen
+              << std::endl;
+
+    // every worker takes the next file in the list, the files do not share any ROOT object
+    ROOT::EnableThreadSafety();
+    auto start = steady_clock::now();
+    std::vector<FileResult> results(files.size());
+    std::atomic<size_t> next(0);
+    std::mutex print_mutex;
+    uint32_t seed = args["seed"].Int();
+    auto worker = [&] () {
+        size_t i;
+        while ((i = next++) < files.size()) {
+            auto &res = results[i];
+            // a fixed seed gives the same results whatever the thread is
+            res.ok = reduce_file(files[i], opt, seed ? seed + i : 0, res);
+            std::lock_guard<std::mutex> lock(print_mutex);
+            if (res.ok) {
+                std::cout << "Reduced " << files[i] << ": " << res.events << " events in " << std::fixed
+                          << std::setprecision(2) << res.sec << " s" << std::endl;
+                if (res.bad_flux || res.bad_hgc) {
+                    std::cout << "\t" << res.bad_flux << " flux hits with a wrong id, " << res.bad_hgc
+                              << " Cherenkov photons with a wrong id or outside of the sensors" << std::endl;
+                }
+            } else {
+                std::cerr << "Failed to reduce " << files[i] << ": " << res.message << std::endl;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 0; i < nthreads; ++i) {
+        workers.emplace_back(worker);
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    long nev = 0;
+    size_t nfailed = 0;
+    for (auto &res : results) {
+        nev += res.events;
+        nfailed += res.ok ? 0 : 1;
+    }
+    double sec = duration_cast<duration<double>>(steady_clock::now() - start).count();
+    std::cout << "Reduced " << files.size() - nfailed << "/" << files.size() << " files, " << nev << " events in "
+              << std::fixed << std::setprecision(2) << sec << " s (" << std::setprecision(0)
+              << ((sec > 0.) ? nev/sec : 0.) << " events/s)." << std::endl;
+
+    if (!merged.empty()) {
+        if (!write_merged(merged, results)) {
+            std::cerr << "Failed to write the merged output " << merged << std::endl;
+            return -1;
+        }
+        std::cout << "Merged output saved to " << merged << std::endl;
+    }
+    return nfailed ? -1 : 0;
+}
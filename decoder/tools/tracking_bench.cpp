@@ -0,0 +1,182 @@
+/*  A program to measure the track finding with toy model events, without the GUI or any data file
+ *  The tracking detectors are set up from config/gem_tracking.conf, each event has a number of straight tracks
+ *  (doubled from 1 to -m) and background hits on every detector, the events are the same for a given seed
+ *  For each track multiplicity, it reports the tracking speed, the candidates fitted per event, the fraction of
+ *  events with skipped hit combinations (too many of them) and of the aborted ones (nothing fitted), the efficiency
+ *  (truth tracks found with only their own hits) and the fake rate
+ *  The tracks reported are the best track in the single-track mode (the other saved candidates share its hits) and
+ *  all the tracks in the multi-track mode (they do not share hits), -c sets the chi2 cut of the tracks after the first
+ *  With --check, it only verifies the batch coordinate transform (CoordSystem::TransformAll) against the per-hit
+ *  rotation and translation, and exits with a non-zero status if they differ
+ */
+
+#include "ConfigArgs.h"
+#include "AbstractDetector.h"
+#include "CoordSystem.h"
+#include "ToyEventGenerator.h"
+#include "Tracking.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+using namespace std::chrono;
+using namespace tracking_dev;
+
+
+struct BenchResult
+{
+    double sec = 0.;
+    long candidates = 0;
+    int skipped = 0;            // events with at least one hit combination skipped
+    int aborted = 0;            // events skipped entirely, no candidate fitted
+    long true_tracks = 0;       // with enough hits to be found
+    long true_found = 0;
+    long tracks_found = 0;      // tracks reported
+    long fake_tracks = 0;
+};
+
+// match the reported tracks to the truth tracks, a track is matched if all its hits are from the same truth track
+void check_tracks(Tracking &tracking, const ToyEventGenerator &gen, int min_hits, BenchResult &res)
+{
+    const auto &truth = gen.GetTracks();
+    for (auto &t : truth) {
+        res.true_tracks += (t.nhits >= min_hits);
+    }
+
+    int ntracks = (int)tracking.GetAllXtrack().size();
+    int best = tracking.GetBestTrackIndex();
+    if (best < 0) {
+        return;
+    }
+
+    // the best track only in the single-track mode, the other saved candidates are alternatives of it
+    std::vector<bool> reported(ntracks, tracking.IsMultiTrackMode());
+    reported[best] = true;
+
+    auto owner = gen.MatchTracks(ntracks, tracking.GetAllXlocal(), tracking.GetAllYlocal(), tracking.GetAllZlocal(),
+                                 tracking.GetAllHitTrackIndex());
+
+    std::vector<bool> found(truth.size(), false);
+    for (int i = 0; i < ntracks; ++i) {
+        if (!reported[i]) {
+            continue;
+        }
+        res.tracks_found++;
+        if (owner[i] >= 0) {
+            found[owner[i]] = true;
+        } else {
+            res.fake_tracks++;
+        }
+    }
+    res.true_found += std::count(found.begin(), found.end(), true);
+}
+
+
+int main(int argc, char* argv[])
+{
+    // setup input arguments
+    ConfigArgs arg_parser;
+    arg_parser.AddHelp("--help");
+    arg_parser.AddArg<int>("-e", "events", "number of events for each track multiplicity", 10000);
+    arg_parser.AddArg<int>("-m", "max_tracks", "maximum number of tracks per event, doubled from 1", 8);
+    arg_parser.AddArg<int>("-b", "background", "number of background hits per detector", 10);
+    arg_parser.AddArg<int>("-s", "seed", "random seed of the toy events", 1);
+    arg_parser.AddArg<double>("-r", "resolution", "hit resolution (mm)", 0.1);
+    arg_parser.AddArg<double>("-v", "vertex", "track position range at z = 0 (+/- mm)", 40.);
+    arg_parser.AddArg<double>("-k", "slope", "track slope range (+/-)", 0.01);
+    arg_parser.AddArg<int>("-t", "multi_track", "multi-track mode, 0: off, 1: on, -1: from the tracking config", -1);
+    arg_parser.AddArg<double>("-c", "later_chi2", "multi-track max chi2 of the later tracks, < 0: from the tracking config", -1.);
+    arg_parser.AddSwitch("--check", "check", "only check the batch coordinate transform against the per-hit one");
+
+    auto args = arg_parser.ParseArgs(argc, argv);
+    if (args["check"].Bool()) {
+        CoordSystem coord;
+        return coord.UnitTest() ? 0 : 1;
+    }
+    int nev = args["events"].Int();
+    int max_tracks = args["max_tracks"].Int();
+    int nbkg = args["background"].Int();
+
+    Tracking tracking;
+    Cuts *cuts = tracking.GetTrackingCuts();
+
+    // tracking detectors, by layer id
+    std::vector<Cuts::block_t> layers;
+    for (auto &it : cuts->__get_block_data()) {
+        if (it.second.is_tracker) {
+            layers.push_back(it.second);
+        }
+    }
+    std::sort(layers.begin(), layers.end(), [](const Cuts::block_t &a, const Cuts::block_t &b) {
+        return a.layer_id < b.layer_id;
+    });
+
+    auto grid_width = cuts->__get("grid width").arr<double>();
+    double grid_shift = cuts->__get("grid shift").val<double>();
+
+    ToyEventGenerator gen(args["seed"].Int());
+    gen.SetResolution(args["resolution"].Double());
+    gen.SetVertexRange(args["vertex"].Double(), args["vertex"].Double());
+    gen.SetSlopeRange(args["slope"].Double(), args["slope"].Double());
+
+    std::vector<AbstractDetector> detectors(layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        auto &det = detectors[i];
+        det.SetOrigin(point_t(layers[i].position[0], layers[i].position[1], layers[i].position[2]));
+        det.SetGridWidth(grid_width[0], grid_width[1]);
+        det.SetGridShift(grid_shift);
+        det.SetDimension(point_t(layers[i].dimension[0], layers[i].dimension[1], layers[i].dimension[2]));
+        det.SetLayerID(layers[i].layer_id);
+        tracking.AddDetector(layers[i].layer_id, &det);
+        gen.AddDetector(&det);
+        std::cout << "Layer " << layers[i].layer_id << " at z = " << layers[i].position[2] << " mm" << std::endl;
+    }
+    tracking.CompleteSetup();
+    if (args["multi_track"].Int() >= 0) {
+        tracking.SetMultiTrackMode(args["multi_track"].Int() > 0);
+    }
+    if (args["later_chi2"].Double() >= 0.) {
+        tracking.SetMultiTrackChi2Cut(args["later_chi2"].Double());
+    }
+    int min_hits = cuts->__get("minimum hits on track").val<int>();
+
+    std::cout << "Multi-track mode " << (tracking.IsMultiTrackMode() ? "on" : "off");
+    if (tracking.IsMultiTrackMode()) {
+        std::cout << " (max chi2 of the later tracks " << tracking.GetMultiTrackChi2Cut() << ")";
+    }
+    std::cout << ", "
+              << nbkg << " background hits per detector, " << nev << " events per multiplicity." << std::endl;
+
+    for (int ntracks = 1; ntracks <= max_tracks; ntracks *= 2) {
+        BenchResult res;
+        for (int ev = 0; ev < nev; ++ev) {
+            gen.ClearEvent();
+            for (int i = 0; i < ntracks; ++i) {
+                gen.GenerateTrack();
+            }
+            gen.AddBackground(nbkg);
+
+            auto start = steady_clock::now();
+            tracking.FindTracks();
+            res.sec += duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+            // the abort flag is raised for any skipped hit combination, the event is only lost if nothing is fitted
+            res.candidates += tracking.GetNCandidatesFitted();
+            res.skipped += tracking.IsTrackingAborted();
+            res.aborted += tracking.IsTrackingAborted() && (tracking.GetNCandidatesFitted() == 0);
+            check_tracks(tracking, gen, min_hits, res);
+        }
+
+        std::cout << std::setw(3) << ntracks << " tracks/event: "
+                  << std::fixed << std::setprecision(0) << nev/res.sec << " events/s, "
+                  << std::setprecision(1) << (double)res.candidates/nev << " candidates/event, "
+                  << std::setprecision(2) << 100.*res.skipped/nev << "% with skipped combinations, "
+                  << 100.*res.aborted/nev << "% aborted, "
+                  << "efficiency " << 100.*res.true_found/std::max(res.true_tracks, 1L) << "%, "
+                  << "fake rate " << 100.*res.fake_tracks/std::max(res.tracks_found, 1L) << "%"
+                  << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#ifndef ABSTRACT_DETECTOR_H
+#define ABSTRACT_DETECTOR_H
+
+#include "tracking_struct.h"
+#include <vector>
+#include <unordered_map>
+
+namespace tracking_dev {
+
+class AbstractDetector
+{
+public:
+    AbstractDetector();
+    ~AbstractDetector();
+
+    void SetOrigin(const point_t &p);
+    void SetXAxis(const point_t &p);
+    void SetYAxis(const point_t &p);
+    void SetZAxis(const point_t &p);
+    void SetDimension(const point_t &p);
+    void SetLayerID(const int i) {layer_id = i;}
+
+    void AddLocalHit(const point_t &p);
+    void AddGlobalHit(const point_t &p);
+    void AddHit(const point_t &p) { AddGlobalHit(p); }
+    void AddHit(const double &x, const double &y);
+    void AddFittedHits(const point_t &p) { addNonIndexHit(p, fitted_hits); }
+    void AddRealHits(const point_t &p) { addNonIndexHit(p, real_hits); }
+    void AddBackgroundHits(const point_t &p) { addNonIndexHit(p, background_hits); }
+
+    // getters
+    const point_t &GetOrigin() const;
+    double GetZPosition() const;
+    const point_t &GetXAxis() const;
+    const point_t &GetYAxis() const;
+    const point_t &GetZAxis() const;
+    const point_t &GetDimension() const;
+    int GetLayerID() const {return layer_id;}
+    const std::vector<point_t> &GetLocalHits() const;
+    const std::vector<point_t> &GetGlobalHits() const;
+    const std::vector<point_t> &GetHits() const {return global_hits;}
+    const point_t &Get2DHit(int i) const {return global_hits[i];}
+    unsigned int Get2DHitCounts() const {return global_hits.size();}
+    const std::unordered_map<grid_addr_t, grid_t> &GetGrids() const {return grids;}
+    const std::unordered_map<grid_addr_t, bool> &GetGridChosen() const {return grid_chosen;}
+    std::vector<grid_addr_t> GetPointHomeGrids(const point_t &p);
+    int GetGridNeighborStatus(const point_t &p, const grid_addr_t &a);
+
+    // dense grid, grid index = i * ny + j for grid_addr_t(i, j)
+    int GetNGridsX() const {return grid_nx;}
+    int GetNGridsY() const {return grid_ny;}
+    int GetGridIndex(const point_t &p) const;
+    // the home grid of a point and the neighbor grids it is close to (home grid first),
+    // returns the number of grids
+    int GetPointSearchGrids(const point_t &p, const int *&grid_index) const;
+    // indices of the hits in a grid, in the order they were added
+    const int *GetGridHits(int grid_index, int &nhits);
+    // take a hit out of the grids (it is still in the hit list), and put all hits back
+    void RemoveGridHit(int i);
+    void RestoreGridHits();
+    const std::vector<point_t> &GetFittedHits() const {return fitted_hits;}
+    const std::vector<point_t> &GetRealHits() const {return real_hits;}
+    const std::vector<point_t> &GetBackgroundHits() const {return background_hits;}
+
+    // members
+    void Reset();
+    void SetupGrids();
+    void ShowGridHitStat();
+
+    // setters
+    void SetGridWidth(double xw, double yw){ grid_xwidth = xw; grid_ywidth = yw;}
+    void SetGridShift(double shift) {grid_shift = shift;}
+
+public:
+    void addNonIndexHit(const point_t &p, std::vector<point_t> &hits);
+    void addIndexHit(const point_t &p);
+
+private:
+    point_t origin;
+    point_t z_axis;
+    point_t x_axis;
+    point_t y_axis;
+    point_t dimension; // total length, not half length
+    int layer_id;
+
+    // local hits is only used for detector raw signal check
+    std::vector<point_t> local_hits;
+    // for 2D hits, all hits, in global coordinates
+    std::vector<point_t> global_hits;
+
+    // test - in global coordinates
+    std::vector<point_t> fitted_hits;
+    std::vector<point_t> real_hits;
+    std::vector<point_t> background_hits;
+
+    // grid
+    double grid_xwidth = 17.2, grid_ywidth = 17.2; // units in mm
+    double grid_shift = 0.4;
+    //double grid_xwidth = 102.4, grid_ywidth = 102.4; // units in mm
+    //double grid_shift = 0.;
+    double neighbor_grid_marginx = 0.3; // default is 1/4 grid width
+    double neighbor_grid_marginy = 0.3;
+ 
+    // for display
+    std::unordered_map<grid_addr_t, grid_t> grids;
+    std::unordered_map<grid_addr_t, bool> grid_chosen;
+
+    // dense grid geometry, built in SetupGrids
+    int grid_nx = 0, grid_ny = 0;
+    double grid_x_low = 0., grid_y_low = 0.;
+    std::vector<double> grid_x1, grid_x2;      // grid edges by column
+    std::vector<double> grid_y1, grid_y2;      // grid edges by row
+    // search grids for each (grid, neighbor status), CSR layout
+    std::vector<int> search_grid_offset;       // size of grid_nx * grid_ny * 9 + 1
+    std::vector<int> search_grids;
+
+    // hits by grid, CSR layout, rebuilt with a counting sort when hits were added
+    std::vector<int> hit_grid_index;           // grid index of each global hit, -1 if out of grids
+    std::vector<int> grid_hit_offset;          // size of grid_nx * grid_ny + 1
+    std::vector<int> grid_hits;
+    bool grid_hits_dirty = false;
+
+    void buildGridHits();
+    int getNeighborStatus(const point_t &p, int i, int j) const;
+};
+
+};
+
+#endif
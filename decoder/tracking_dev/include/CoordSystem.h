@@ -0,0 +1,61 @@
+#ifndef COORD_SYSTEM_H
+#define COORD_SYSTEM_H
+
+#include "tracking_struct.h"
+#include "Cuts.h"
+#include <vector>
+
+namespace tracking_dev
+{
+    class CoordSystem 
+    {
+    public:
+        CoordSystem();
+        ~CoordSystem();
+
+        void Init();
+        void PassCutsHandle(Cuts *c){gem_cuts = c;}
+
+        void Rotate(point_t &p, const point_t &rot);
+        void Translate(point_t &p, const point_t &t);
+        void Transform(point_t &p, const point_t &rot, const point_t &t);
+        void Transform(point_t &p, int ilayer);
+        // transform all hits of a layer, in and out can be the same array
+        void TransformAll(int ilayer, const point_t *in, point_t *out, size_t n) const;
+
+        // unit test, TransformAll against the per-hit Transform
+        bool UnitTest();
+
+        // getters
+        point_t GetLayerOffset(int i){return offset_gem.at(i);}
+        point_t GetLayerTiltAngle(int i){return angle_gem.at(i);}
+        point_t GetLayerPosition(int i){return position_gem.at(i);}
+        point_t GetLayerDimension(int i){return dimension_gem.at(i);}
+        bool IsInTrackerSystem(int i){return tracker_config_gem.at(i);}
+        Cuts* GetCutsHandle(){return gem_cuts;}
+
+    private:
+        void buildLayerTransforms();
+        bool checkTransformAll(const std::vector<point_t> &in);
+
+    private:
+        Cuts *gem_cuts;
+
+        // rotation (R = RzRyRx, same as Rotate) and translation of a layer,
+        // built once from the tilt angles and offsets, indexed by layer id
+        struct LayerTransform
+        {
+            double r[3][3];
+            double t[3];
+        };
+        std::vector<LayerTransform> layer_transform;
+
+        std::unordered_map<int, point_t> offset_gem;
+        std::unordered_map<int, point_t> angle_gem;
+        std::unordered_map<int, point_t> position_gem;
+        std::unordered_map<int, point_t> dimension_gem;
+        std::unordered_map<int, bool> tracker_config_gem;
+    };
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef TOY_EVENT_GENERATOR_H
+#define TOY_EVENT_GENERATOR_H
+
+#include "tracking_struct.h"
+#include <vector>
+#include <random>
+
+namespace tracking_dev {
+
+class AbstractDetector;
+
+// a straight track of the toy model
+struct toy_track_t
+{
+    double x, y;                  // track position at z = 0
+    double xp, yp;                // track slope at x-z, y-z plane
+    int nhits;                    // number of hits inside the detectors
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// toy model events for the tracking detectors
+//
+// straight tracks with uniform positions (at z = 0) and slopes, the hits are
+// smeared with a gaussian resolution and only kept if they are inside the
+// detector, background hits are uniform around the detector center (the whole
+// detector by default), the truth track of each hit is kept for checking the
+// tracking results, a fixed seed gives the same events
+
+class ToyEventGenerator
+{
+public:
+    ToyEventGenerator(unsigned int seed = 0);
+    ~ToyEventGenerator();
+
+    void AddDetector(AbstractDetector *det);
+    void SetSeed(unsigned int seed) {rng.seed(seed);}
+    void SetVertexRange(double xr, double yr) {vertex_xrange = xr; vertex_yrange = yr;}
+    void SetSlopeRange(double xr, double yr) {slope_xrange = xr; slope_yrange = yr;}
+    void SetResolution(double r) {resolution = r;}
+    void SetBackgroundRange(double xr, double yr) {bkg_xrange = xr; bkg_yrange = yr;}
+    void SetDetectorOffset(int i, double x, double y);
+
+    // reset the detectors and the truth tracks
+    void ClearEvent();
+    void GenerateTrack();
+    void AddBackground(int nhits_per_detector);
+
+    // getters
+    int GetNDetectors() const {return (int)detectors.size();}
+    const std::vector<toy_track_t> &GetTracks() const {return tracks;}
+    // truth track index of a hit in a detector, -1 for background
+    int GetHitTrack(int idet, int hit_index) const;
+    // find the detector and the hit by position, returns the truth track index,
+    // -1 for background, -2 if not found
+    int FindHitTrack(const point_t &p) const;
+    // truth track index of each reconstructed track, from its hits (x, y, z)
+    // and their track index, -1 if the hits are not all from one truth track
+    std::vector<int> MatchTracks(int ntracks, const std::vector<double> &x,
+            const std::vector<double> &y, const std::vector<double> &z,
+            const std::vector<int> &hit_track_index) const;
+
+private:
+    void addHit(int idet, const point_t &p, int track_index);
+
+private:
+    std::vector<AbstractDetector*> detectors;
+    std::vector<double> det_xoffset, det_yoffset;
+    std::vector<std::vector<int>> hit_track;       // truth track index of each hit
+
+    std::vector<toy_track_t> tracks;
+
+    // toy model parameters, units in mm
+    double vertex_xrange = 20., vertex_yrange = 20.;
+    double slope_xrange = 0.1, slope_yrange = 0.1;
+    double resolution = 1.;
+    double bkg_xrange = -1., bkg_yrange = -1.;     // < 0: the whole detector
+
+    std::mt19937_64 rng;
+};
+
+};
+
+#endif
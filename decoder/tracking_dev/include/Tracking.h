@@ -0,0 +1,210 @@
+#ifndef TRACKING_H
+#define TRACKING_H
+
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <iomanip>
+#include "tracking_struct.h"
+#include "Cuts.h"
+
+namespace tracking_dev {
+
+    class TrackingUtility;
+    class AbstractDetector;
+
+#define LARGE_VALUE 999999999.
+
+class Tracking
+{
+public:
+    Tracking();
+    ~Tracking();
+
+    void AddDetector(int index, AbstractDetector*);
+    void CompleteSetup();
+    void FindTracks();
+    void ClearPreviousEvent();
+
+    // unit test
+    void UnitTest();
+    void Print(const std::vector<int> &v);
+    void PrintHitStatus();
+    void PrintLayerGroups();
+
+    // getters for best track
+    bool GetBestTrack(double &xt, double &yt, double &xp, double &yp, double &chi);
+    int GetNHitsonBestTrack(){return nhits_on_best_track;}
+    const std::vector<int> &GetBestTrackLayerIndex(){return best_track_layer_index;}
+    const std::vector<int> &GetBestTrackHitIndex(){return best_track_hit_index;}
+    const std::vector<point_t> &GetVHitsOnBestTrack(){return best_hits_on_track;}
+
+    // getters for all good tracks that pass chi2 cut
+    // in multi-track mode, these are the tracks found one after another, they do not share hits
+    int GetNGoodTrackCandidates(){return n_good_track_candidates;}
+    int GetNTracksFound(){return n_tracks_found;}
+    int GetBestTrackIndex(){return best_track_index;}
+    long GetNCandidatesFitted() const {return n_candidates_fitted;}
+    bool IsTrackingAborted() const {return tracking_aborted;}
+    const std::vector<double> & GetAllXtrack() const {return v_xtrack;}
+    const std::vector<double> & GetAllYtrack() const {return v_ytrack;}
+    const std::vector<double> & GetAllXptrack() const {return v_xptrack;}
+    const std::vector<double> & GetAllYptrack() const {return v_yptrack;}
+    const std::vector<double> & GetAllChi2ndf() const {return v_track_chi2ndf;}
+    const std::vector<int> & GetAllTrackNhits() const {return v_track_nhits;}
+    int GetTotalNgoodHits() {return n_total_good_hits;}
+    const std::vector<double> & GetAllXlocal() const {return v_xlocal;}
+    const std::vector<double> & GetAllYlocal() const {return v_ylocal;}
+    const std::vector<double> & GetAllZlocal() const {return v_zlocal;}
+    const std::vector<int> & GetAllHitTrackIndex() const {return v_hit_track_index;}
+    const std::vector<int> & GetAllHitModule() const {return v_hit_module;}
+
+    TrackingUtility* GetTrackingUtility() {return tracking_utility;}
+    Cuts* GetTrackingCuts(){return tracking_cuts;}
+    bool IsMultiTrackMode() const {return multi_track_mode;}
+    void SetMultiTrackMode(bool m) {multi_track_mode = m;}
+    void SetMultiTrackChi2Cut(double c) {multi_track_chi2_cut = c;}
+    double GetMultiTrackChi2Cut() const {return multi_track_chi2_cut;}
+
+private:
+    void initHitStatus();
+    void initLayerGroups();
+    void loopAllLayerGroups();
+    void clearBestTrack();
+    void findExclusiveTracks();
+    void useBestTrackHits();
+
+    void nextLayerGroup(const std::vector<int> &group);
+    void scanCandidate(const std::vector<int> &nhit_by_layer,
+            const std::vector<int> &layer_index,
+            std::vector<int> &hit_comb);
+
+    void nextLayerGroup_gridway(const std::vector<int> &group);
+    void scanCandidate_gridway(const int &p_start, const int &p_start_index,
+            const int &p_end, const int &p_end_index,
+            const std::vector<int> &middle_layers);
+    void getMiddleLayerGridHitIndex(const int &start, const int &start_index,
+            const int &end, const int &end_index,
+            const std::vector<int> &middle_layers,
+            std::vector<std::vector<int>> &hit_index_by_layer);
+
+    // least-squares sums of the hits on a candidate track
+    struct LineFitSums
+    {
+        double sumx = 0., sumy = 0., sumz = 0., sumxz = 0., sumyz = 0., sumz2 = 0.;
+
+        LineFitSums Add(const point_t &p) const
+        {
+            LineFitSums s;
+            s.sumx = sumx + p.x, s.sumy = sumy + p.y, s.sumz = sumz + p.z;
+            s.sumxz = sumxz + p.x * p.z, s.sumyz = sumyz + p.y * p.z;
+            s.sumz2 = sumz2 + p.z * p.z;
+            return s;
+        }
+    };
+
+    // track fitting
+    void nextTrackCandidate(const std::vector<std::pair<int, int>> &combination);
+    void nextTrackCandidate(const std::vector<point_t> &combination);
+    void nextTrackCandidate(const std::vector<int> &layer_index, const std::vector<int> &hit_index);
+    void nextTrackCandidate(const point_t * const *hits, int nhits, const LineFitSums &sums);
+    void saveTrackCandidate(const point_t * const *hits, int nhits, double xtrack, double ytrack,
+            double xptrack, double yptrack, double chi2ndf);
+    bool found_tracks_with_nlayer(int nlayer);
+
+private:
+    void getCombinationList(const std::vector<int> &layers, const int &m,
+            std::vector<std::vector<int>>& res);
+    void fillSavedTracks();
+
+private:
+    TrackingUtility *tracking_utility;
+    Cuts *tracking_cuts;
+
+    std::unordered_map<int, AbstractDetector*> detector; // layer_id <-> detector
+    std::vector<int> layer_index; // vector of layer_id
+
+    std::unordered_map<int, std::vector<bool>> hit_used; // layer_index <-> detector hit status
+    std::unordered_map<int, int> n_hits_used;            // layer_index <-> number of hits used
+    long n_outer_combinations = 0;                       // unused hits on the outer layers of a group
+
+    int minimum_hits_on_track = 3;
+    double chi2_cut = 10;
+    int abort_quantity = 10000;
+    int max_track_save_quantity = 10;
+    bool multi_track_mode = false;
+    double multi_track_chi2_cut = 1;        // for the tracks after the first one
+
+    // optics cut
+    double k_min_yz = -9999, k_max_yz = 9999;
+    double k_min_xz = -9999, k_max_xz = 9999;
+
+    // all possible groups
+    std::unordered_map<int, std::vector<std::vector<int>>> group_nlayer;
+
+    // cache current working combination
+    std::vector<int> current_layer_comb; // optional, as (xtrack, ytrack), (xptrack, yptrack) is enough
+    std::vector<int> current_hit_comb;   // optional, as (xtrack, ytrack), (xptrack, yptrack) is enough
+
+    // candidate enumeration, reused for all combinations (one level per layer)
+    std::vector<int> grid_middle_layers;
+    std::vector<std::vector<int>> grid_hit_index;   // candidate hits on middle layers
+    std::vector<AbstractDetector*> comb_detectors;
+    std::vector<const point_t*> comb_hits;
+    std::vector<LineFitSums> comb_sums;             // sums of the hits on levels [0, i)
+    std::vector<size_t> comb_pos;                   // explicit stack of hit positions
+
+    // tracking result - best track
+    int best_track_index;
+    int n_tracks_found = 0;
+    int nhits_on_best_track;
+    std::vector<int> best_track_layer_index; // optional, as (xtrack, ytrack), (xptrack, yptrack) is enough
+    std::vector<int> best_track_hit_index;   // optional, as (xtrack, ytrack), (xptrack, yptrack) is enough
+    double best_track_chi2ndf = LARGE_VALUE;
+    double best_xtrack = LARGE_VALUE, best_ytrack = LARGE_VALUE;
+    double best_xptrack = LARGE_VALUE, best_yptrack = LARGE_VALUE;
+    //
+    std::unordered_map<int, double> best_track_chi2ndf_by_nlayer;
+
+    // tracking result - all good tracks that pass chi2 cut
+    // all possible track candidates, this is not exclusive.
+    // for example, if hit_1 is used by track_candidate_1, it can also be used by track_candidate_2
+    // this number estimate all possible combinations, b/c each combination have the same weight (we don't
+    // know how to assign weight to a track).
+    // in multi-track mode, only the candidates of the first search are counted
+    int n_good_track_candidates = 0;
+    std::vector<double> v_xtrack, v_ytrack, v_xptrack, v_yptrack, v_track_chi2ndf;
+    std::vector<int> v_track_nhits;
+    int n_total_good_hits;
+    std::vector<double> v_xlocal, v_ylocal, v_zlocal;
+    std::vector<int> v_hit_track_index;
+    std::vector<int> v_hit_module;
+
+    // the lowest chi2 tracks, a max-heap (worst track on top) of at most max_track_save_quantity
+    struct SavedHit
+    {
+        double x, y, z;
+        int module_id;
+    };
+    struct SavedTrack
+    {
+        double chi2ndf, xtrack, ytrack, xptrack, yptrack;
+        long order;        // order found, the earlier one is kept for the same chi2
+        int slot;          // index in saved_track_hits
+    };
+    std::vector<SavedTrack> saved_tracks;
+    std::vector<std::vector<SavedHit>> saved_track_hits;
+    long n_candidates_fitted = 0;
+    bool tracking_aborted = false;       // too many combinations in a layer group
+
+    // debug
+    std::vector<point_t> best_hits_on_track;
+
+    // multi-track mode, the best track of the event is the first one found
+    std::vector<int> first_track_layer_index, first_track_hit_index;
+    std::vector<point_t> first_hits_on_track;
+};
+
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "AbstractDetector.h"
 #include <cmath>
+#include <algorithm>
 
 namespace tracking_dev {
 
@@ -101,8 +102,8 @@ void AbstractDetector::Reset()
     // reset grid counters
     for(auto &i: grid_chosen)
         i.second = false;
-    for(auto &i: vhits_by_grid)
-        i.second.clear();
+    hit_grid_index.clear();
+    grid_hits_dirty = true;
 }
 
 void AbstractDetector::AddHit(const double &x, const double &y)
@@ -122,16 +123,9 @@ inline void AbstractDetector::addIndexHit(const point_t &p)
 {
     global_hits.push_back(p);
 
-    size_t index = global_hits.size() - 1;
-
-    double x_low = -dimension.x/2. - grid_shift;
-    double y_low = -dimension.y/2. - grid_shift;
-
-    int i = (p.x - x_low)/grid_xwidth;
-    int j = (p.y - y_low)/grid_ywidth;
-
-    grid_addr_t addr(i, j);
-    vhits_by_grid[addr].push_back(index);
+    // the hits are sorted into grids when the grid hits are requested
+    hit_grid_index.push_back(GetGridIndex(p));
+    grid_hits_dirty = true;
 }
 
 void AbstractDetector::SetupGrids()
@@ -140,15 +134,25 @@ void AbstractDetector::SetupGrids()
     int nbinsx = std::ceil((width + grid_shift)/grid_xwidth);
     int nbinsy = std::ceil((height + grid_shift)/grid_ywidth);
 
+    grids.clear();
+    grid_chosen.clear();
+    grid_nx = std::max(nbinsx, 0), grid_ny = std::max(nbinsy, 0);
+    grid_x_low = -dimension.x/2. - grid_shift;
+    grid_y_low = -dimension.y/2. - grid_shift;
+    grid_x1.resize(grid_nx), grid_x2.resize(grid_nx);
+    grid_y1.resize(grid_ny), grid_y2.resize(grid_ny);
+
     for(int i=0; i<nbinsx; i++)
     {
         double x_low = i*grid_xwidth - grid_shift - width/2.;
         double x_high = (i+1)*grid_xwidth - grid_shift - width/2.;
+        grid_x1[i] = x_low, grid_x2[i] = x_high;
 
         for(int j=0; j<nbinsy; j++)
         {
             double y_low = j*grid_ywidth - grid_shift - height/2.;
             double y_high = (j+1)*grid_ywidth - grid_shift - height/2.;
+            grid_y1[j] = y_low, grid_y2[j] = y_high;
 
             grid_addr_t addr(i, j);
             grid_t g(x_low, y_low, x_high, y_high);
@@ -162,66 +166,156 @@ void AbstractDetector::SetupGrids()
     // then include this neighbor grid
     neighbor_grid_marginx = grid_xwidth / 3.;
     neighbor_grid_marginy = grid_ywidth / 3.;
+
+    // grids to search for each grid and neighbor status (see GetGridNeighborStatus)
+    search_grid_offset.clear();
+    search_grids.clear();
+    auto add_grid = [&](int a, int b)
+    {
+        if(a >= 0 && a < grid_nx && b >= 0 && b < grid_ny)
+            search_grids.push_back(a*grid_ny + b);
+    };
+
+    for(int i=0; i<grid_nx; i++)
+    {
+        for(int j=0; j<grid_ny; j++)
+        {
+            for(int status=0; status<9; status++)
+            {
+                search_grid_offset.push_back(search_grids.size());
+                add_grid(i, j);
+
+                switch(status) {
+                    case 1:
+                        add_grid(i-1, j);
+                        break;
+                    case 2:
+                        { add_grid(i-1, j); add_grid(i, j+1); add_grid(i-1, j+1); }
+                        break;
+                    case 3:
+                        add_grid(i, j+1);
+                        break;
+                    case 4:
+                        { add_grid(i+1, j); add_grid(i+1, j+1); add_grid(i, j+1); }
+                        break;
+                    case 5:
+                        add_grid(i+1, j);
+                        break;
+                    case 6:
+                        { add_grid(i+1, j); add_grid(i+1, j-1); add_grid(i, j-1); }
+                        break;
+                    case 7:
+                        add_grid(i, j-1);
+                        break;
+                    case 8:
+                        { add_grid(i-1, j); add_grid(i-1, j-1); add_grid(i, j-1); }
+                        break;
+                    default:
+                        break;
+                };
+            }
+        }
+    }
+    search_grid_offset.push_back(search_grids.size());
+
+    // grids changed, sort the hits again
+    hit_grid_index.clear();
+    for(auto &p: global_hits)
+        hit_grid_index.push_back(GetGridIndex(p));
+    grid_hits_dirty = true;
 }
 
-std::vector<grid_addr_t> AbstractDetector::GetPointHomeGrids(const point_t &p)
+// grid index of a point, -1 if it is not in any grid
+int AbstractDetector::GetGridIndex(const point_t &p) const
 {
-    double x_low = -dimension.x/2. - grid_shift;
-    double y_low = -dimension.y/2. - grid_shift;
+    int i = (p.x - grid_x_low) / grid_xwidth;
+    int j = (p.y - grid_y_low) / grid_ywidth;
+
+    if(i < 0 || i >= grid_nx || j < 0 || j >= grid_ny)
+        return -1;
 
-    int i = (p.x - x_low) / grid_xwidth;
-    int j = (p.y - y_low) / grid_ywidth;
+    return i*grid_ny + j;
+}
 
-    grid_addr_t addr(i, j);
+int AbstractDetector::GetPointSearchGrids(const point_t &p, const int *&grid_index) const
+{
+    int index = GetGridIndex(p);
+    if(index < 0)
+        return 0;
 
-    std::vector<grid_addr_t> res;
+    int status = getNeighborStatus(p, index / grid_ny, index % grid_ny);
+    int k = index*9 + status;
 
-    if(grids.find(addr) == grids.end())
-        return res;
+    grid_index = &search_grids[search_grid_offset[k]];
+    return search_grid_offset[k + 1] - search_grid_offset[k];
+}
 
-    res.push_back(addr);
+std::vector<grid_addr_t> AbstractDetector::GetPointHomeGrids(const point_t &p)
+{
+    std::vector<grid_addr_t> res;
 
-    int status = GetGridNeighborStatus(p, addr);
+    const int *index;
+    int n = GetPointSearchGrids(p, index);
+    for(int k=0; k<n; k++)
+        res.emplace_back(index[k] / grid_ny, index[k] % grid_ny);
 
-    auto add_grid = [&](int a, int b)
+    return res;
+}
+
+// counting sort of the hits by grid, the hits in a grid keep the order they were added
+void AbstractDetector::buildGridHits()
+{
+    int ngrids = grid_nx * grid_ny;
+    grid_hit_offset.assign(ngrids + 1, 0);
+    for(auto &g: hit_grid_index)
+        if(g >= 0) grid_hit_offset[g + 1]++;
+    for(int g=0; g<ngrids; g++)
+        grid_hit_offset[g + 1] += grid_hit_offset[g];
+
+    grid_hits.resize(grid_hit_offset[ngrids]);
+    for(int i=0; i<(int)hit_grid_index.size(); i++)
     {
-        grid_addr_t tmp(a, b);
-        if(grids.find(tmp) != grids.end())
-            res.push_back(tmp);
-    };
+        int g = hit_grid_index[i];
+        if(g >= 0) grid_hits[grid_hit_offset[g]++] = i;
+    }
 
-    switch(status) {
-        case 0:
-            break;
-        case 1:
-            add_grid(i-1, j);
-            break;
-        case 2:
-            { add_grid(i-1, j); add_grid(i, j+1); add_grid(i-1, j+1); }
-            break;
-        case 3:
-            add_grid(i, j+1);
-            break;
-        case 4:
-            { add_grid(i+1, j); add_grid(i+1, j+1); add_grid(i, j+1); }
-            break;
-        case 5:
-            add_grid(i+1, j);
-            break;
-        case 6:
-            { add_grid(i+1, j); add_grid(i+1, j-1); add_grid(i, j-1); }
-            break;
-        case 7:
-            add_grid(i, j-1);
-            break;
-        case 8:
-            { add_grid(i-1, j); add_grid(i-1, j-1); add_grid(i, j-1); }
-            break;
-        default:
-            break;
-    };
+    // the offsets are now the grid ends, shift them back to the grid starts
+    for(int g=ngrids; g>0; g--)
+        grid_hit_offset[g] = grid_hit_offset[g - 1];
+    grid_hit_offset[0] = 0;
 
-    return res;
+    grid_hits_dirty = false;
+}
+
+const int *AbstractDetector::GetGridHits(int grid_index, int &nhits)
+{
+    if(grid_hits_dirty)
+        buildGridHits();
+
+    nhits = grid_hit_offset[grid_index + 1] - grid_hit_offset[grid_index];
+    return grid_hits.data() + grid_hit_offset[grid_index];
+}
+
+// the grids are sorted again at the next lookup without the removed hits
+void AbstractDetector::RemoveGridHit(int i)
+{
+    if(hit_grid_index[i] < 0)
+        return;
+
+    hit_grid_index[i] = -1;
+    grid_hits_dirty = true;
+}
+
+void AbstractDetector::RestoreGridHits()
+{
+    for(size_t i=0; i<global_hits.size(); i++)
+    {
+        int g = GetGridIndex(global_hits[i]);
+        if(g != hit_grid_index[i]) {
+            hit_grid_index[i] = g;
+            grid_hits_dirty = true;
+        }
+    }
 }
 
 // grid neighbor status
@@ -232,10 +326,15 @@ std::vector<grid_addr_t> AbstractDetector::GetPointHomeGrids(const point_t &p)
 // 8---7---6
 int AbstractDetector::GetGridNeighborStatus(const point_t &p, const grid_addr_t &addr)
 {
-    double x_left = p.x - grids.at(addr).x1;
-    double x_right = grids.at(addr).x2 - p.x;
-    double y_bottom = p.y - grids.at(addr).y1;
-    double y_top = grids.at(addr).y2 - p.y;
+    return getNeighborStatus(p, addr.x, addr.y);
+}
+
+int AbstractDetector::getNeighborStatus(const point_t &p, int i, int j) const
+{
+    double x_left = p.x - grid_x1[i];
+    double x_right = grid_x2[i] - p.x;
+    double y_bottom = p.y - grid_y1[j];
+    double y_top = grid_y2[j] - p.y;
 
     if(x_left < neighbor_grid_marginx){
         if(y_top < neighbor_grid_marginy)
@@ -264,9 +363,12 @@ int AbstractDetector::GetGridNeighborStatus(const point_t &p, const grid_addr_t
 
 void AbstractDetector::ShowGridHitStat()
 {
-    for(auto &i: vhits_by_grid)
+    for(int g=0; g<grid_nx*grid_ny; g++)
     {
-        std::cout<<i.first<<": "<<i.second.size()<<std::endl;
+        int n;
+        GetGridHits(g, n);
+        if(n > 0)
+            std::cout<<grid_addr_t(g / grid_ny, g % grid_ny)<<": "<<n<<std::endl;
     }
 }
 
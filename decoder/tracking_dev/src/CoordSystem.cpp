@@ -1,5 +1,7 @@
 #include "CoordSystem.h"
 #include <cmath>
+#include <algorithm>
+#include <iostream>
 
 namespace tracking_dev {
     CoordSystem::CoordSystem()
@@ -55,6 +57,44 @@ namespace tracking_dev {
             // is in tracker system or not
             tracker_config_gem[layer] = i.second.is_tracker;
         }
+
+        buildLayerTransforms();
+    }
+
+    void CoordSystem::buildLayerTransforms()
+    {
+        int max_layer = -1;
+        for(auto &i: angle_gem)
+            max_layer = std::max(max_layer, i.first);
+        for(auto &i: offset_gem)
+            max_layer = std::max(max_layer, i.first);
+
+        // layers not configured are not transformed
+        LayerTransform identity = {{{1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.}}, {0., 0., 0.}};
+        layer_transform.assign(max_layer + 1, identity);
+
+        for(int layer=0; layer<=max_layer; layer++)
+        {
+            point_t rot = angle_gem.count(layer) ? angle_gem.at(layer) : point_t(0, 0, 0);
+            point_t t = offset_gem.count(layer) ? offset_gem.at(layer) : point_t(0, 0, 0);
+
+            // same matrix elements as in Rotate
+            double c_gamma = std::cos(rot.x), s_gamma = std::sin(rot.x);
+            double c_beta = std::cos(rot.y), s_beta = std::sin(rot.y);
+            double c_alpha = std::cos(rot.z), s_alpha = std::sin(rot.z);
+
+            auto &m = layer_transform[layer];
+            m.r[0][0] = c_beta*c_gamma;
+            m.r[0][1] = s_alpha*s_beta*c_gamma - c_alpha*s_gamma;
+            m.r[0][2] = c_alpha*s_beta*c_gamma + s_alpha*s_gamma;
+            m.r[1][0] = c_beta*s_gamma;
+            m.r[1][1] = s_alpha*s_beta*s_gamma + c_alpha*c_gamma;
+            m.r[1][2] = c_alpha*s_beta*s_gamma - s_alpha*c_gamma;
+            m.r[2][0] = -s_beta;
+            m.r[2][1] = c_beta*s_gamma;
+            m.r[2][2] = c_beta*c_gamma;
+            m.t[0] = t.x, m.t[1] = t.y, m.t[2] = t.z;
+        }
     }
 
     void CoordSystem::Rotate(point_t & p, const point_t &rot)
@@ -99,6 +139,93 @@ namespace tracking_dev {
 
     void CoordSystem::Transform(point_t &p, int ilayer)
     {
-        Transform(p, angle_gem[ilayer], offset_gem[ilayer]);
+        if(ilayer < 0 || ilayer >= (int)layer_transform.size()) {
+            Transform(p, angle_gem[ilayer], offset_gem[ilayer]);
+            return;
+        }
+
+        TransformAll(ilayer, &p, &p, 1);
+    }
+
+    void CoordSystem::TransformAll(int ilayer, const point_t *in, point_t *out, size_t n) const
+    {
+        if(ilayer < 0 || ilayer >= (int)layer_transform.size()) {
+            for(size_t i=0; i<n; i++) {
+                if(&out[i] != &in[i]) out[i] = in[i];
+            }
+            return;
+        }
+
+        // rotation is in gem local coordinates (local z = 0), so only the first two columns are used
+        const auto &m = layer_transform[ilayer];
+        const double r00 = m.r[0][0], r01 = m.r[0][1], r10 = m.r[1][0], r11 = m.r[1][1];
+        const double r20 = m.r[2][0], r21 = m.r[2][1];
+        const double tx = m.t[0], ty = m.t[1], tz = m.t[2];
+
+        for(size_t i=0; i<n; i++)
+        {
+            double x = in[i].x, y = in[i].y, z = in[i].z;
+            if(&out[i] != &in[i]) out[i] = in[i];
+
+            out[i].x = (r00 * x + r01 * y) + tx;
+            out[i].y = (r10 * x + r11 * y) + ty;
+            out[i].z = ((r20 * x + r21 * y) + z) + tz;
+        }
+    }
+
+    // compare the batch transform to the per-hit rotation and translation, returns true if they agree
+    // the configured layers are tested, and the same layers with tilted and shifted planes, so the rotation
+    // is also tested when the configuration has no tilt
+    bool CoordSystem::UnitTest()
+    {
+        std::cout<<"CoordSystem Unit Test."<<std::endl;
+
+        std::vector<point_t> in;
+        for(int i=0; i<1000; i++)
+            in.emplace_back((i%40 - 20)*2.56 + 0.013*i, (i/40 - 12)*4.1 - 0.007*i, 0.);
+
+        CoordSystem tilted(*this);
+        for(int layer=0; layer<(int)layer_transform.size(); layer++)
+        {
+            tilted.angle_gem[layer] = point_t(0.01*(layer + 1), -0.02*(layer + 1), 0.003*(layer + 1));
+            tilted.offset_gem[layer] = point_t(1.5*layer, -2.25, 0.7*layer);
+        }
+        tilted.buildLayerTransforms();
+
+        std::cout<<"configured layers:"<<std::endl;
+        bool passed = checkTransformAll(in);
+        std::cout<<"tilted layers:"<<std::endl;
+        passed = tilted.checkTransformAll(in) && passed;
+
+        std::cout<<(passed ? "passed." : "FAILED.")<<std::endl;
+        return passed;
+    }
+
+    bool CoordSystem::checkTransformAll(const std::vector<point_t> &in)
+    {
+        std::vector<point_t> out(in.size());
+        bool passed = true;
+        for(int layer=0; layer<(int)layer_transform.size(); layer++)
+        {
+            TransformAll(layer, in.data(), out.data(), in.size());
+
+            // layers not configured are not transformed, same as buildLayerTransforms
+            point_t rot = angle_gem.count(layer) ? angle_gem.at(layer) : point_t(0, 0, 0);
+            point_t t = offset_gem.count(layer) ? offset_gem.at(layer) : point_t(0, 0, 0);
+
+            double max_diff = 0.;
+            for(size_t i=0; i<in.size(); i++)
+            {
+                point_t p = in[i];
+                Transform(p, rot, t);
+                max_diff = std::max(max_diff, std::abs(p.x - out[i].x));
+                max_diff = std::max(max_diff, std::abs(p.y - out[i].y));
+                max_diff = std::max(max_diff, std::abs(p.z - out[i].z));
+            }
+            std::cout<<"layer "<<layer<<": max difference = "<<max_diff<<std::endl;
+            if(max_diff > 1e-9)
+                passed = false;
+        }
+        return passed;
     }
 };
@@ -0,0 +1,149 @@
+#include "ToyEventGenerator.h"
+#include "AbstractDetector.h"
+#include <cmath>
+
+namespace tracking_dev {
+
+ToyEventGenerator::ToyEventGenerator(unsigned int seed) : rng(seed)
+{
+}
+
+ToyEventGenerator::~ToyEventGenerator()
+{
+}
+
+void ToyEventGenerator::AddDetector(AbstractDetector *det)
+{
+    detectors.push_back(det);
+    det_xoffset.push_back(0.);
+    det_yoffset.push_back(0.);
+    hit_track.emplace_back();
+}
+
+// shift all hits on a detector, to mimic a misaligned detector
+void ToyEventGenerator::SetDetectorOffset(int i, double x, double y)
+{
+    det_xoffset.at(i) = x;
+    det_yoffset.at(i) = y;
+}
+
+void ToyEventGenerator::ClearEvent()
+{
+    for(auto &det: detectors)
+        det -> Reset();
+    for(auto &v: hit_track)
+        v.clear();
+
+    tracks.clear();
+}
+
+void ToyEventGenerator::GenerateTrack()
+{
+    std::uniform_real_distribution<double> xrand(-vertex_xrange, vertex_xrange);
+    std::uniform_real_distribution<double> yrand(-vertex_yrange, vertex_yrange);
+    std::uniform_real_distribution<double> xdir(-slope_xrange, slope_xrange);
+    std::uniform_real_distribution<double> ydir(-slope_yrange, slope_yrange);
+    std::normal_distribution<double> smear(0., resolution);
+
+    toy_track_t track;
+    track.x = xrand(rng), track.y = yrand(rng);
+    track.xp = xdir(rng), track.yp = ydir(rng);
+    track.nhits = 0;
+
+    int track_index = (int)tracks.size();
+    for(size_t i=0; i<detectors.size(); i++)
+    {
+        const point_t &origin = detectors[i] -> GetOrigin();
+        const point_t &dim = detectors[i] -> GetDimension();
+
+        point_t v(track.x + track.xp * origin.z, track.y + track.yp * origin.z, origin.z);
+
+        // smear by resolution
+        v.x += smear(rng) + det_xoffset[i];
+        v.y += smear(rng) + det_yoffset[i];
+
+        // outside the detector
+        if(std::abs(v.x - origin.x) > dim.x / 2. || std::abs(v.y - origin.y) > dim.y / 2.)
+            continue;
+
+        detectors[i] -> AddRealHits(v); // for drawing purpose
+        addHit(i, v, track_index);
+        track.nhits++;
+    }
+
+    tracks.push_back(track);
+}
+
+void ToyEventGenerator::AddBackground(int nhits_per_detector)
+{
+    for(size_t i=0; i<detectors.size(); i++)
+    {
+        const point_t &origin = detectors[i] -> GetOrigin();
+        const point_t &dim = detectors[i] -> GetDimension();
+
+        double xr = (bkg_xrange < 0) ? dim.x / 2. : bkg_xrange;
+        double yr = (bkg_yrange < 0) ? dim.y / 2. : bkg_yrange;
+        std::uniform_real_distribution<double> xrand(-xr, xr);
+        std::uniform_real_distribution<double> yrand(-yr, yr);
+
+        for(int j=0; j<nhits_per_detector; j++)
+        {
+            point_t v = origin;
+            v.x += xrand(rng) + det_xoffset[i];
+            v.y += yrand(rng) + det_yoffset[i];
+
+            detectors[i] -> AddBackgroundHits(v); // for drawing purpose
+            addHit(i, v, -1);
+        }
+    }
+}
+
+void ToyEventGenerator::addHit(int idet, const point_t &p, int track_index)
+{
+    detectors[idet] -> AddHit(p);
+    hit_track[idet].push_back(track_index);
+}
+
+int ToyEventGenerator::GetHitTrack(int idet, int hit_index) const
+{
+    return hit_track.at(idet).at(hit_index);
+}
+
+int ToyEventGenerator::FindHitTrack(const point_t &p) const
+{
+    for(size_t i=0; i<detectors.size(); i++)
+    {
+        if(detectors[i] -> GetOrigin().z != p.z)
+            continue;
+
+        const std::vector<point_t> &hits = detectors[i] -> GetHits();
+        for(size_t j=0; j<hits.size(); j++)
+        {
+            if(hits[j].x == p.x && hits[j].y == p.y)
+                return hit_track[i][j];
+        }
+    }
+
+    return -2;
+}
+
+std::vector<int> ToyEventGenerator::MatchTracks(int ntracks, const std::vector<double> &x,
+        const std::vector<double> &y, const std::vector<double> &z,
+        const std::vector<int> &hit_track_index) const
+{
+    // -2: no hit checked yet, -1: fake, >= 0: the truth track
+    std::vector<int> owner(ntracks, -2);
+    for(size_t i=0; i<x.size(); i++)
+    {
+        int &o = owner[hit_track_index[i]];
+        int k = FindHitTrack(point_t(x[i], y[i], z[i]));
+        o = ((o == -2 || o == k) && k >= 0) ? k : -1;
+    }
+
+    for(auto &o: owner)
+        if(o < 0) o = -1;
+
+    return owner;
+}
+
+};
@@ -37,6 +37,8 @@ void Tracking::CompleteSetup()
     chi2_cut = (tracking_cuts -> __get("track max chi2")).val<float>();
     abort_quantity = (tracking_cuts -> __get("abort tracking quantity")).val<int>();
     max_track_save_quantity = (tracking_cuts -> __get("save max track quantity")).val<int>();
+    multi_track_mode = (tracking_cuts -> __get("multi-track mode")).val<bool>();
+    multi_track_chi2_cut = (tracking_cuts -> __get("multi-track max chi2")).val<float>();
 
     k_min_xz = (tracking_cuts -> __get("track x-z slope range")).arr<double>()[0];
     k_max_xz = (tracking_cuts -> __get("track x-z slope range")).arr<double>()[1];
@@ -53,11 +55,18 @@ void Tracking::FindTracks()
 {
     ClearPreviousEvent();
 
+    initHitStatus();
+
     //PrintHitStatus();
 
+    if(multi_track_mode) {
+        findExclusiveTracks();
+        return;
+    }
+
     loopAllLayerGroups();
 
-    vectorize_map();
+    fillSavedTracks();
 
     //std::cout<<"---- best hits used to fit tracks: "<<std::endl;
     //for(auto &i: best_hits_on_track)
@@ -80,6 +89,26 @@ void Tracking::FindTracks()
 void Tracking::ClearPreviousEvent()
 {
     best_track_index = -1;
+    clearBestTrack();
+
+    n_good_track_candidates =  0;
+    n_tracks_found = 0;
+    v_xtrack.clear(), v_ytrack.clear(), v_xptrack.clear(), v_yptrack.clear();
+    v_track_chi2ndf.clear();
+    v_track_nhits.clear();
+
+    n_total_good_hits = 0;
+    v_xlocal.clear(), v_ylocal.clear(), v_zlocal.clear();
+    v_hit_track_index.clear();
+    v_hit_module.clear();
+
+    saved_tracks.clear();
+    n_candidates_fitted = 0;
+    tracking_aborted = false;
+}
+
+void Tracking::clearBestTrack()
+{
     best_track_chi2ndf = LARGE_VALUE;
     best_xtrack = LARGE_VALUE; best_ytrack = LARGE_VALUE;
     best_xptrack = LARGE_VALUE; best_yptrack = LARGE_VALUE;
@@ -94,24 +123,6 @@ void Tracking::ClearPreviousEvent()
 
     // debug
     best_hits_on_track.clear();
-
-    n_good_track_candidates =  0;
-    n_tracks_found = 0;
-    v_xtrack.clear(), v_ytrack.clear(), v_xptrack.clear(), v_yptrack.clear();
-    v_track_chi2ndf.clear();
-    v_track_nhits.clear();
-
-    n_total_good_hits = 0;
-    v_xlocal.clear(), v_ylocal.clear(), v_zlocal.clear();
-    v_hit_track_index.clear();
-    v_hit_module.clear();
-
-    m_xtrack.clear(), m_ytrack.clear(), m_xptrack.clear(), m_yptrack.clear();
-    m_track_chi2ndf.clear();
-    m_track_nhits.clear();
-    m_xlocal.clear(), m_ylocal.clear(), m_zlocal.clear();
-    m_hit_track_index.clear();
-    m_hit_module.clear();
 }
 
 bool Tracking::GetBestTrack(double &xt, double &yt, double &xp, double &yp, double &chi)
@@ -128,13 +139,88 @@ bool Tracking::GetBestTrack(double &xt, double &yt, double &xp, double &yp, doub
 
 void Tracking::initHitStatus()
 {
-    hit_used.clear();
-
     for(auto &i: detector)
     {
         unsigned int n = i.second -> Get2DHitCounts();
-        std::vector<bool> tmp(n, false);
-        hit_used[i.first] = tmp;
+        hit_used[i.first].assign(n, false);
+        n_hits_used[i.first] = 0;
+    }
+}
+
+// multi-track mode: find the best track, remove its hits from the search, and
+// repeat with the remaining hits until no more track is found (or the max
+// number of tracks to save is reached), so the tracks found do not share hits
+void Tracking::findExclusiveTracks()
+{
+    while(n_tracks_found < max_track_save_quantity)
+    {
+        clearBestTrack();
+        loopAllLayerGroups();
+
+        // no track passed the cuts
+        if(best_track_chi2ndf >= LARGE_VALUE)
+            break;
+
+        // the later tracks are searched in the hits left, where the background
+        // hits easily line up to pass the chi2 cut, so they have a tighter one,
+        // the search stops at the first best track failing it
+        if(n_tracks_found > 0 && best_track_chi2ndf > multi_track_chi2_cut)
+            break;
+
+        int itrack = n_tracks_found++;
+        v_xtrack.push_back(best_xtrack), v_ytrack.push_back(best_ytrack);
+        v_xptrack.push_back(best_xptrack), v_yptrack.push_back(best_yptrack);
+        v_track_chi2ndf.push_back(best_track_chi2ndf);
+        v_track_nhits.push_back(nhits_on_best_track);
+
+        n_total_good_hits += nhits_on_best_track;
+        for(auto &h: best_hits_on_track) {
+            v_xlocal.push_back(h.x), v_ylocal.push_back(h.y), v_zlocal.push_back(h.z);
+            v_hit_track_index.push_back(itrack);
+            v_hit_module.push_back(h.module_id);
+        }
+
+        if(itrack == 0) {
+            first_track_layer_index = best_track_layer_index;
+            first_track_hit_index = best_track_hit_index;
+            first_hits_on_track = best_hits_on_track;
+        }
+
+        useBestTrackHits();
+    }
+
+    // put the removed hits back, the detectors keep the event as it was added
+    if(n_tracks_found > 0) {
+        for(auto &i: detector)
+            i.second -> RestoreGridHits();
+    }
+
+    // the best track of the event is the first one found
+    clearBestTrack();
+    if(n_tracks_found == 0)
+        return;
+
+    best_track_index = 0;
+    best_track_chi2ndf = v_track_chi2ndf[0];
+    best_xtrack = v_xtrack[0], best_ytrack = v_ytrack[0];
+    best_xptrack = v_xptrack[0], best_yptrack = v_yptrack[0];
+    nhits_on_best_track = v_track_nhits[0];
+    best_track_layer_index.swap(first_track_layer_index);
+    best_track_hit_index.swap(first_track_hit_index);
+    best_hits_on_track.swap(first_hits_on_track);
+}
+
+// mark the hits of the best track used, and take them out of the grids
+void Tracking::useBestTrackHits()
+{
+    for(size_t i=0; i<best_track_layer_index.size(); i++)
+    {
+        int layer = best_track_layer_index[i];
+        int hit = best_track_hit_index[i];
+
+        hit_used[layer][hit] = true;
+        n_hits_used[layer]++;
+        detector[layer] -> RemoveGridHit(hit);
     }
 }
 
@@ -168,6 +254,7 @@ void Tracking::nextLayerGroup(const std::vector<int> &group)
 {
     std::vector<int> hit_counts;
 
+    // the used hits are skipped when the candidates are fitted
     for(auto &i: group)
     {
         unsigned int nhits_this_layer = detector[i] -> Get2DHitCounts();
@@ -230,89 +317,106 @@ void Tracking::nextLayerGroup_gridway(const std::vector<int> &group)
     int end_layer = group.back();
 
     // middle layers
-    std::vector<int> middle_layers;
-    for(int i=1; i<(int)group.size() - 1; i++)
-    {
-        middle_layers.push_back(group[i]);
-    }
+    std::vector<int> &middle_layers = grid_middle_layers;
+    middle_layers.assign(group.begin() + 1, group.end() - 1);
 
     // optics cut for outer layers - to be implemented in here
     int S = (int)detector.at(start_layer) -> Get2DHitCounts();
     int E = (int)detector.at(end_layer) -> Get2DHitCounts();
 
     // if possible combinations in outter layers already passed max quantity, abort tracking
-    if(S * E > abort_quantity) return;
+    // (hits used by the tracks found are not counted)
+    n_outer_combinations = (long)(S - n_hits_used.at(start_layer)) * (E - n_hits_used.at(end_layer));
+    if(n_outer_combinations > abort_quantity) {
+        tracking_aborted = true;
+        return;
+    }
+
+    const std::vector<bool> &start_used = hit_used.at(start_layer);
+    const std::vector<bool> &end_used = hit_used.at(end_layer);
 
     for(int start_layer_hit_index=0; start_layer_hit_index<S; start_layer_hit_index++)
     {
+        if(start_used[start_layer_hit_index])
+            continue;
+
         for(int end_layer_hit_index=0; end_layer_hit_index<E; end_layer_hit_index++)
         {
+            if(end_used[end_layer_hit_index])
+                continue;
+
             scanCandidate_gridway(start_layer, start_layer_hit_index,
                     end_layer, end_layer_hit_index, middle_layers);
         }
     }
 }
 
-// a helper
+// a helper, loop over all hit combinations on the middle layers for the given outer layer hits,
+// it is iterative with an explicit stack of hit positions, and the least-squares sums are kept
+// for each level, so changing the hit on a layer only adds that hit to the sums of the level above
 void Tracking::scanCandidate_gridway(const int &start_layer, const int &start_layer_hit_index,
         const int &end_layer, const int& end_layer_hit_index,
         const std::vector<int> &middle_layers)
 {
-    std::unordered_map<int, std::vector<int>> hit_index_by_layer; // for middle layers
-
     getMiddleLayerGridHitIndex(start_layer, start_layer_hit_index,
-            end_layer, end_layer_hit_index, middle_layers, hit_index_by_layer);
+            end_layer, end_layer_hit_index, middle_layers, grid_hit_index);
 
     // abort tracking when combinations is too many, too much computing time
-    int possible_track_combinations = ((int)detector.at(start_layer) -> Get2DHitCounts()) *
-        ((int)detector.at(end_layer) -> Get2DHitCounts());
-    for(auto &i: middle_layers)
-        possible_track_combinations *= (hit_index_by_layer.at(i).size());
+    long possible_track_combinations = n_outer_combinations;
+    for(size_t i=0; i<middle_layers.size(); i++)
+        possible_track_combinations *= grid_hit_index[i].size();
 
     if(possible_track_combinations > abort_quantity)
-        return;
+        tracking_aborted = true;
 
-    std::vector<int> layer_combo{start_layer, end_layer};
-    std::vector<int> hit_combo{start_layer_hit_index, end_layer_hit_index};
-
-    int remaining_layers = middle_layers.size();
-    scanCandidate_gridway(hit_index_by_layer, layer_combo, hit_combo, 
-            middle_layers, remaining_layers);
-}
-
-// a recursive helper
-void Tracking::scanCandidate_gridway(const std::unordered_map<int, std::vector<int>> &vhitid_by_layer,
-        std::vector<int> layer_combo, std::vector<int> hit_combo,
-        const std::vector<int> &middle_layers,
-        int remainning_layer)
-{
-    if(remainning_layer < 0)
+    if(possible_track_combinations > abort_quantity || possible_track_combinations == 0)
         return;
 
-    if(remainning_layer == 0)
-    {
-        // found candidates
-        current_hit_comb.clear();
-        current_hit_comb = hit_combo;
-        current_layer_comb.clear();
-        current_layer_comb = layer_combo; // cache current layer group
+    // combination layout: start layer, end layer, then the middle layers in reverse order
+    int nmiddle = (int)middle_layers.size();
+    int nlevels = nmiddle + 2;
+    current_layer_comb.resize(nlevels), current_hit_comb.resize(nlevels);
+    comb_detectors.resize(nlevels), comb_hits.resize(nlevels);
+    comb_sums.resize(nlevels + 1), comb_pos.assign(nlevels, 0);
+
+    current_layer_comb[0] = start_layer, current_hit_comb[0] = start_layer_hit_index;
+    current_layer_comb[1] = end_layer, current_hit_comb[1] = end_layer_hit_index;
+    for(int i=0; i<nmiddle; i++)
+        current_layer_comb[i + 2] = middle_layers[nmiddle - 1 - i];
+    for(int i=0; i<nlevels; i++)
+        comb_detectors[i] = detector.at(current_layer_comb[i]);
+
+    comb_sums[0] = LineFitSums();
+    for(int i=0; i<2; i++) {
+        comb_hits[i] = &comb_detectors[i] -> Get2DHit(current_hit_comb[i]);
+        comb_sums[i + 1] = comb_sums[i].Add(*comb_hits[i]);
+    }
 
-        nextTrackCandidate(layer_combo, hit_combo);
+    if(nmiddle == 0) {
+        nextTrackCandidate(comb_hits.data(), nlevels, comb_sums[nlevels]);
         return;
     }
 
-    int layer = middle_layers.at(remainning_layer-1);
-    remainning_layer--;
-    layer_combo.push_back(layer);
-
-    for(auto &i: vhitid_by_layer.at(layer))
+    int level = 2;
+    while(level >= 2)
     {
-        hit_combo.push_back(i);
+        const std::vector<int> &candidates = grid_hit_index[nmiddle - 1 - (level - 2)];
+        if(comb_pos[level] >= candidates.size()) {
+            comb_pos[level] = 0;
+            level--;
+            continue;
+        }
 
-        scanCandidate_gridway(vhitid_by_layer, layer_combo, hit_combo,
-                middle_layers, remainning_layer);
+        int hit_index = candidates[comb_pos[level]++];
+        current_hit_comb[level] = hit_index;
+        comb_hits[level] = &comb_detectors[level] -> Get2DHit(hit_index);
+        comb_sums[level + 1] = comb_sums[level].Add(*comb_hits[level]);
 
-        hit_combo.pop_back();
+        // found candidates
+        if(level == nlevels - 1)
+            nextTrackCandidate(comb_hits.data(), nlevels, comb_sums[nlevels]);
+        else
+            level++;
     }
 }
 
@@ -320,30 +424,30 @@ void Tracking::scanCandidate_gridway(const std::unordered_map<int, std::vector<i
 void Tracking::getMiddleLayerGridHitIndex(const int &start_layer, 
         const int &start_layer_hitindex, const int &end_layer, const int &end_layer_hitindex,
         const std::vector<int> &middle_layers,
-        std::unordered_map<int, std::vector<int>> &hit_index_by_layer)
+        std::vector<std::vector<int>> &hit_index_by_layer)
 {
-    point_t p_start = detector[start_layer] -> Get2DHit(start_layer_hitindex);
-    point_t p_end = detector[end_layer] -> Get2DHit(end_layer_hitindex);
+    const point_t &p_start = detector[start_layer] -> Get2DHit(start_layer_hitindex);
+    const point_t &p_end = detector[end_layer] -> Get2DHit(end_layer_hitindex);
+
+    if(hit_index_by_layer.size() < middle_layers.size())
+        hit_index_by_layer.resize(middle_layers.size());
 
-    for(auto &i: middle_layers)
+    for(size_t l=0; l<middle_layers.size(); l++)
     {
-        double z = detector[i] ->GetZPosition();
+        AbstractDetector *det = detector[middle_layers[l]];
+        double z = det -> GetZPosition();
         point_t p = tracking_utility -> intersection_point(p_start, p_end, z);
-        std::vector<grid_addr_t> home_grids = detector[i] -> GetPointHomeGrids(p);
-
-        const auto &vhits_by_grid = detector[i] -> GetGridVHits();
-
-        std::vector<int> tmp_vhits;
 
-        for(auto &addr: home_grids) {
-            if(vhits_by_grid.find(addr) == vhits_by_grid.end())
-                continue;
+        std::vector<int> &tmp_vhits = hit_index_by_layer[l];
+        tmp_vhits.clear();
 
-            tmp_vhits.insert(tmp_vhits.end(), vhits_by_grid.at(addr).begin(),
-                    vhits_by_grid.at(addr).end());
+        const int *grids;
+        int ngrids = det -> GetPointSearchGrids(p, grids);
+        for(int g=0; g<ngrids; g++) {
+            int nhits;
+            const int *hits = det -> GetGridHits(grids[g], nhits);
+            tmp_vhits.insert(tmp_vhits.end(), hits, hits + nhits);
         }
-
-        hit_index_by_layer[i] = tmp_vhits;
     }
 }
 
@@ -399,93 +503,104 @@ void Tracking::nextTrackCandidate(const std::vector<int> &layer_id,
         exit(0);
     }
 
-    std::vector<point_t> hits;
-
+    comb_hits.resize(layer_id.size());
+    LineFitSums sums;
     for(unsigned int i=0; i<layer_id.size(); i++)
     {
-        hits.push_back(detector[layer_id[i]] -> Get2DHit(hit_index[i]));
+        // hit used by a track found
+        if(hit_used[layer_id[i]][hit_index[i]])
+            return;
+
+        comb_hits[i] = &detector[layer_id[i]] -> Get2DHit(hit_index[i]);
+        sums = sums.Add(*comb_hits[i]);
     }
 
-    nextTrackCandidate(hits);
+    nextTrackCandidate(comb_hits.data(), (int)comb_hits.size(), sums);
 }
 
 //
 void Tracking::nextTrackCandidate(const std::vector<std::pair<int, int>>& combo)
 {
-    std::vector<point_t> hits;
-    for(auto &i: combo) {
-        hits.push_back(detector[i.first] -> Get2DHit(i.second));
+    comb_hits.resize(combo.size());
+    LineFitSums sums;
+    for(unsigned int i=0; i<combo.size(); i++) {
+        comb_hits[i] = &detector[combo[i].first] -> Get2DHit(combo[i].second);
+        sums = sums.Add(*comb_hits[i]);
     }
 
-    nextTrackCandidate(hits);
+    nextTrackCandidate(comb_hits.data(), (int)comb_hits.size(), sums);
 }
 
 //
 void Tracking::nextTrackCandidate(const std::vector<point_t> &hits)
+{
+    comb_hits.resize(hits.size());
+    LineFitSums sums;
+    for(unsigned int i=0; i<hits.size(); i++) {
+        comb_hits[i] = &hits[i];
+        sums = sums.Add(hits[i]);
+    }
+
+    nextTrackCandidate(comb_hits.data(), (int)comb_hits.size(), sums);
+}
+
+//
+void Tracking::nextTrackCandidate(const point_t * const *hits, int nhits, const LineFitSums &sums)
 {
     // @parameters:
     //           (xtrack, ytrack) : track projected 2D points at z = 0
     //         (xptrack, yptrack) : track slope at x-z, y-z plane
     //                    chi2ndf : reduced chi square
-    // std::vector<double> xresid : x residue for each layer
-    // std::vector<double> yresid : y residue for each layer
+    // same as TrackingUtility::FitLine, but the sums are accumulated by the caller
+    // and the residuals are not saved
 
-    double xtrack, ytrack, xptrack, yptrack, chi2ndf;
-    std::vector<double> xresid, yresid;
+    n_candidates_fitted++;
 
-    tracking_utility -> FitLine(hits, xtrack, ytrack, xptrack, yptrack,
-            chi2ndf, xresid, yresid);
+    double nhits_ = (double)nhits;
+    double denominator = (sums.sumz2 * nhits_ - sums.sumz * sums.sumz);
+
+    double xptrack = (nhits_ * sums.sumxz - sums.sumx * sums.sumz) / denominator;
+    double yptrack = (nhits_ * sums.sumyz - sums.sumy * sums.sumz) / denominator;
+    double xtrack = (sums.sumx * sums.sumz2 - sums.sumxz * sums.sumz) / denominator;
+    double ytrack = (sums.sumy * sums.sumz2 - sums.sumyz * sums.sumz) / denominator;
 
     // slope cut
     if(xptrack < k_min_xz || xptrack > k_max_xz) return;
     if(yptrack < k_min_yz || yptrack > k_max_yz) return;
 
+    // residuals to the track projected at each hit
+    point_t slope_track = point_t(xptrack, yptrack, 1.).unit();
+    double chi2 = 0.;
+    for(int i=0; i<nhits; i++)
+    {
+        double r = hits[i] -> z / slope_track.z;
+        double dx = xtrack + slope_track.x * r - hits[i] -> x;
+        double dy = ytrack + slope_track.y * r - hits[i] -> y;
+        chi2 += dx * dx + dy * dy;
+    }
+
+    double ndf = 2. * nhits_ - 4;
+    if(ndf <= 0) ndf = 1.;
+    double chi2ndf = chi2 / ndf;
+
     // chi2ndf too big
     if(chi2ndf > chi2_cut) return;
 
-    // using map here is only for sorting purpose, keep the 20 lowest chi2 tracks
-    if((int)m_xtrack.size() <= max_track_save_quantity || chi2ndf < (std::prev(m_xtrack.end()) -> first))
-    {
+    // every candidate passing the cuts is counted, as the old saved map did: it
+    // was trimmed back to max_track_save_quantity after each insertion, so its
+    // insertion condition (size <= max_track_save_quantity) always held.
+    // in multi-track mode, only the first search (with all the hits) is counted,
+    // so the number means the same in both modes
+    if(!multi_track_mode || n_tracks_found == 0)
         n_good_track_candidates++;
-        n_tracks_found++;
-        m_xtrack[chi2ndf] = xtrack, m_ytrack[chi2ndf] = ytrack;
-        m_xptrack[chi2ndf] = xptrack, m_yptrack[chi2ndf] = yptrack;
-        m_track_chi2ndf[chi2ndf] = chi2ndf; // for consistency
-        m_track_nhits[chi2ndf] = (int)hits.size();
-
-        int track_index_ = std::distance(m_xtrack.begin(), m_xtrack.find(chi2ndf));
-
-        n_total_good_hits += (int)hits.size();
-        for(auto &i: hits) {
-            m_xlocal[chi2ndf].emplace_back(i.x), m_ylocal[chi2ndf].emplace_back(i.y);
-            m_zlocal[chi2ndf].emplace_back(i.z);
-            m_hit_track_index[chi2ndf].emplace_back(track_index_);
-            m_hit_module[chi2ndf].emplace_back(i.module_id);
-        }
-    }
 
-    // erase the current biggest chi2 track
-    if((int)m_xtrack.size() > max_track_save_quantity)
-    {
-        n_tracks_found--;
-        m_xtrack.erase(std::prev(m_xtrack.end())), m_ytrack.erase(std::prev(m_ytrack.end()));
-        m_xptrack.erase(std::prev(m_xptrack.end())), m_yptrack.erase(std::prev(m_yptrack.end()));
-        m_track_chi2ndf.erase(std::prev(m_track_chi2ndf.end()));
-        m_track_nhits.erase(std::prev(m_track_nhits.end()));
-
-        int nhits_in_last_track = m_xlocal.rbegin() -> second.size();
-        n_total_good_hits -= nhits_in_last_track;
-        m_xlocal.erase(std::prev(m_xlocal.end())), m_ylocal.erase(std::prev(m_ylocal.end()));
-        m_zlocal.erase(std::prev(m_zlocal.end()));
-        m_hit_track_index.erase(std::prev(m_hit_track_index.end()));
-        m_hit_module.erase(std::prev(m_hit_module.end()));
-    }
+    // in multi-track mode, only the best track of each search is kept
+    if(!multi_track_mode)
+        saveTrackCandidate(hits, nhits, xtrack, ytrack, xptrack, yptrack, chi2ndf);
 
     // best track, the one with minimum chi2
     if(chi2ndf < best_track_chi2ndf)
     {
-        best_track_index = (int)v_xtrack.size() - 1;
-
         best_track_chi2ndf = chi2ndf;
         best_xtrack = xtrack;
         best_ytrack = ytrack;
@@ -493,20 +608,64 @@ void Tracking::nextTrackCandidate(const std::vector<point_t> &hits)
         best_yptrack = yptrack;
 
         // optional
-        best_track_layer_index = current_layer_comb;
-        best_track_hit_index = current_hit_comb;
+        best_track_layer_index.assign(current_layer_comb.begin(), current_layer_comb.begin() + nhits);
+        best_track_hit_index.assign(current_hit_comb.begin(), current_hit_comb.begin() + nhits);
 
-        nhits_on_best_track = (int) hits.size();
+        nhits_on_best_track = nhits;
 
         // chi2ndf by number of layers
         best_track_chi2ndf_by_nlayer[nhits_on_best_track] = chi2ndf;
 
         // debug
         best_hits_on_track.clear();
-        best_hits_on_track = hits;
+        for(int i=0; i<nhits; i++)
+            best_hits_on_track.push_back(*hits[i]);
     }
 }
 
+// keep the lowest chi2 tracks, the one on top of the heap is the first to be replaced
+static inline bool saved_track_less(double chi2_a, long order_a, double chi2_b, long order_b)
+{
+    return chi2_a < chi2_b || (chi2_a == chi2_b && order_a < order_b);
+}
+
+void Tracking::saveTrackCandidate(const point_t * const *hits, int nhits, double xtrack, double ytrack,
+        double xptrack, double yptrack, double chi2ndf)
+{
+    if(max_track_save_quantity <= 0)
+        return;
+
+    auto heap_less = [](const SavedTrack &a, const SavedTrack &b) {
+        return saved_track_less(a.chi2ndf, a.order, b.chi2ndf, b.order);
+    };
+
+    int slot;
+    if((int)saved_tracks.size() < max_track_save_quantity) {
+        slot = (int)saved_tracks.size();
+        saved_tracks.push_back(SavedTrack());
+    } else {
+        // not better than the worst saved track
+        if(!saved_track_less(chi2ndf, n_candidates_fitted, saved_tracks.front().chi2ndf, saved_tracks.front().order))
+            return;
+        std::pop_heap(saved_tracks.begin(), saved_tracks.end(), heap_less);
+        slot = saved_tracks.back().slot;
+    }
+
+    SavedTrack &t = saved_tracks.back();
+    t.chi2ndf = chi2ndf, t.xtrack = xtrack, t.ytrack = ytrack;
+    t.xptrack = xptrack, t.yptrack = yptrack;
+    t.order = n_candidates_fitted, t.slot = slot;
+    std::push_heap(saved_tracks.begin(), saved_tracks.end(), heap_less);
+
+    // the hit buffers are kept between events
+    if((int)saved_track_hits.size() <= slot)
+        saved_track_hits.resize(slot + 1);
+    auto &saved_hits = saved_track_hits[slot];
+    saved_hits.resize(nhits);
+    for(int i=0; i<nhits; i++)
+        saved_hits[i] = SavedHit{hits[i] -> x, hits[i] -> y, hits[i] -> z, hits[i] -> module_id};
+}
+
 //
 void Tracking::initLayerGroups()
 {
@@ -534,17 +693,33 @@ bool Tracking::found_tracks_with_nlayer(int nlayer)
     return true;
 }
 
-// 
-void Tracking::vectorize_map()
+// sort the saved tracks by chi2, and fill them to the result vectors
+void Tracking::fillSavedTracks()
 {
-    vectorize_map<double>(m_xtrack, v_xtrack), vectorize_map<double>(m_ytrack, v_ytrack);
-    vectorize_map<double>(m_xptrack, v_xptrack), vectorize_map<double>(m_yptrack, v_yptrack);
-    vectorize_map<double>(m_track_chi2ndf, v_track_chi2ndf);
-    vectorize_map<int>(m_track_nhits, v_track_nhits);
-    vectorize_map<double>(m_xlocal, v_xlocal); vectorize_map<double>(m_ylocal, v_ylocal);
-    vectorize_map<double>(m_zlocal, v_zlocal);
-    vectorize_map<int>(m_hit_track_index, v_hit_track_index);
-    vectorize_map<int>(m_hit_module, v_hit_module);
+    std::sort(saved_tracks.begin(), saved_tracks.end(), [](const SavedTrack &a, const SavedTrack &b) {
+            return saved_track_less(a.chi2ndf, a.order, b.chi2ndf, b.order);
+            });
+
+    n_tracks_found = (int)saved_tracks.size();
+    best_track_index = saved_tracks.empty() ? -1 : 0;
+
+    for(int i=0; i<(int)saved_tracks.size(); i++)
+    {
+        const SavedTrack &t = saved_tracks[i];
+        const auto &hits = saved_track_hits[t.slot];
+
+        v_xtrack.push_back(t.xtrack), v_ytrack.push_back(t.ytrack);
+        v_xptrack.push_back(t.xptrack), v_yptrack.push_back(t.yptrack);
+        v_track_chi2ndf.push_back(t.chi2ndf);
+        v_track_nhits.push_back((int)hits.size());
+
+        n_total_good_hits += (int)hits.size();
+        for(auto &h: hits) {
+            v_xlocal.push_back(h.x), v_ylocal.push_back(h.y), v_zlocal.push_back(h.z);
+            v_hit_track_index.push_back(i);
+            v_hit_module.push_back(h.module_id);
+        }
+    }
 }
 
 //
@@ -160,20 +160,24 @@ namespace tracking_dev
         double z_det = det -> GetZPosition();
         det -> Reset();
 
+        layer_hits.clear();
         for(auto &i: detector_2d_hits) {
-            point_t p(i.x, i.y, z_det, i.x_charge, i.y_charge, i.x_peak, i.y_peak, 
+            layer_hits.emplace_back(i.x, i.y, z_det, i.x_charge, i.y_charge, i.x_peak, i.y_peak, 
                     i.x_max_timebin, i.y_max_timebin, i.x_size, i.y_size);
 
             // currently use layer id as module id, this works for now since one layer
             // has only one module; for the future, module_id should be read
             // from mapping file, which is easy to implement, since we already have
             // gem_det pointer here: module_id = gem_det -> GetModuleID();
-            p.module_id = layer;
-            p.layer_id = layer;
+            layer_hits.back().module_id = layer;
+            layer_hits.back().layer_id = layer;
+        }
+
+        // the whole layer at once
+        coord_system -> TransformAll(layer, layer_hits.data(), layer_hits.data(), layer_hits.size());
 
-            coord_system -> Transform(p, layer);
+        for(auto &p: layer_hits)
             det -> AddHit(p);
-        }
     }
 
     void TrackingDataHandler::GetCurrentEvent()
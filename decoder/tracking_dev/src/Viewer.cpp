@@ -5,6 +5,7 @@
 #include "Tracking.h"
 #include "TrackingDataHandler.h"
 #include "TrackingUtility.h"
+#include "ToyEventGenerator.h"
 #include <iostream>
 #include <cstdlib>
 #include <cmath>
@@ -15,8 +16,8 @@
 #include <QLineEdit>
 #include <QFileDialog>
 #include <QSpinBox>
-#include <TRandom.h>
 #include <chrono>
+#include <algorithm>
 
 namespace tracking_dev {
 
@@ -24,9 +25,6 @@ namespace tracking_dev {
 
 Viewer::Viewer(QWidget *parent) : QWidget(parent)
 {
-    // root
-    gen = new TRandom(0);
-
 #ifdef USE_SIM_DATA
     InitToyDetectorSetup();
 #else
@@ -63,6 +61,26 @@ void Viewer::InitToyDetectorSetup()
     }
 
     tracking -> CompleteSetup();
+    // the chi2 of the later tracks in multi-track mode, for the toy resolution (1 mm)
+    tracking -> SetMultiTrackChi2Cut(10.);
+
+    // vertex within +/- 20 mm, slope within +/- 0.1, resolution 1 mm
+    toy_generator = new ToyEventGenerator(TOY_SEED);
+    toy_generator -> SetVertexRange(20., 20.);
+    toy_generator -> SetSlopeRange(1./10., 1./10.);
+    toy_generator -> SetResolution(1.);
+    toy_generator -> SetBackgroundRange(20., 20.);
+
+    // 0, 2, -1, 3
+    //static double x_correct[4] = {0, 0, 0, 0};
+    //static double y_correct[4] = {0, 0, 0, 0};
+    static double x_correct[4] = {-0.1, 1.3, -2.3, 1.1};
+    static double y_correct[4] = {-0.1, 1.3, -2.3, 1.1};
+
+    for(int i=0; i<NDET_SIM; i++) {
+        toy_generator -> AddDetector(fDet[i]);
+        toy_generator -> SetDetectorOffset(i, fXOffset[i] - x_correct[i], fYOffset[i] - y_correct[i]);
+    }
 }
 
 void Viewer::InitGui()
@@ -98,6 +116,7 @@ void Viewer::InitGui()
     btn_next = new QSpinBox(this);
     btn_next -> setRange(0, 9999999);
     btn_50K = new QPushButton("Replay 50K", this);
+    btn_multiplicity = new QPushButton("Toy Multiplicity", this);
     btn_open_file = new QPushButton("Open File", this);
     label_counter = new QLabel("Event Number: 0", this);
     label_file = new QLineEdit("../data/hallc_fadc_ssp_4818.evio.1", this);
@@ -110,6 +129,12 @@ void Viewer::InitGui()
     _tmplayout -> addWidget(label_file);
     _tmplayout -> addWidget(label_counter);
     _tmplayout -> addWidget(btn_50K);
+#ifdef USE_SIM_DATA
+    _tmplayout -> addWidget(btn_multiplicity);
+#else
+    // the toy multiplicity replay needs the toy model events
+    btn_multiplicity -> hide();
+#endif
     _tmplayout -> addWidget(btn_next);
     global_layout -> addLayout(_tmplayout);
 
@@ -117,6 +142,7 @@ void Viewer::InitGui()
     connect(label_file, SIGNAL(textChanged(const QString &)), this, SLOT(ProcessNewFile(const QString &)));
     connect(btn_next, SIGNAL(valueChanged(int)), this, SLOT(DrawEvent(int)));
     connect(btn_50K, SIGNAL(clicked()), this, SLOT(Replay50K()));
+    connect(btn_multiplicity, SIGNAL(clicked()), this, SLOT(ReplayToyMultiplicity()));
 }
 
 void Viewer::OpenFile()
@@ -145,72 +171,24 @@ void Viewer::ProcessNewFile(const QString &_s)
 
 void Viewer::ClearPrevEvent()
 {
+    // the toy generator also clears the truth tracks
+    if(toy_generator) {
+        toy_generator -> ClearEvent();
+        return;
+    }
+
     for(int i=0; i<NDetector_Implemented; i++)
         fDet[i] -> Reset();
 }
 
 void Viewer::GenerateToyTrackEvent()
 {
-    double xrand = gen -> Uniform(-20., 20.);
-    double yrand = gen -> Uniform(-20., 20.);
-
-    static double tanx = 1./10.;
-    static double tany = 1./10.;
-
-    double xdir = gen -> Uniform(-tanx, tanx);
-    double ydir = gen -> Uniform(-tany, tany);
-    static double zdir = 1.;
-
-    point_t dir(xdir, ydir, zdir);
-    dir = dir.unit();
-
-    // 0, 2, -1, 3
-    //static double x_correct[4] = {0, 0, 0, 0};
-    //static double y_correct[4] = {0, 0, 0, 0};
-    static double x_correct[4] = {-0.1, 1.3, -2.3, 1.1};
-    static double y_correct[4] = {-0.1, 1.3, -2.3, 1.1};
-
-    for(int i=0; i<NDetector_Implemented; i++)
-    {
-        point_t origin = fDet[i] -> GetOrigin();
-        point_t z_axis = fDet[i] -> GetZAxis();
-
-        double r =  origin.mod() / z_axis.dot(dir);
-
-        point_t v = dir * r;
-
-        v.x = v.x + xrand;
-        v.y = v.y + yrand;
-
-        // smear by resolution 1mm
-        v.x = gen -> Gaus(v.x, 1.) + fXOffset[i] - x_correct[i];
-        v.y = gen -> Gaus(v.y, 1.) + fYOffset[i] - y_correct[i];
-
-        fDet[i] -> AddRealHits(v); // for drawing purpose
-        fDet[i] -> AddHit(v);
-    }
+    toy_generator -> GenerateTrack();
 }
 
 void Viewer::AddToyEventBackground()
 {
-    for(int i=0; i<NDetector_Implemented; i++)
-    {
-        for(int j=0; j<N_BACKGROUND; j++)
-        {
-            double xrand = gen -> Uniform(-20., 20.);
-            double yrand = gen -> Uniform(-20., 20.);
-            // smear by resoution
-            xrand = gen -> Gaus(xrand, 1.0) + fXOffset[i];
-            yrand = gen -> Gaus(yrand, 1.0) + fYOffset[i];
-            
-            point_t temp = fDet[i] -> GetOrigin();
-
-            temp.x = xrand, temp.y = yrand;
-
-            fDet[i] -> AddBackgroundHits(temp); // for drawing purpose
-            fDet[i] -> AddHit(temp);
-        }
-    }
+    toy_generator -> AddBackground(N_BACKGROUND);
 }
 
 void Viewer::DrawEvent(int event_number)
@@ -412,6 +390,56 @@ void Viewer::Replay50K()
     hist_m.save("Rootfiles/tracking_result.root");
 }
 
+// toy model only, tracking speed with different number of tracks per event,
+// use it with multi-track mode on, to find all the tracks of an event
+void Viewer::ReplayToyMultiplicity()
+{
+#ifdef USE_SIM_DATA
+    typedef std::chrono::high_resolution_clock Time;
+    typedef std::chrono::duration<float> fsec;
+
+    const int nevents = 10000;
+    std::cout<<"multi-track mode: "<<(tracking -> IsMultiTrackMode() ? "on" : "off")<<std::endl;
+
+    for(int ntracks: {1, 2, 4, 8, 16})
+    {
+        long tracks_found = 0, truth_found = 0;
+        float time_used = 0;
+        for(int event_counter=0; event_counter<nevents; event_counter++)
+        {
+            ClearPrevEvent();
+            for(int i=0; i<ntracks; i++)
+                GenerateToyTrackEvent();
+            AddToyEventBackground();
+
+            auto t0 = Time::now();
+            tracking -> FindTracks();
+            fsec fs = Time::now() - t0;
+            time_used += fs.count();
+
+            tracks_found += tracking -> GetNTracksFound();
+
+            // truth tracks found, by a track with only their hits
+            std::vector<int> owner = toy_generator -> MatchTracks(tracking -> GetNTracksFound(),
+                    tracking -> GetAllXlocal(), tracking -> GetAllYlocal(), tracking -> GetAllZlocal(),
+                    tracking -> GetAllHitTrackIndex());
+            std::vector<bool> found(ntracks, false);
+            for(auto &o: owner)
+                if(o >= 0) found[o] = true;
+            truth_found += std::count(found.begin(), found.end(), true);
+        }
+
+        std::cout<<ntracks<<" tracks per event: "
+                 <<(double)tracks_found / nevents<<" tracks found per event, "
+                 <<tracks_found / time_used<<" tracks/s, "
+                 <<truth_found / time_used<<" truth-matched tracks/s, "
+                 <<nevents / time_used<<" events/s"<<std::endl;
+    }
+#else
+    std::cout<<"toy multiplicity replay is only available with USE_SIM_DATA."<<std::endl;
+#endif
+}
+
 void Viewer::FillEventHistos()
 {
     for(int i=0; i<NDetector_Implemented; i++)
@@ -2,6 +2,7 @@
 #include <QApplication>
 #include "Viewer.h"
 #include "Tracking.h"
+#include "CoordSystem.h"
 
 int main(int argc, char* argv[])
 {
@@ -9,6 +10,8 @@ int main(int argc, char* argv[])
     /*
     Tracking *tracking = new Tracking();
     tracking -> UnitTest();
+    CoordSystem *coord_system = new CoordSystem();
+    coord_system -> UnitTest();
     return 0;
     */
 